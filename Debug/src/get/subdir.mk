@@ -5,6 +5,9 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
 ../src/get/account.cpp \
+../src/get/backfill.cpp \
+../src/get/candle_store.cpp \
+../src/get/candles.cpp \
 ../src/get/get.cpp \
 ../src/get/historical.cpp \
 ../src/get/instrument_info.cpp \
@@ -15,6 +18,9 @@ CPP_SRCS += \
 
 OBJS += \
 ./src/get/account.o \
+./src/get/backfill.o \
+./src/get/candle_store.o \
+./src/get/candles.o \
 ./src/get/get.o \
 ./src/get/historical.o \
 ./src/get/instrument_info.o \
@@ -25,6 +31,9 @@ OBJS += \
 
 CPP_DEPS += \
 ./src/get/account.d \
+./src/get/backfill.d \
+./src/get/candle_store.d \
+./src/get/candles.d \
 ./src/get/get.d \
 ./src/get/historical.d \
 ./src/get/instrument_info.d \
@@ -5,16 +5,19 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
 ../src/streaming/streaming.cpp \
+../src/streaming/streaming_decoders.cpp \
 ../src/streaming/streaming_session.cpp \
 ../src/streaming/streaming_subscriptions.cpp 
 
 OBJS += \
 ./src/streaming/streaming.o \
+./src/streaming/streaming_decoders.o \
 ./src/streaming/streaming_session.o \
 ./src/streaming/streaming_subscriptions.o 
 
 CPP_DEPS += \
 ./src/streaming/streaming.d \
+./src/streaming/streaming_decoders.d \
 ./src/streaming/streaming_session.d \
 ./src/streaming/streaming_subscriptions.d 
 
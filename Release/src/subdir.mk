@@ -8,7 +8,9 @@ CPP_SRCS += \
 ../src/common.cpp \
 ../src/curl_connect.cpp \
 ../src/error.cpp \
+../src/request_stats.cpp \
 ../src/tdma_connect.cpp \
+../src/token_cache.cpp \
 ../src/util.cpp \
 ../src/websocket_connect.cpp 
 
@@ -17,7 +19,9 @@ OBJS += \
 ./src/common.o \
 ./src/curl_connect.o \
 ./src/error.o \
+./src/request_stats.o \
 ./src/tdma_connect.o \
+./src/token_cache.o \
 ./src/util.o \
 ./src/websocket_connect.o 
 
@@ -26,7 +30,9 @@ CPP_DEPS += \
 ./src/common.d \
 ./src/curl_connect.d \
 ./src/error.d \
+./src/request_stats.d \
 ./src/tdma_connect.d \
+./src/token_cache.d \
 ./src/util.d \
 ./src/websocket_connect.d 
 
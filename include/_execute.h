@@ -16,11 +16,74 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 */
 
 #include <string>
-
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+#include "curl_connect.h"
+#include "json_writer.h"
 #include "tdma_api_execute.h"
 
 namespace tdma {
 
+/*
+ * to_string() for the order enums w/o a trip through the ABI (and a new
+ * buffer) on every call; the names are looked up once
+ */
+template<typename E, bool(*IsValid)(int)>
+const std::string&
+cached_enum_name(E e)
+{
+    static const std::vector<std::string> names = [](){
+        std::vector<std::string> v;
+        for( int i = 0; i < 32; ++i )
+            v.push_back( IsValid(i) ? to_string(static_cast<E>(i)) : "" );
+        return v;
+    }();
+
+    int i = static_cast<int>(e);
+    if( !IsValid(i) )
+        TDMA_API_THROW(ValueException, "invalid order enum value");
+    return names[i];
+}
+
+#define DEF_ORDER_ENUM_NAME(type) \
+inline const std::string& \
+enum_name(type v) \
+{ return cached_enum_name<type, type##_is_valid>(v); }
+
+DEF_ORDER_ENUM_NAME(OrderSession)
+DEF_ORDER_ENUM_NAME(OrderDuration)
+DEF_ORDER_ENUM_NAME(OrderAssetType)
+DEF_ORDER_ENUM_NAME(OrderInstruction)
+DEF_ORDER_ENUM_NAME(OrderType)
+DEF_ORDER_ENUM_NAME(ComplexOrderStrategyType)
+DEF_ORDER_ENUM_NAME(OrderStrategyType)
+
+#undef DEF_ORDER_ENUM_NAME
+
+
+/*
+ * where OrderTemplateImpl's patchable values are in the serialized order;
+ * each is a slot of WIDTH bytes (value + space padding), npos if absent
+ */
+struct OrderSlots{
+    static const size_t PRICE_WIDTH = 24;
+    static const size_t QUANTITY_WIDTH = 20;
+
+    size_t price;
+    size_t stop_price;
+    std::vector<size_t> quantities; // one per (top-level) leg
+
+    OrderSlots()
+        : price(std::string::npos), stop_price(std::string::npos), quantities()
+        {}
+};
+
+
 class OrderLegImpl {
     OrderAssetType _asset_type;
     std::string _symbol;
@@ -61,9 +124,14 @@ public:
     json
     as_json() const;
 
+    /* same output as as_json().dump() */
     std::string
     as_json_string() const;
 
+    /* 'quantity_slot' (if not null) gets a slot in place of the quantity */
+    void
+    write_json(JsonWriter& writer, size_t *quantity_slot = nullptr) const;
+
     typename ProxyType::CType // need to call Destroy when done
     as_ctype() const;
 };
@@ -113,9 +181,17 @@ public:
     json
     as_json() const;
 
+    /* same output as as_json().dump() */
     std::string
     as_json_string() const;
 
+    /*
+     * 'slots' (if not null) get slots in place of price, stop price and the
+     * legs' quantities (if they're set); children are written as is
+     */
+    void
+    write_json(JsonWriter& writer, OrderSlots *slots = nullptr) const;
+
     OrderSession
     get_session() const;
 
@@ -199,6 +275,163 @@ public:
 };
 
 
+/*
+ * ExecutePool - small set of persistent, pre-warmed connections for order
+ * execution (send/cancel) so a new order doesn't pay for a DNS lookup, TCP
+ * connect and TLS handshake.
+ *
+ * Idle connections are 'pinged' every 'keepalive' so the server doesn't
+ * close them on us - one at a time, paced by the getters' 'accounts' rate
+ * limit. In 'latency first' mode a caller never waits for a
+ * slot - if all are in use a fresh connection is created for that one
+ * request.
+ */
+class ExecutePool{
+    struct Slot{
+        conn::HTTPSExecuteConnection connection;
+        bool busy;
+        conn::clock_ty::time_point last_used;
+        Slot();
+    };
+
+    std::vector<std::shared_ptr<Slot>> _slots;
+    std::chrono::seconds _keepalive;
+    bool _latency_first;
+    std::string _keepalive_url;
+    mutable std::mutex _mtx;
+    std::condition_variable _slot_cond;
+    std::condition_variable _keepalive_cond;
+    bool _stop;
+    std::thread _keepalive_thread;
+
+    ExecutePool();
+
+    void
+    _release(std::shared_ptr<Slot>& slot);
+
+    void
+    _keepalive_loop();
+
+public:
+    static const unsigned int DEF_SIZE;
+    static const std::chrono::seconds DEF_KEEPALIVE;
+
+    /* connection checked out of the pool; returned on destruction */
+    class Lease{
+        friend class ExecutePool;
+        ExecutePool *_pool;
+        std::shared_ptr<Slot> _slot;
+        std::unique_ptr<conn::HTTPSExecuteConnection> _temp;
+
+        Lease(ExecutePool *pool, std::shared_ptr<Slot> slot);
+        Lease(std::unique_ptr<conn::HTTPSExecuteConnection> temp);
+    public:
+        Lease(Lease&& lease) = default;
+        ~Lease();
+
+        conn::HTTPSExecuteConnection&
+        connection();
+    };
+
+    static ExecutePool&
+    instance();
+
+    ExecutePool(const ExecutePool&) = delete;
+
+    ExecutePool&
+    operator=(const ExecutePool&) = delete;
+
+    ~ExecutePool();
+
+    /*
+     * blocks until a slot is free (unless latency_first, size == 0 or
+     * !wait; then a cold connection is used if none are free)
+     */
+    Lease
+    acquire(bool wait = true);
+
+    /* in-use slots finish their request before being dropped */
+    void
+    configure( unsigned int size,
+               std::chrono::seconds keepalive,
+               bool latency_first );
+
+    unsigned int
+    get_size() const;
+
+    std::chrono::seconds
+    get_keepalive() const;
+
+    bool
+    is_latency_first() const;
+
+    /* open (and authorize) every idle slot w/ an account GET */
+    void
+    warm(Credentials& creds, const std::string& account_id);
+};
+
+
+/*
+ * OrderTemplateImpl - an order serialized ahead of time, w/ fixed-width
+ * slots for its price, stop price and leg quantities, bound to its own
+ * (private) connection. Firing it only patches the slots and POSTs.
+ */
+class OrderTemplateImpl{
+    std::string _account_url;
+    std::string _orders_url;
+    std::string _body;
+    OrderSlots _slots;
+    conn::HTTPSExecuteConnection _connection;
+    mutable std::mutex _mtx;
+
+    void
+    _patch(size_t off, size_t width, const char* s, int n, const char* what);
+
+    void
+    _patch_price(size_t off, double price, const char* what);
+
+public:
+    typedef OrderTemplate ProxyType;
+    static const int TYPE_ID_LOW = 1;
+    static const int TYPE_ID_HIGH = 1;
+
+    OrderTemplateImpl( const std::string& account_id,
+                       const OrderTicketImpl& order );
+
+    OrderTemplateImpl( const OrderTemplateImpl& ) = delete;
+
+    OrderTemplateImpl&
+    operator=( const OrderTemplateImpl& ) = delete;
+
+    /* open (and authorize) the connection w/ an account GET */
+    void
+    warm(Credentials& creds);
+
+    /* THROW ValueException if the order had no such field or it won't fit */
+    void
+    set_price(double price);
+
+    void
+    set_stop_price(double stop_price);
+
+    void
+    set_quantity(size_t leg, size_t quantity);
+
+    /* (w/ the slot padding) */
+    std::string
+    as_json_string() const;
+
+    /* returns the order id */
+    std::string
+    send(Credentials& creds);
+};
+
+
+/* (empty if not found) */
+std::string
+order_id_from_header(const std::string& header);
+
+
 template<typename T>
 int
 order_obj_is_same( typename T::ProxyType::CType *pl,
@@ -17,8 +17,15 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 
 #include <string>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <exception>
 
 #include "curl_connect.h"
+#include "rate_limiter.h"
 #include "tdma_api_get.h"
 
 namespace tdma {
@@ -42,20 +49,166 @@ const int TYPE_ID_GETTER_ORDERS = 16;
 const int TYPE_ID_GETTER_USER_PRINCIPALS = 17;
 const int TYPE_ID_GETTER_INSTRUMENT_INFO = 18;
 
+/* struct-of-arrays candles; 'datetime' in msec since epoch */
+struct CandleColumns{
+    std::vector<long long> datetime;
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<long long> volume;
+
+    size_t
+    size() const
+    { return datetime.size(); }
+
+    void
+    reserve(size_t n);
+
+    void
+    clear();
+
+    void
+    push_back( long long dt,
+               double o,
+               double h,
+               double l,
+               double c,
+               long long v );
+};
+
+/*
+ * decode (append) the 'candles' of a pricehistory response straight into
+ * 'columns' w/o building a json DOM. THROWS ValueException
+ */
+void
+decode_candles(const char* data, size_t n, CandleColumns& columns);
+
+/*
+ * decode the 'candles' of a pricehistory response straight into ONE newly
+ * allocated Candles_C block (free w/ FreeCandles_ABI). THROWS
+ * ValueException, leaving *pcandles zeroed
+ */
+void
+decode_candles(const char* data, size_t n, Candles_C *pcandles);
+
+/* ONE allocation for all arrays; free w/ FreeCandles_ABI */
+int
+candles_to_abi( const CandleColumns& columns,
+                Candles_C *pcandles,
+                bool allow_exceptions );
+
+
+class HistoricalRangeGetterImpl;
+
+/*
+ * HistoricalRangeFetcher - one reusable range getter (and connection) for
+ * library-side batch jobs; defined in historical.cpp. NOT thread-safe, use
+ * one per thread (w/ its own Credentials).
+ */
+class HistoricalRangeFetcher{
+    Credentials& _creds;
+    FrequencyType _frequency_type;
+    unsigned int _frequency;
+    bool _extended_hours;
+    std::unique_ptr<HistoricalRangeGetterImpl> _getter;
+
+public:
+    HistoricalRangeFetcher( Credentials& creds,
+                            FrequencyType frequency_type,
+                            unsigned int frequency,
+                            bool extended_hours );
+
+    ~HistoricalRangeFetcher();
+
+    /* (throttled) get, appending to 'columns'; returns response size */
+    size_t
+    fetch( const std::string& symbol,
+           unsigned long long start_msec_since_epoch,
+           unsigned long long end_msec_since_epoch,
+           CandleColumns& columns );
+};
+
+
+/* backfill.cpp */
+typedef std::function<void(const std::string&, CandleColumns&&,
+                           std::exception_ptr)> backfill_symbol_cb_ty;
+
+typedef std::function<void(const BackfillProgress_C&)>
+    backfill_progress_cb_ty;
+
+/* largest span one pricehistory request can cover for 'frequency_type' */
+unsigned long long
+backfill_window_msec(FrequencyType frequency_type);
+
+/*
+ * split [start, end] into windows, fetch them on 'nworkers' threads (under
+ * the shared rate limits) and merge/dedupe by symbol. Blocks until done.
+ *
+ * 'on_symbol' gets each symbol's candles (or the first error) as soon as
+ * its last window comes in; callbacks are called one at a time from the
+ * worker threads.
+ */
+void
+backfill_history( Credentials& creds,
+                  const std::vector<std::string>& symbols,
+                  FrequencyType frequency_type,
+                  unsigned int frequency,
+                  unsigned long long start_msec_since_epoch,
+                  unsigned long long end_msec_since_epoch,
+                  bool extended_hours,
+                  unsigned int nworkers,
+                  backfill_symbol_cb_ty on_symbol,
+                  backfill_progress_cb_ty on_progress );
+
+
 class APIGetterImpl{
-    static std::chrono::milliseconds wait_msec; // DEF_WAIT_MSEC
-    static std::chrono::milliseconds last_get_msec; // 0
-    static std::mutex get_mtx;
+    /* indexed by EndpointFamilyType; 'all' defaults to DEF_WAIT_MSEC */
+    static RateLimiter rate_limiters[4];
 
-    static std::string
+    /* caller holds getter._in_flight */
+    static conn::ResponseBuffer
     throttled_get(APIGetterImpl& getter);
 
-    static std::chrono::milliseconds
-    throttled_wait_remaining();
+    static EndpointFamilyType
+    endpoint_family_from_url(const std::string& url);
+
+    /*
+     * ONE request (sync or async) in flight per getter; the underlying
+     * connection can't be shared. Held from the start of get()/get_async()
+     * until it returns/calls back.
+     */
+    class InFlightGuard{
+        std::mutex _mtx;
+        std::condition_variable _cond;
+        bool _busy;
+    public:
+        InFlightGuard() : _busy(false) {}
+
+        void
+        acquire()
+        {
+            std::unique_lock<std::mutex> l(_mtx);
+            _cond.wait( l, [this](){ return !_busy; } );
+            _busy = true;
+        }
+
+        void
+        release()
+        {
+            {
+                std::lock_guard<std::mutex> _(_mtx);
+                _busy = false;
+            }
+            _cond.notify_all();
+        }
+    };
 
     api_on_error_cb_ty _on_error_callback;
     std::reference_wrapper<Credentials> _credentials;
     conn::HTTPSGetConnection _connection;
+    EndpointFamilyType _endpoint_family;
+    std::unique_ptr<InFlightGuard> _in_flight;
 
 protected:
     APIGetterImpl(Credentials& creds, api_on_error_cb_ty on_error_callback);
@@ -77,12 +230,21 @@ protected:
     APIGetterImpl&
     operator=( APIGetterImpl&& ) = default;
 
+    /* waits for an outstanding async request */
     virtual
-    ~APIGetterImpl(){}
+    ~APIGetterImpl();
 
     void
     set_url(std::string url);
 
+    /*
+     * called before every request, sync or async, before any I/O: THROW
+     * on bad input, false to skip the request and return empty data
+     */
+    virtual bool
+    _check_request()
+    { return true; }
+
 public:
     typedef APIGetter ProxyType;
     static const int TYPE_ID_LOW = TYPE_ID_GETTER_QUOTE;
@@ -99,9 +261,36 @@ public:
     static std::chrono::milliseconds
     wait_remaining();
 
-    virtual std::string
+    static void
+    set_rate_limit( EndpointFamilyType endpoint_family,
+                    std::chrono::milliseconds interval,
+                    unsigned int burst );
+
+    static std::pair<std::chrono::milliseconds, unsigned int>
+    get_rate_limit(EndpointFamilyType endpoint_family);
+
+    /* reserve a slot from 'all' AND 'endpoint_family' (doesn't block) */
+    static conn::clock_ty::time_point
+    reserve(EndpointFamilyType endpoint_family);
+
+    /* reserve and sleep until the slot is ours */
+    static void
+    throttle(EndpointFamilyType endpoint_family);
+
+    std::string
     get();
 
+    /* the buffer curl wrote into; override this, not get() */
+    virtual conn::ResponseBuffer
+    get_buffer();
+
+    /*
+     * returns immediately; 'callback' is called once, from a library
+     * thread, w/ the data or an exception
+     */
+    void
+    get_async(connect_async_cb_ty callback);
+
     void
     close();
 
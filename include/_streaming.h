@@ -18,6 +18,7 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include "_tdma_api.h"
 #include "tdma_api_streaming.h"
@@ -42,6 +43,7 @@ const int TYPE_ID_SUB_ACTIVES_NASDAQ = 15;
 const int TYPE_ID_SUB_ACTIVES_NYSE = 16;
 const int TYPE_ID_SUB_ACTIVES_OTCBB = 17;
 const int TYPE_ID_SUB_ACTIVES_OPTION = 18;
+const int TYPE_ID_SUB_ACCT_ACTIVITY = 19;
 
 const int TYPE_ID_STREAMING_SESSION = 100;
 
@@ -53,6 +55,64 @@ StreamerInfo
 get_streamer_info(Credentials& creds);
 
 
+/*
+ * decode the raw 'content' array of a 'data' response; THROW on bad data
+ * (exported for the offline tests)
+ */
+DLL_SPEC_ void
+decode_quote_updates( const char* content,
+                      size_t n,
+                      std::vector<QuoteUpdate_C>& updates );
+
+DLL_SPEC_ void
+decode_option_updates( const char* content,
+                       size_t n,
+                       std::vector<OptionUpdate_C>& updates );
+
+DLL_SPEC_ void
+decode_futures_updates( const char* content,
+                        size_t n,
+                        std::vector<LevelOneFuturesUpdate_C>& updates );
+
+DLL_SPEC_ void
+decode_forex_updates( const char* content,
+                      size_t n,
+                      std::vector<LevelOneForexUpdate_C>& updates );
+
+DLL_SPEC_ void
+decode_timesale_ticks( const char* content,
+                       size_t n,
+                       std::vector<TimesaleTick_C>& ticks );
+
+/* CHART_EQUITY, CHART_FUTURES or CHART_OPTIONS */
+DLL_SPEC_ void
+decode_chart_bars( StreamerServiceType service,
+                   const char* content,
+                   size_t n,
+                   std::vector<ChartBar_C>& bars );
+
+/* one per message; unknown message types are 'other' */
+DLL_SPEC_ void
+decode_acct_activity( const char* content,
+                      size_t n,
+                      std::vector<AcctActivity_C>& messages );
+
+/* copy the fields set in 'update' over 'state' (and add them to its bits) */
+void
+merge_update(QuoteUpdate_C& state, const QuoteUpdate_C& update);
+
+void
+merge_update(OptionUpdate_C& state, const OptionUpdate_C& update);
+
+void
+merge_update( LevelOneFuturesUpdate_C& state,
+              const LevelOneFuturesUpdate_C& update );
+
+void
+merge_update( LevelOneForexUpdate_C& state,
+              const LevelOneForexUpdate_C& update );
+
+
 class StreamingSubscriptionImpl{
     StreamerServiceType _service;
     std::string _command;
@@ -68,7 +128,7 @@ protected:
 public:
     typedef StreamingSubscription ProxyType;
     static const int TYPE_ID_LOW = TYPE_ID_SUB_QUOTES;
-    static const int TYPE_ID_HIGH = TYPE_ID_SUB_ACTIVES_OPTION;
+    static const int TYPE_ID_HIGH = TYPE_ID_SUB_ACCT_ACTIVITY;
 
     static
     std::string
@@ -47,11 +47,70 @@ connect_get( conn::HTTPSConnection& connection,
              Credentials& creds,
              api_on_error_cb_ty on_error_cb );
 
+/* the buffer curl wrote into (see ResponseBuffer::release) */
+std::pair<conn::ResponseBuffer, conn::clock_ty::time_point>
+connect_get_buffer( conn::HTTPSConnection& connection,
+                    Credentials& creds,
+                    api_on_error_cb_ty on_error_cb );
+
+/* called once (from a library thread) w/ data or a non-null exception_ptr */
+typedef std::function<void(std::string, std::exception_ptr)>
+    connect_async_cb_ty;
+
+void
+connect_get_async( conn::HTTPSConnection& connection,
+                   Credentials& creds,
+                   api_on_error_cb_ty on_error_cb,
+                   connect_async_cb_ty callback,
+                   conn::clock_ty::time_point not_before
+                       = conn::clock_ty::now() );
+
 std::pair<std::string, conn::clock_ty::time_point>
 connect_execute( conn::HTTPSConnection& connection,
                    Credentials& creds,
                    long success_code );
 
+/* connect_execute on the async engine; 'callback' gets the response header */
+void
+connect_execute_async( conn::HTTPSConnection& connection,
+                       Credentials& creds,
+                       long success_code,
+                       connect_async_cb_ty callback );
+
+/* per-endpoint request stats (see RequestStats_Get_ABI) */
+void
+record_request(const conn::RequestTiming& timing);
+
+/* time a GET to 'url' waited on the rate limiter */
+void
+record_throttle_wait(const std::string& url, conn::clock_ty::duration wait);
+
+/*
+ * access token cache (by client_id) - THROW if creds are invalid
+ *
+ * refresh_cached_access_token is single-flight: if 'stale_token' is still
+ * cached one caller refreshes while the others wait and share the result;
+ * if it's not the current cached token is returned w/o a refresh
+ */
+std::string
+cached_access_token(Credentials& creds);
+
+std::string
+refresh_cached_access_token(Credentials& creds, const std::string& stale_token);
+
+/* for tokens refreshed outside the cache; life_sec <= 0 if unknown */
+void
+update_cached_access_token(const Credentials& creds, long long life_sec);
+
+/* for tokens loaded from disk (age unknown); refreshed once, in the
+   background */
+void
+load_cached_access_token(const Credentials& creds);
+
+/* refresh creds->access_token; returns its lifetime in sec (0 if unknown) */
+long long
+refresh_access_token(Credentials* creds);
+
 json
 get_user_principals_for_streaming(Credentials& creds);
 
@@ -85,6 +144,10 @@ set_error_state( int code,
 std::tuple<int, std::string, int, std::string>
 get_error_state();
 
+/* error code and message of an exception, for async callbacks */
+void
+error_from_exception(std::exception_ptr eptr, int *code, std::string *msg);
+
 
 template<typename RetTy>
 struct ImplReturnHelper{
@@ -192,7 +255,8 @@ kill_proxy( ProxyTy *proxy,
                 IsValidCProxy<ProxyTy, Getter_C>::value ||
                 IsValidCProxy<ProxyTy, StreamingSubscription_C>::value ||
                 IsValidCProxy<ProxyTy, OrderLeg_C>::value ||
-                IsValidCProxy<ProxyTy, OrderTicket_C>::value
+                IsValidCProxy<ProxyTy, OrderTicket_C>::value ||
+                IsValidCProxy<ProxyTy, OrderTemplate_C>::value
                 >::type* _ = nullptr )
 {
     proxy->obj = nullptr;
@@ -0,0 +1,205 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef CALLBACK_DISPATCHER_H
+#define CALLBACK_DISPATCHER_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+#include "_tdma_api.h"
+#include "tdma_api_streaming.h"
+#include "spsc_ring.h"
+
+namespace tdma{
+
+/*
+ * CallbackDispatcher - runs tasks on a fixed set of worker threads, one per
+ * shard; ONE thread pushes:
+ *
+ * 1) tasks for a shard run in the order pushed, so anything that always
+ *    goes to the same shard (e.g a symbol's updates) stays in order.
+ *
+ * 2) each shard is an SPSCRing so push never blocks; the task slots (and
+ *    their buffers) get re-used.
+ *
+ * 3) stop() lets the workers finish everything pushed before it.
+ */
+template<typename T>
+class CallbackDispatcher{
+public:
+    typedef std::function<void(T&)> exec_ty;
+
+private:
+    /* interrupt() pops a default Slot - 'live' false - to stop the worker */
+    struct Slot{
+        T task;
+        size_t nupdates;
+        bool live;
+
+        Slot() : task(), nupdates(0), live(false) {}
+    };
+
+    struct Shard{
+        SPSCRing<Slot> ring;
+        std::thread thread;
+        std::atomic<unsigned long long> tasks;
+        std::atomic<unsigned long long> updates;
+        std::atomic<unsigned long long> queue_max;
+        std::atomic<long long> callback_usec;
+        std::atomic<long long> callback_max_usec;
+
+        explicit Shard(size_t capacity)
+            :
+                ring(capacity),
+                thread(),
+                tasks(0),
+                updates(0),
+                queue_max(0),
+                callback_usec(0),
+                callback_max_usec(0)
+            {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> _shards;
+    exec_ty _exec;
+    bool _running;
+
+    void
+    _work(Shard& s)
+    {
+        using namespace std::chrono;
+
+        Slot slot;
+        for( ;; ){
+            s.ring.pop_or_wait(slot);
+            if( !slot.live )
+                break;
+
+            auto beg = steady_clock::now();
+            _exec(slot.task);
+            long long usec = duration_cast<microseconds>(
+                steady_clock::now() - beg ).count();
+
+            s.tasks.fetch_add(1, std::memory_order_relaxed);
+            s.updates.fetch_add(slot.nupdates, std::memory_order_relaxed);
+            s.callback_usec.fetch_add(usec, std::memory_order_relaxed);
+            if( usec > s.callback_max_usec.load(std::memory_order_relaxed) )
+                s.callback_max_usec.store(usec, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    CallbackDispatcher(size_t nshards, size_t capacity, exec_ty exec)
+        :
+            _shards(),
+            _exec(exec),
+            _running(false)
+        {
+            for( size_t i = 0; i < nshards; ++i )
+                _shards.emplace_back( new Shard(capacity) );
+        }
+
+    ~CallbackDispatcher()
+    { stop(); }
+
+    CallbackDispatcher( const CallbackDispatcher& ) = delete;
+
+    CallbackDispatcher&
+    operator=( const CallbackDispatcher& ) = delete;
+
+    void
+    start()
+    {
+        if( _running )
+            return;
+        for( auto& s : _shards ){
+            Shard *ps = s.get();
+            s->thread = std::thread( [this, ps](){ _work(*ps); } );
+        }
+        _running = true;
+    }
+
+    /* BLOCKS until the workers have run everything already pushed */
+    void
+    stop()
+    {
+        if( !_running )
+            return;
+        for( auto& s : _shards )
+            s->ring.interrupt();
+        for( auto& s : _shards ){
+            if( s->thread.joinable() )
+                s->thread.join();
+        }
+        _running = false;
+    }
+
+    size_t
+    size() const
+    { return _shards.size(); }
+
+    /* PUSHER - fill(T&) sets the (re-used) task */
+    template<typename F>
+    void
+    push(size_t shard, size_t nupdates, F fill)
+    {
+        Shard& s = *_shards[shard];
+        s.ring.push( [&](Slot& slot){
+            slot.live = true;
+            slot.nupdates = nupdates;
+            fill(slot.task);
+        });
+
+        /* only we raise it */
+        unsigned long long depth = s.ring.size();
+        if( depth > s.queue_max.load(std::memory_order_relaxed) )
+            s.queue_max.store(depth, std::memory_order_relaxed);
+    }
+
+    /* THROWS ValueException if 'shard' >= size() */
+    void
+    stats(size_t shard, StreamingDispatchStats_C *pstats) const
+    {
+        if( shard >= _shards.size() ){
+            TDMA_API_THROW( ValueException,
+                            "invalid dispatch shard: " + std::to_string(shard) );
+        }
+
+        const Shard& s = *_shards[shard];
+        unsigned long long tasks = s.tasks.load(std::memory_order_relaxed);
+        pstats->tasks = tasks;
+        pstats->updates = s.updates.load(std::memory_order_relaxed);
+        pstats->queue_depth = s.ring.size();
+        pstats->queue_max = s.queue_max.load(std::memory_order_relaxed);
+        pstats->spilled = s.ring.nspilled();
+        pstats->callback_msec = s.callback_usec.load(std::memory_order_relaxed)
+                                / (tasks ? static_cast<double>(tasks) : 1.0)
+                                / 1000.0;
+        pstats->callback_max_msec =
+            s.callback_max_usec.load(std::memory_order_relaxed) / 1000.0;
+    }
+};
+
+} /* tdma */
+
+#endif /* CALLBACK_DISPATCHER_H */
@@ -0,0 +1,184 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef CANDLE_STORE_H
+#define CANDLE_STORE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "_common.h"
+#include "tdma_api_get.h"
+
+namespace tdma{
+
+struct CandleColumns;
+
+/* read-only mapping of the first 'size' bytes of a file */
+class MappedFile{
+    const char *_data;
+    size_t _size;
+    mutable std::string _retired_path; // deleted w/ the mapping (windows)
+#ifdef _WIN32
+    void *_hmap;
+#endif /* _WIN32 */
+
+public:
+    MappedFile(const std::string& path, size_t size);
+
+    ~MappedFile();
+
+    MappedFile( const MappedFile& ) = delete;
+
+    MappedFile&
+    operator=( const MappedFile& ) = delete;
+
+    const char*
+    data() const
+    { return _data; }
+
+    size_t
+    size() const
+    { return _size; }
+
+    /* the file was renamed to 'path'; delete it once unmapped (windows) */
+    void
+    retire(const std::string& path) const
+    { _retired_path = path; }
+};
+
+
+/* zero-copy slice of a store file; shares ownership of the mapping */
+struct CandleStoreView{
+    std::shared_ptr<const MappedFile> mapping;
+    const CandleRecord_C *records;
+    size_t n;
+};
+
+
+/*
+ * CandleStoreFile - candles of one symbol/frequency on disk:
+ *
+ *   [base].candles : small header + CandleRecord_C records sorted by
+ *                    datetime w/o duplicates. Candles past the end are
+ *                    appended, anything else (gap/head fills) rewrites
+ *                    the file. Read through a (re)mapping of the file;
+ *                    views keep their (old) mapping. On windows a
+ *                    rewrite renames the mapped file to [base].candles.oldN
+ *                    first, deleted when its last view goes away.
+ *
+ *   [base].index   : the [start, end] msec ranges already fetched so we
+ *                    know what's missing even where there's no data
+ *                    (nights, weekends, holidays etc.)
+ *
+ * Only completed bars are stored. Thread-safe, NOT process-safe.
+ */
+class CandleStoreFile{
+public:
+    typedef std::pair<unsigned long long, unsigned long long> range_ty;
+
+private:
+    std::string _data_path;
+    std::string _index_path;
+    unsigned long long _bar_msec;
+    std::vector<range_ty> _coverage; // sorted, disjoint
+    std::shared_ptr<const MappedFile> _mapping;
+    size_t _count;
+    unsigned long long _generation; // of retired data files (windows)
+    mutable std::mutex _mtx;
+
+    const CandleRecord_C*
+    _records() const;
+
+    void
+    _load();
+
+    void
+    _map();
+
+    void
+    _append(const std::vector<CandleRecord_C>& records);
+
+    void
+    _rewrite(const std::vector<CandleRecord_C>& records);
+
+    void
+    _cover(unsigned long long start, unsigned long long end);
+
+    void
+    _write_index() const;
+
+public:
+    CandleStoreFile(const std::string& base_path, unsigned long long bar_msec);
+
+    /* latest datetime a completed bar can have right now */
+    unsigned long long
+    last_complete_msec() const;
+
+    /* ranges in [start, end] not fetched yet (end clamped to completed bars) */
+    std::vector<range_ty>
+    missing(unsigned long long start, unsigned long long end) const;
+
+    /* store the (completed) candles in [start, end] fetched for that range */
+    void
+    insert( unsigned long long start,
+            unsigned long long end,
+            const CandleColumns& candles );
+
+    CandleStoreView
+    view(unsigned long long start, unsigned long long end) const;
+
+    size_t
+    size() const;
+};
+
+
+/*
+ * CandleStore - a directory of CandleStoreFiles, one per symbol, frequency
+ * type, frequency and extended hours. An empty directory disables it.
+ */
+class CandleStore{
+    std::string _directory;
+    std::map<std::string, std::shared_ptr<CandleStoreFile>> _files;
+    mutable std::mutex _mtx;
+
+    CandleStore() {}
+
+public:
+    static CandleStore&
+    instance();
+
+    void
+    set_directory(const std::string& directory);
+
+    std::string
+    get_directory() const;
+
+    /* THROWS if no directory has been set */
+    std::shared_ptr<CandleStoreFile>
+    open( const std::string& symbol,
+          FrequencyType frequency_type,
+          unsigned int frequency,
+          bool extended_hours );
+};
+
+} /* tdma */
+
+#endif /* CANDLE_STORE_H */
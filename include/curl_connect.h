@@ -26,6 +26,9 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <mutex>
 #include <tuple>
 #include <memory>
+#include <functional>
+#include <exception>
+#include <chrono>
 
 #include "_common.h"
 #include "curl/curl.h"
@@ -39,6 +42,116 @@ typedef std::chrono::steady_clock clock_ty;
 static_assert( static_cast<double>(clock_ty::period::num)
                / clock_ty::period::den <= .001, "invalid tick size of clock" );
 
+/*
+ * ResponseBuffer - malloc'd, growable byte buffer that curl writes the
+ * response body into. Movable, not copyable.
+ *
+ * release() hands the underlying (NUL-terminated) buffer to the caller,
+ * who must free() it; this lets the ABI pass the bytes curl wrote straight
+ * to the client (FreeBuffer_ABI) without another copy.
+ */
+class ResponseBuffer{
+    char *_data;
+    size_t _size;
+    size_t _capacity;
+
+public:
+    ResponseBuffer();
+
+    ResponseBuffer( ResponseBuffer&& buffer );
+
+    ResponseBuffer&
+    operator=( ResponseBuffer&& buffer );
+
+    ResponseBuffer( const ResponseBuffer& ) = delete;
+
+    ResponseBuffer&
+    operator=( const ResponseBuffer& ) = delete;
+
+    ~ResponseBuffer();
+
+    /* THROWS std::bad_alloc */
+    void
+    reserve(size_t n);
+
+    /* THROWS std::bad_alloc */
+    void
+    append(const char* data, size_t n);
+
+    /* size -> 0, keeps the allocation */
+    void
+    clear()
+    { _size = 0; }
+
+    const char*
+    data() const
+    { return _data ? _data : ""; }
+
+    size_t
+    size() const
+    { return _size; }
+
+    size_t
+    capacity() const
+    { return _capacity; }
+
+    bool
+    empty() const
+    { return _size == 0; }
+
+    std::string
+    str() const
+    { return std::string(data(), _size); }
+
+    /*
+     * give up ownership of the buffer; 'n' is set to size + 1 (the
+     * terminating NUL). Caller must free(). THROWS std::bad_alloc
+     */
+    char*
+    release(size_t *n);
+};
+
+// <status code, data, header, time>
+typedef std::tuple<long, std::string, std::string, clock_ty::time_point>
+    execute_result_ty;
+
+// <status code, data, header, time>
+typedef std::tuple<long, ResponseBuffer, std::string, clock_ty::time_point>
+    execute_buffer_result_ty;
+
+/*
+ * completion callback for execute_async; called from the engine thread
+ * w/ a non-null exception_ptr on failure - SHOULD NOT BLOCK
+ *
+ * SHOULD NOT THROW: if it throws when handed a result it's called once
+ * more w/ that exception; anything thrown from an error call is dropped.
+ */
+typedef std::function<void(execute_result_ty, std::exception_ptr)>
+    execute_cb_ty;
+
+/*
+ * RequestTiming - what curl reports about the last request on a handle
+ *
+ * phase times are in usec from the start of the request (curl's
+ * definitions), i.e cumulative: namelookup <= connect <= appconnect <=
+ * starttransfer <= total. Phases skipped on a re-used connection are 0.
+ */
+struct RequestTiming{
+    std::string url;
+    std::string method;
+    long code; // http response code, 0 if none
+    CURLcode curl_code;
+    long long namelookup_usec;
+    long long connect_usec;
+    long long appconnect_usec;
+    long long starttransfer_usec;
+    long long total_usec;
+    unsigned long long bytes_down;
+    unsigned long long bytes_up;
+
+    RequestTiming();
+};
+
 class CurlConnection {
     friend std::ostream&
     operator<<(std::ostream& out, const CurlConnection& session);       
@@ -83,6 +196,36 @@ public:
     std::tuple<long, std::string, std::string, clock_ty::time_point>
     execute(bool return_header_data);
 
+    /* same as execute() but hands back the buffer curl wrote into */
+    execute_buffer_result_ty
+    execute_buffer(bool return_header_data);
+
+    /*
+     * hand the request to the (single thread) curl_multi engine, starting no
+     * earlier than 'not_before'; returns immediately. Connection MUST stay
+     * alive, and not be used, until the callback has been called.
+     */
+    void
+    execute_async( bool return_header_data,
+                   execute_cb_ty callback,
+                   clock_ty::time_point not_before = clock_ty::now() );
+
+    /*
+     * run 'job' on the engine's (single) worker thread, in order, for
+     * blocking work an execute_async callback can't do itself (e.g. a
+     * token refresh and retry). Jobs still queued when the engine shuts
+     * down are dropped; the worker is joined.
+     */
+    static void
+    execute_blocking(std::function<void()> job);
+
+    /* timing of the last request that completed (or failed) in curl */
+    RequestTiming
+    last_timing() const;
+
+    std::string
+    GET_url() const;
+
     void
     close();
 
@@ -169,6 +312,20 @@ public:
 };
 
 
+/* re-usable connection that can change method between requests */
+class HTTPSExecuteConnection
+        : public HTTPSConnection{
+    void _set();
+public:
+    HTTPSExecuteConnection();
+    HTTPSExecuteConnection(std::string url);
+
+    /* "GET", "POST", "PUT", "DELETE" etc. */
+    void
+    SET_method(const std::string& method, const std::string& fields = "");
+};
+
+
 class CurlException
         : public std::exception{
     std::string _what;
@@ -0,0 +1,150 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef JSON_SCANNER_H
+#define JSON_SCANNER_H
+
+#include <utility>
+#include <cstring>
+#include <cstdlib>
+
+namespace tdma{
+
+/*
+ * JsonScanner - forward-only primitives for pulling a few values out of a
+ * JSON buffer w/o building a DOM. Derived classes walk the structure they
+ * expect; anything else throws Fail. The buffer isn't NUL-terminated.
+ */
+class JsonScanner{
+protected:
+    struct Fail{};
+
+    typedef std::pair<const char*, size_t> slice_ty;
+
+    const char *_p;
+    const char *_end;
+
+    JsonScanner(const char* data, size_t n)
+        : _p(data), _end(data + n)
+        {}
+
+    void
+    _skip_ws()
+    {
+        while( _p < _end &&
+               (*_p == ' ' || *_p == '\n' || *_p == '\r' || *_p == '\t') )
+        {
+            ++_p;
+        }
+    }
+
+    char
+    _peek()
+    {
+        _skip_ws();
+        if( _p >= _end )
+            throw Fail();
+        return *_p;
+    }
+
+    void
+    _expect(char c)
+    {
+        if( _peek() != c )
+            throw Fail();
+        ++_p;
+    }
+
+    /* returns true if it consumed 'c' */
+    bool
+    _consume(char c)
+    {
+        if( _peek() != c )
+            return false;
+        ++_p;
+        return true;
+    }
+
+    /* raw [begin, len), escapes left in place */
+    slice_ty
+    _string()
+    {
+        _expect('"');
+        const char *b = _p;
+        while( _p < _end && *_p != '"' ){
+            if( *_p == '\\' )
+                ++_p;
+            ++_p;
+        }
+        if( _p >= _end )
+            throw Fail();
+        return std::make_pair(b, static_cast<size_t>(_p++ - b));
+    }
+
+    /* number, true, false, null: raw [begin, len) */
+    slice_ty
+    _literal()
+    {
+        _peek();
+        const char *b = _p;
+        while( _p < _end && *_p != ',' && *_p != '}' && *_p != ']'
+               && *_p != ' ' && *_p != '\n' && *_p != '\r' && *_p != '\t' )
+        {
+            ++_p;
+        }
+        if( _p == b )
+            throw Fail();
+        return std::make_pair(b, static_cast<size_t>(_p - b));
+    }
+
+    void
+    _skip_value()
+    {
+        char c = _peek();
+        if( c == '"' ){
+            _string();
+            return;
+        }
+        if( c == '{' || c == '[' ){
+            int depth = 0;
+            do{
+                if( _p >= _end )
+                    throw Fail();
+                c = *_p;
+                if( c == '"' ){
+                    _string();
+                    continue;
+                }
+                if( c == '{' || c == '[' )
+                    ++depth;
+                else if( c == '}' || c == ']' )
+                    --depth;
+                ++_p;
+            }while( depth > 0 );
+            return;
+        }
+        _literal();
+    }
+
+    static bool
+    _is(const slice_ty& s, const char* str, size_t n)
+    { return s.second == n && memcmp(s.first, str, n) == 0; }
+};
+
+} /* tdma */
+
+#endif /* JSON_SCANNER_H */
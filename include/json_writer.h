@@ -0,0 +1,213 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <cstdio>
+
+#include "json.hpp"
+
+namespace tdma{
+
+/*
+ * JsonWriter - appends compact JSON to a buffer w/o building a DOM; the
+ * buffer's capacity is kept across clear() so a re-used writer stops
+ * allocating. Output matches json::dump() as long as the caller writes
+ * object keys in sorted order (json objects are std::maps).
+ */
+class JsonWriter{
+    std::string _buf;
+    bool _comma;
+
+    void
+    _sep()
+    {
+        if( _comma )
+            _buf.push_back(',');
+        _comma = true;
+    }
+
+    void
+    _escaped(const char* s, size_t n)
+    {
+        static const char HEX[] = "0123456789abcdef";
+
+        size_t start = _buf.size();
+        _buf.push_back('"');
+        for( size_t i = 0; i < n; ++i ){
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            if( c >= 0x80 ){
+                /* let json validate/copy the multi-byte case */
+                _buf.resize(start);
+                _buf.append( nlohmann::json(std::string(s, n)).dump() );
+                return;
+            }
+            switch( c ){
+            case '\b': _buf.append("\\b", 2); break;
+            case '\t': _buf.append("\\t", 2); break;
+            case '\n': _buf.append("\\n", 2); break;
+            case '\f': _buf.append("\\f", 2); break;
+            case '\r': _buf.append("\\r", 2); break;
+            case '"': _buf.append("\\\"", 2); break;
+            case '\\': _buf.append("\\\\", 2); break;
+            default:
+                if( c <= 0x1F ){
+                    _buf.append("\\u00", 4);
+                    _buf.push_back( HEX[c >> 4] );
+                    _buf.push_back( HEX[c & 0xF] );
+                }else{
+                    _buf.push_back( static_cast<char>(c) );
+                }
+            }
+        }
+        _buf.push_back('"');
+    }
+
+public:
+    JsonWriter()
+        : _buf(), _comma(false)
+        {}
+
+    void
+    clear()
+    {
+        _buf.clear();
+        _comma = false;
+    }
+
+    const std::string&
+    str() const
+    { return _buf; }
+
+    JsonWriter&
+    begin_object()
+    {
+        _sep();
+        _buf.push_back('{');
+        _comma = false;
+        return *this;
+    }
+
+    JsonWriter&
+    end_object()
+    {
+        _buf.push_back('}');
+        _comma = true;
+        return *this;
+    }
+
+    JsonWriter&
+    begin_array()
+    {
+        _sep();
+        _buf.push_back('[');
+        _comma = false;
+        return *this;
+    }
+
+    JsonWriter&
+    end_array()
+    {
+        _buf.push_back(']');
+        _comma = true;
+        return *this;
+    }
+
+    /* 'k' is a literal and isn't escaped */
+    JsonWriter&
+    key(const char* k)
+    {
+        _sep();
+        _buf.push_back('"');
+        _buf.append(k);
+        _buf.append("\":", 2);
+        _comma = false;
+        return *this;
+    }
+
+    JsonWriter&
+    value(const std::string& s)
+    {
+        _sep();
+        _escaped(s.c_str(), s.size());
+        return *this;
+    }
+
+    JsonWriter&
+    value(unsigned long long v)
+    {
+        char tmp[24];
+        char *p = tmp + sizeof(tmp);
+        do{
+            *--p = static_cast<char>('0' + v % 10);
+            v /= 10;
+        }while( v );
+        _sep();
+        _buf.append(p, tmp + sizeof(tmp) - p);
+        return *this;
+    }
+
+    /*
+     * 'width' spaces in place of a value, to be patch()ed later; returns
+     * its offset. (whitespace after a value is valid JSON)
+     */
+    size_t
+    slot(size_t width)
+    {
+        _sep();
+        size_t off = _buf.size();
+        _buf.append(width, ' ');
+        return off;
+    }
+
+    /* false (and no change) if 'n' is wider than the slot */
+    static bool
+    patch(std::string& buf, size_t off, size_t width, const char* s, size_t n)
+    {
+        if( n > width )
+            return false;
+        buf.replace(off, n, s, n);
+        buf.replace(off + n, width - n, width - n, ' ');
+        return true;
+    }
+
+    /* a quoted, fixed-point string (same as util::to_fixedpoint_string) */
+    JsonWriter&
+    fixedpoint_value(double v, unsigned int decimal_places = 4)
+    {
+        /* big enough for any double in %f at the usual precision */
+        char tmp[352];
+        int prec = static_cast<int>(decimal_places);
+        int n = std::snprintf(tmp, sizeof(tmp), "\"%.*f\"", prec, v);
+        _sep();
+        if( n < static_cast<int>(sizeof(tmp)) ){
+            _buf.append(tmp, n);
+        }else{
+            size_t off = _buf.size();
+            _buf.resize(off + n + 1);
+            std::snprintf(&_buf[off], n + 1, "\"%.*f\"", prec, v);
+            _buf.resize(off + n);
+        }
+        return *this;
+    }
+};
+
+} /* tdma */
+
+#endif /* JSON_WRITER_H */
@@ -0,0 +1,323 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef LEVEL_ONE_CACHE_H
+#define LEVEL_ONE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+
+#include "_tdma_api.h"
+#include "tdma_api_streaming.h"
+
+namespace tdma{
+
+/*
+ * SeqlockTable - latest state of each symbol, for ONE writer and any
+ * number of readers:
+ *
+ * 1) symbols are interned to ids (0, 1, 2...) on first write; readers can
+ *    look an id up once and skip the symbol map from then on.
+ *
+ * 2) records live in fixed-size chunks that never move, so a published id
+ *    always refers to the same record.
+ *
+ * 3) each record is a seqlock: the writer makes the sequence odd, stores,
+ *    then makes it even; readers copy and retry if it changed/was odd.
+ *    Readers never block the writer. Records are stored as atomic words
+ *    so the racing copy is well-defined.
+ *
+ * 4) the writer merges each update into the current state, so readers
+ *    always get the full (consistent) record.
+ */
+template<typename T>
+class SeqlockTable{
+    static_assert( std::is_pod<T>::value
+                   && sizeof(T) % sizeof(unsigned long long) == 0,
+                   "SeqlockTable needs a POD record of whole words" );
+
+    typedef unsigned long long word_ty;
+
+    static const size_t NWORDS = sizeof(T) / sizeof(word_ty);
+    static const size_t CHUNK_BITS = 10;
+    static const size_t CHUNK_SIZE = 1 << CHUNK_BITS;
+    static const size_t MAX_CHUNKS = 1024;
+
+    struct Record{
+        std::atomic<unsigned> seq;
+        std::atomic<word_ty> words[NWORDS];
+    };
+
+    std::atomic<Record*> _chunks[MAX_CHUNKS];
+    std::atomic<size_t> _size;
+
+    /* only the writer inserts, so it can read w/o the lock */
+    std::unordered_map<std::string, size_t> _ids;
+    std::vector<std::string> _symbols;
+    mutable std::mutex _ids_mtx;
+
+    Record*
+    _record(size_t id) const
+    {
+        return _chunks[id >> CHUNK_BITS].load(std::memory_order_acquire)
+               + (id & (CHUNK_SIZE - 1));
+    }
+
+    static void
+    _load(const Record& r, T& t)
+    {
+        word_ty *w = reinterpret_cast<word_ty*>(&t);
+        for( size_t i = 0; i < NWORDS; ++i )
+            w[i] = r.words[i].load(std::memory_order_relaxed);
+    }
+
+    static void
+    _store(Record& r, const T& t)
+    {
+        const word_ty *w = reinterpret_cast<const word_ty*>(&t);
+        for( size_t i = 0; i < NWORDS; ++i )
+            r.words[i].store(w[i], std::memory_order_relaxed);
+    }
+
+    /* WRITER - false if the table is full */
+    bool
+    _intern(const std::string& symbol, size_t *id)
+    {
+        auto i = _ids.find(symbol);
+        if( i != _ids.end() ){
+            *id = i->second;
+            return true;
+        }
+
+        size_t n = _size.load(std::memory_order_relaxed);
+        if( n == MAX_CHUNKS * CHUNK_SIZE )
+            return false;
+        if( (n & (CHUNK_SIZE - 1)) == 0 ){
+            /* value-initialized: seq and words all zero */
+            _chunks[n >> CHUNK_BITS].store( new Record[CHUNK_SIZE](),
+                                            std::memory_order_release );
+        }
+
+        std::lock_guard<std::mutex> _(_ids_mtx);
+        _ids.emplace(symbol, n);
+        _symbols.push_back(symbol);
+        *id = n;
+        return true;
+    }
+
+public:
+    SeqlockTable()
+        : _size(0)
+    {
+        for( auto& c : _chunks )
+            c.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~SeqlockTable()
+    {
+        for( auto& c : _chunks )
+            delete[] c.load();
+    }
+
+    SeqlockTable( const SeqlockTable& ) = delete;
+
+    SeqlockTable&
+    operator=( const SeqlockTable& ) = delete;
+
+    /* WRITER - merge(T& state) updates the symbol's current state */
+    template<typename F>
+    void
+    update(const std::string& symbol, F merge)
+    {
+        size_t id;
+        if( !_intern(symbol, &id) )
+            return;
+
+        Record& r = *_record(id);
+        T t = T();
+        _load(r, t);
+        merge(t);
+
+        unsigned seq = r.seq.load(std::memory_order_relaxed);
+        r.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _store(r, t);
+        r.seq.store(seq + 2, std::memory_order_release);
+
+        if( id == _size.load(std::memory_order_relaxed) )
+            _size.store(id + 1, std::memory_order_release);
+    }
+
+    /* READER - false if 'id' hasn't been written yet */
+    bool
+    get(size_t id, T& t) const
+    {
+        if( id >= _size.load(std::memory_order_acquire) )
+            return false;
+
+        const Record& r = *_record(id);
+        for( ;; ){
+            unsigned seq = r.seq.load(std::memory_order_acquire);
+            if( seq & 1 )
+                continue;
+            _load(r, t);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if( r.seq.load(std::memory_order_relaxed) == seq )
+                return true;
+        }
+    }
+
+    /* READER - -1 if 'symbol' hasn't been written yet */
+    long long
+    id(const std::string& symbol) const
+    {
+        std::lock_guard<std::mutex> _(_ids_mtx);
+        auto i = _ids.find(symbol);
+        if( i == _ids.end() )
+            return -1;
+        /* inserted before its first record is published */
+        size_t id = i->second;
+        return id < _size.load(std::memory_order_acquire)
+               ? static_cast<long long>(id) : -1;
+    }
+
+    bool
+    get(const std::string& symbol, T& t) const
+    {
+        long long i = id(symbol);
+        return i >= 0 && get(static_cast<size_t>(i), t);
+    }
+
+    std::vector<std::string>
+    symbols() const
+    {
+        size_t n = _size.load(std::memory_order_acquire);
+        std::lock_guard<std::mutex> _(_ids_mtx);
+        return std::vector<std::string>(_symbols.begin(),
+                                        _symbols.begin() + n);
+    }
+
+    size_t
+    size() const
+    { return _size.load(std::memory_order_acquire); }
+};
+
+
+/*
+ * LevelOneCache - level one state by service, written by a session's
+ * listener thread. The by-service methods THROW ValueException if 'service'
+ * isn't QUOTE, OPTION, LEVELONE_FUTURES or LEVELONE_FOREX, or 'record_size'
+ * isn't the size of its record type.
+ */
+struct LevelOneCache{
+    SeqlockTable<QuoteUpdate_C> quotes;
+    SeqlockTable<OptionUpdate_C> options;
+    SeqlockTable<LevelOneFuturesUpdate_C> futures;
+    SeqlockTable<LevelOneForexUpdate_C> forex;
+
+    static size_t
+    record_size(StreamerServiceType service)
+    {
+        switch( service ){
+        case StreamerServiceType::QUOTE:
+            return sizeof(QuoteUpdate_C);
+        case StreamerServiceType::OPTION:
+            return sizeof(OptionUpdate_C);
+        case StreamerServiceType::LEVELONE_FUTURES:
+            return sizeof(LevelOneFuturesUpdate_C);
+        case StreamerServiceType::LEVELONE_FOREX:
+            return sizeof(LevelOneForexUpdate_C);
+        default:
+            TDMA_API_THROW( ValueException,
+                            "no level one cache for service: "
+                            + to_string(service) );
+        }
+    }
+
+    long long
+    id(StreamerServiceType service, const std::string& symbol) const
+    {
+        switch( service ){
+        case StreamerServiceType::QUOTE: return quotes.id(symbol);
+        case StreamerServiceType::OPTION: return options.id(symbol);
+        case StreamerServiceType::LEVELONE_FUTURES: return futures.id(symbol);
+        case StreamerServiceType::LEVELONE_FOREX: return forex.id(symbol);
+        default: record_size(service);
+        }
+        return -1;
+    }
+
+    std::vector<std::string>
+    symbols(StreamerServiceType service) const
+    {
+        switch( service ){
+        case StreamerServiceType::QUOTE: return quotes.symbols();
+        case StreamerServiceType::OPTION: return options.symbols();
+        case StreamerServiceType::LEVELONE_FUTURES: return futures.symbols();
+        case StreamerServiceType::LEVELONE_FOREX: return forex.symbols();
+        default: record_size(service);
+        }
+        return {};
+    }
+
+    /* false if 'id' hasn't been written yet */
+    bool
+    get( StreamerServiceType service,
+         size_t id,
+         void *record,
+         size_t record_size ) const
+    {
+        if( record_size != LevelOneCache::record_size(service) ){
+            TDMA_API_THROW( ValueException,
+                            "invalid record size for service: "
+                            + to_string(service) );
+        }
+        switch( service ){
+        case StreamerServiceType::QUOTE:
+            return quotes.get(id, *static_cast<QuoteUpdate_C*>(record));
+        case StreamerServiceType::OPTION:
+            return options.get(id, *static_cast<OptionUpdate_C*>(record));
+        case StreamerServiceType::LEVELONE_FUTURES:
+            return futures.get(id,
+                *static_cast<LevelOneFuturesUpdate_C*>(record));
+        case StreamerServiceType::LEVELONE_FOREX:
+            return forex.get(id,
+                *static_cast<LevelOneForexUpdate_C*>(record));
+        default:
+            return false;
+        }
+    }
+
+    bool
+    get( StreamerServiceType service,
+         const std::string& symbol,
+         void *record,
+         size_t record_size ) const
+    {
+        long long i = id(service, symbol);
+        return i >= 0
+            && get(service, static_cast<size_t>(i), record, record_size);
+    }
+};
+
+} /* tdma */
+
+#endif /* LEVEL_ONE_CACHE_H */
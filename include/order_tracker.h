@@ -0,0 +1,215 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef ORDER_TRACKER_H
+#define ORDER_TRACKER_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include "level_one_cache.h"
+#include "tdma_api_get.h"
+
+namespace tdma{
+
+/*
+ * OrderTracker - state of each order seen on ACCT_ACTIVITY, by order id,
+ * written by a session's listener thread (same rules as SeqlockTable).
+ *
+ * Status follows the messages: entry -> ACCEPTED, route/activation ->
+ * WORKING, fills -> WORKING/FILLED, cancel request -> PENDING_CANCEL,
+ * UROUT -> CANCELED (or REPLACED if a replace is pending) etc. An order
+ * first seen mid-life (e.g. a fill) starts out ACCEPTED and has whatever
+ * the message had; quantity is 0 if that didn't include the order.
+ */
+class OrderTracker{
+    SeqlockTable<OrderState_C> _orders;
+
+    static bool
+    _is_done(int status)
+    {
+        switch( static_cast<OrderStatusType>(status) ){
+        case OrderStatusType::FILLED:
+        case OrderStatusType::CANCELED:
+        case OrderStatusType::REJECTED:
+        case OrderStatusType::REPLACED:
+        case OrderStatusType::EXPIRED:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    template<size_t N>
+    static void
+    _set(char (&to)[N], const char* from)
+    {
+        size_t n = strnlen(from, N - 1);
+        memcpy(to, from, n);
+        to[n] = 0;
+    }
+
+    template<size_t N>
+    static void
+    _copy(char (&to)[N], const char* from)
+    {
+        if( *from )
+            _set(to, from);
+    }
+
+    static void
+    _fill(OrderState_C& o, const AcctActivity_C& m)
+    {
+        double qty = m.execution_quantity;
+        if( qty > 0 ){
+            double filled = o.filled_quantity + qty;
+            o.average_fill_price =
+                (o.average_fill_price * o.filled_quantity
+                 + m.execution_price * qty) / filled;
+            o.filled_quantity = filled;
+            o.last_fill_price = m.execution_price;
+            o.last_fill_quantity = qty;
+        }
+
+        bool done;
+        if( m.leaves_quantity >= 0 ){
+            o.remaining_quantity = m.leaves_quantity;
+            done = (m.leaves_quantity == 0);
+        }else if( o.quantity > 0 ){ /* no <LeavesQuantity> */
+            o.remaining_quantity = std::max(0.0, o.quantity - o.filled_quantity);
+            done = (o.remaining_quantity == 0);
+        }else{ /* don't know the size; go by the message */
+            done = ( m.message_type
+                     == static_cast<int>(AcctActivityMessageType::order_fill) );
+        }
+        o.status = static_cast<int>( done ? OrderStatusType::FILLED
+                                          : OrderStatusType::WORKING );
+    }
+
+    static void
+    _apply( OrderState_C& o,
+            unsigned long long timestamp,
+            const AcctActivity_C& m )
+    {
+        if( !*o.order_id ){
+            _set(o.order_id, m.order_id);
+            o.status = static_cast<int>(OrderStatusType::ACCEPTED);
+        }
+        _copy(o.account, m.account);
+        _copy(o.symbol, m.symbol);
+        _copy(o.instruction, m.instruction);
+        if( m.quantity > 0 )
+            o.quantity = m.quantity;
+        if( m.limit_price > 0 )
+            o.limit_price = m.limit_price;
+        if( m.message_type != static_cast<int>(AcctActivityMessageType::other) )
+            o.last_message_type = m.message_type;
+        o.update_time = timestamp;
+
+        /* (fills overwrite this w/ 'leaves') */
+        if( o.quantity > o.filled_quantity )
+            o.remaining_quantity = o.quantity - o.filled_quantity;
+        else if( o.quantity > 0 )
+            o.remaining_quantity = 0;
+
+        switch( static_cast<AcctActivityMessageType>(m.message_type) ){
+        case AcctActivityMessageType::order_entry_request:
+        case AcctActivityMessageType::order_cancel_replace_request:
+            o.status = static_cast<int>(OrderStatusType::ACCEPTED);
+            break;
+        case AcctActivityMessageType::order_route:
+        case AcctActivityMessageType::order_activation:
+            if( !_is_done(o.status) )
+                o.status = static_cast<int>(OrderStatusType::WORKING);
+            break;
+        case AcctActivityMessageType::order_partial_fill:
+        case AcctActivityMessageType::order_fill:
+        case AcctActivityMessageType::manual_execution:
+            _fill(o, m);
+            break;
+        case AcctActivityMessageType::order_cancel_request:
+            if( !_is_done(o.status) )
+                o.status = static_cast<int>(OrderStatusType::PENDING_CANCEL);
+            break;
+        case AcctActivityMessageType::too_late_to_cancel:
+            if( o.status == static_cast<int>(OrderStatusType::PENDING_CANCEL)
+                || o.status
+                    == static_cast<int>(OrderStatusType::PENDING_REPLACE) )
+            {
+                o.status = static_cast<int>(OrderStatusType::WORKING);
+            }
+            break;
+        case AcctActivityMessageType::ur_out:
+            o.status = static_cast<int>(
+                (o.status == static_cast<int>(OrderStatusType::PENDING_REPLACE))
+                    ? OrderStatusType::REPLACED
+                    : OrderStatusType::CANCELED
+                );
+            break;
+        case AcctActivityMessageType::order_rejection:
+            o.status = static_cast<int>(OrderStatusType::REJECTED);
+            break;
+        default:
+            break;
+        }
+    }
+
+public:
+    /* WRITER - messages w/o an order id (SUBSCRIBED, ERROR) are ignored */
+    void
+    apply(unsigned long long timestamp, const AcctActivity_C& m)
+    {
+        if( !*m.order_id )
+            return;
+
+        if( *m.original_order_id ){
+            _orders.update( m.original_order_id,
+                [&m](OrderState_C& o){
+                    if( !*o.order_id ){
+                        _set(o.order_id, m.original_order_id);
+                        _copy(o.account, m.account);
+                    }
+                    if( !_is_done(o.status) ){
+                        o.status =
+                            static_cast<int>(OrderStatusType::PENDING_REPLACE);
+                    }
+                } );
+        }
+
+        _orders.update( m.order_id,
+                        [&](OrderState_C& o){ _apply(o, timestamp, m); } );
+    }
+
+    /* READER - false if 'order_id' hasn't been seen */
+    bool
+    get(const std::string& order_id, OrderState_C& state) const
+    { return _orders.get(order_id, state); }
+
+    std::vector<std::string>
+    order_ids() const
+    { return _orders.symbols(); }
+
+    size_t
+    size() const
+    { return _orders.size(); }
+};
+
+} /* tdma */
+
+#endif /* ORDER_TRACKER_H */
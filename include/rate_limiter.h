@@ -0,0 +1,133 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+
+#include "_common.h"
+
+namespace tdma{
+
+/*
+ * RateLimiter - token bucket (implemented as a virtual-scheduling GCRA)
+ *
+ * The bucket holds up to 'burst' tokens and refills one token every
+ * 'interval'. reserve() claims the next available token and returns the
+ * time point at which the caller is allowed to proceed. The internal mutex
+ * is only held long enough to do the arithmetic - callers sleep (and do
+ * their I/O) WITHOUT holding it - so any number of requests can be in
+ * flight at once while their *start* times still honor the rate.
+ *
+ * An interval of 0 disables the bucket (reserve returns immediately).
+ */
+class RateLimiter{
+public:
+    typedef std::chrono::steady_clock clock_ty;
+
+private:
+    std::chrono::milliseconds _interval;
+    unsigned int _burst;
+    clock_ty::time_point _tat; // 'theoretical arrival time' of next token
+    mutable std::mutex _mtx;
+
+    std::chrono::milliseconds
+    _span() const
+    { return _interval * _burst; }
+
+public:
+    RateLimiter( std::chrono::milliseconds interval, unsigned int burst = 1 )
+        :
+            _interval( interval ),
+            _burst( std::max(burst, 1U) ),
+            _tat( clock_ty::now() ),
+            _mtx()
+        {
+        }
+
+    RateLimiter( const RateLimiter& ) = delete;
+
+    RateLimiter&
+    operator=( const RateLimiter& ) = delete;
+
+    /*
+     * reserve a token no earlier than 'earliest'; returns when the
+     * caller can proceed (>= earliest). Chaining reservations through
+     * 'earliest' lets a request draw from more than one bucket.
+     */
+    clock_ty::time_point
+    reserve( clock_ty::time_point earliest = clock_ty::now() )
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        if( _interval.count() <= 0 )
+            return earliest;
+
+        _tat = std::max(_tat, earliest) + _interval;
+        return std::max(earliest, _tat - _span());
+    }
+
+    std::chrono::milliseconds
+    wait_remaining() const
+    {
+        using namespace std::chrono;
+
+        std::lock_guard<std::mutex> _(_mtx);
+        if( _interval.count() <= 0 )
+            return milliseconds(0);
+
+        auto now = clock_ty::now();
+        auto next = std::max(_tat, now) + _interval - _span();
+        return (next > now) ? duration_cast<milliseconds>(next - now)
+                            : milliseconds(0);
+    }
+
+    std::chrono::milliseconds
+    get_interval() const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _interval;
+    }
+
+    unsigned int
+    get_burst() const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _burst;
+    }
+
+    void
+    set(std::chrono::milliseconds interval, unsigned int burst)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _interval = interval;
+        _burst = std::max(burst, 1U);
+    }
+
+    void
+    set_interval(std::chrono::milliseconds interval)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _interval = interval;
+    }
+};
+
+} /* tdma */
+
+#endif /* RATE_LIMITER_H */
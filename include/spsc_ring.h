@@ -0,0 +1,285 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <limits>
+
+#include "_common.h"
+
+/*
+ * SPSCRing - bounded single-producer/single-consumer ring of re-used slots
+ *
+ * 1) the producer fills a slot in place (push(fill) calls fill(T&)) and
+ *    the consumer swaps it out (pop(T&)), so the consumer's old object -
+ *    and its allocation - goes back into the ring: w/ strings, a steady
+ *    stream of messages doesn't allocate.
+ *
+ * 2) push/pop are lock-free; head/tail sit on their own cache lines.
+ *
+ * 3) the consumer only takes the park mutex when it's about to wait, and
+ *    the producer only takes it (to notify) when the consumer is parked.
+ *
+ * 4) a full ring never blocks the producer (an event loop); it spills into
+ *    a locked deque - order preserved - until the consumer catches up.
+ *
+ * 5) interrupt() has the consumer get an empty T once everything pushed
+ *    before the call has been popped (a 'stop' marker that doesn't need a
+ *    second producer).
+ *
+ * ONE producer thread and ONE consumer thread at a time; handing either
+ * role to another thread needs its own synchronization (e.g thread join).
+ */
+template<typename T>
+class SPSCRing {
+    static const size_t CACHE_LINE = 64;
+    static const size_t NO_INTERRUPT = std::numeric_limits<size_t>::max();
+
+    std::vector<T> _slots;
+    const size_t _mask;
+    char _pad0[CACHE_LINE];
+
+    std::atomic<size_t> _head; // consumer
+    std::atomic<size_t> _popped; // includes spilled
+    char _pad1[CACHE_LINE];
+
+    std::atomic<size_t> _tail; // producer
+    std::atomic<size_t> _pushed; // includes spilled
+    char _pad2[CACHE_LINE];
+
+    std::atomic<bool> _spilling;
+    std::deque<T> _spill;
+    std::atomic<size_t> _nspilled;
+    std::mutex _spill_mtx;
+
+    std::atomic<bool> _parked;
+    std::atomic<size_t> _interrupt_at;
+    std::mutex _park_mtx;
+    std::condition_variable _park_cond;
+
+    static size_t
+    _pow2(size_t n)
+    {
+        size_t p = 2;
+        while( p < n )
+            p <<= 1;
+        return p;
+    }
+
+    void
+    _wake()
+    {
+        /* pairs w/ the fence in pop_or_wait_until */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if( _parked.load(std::memory_order_relaxed) ){
+            std::lock_guard<std::mutex> _(_park_mtx);
+            _park_cond.notify_one();
+        }
+    }
+
+    template<typename F>
+    bool
+    _push_spill(F& fill)
+    {
+        std::lock_guard<std::mutex> _(_spill_mtx);
+        if( !_spilling.load(std::memory_order_relaxed) )
+            return false; // consumer drained it, back to the ring
+        T t;
+        fill(t);
+        _spill.push_back( std::move(t) );
+        ++_nspilled;
+        return true;
+    }
+
+    /* CONSUMER */
+    bool
+    _pop_ring(T& out)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if( head == _tail.load(std::memory_order_acquire) )
+            return false;
+        using std::swap;
+        swap(out, _slots[head & _mask]);
+        _head.store(head + 1, std::memory_order_release);
+        _popped.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+public:
+    typedef T value_type;
+
+    explicit SPSCRing(size_t capacity)
+        :
+            _slots( _pow2(capacity) ),
+            _mask( _slots.size() - 1 ),
+            _head(0),
+            _popped(0),
+            _tail(0),
+            _pushed(0),
+            _spilling(false),
+            _nspilled(0),
+            _parked(false),
+            _interrupt_at(NO_INTERRUPT)
+        {}
+
+    SPSCRing( const SPSCRing& ) = delete;
+
+    SPSCRing&
+    operator=( const SPSCRing& ) = delete;
+
+    /* PRODUCER - fill(T&) sets the (re-used) slot */
+    template<typename F>
+    void
+    push(F fill)
+    {
+        for( ;; ){
+            if( _spilling.load(std::memory_order_acquire) ){
+                if( _push_spill(fill) )
+                    break;
+                continue;
+            }
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            if( tail - _head.load(std::memory_order_acquire) > _mask ){
+                /* full */
+                {
+                    std::lock_guard<std::mutex> _(_spill_mtx);
+                    _spilling.store(true, std::memory_order_release);
+                }
+                continue;
+            }
+            fill( _slots[tail & _mask] );
+            _tail.store(tail + 1, std::memory_order_release);
+            break;
+        }
+        _pushed.fetch_add(1, std::memory_order_release);
+        _wake();
+    }
+
+    /* ANY THREAD - see (5) above */
+    void
+    interrupt()
+    {
+        _interrupt_at.store( _pushed.load(std::memory_order_acquire),
+                             std::memory_order_release );
+        _wake();
+    }
+
+    /* CONSUMER - false if nothing to pop */
+    bool
+    pop(T& out)
+    {
+        /* >= : _pushed is bumped after the slot is published */
+        if( _popped.load(std::memory_order_relaxed)
+            >= _interrupt_at.load(std::memory_order_acquire) )
+        {
+            _interrupt_at.store(NO_INTERRUPT, std::memory_order_relaxed);
+            out = T();
+            return true;
+        }
+
+        if( _pop_ring(out) )
+            return true;
+
+        /*
+         * the ring looked empty but the producer may have filled it and
+         * started spilling since; re-check under the lock - the ring's
+         * frames are older than anything spilled
+         */
+        if( _spilling.load(std::memory_order_acquire) ){
+            std::lock_guard<std::mutex> _(_spill_mtx);
+            if( _pop_ring(out) )
+                return true;
+            if( !_spill.empty() ){
+                using std::swap;
+                swap(out, _spill.front());
+                _spill.pop_front();
+                if( _spill.empty() )
+                    _spilling.store(false, std::memory_order_release);
+                _popped.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* CONSUMER - false on timeout */
+    bool
+    pop_or_wait_until( T& out,
+                       std::chrono::steady_clock::time_point deadline )
+    {
+        for( ;; ){
+            if( pop(out) )
+                return true;
+
+            std::unique_lock<std::mutex> lock(_park_mtx);
+            _parked.store(true, std::memory_order_relaxed);
+            /* pairs w/ the fence in _wake */
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if( pop(out) ){
+                _parked.store(false, std::memory_order_relaxed);
+                return true;
+            }
+            auto status = _park_cond.wait_until(lock, deadline);
+            _parked.store(false, std::memory_order_relaxed);
+            if( status == std::cv_status::timeout ){
+                lock.unlock();
+                return pop(out);
+            }
+        }
+    }
+
+    bool
+    pop_or_wait_for(T& out, std::chrono::milliseconds timeout)
+    {
+        return pop_or_wait_until(out,
+                                 std::chrono::steady_clock::now() + timeout);
+    }
+
+    void
+    pop_or_wait(T& out)
+    {
+        while( !pop_or_wait_for(out, std::chrono::hours(1)) )
+            {}
+    }
+
+    /* approximate if pushing/popping */
+    size_t
+    size() const
+    {
+        size_t popped = _popped.load(std::memory_order_relaxed);
+        size_t pushed = _pushed.load(std::memory_order_acquire);
+        return pushed > popped ? pushed - popped : 0;
+    }
+
+    size_t
+    capacity() const
+    { return _slots.size(); }
+
+    /* total pushes that found the ring full */
+    size_t
+    nspilled() const
+    { return _nspilled.load(std::memory_order_relaxed); }
+};
+
+#endif // SPSC_RING_H
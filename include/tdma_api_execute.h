@@ -24,6 +24,10 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #ifdef __cplusplus
 
 #include <regex>
+#include <chrono>
+#include <tuple>
+#include <future>
+#include <memory>
 
 #endif /* __cplusplus */
 
@@ -307,9 +311,13 @@ public:
     get_cproxy() const
     { return _cproxy.get(); }
 
+    std::string
+    as_json_string() const
+    { return str_from_abi(json_func, get_cproxy()); }
+
     json
     as_json() const
-    { return json::parse( str_from_abi(json_func, get_cproxy()) ); }
+    { return json::parse( as_json_string() ); }
 
 };
 
@@ -4338,6 +4346,124 @@ Execute_CancelOrder_ABI( struct Credentials *creds,
                          int *success,
                          int allow_exceptions );
 
+/* replace 'order_id' w/ 'porder'; returns the new order's id */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Execute_ReplaceOrder_ABI( struct Credentials *creds,
+                          const char* account_id,
+                          const char* order_id,
+                          OrderTicket_C *porder,
+                          char** buf,
+                          size_t *n,
+                          int allow_exceptions );
+
+/*
+ * when an async order went out, its first response byte came back and it
+ * completed - usec since epoch (system clock); first_byte_usec is 0 if
+ * no response was received
+ */
+typedef struct {
+    long long send_usec;
+    long long first_byte_usec;
+    long long complete_usec;
+} ExecuteTiming_C;
+
+/*
+ * send_order_async callback: (error code, order id OR error message, size
+ * w/ NULL term, timing, ctx passed to SendOrderAsync). Called once from a
+ * library thread; the buffer and timing are only valid for the duration
+ * of the call. SHOULD NOT BLOCK.
+ */
+typedef void(*send_order_async_cb_ty)(int, const char*, size_t,
+                                      const ExecuteTiming_C*, void*);
+
+/*
+ * returns once the order is handed to the library's async engine; many
+ * orders can be in flight at once, each on its own (pooled if free)
+ * connection. 'creds' MUST outlive the callback.
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Execute_SendOrderAsync_ABI( struct Credentials *creds,
+                            const char* account_id,
+                            OrderTicket_C *porder,
+                            send_order_async_cb_ty callback,
+                            void *ctx,
+                            int allow_exceptions );
+
+/*
+ * Execution connection pool - persistent, pre-warmed connections used by
+ * Execute_SendOrder/Execute_ReplaceOrder/Execute_CancelOrder.
+ * (size == 0 disables the pool)
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Execute_ConfigurePool_ABI( unsigned int size,
+                           unsigned long keepalive_sec,
+                           int latency_first,
+                           int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Execute_GetPoolConfig_ABI( unsigned int *size,
+                           unsigned long *keepalive_sec,
+                           int *latency_first,
+                           int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Execute_WarmPool_ABI( struct Credentials *creds,
+                      const char* account_id,
+                      int allow_exceptions );
+
+/*
+ * OrderTemplate - an order serialized ahead of time, w/ fixed-width slots
+ * for its price, stop price and (top-level) leg quantities, bound to its
+ * own connection; firing it only patches those slots and sends. Child
+ * orders are sent as they were when the template was created.
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OrderTemplate_Create_ABI( const char* account_id,
+                          OrderTicket_C *porder,
+                          OrderTemplate_C *ptemplate,
+                          int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OrderTemplate_Destroy_ABI( OrderTemplate_C *ptemplate, int allow_exceptions );
+
+/* open (and authorize) the template's connection w/ an account GET */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OrderTemplate_Warm_ABI( OrderTemplate_C *ptemplate,
+                        struct Credentials *creds,
+                        int allow_exceptions );
+
+/* the order must have had a (non-zero) price/stop price to set it */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OrderTemplate_SetPrice_ABI( OrderTemplate_C *ptemplate,
+                            double price,
+                            int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OrderTemplate_SetStopPrice_ABI( OrderTemplate_C *ptemplate,
+                                double stop_price,
+                                int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OrderTemplate_SetQuantity_ABI( OrderTemplate_C *ptemplate,
+                               size_t leg,
+                               size_t quantity,
+                               int allow_exceptions );
+
+/* the JSON that will be sent (slots are space-padded) */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OrderTemplate_AsJsonString_ABI( OrderTemplate_C *ptemplate,
+                                char **buf,
+                                size_t *n,
+                                int allow_exceptions );
+
+/* returns order id */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OrderTemplate_Send_ABI( OrderTemplate_C *ptemplate,
+                        struct Credentials *creds,
+                        char **buf,
+                        size_t *n,
+                        int allow_exceptions );
+
 #ifndef __cplusplus
 
 static inline int
@@ -4356,6 +4482,84 @@ Execute_CancelOrder( struct Credentials *creds,
                      int *success )
 { return Execute_CancelOrder_ABI(creds, account_id, order_id, success, 0); }
 
+static inline int
+Execute_ReplaceOrder( struct Credentials *creds,
+                      const char* account_id,
+                      const char* order_id,
+                      OrderTicket_C *porder,
+                      char** buf,
+                      size_t *n )
+{
+    return Execute_ReplaceOrder_ABI(creds, account_id, order_id, porder, buf,
+                                    n, 0);
+}
+
+static inline int
+Execute_SendOrderAsync( struct Credentials *creds,
+                        const char* account_id,
+                        OrderTicket_C *porder,
+                        send_order_async_cb_ty callback,
+                        void *ctx )
+{
+    return Execute_SendOrderAsync_ABI(creds, account_id, porder, callback,
+                                      ctx, 0);
+}
+
+static inline int
+OrderTemplate_Create( const char* account_id,
+                      OrderTicket_C *porder,
+                      OrderTemplate_C *ptemplate )
+{ return OrderTemplate_Create_ABI(account_id, porder, ptemplate, 0); }
+
+static inline int
+OrderTemplate_Destroy( OrderTemplate_C *ptemplate )
+{ return OrderTemplate_Destroy_ABI(ptemplate, 0); }
+
+static inline int
+OrderTemplate_Warm( OrderTemplate_C *ptemplate, struct Credentials *creds )
+{ return OrderTemplate_Warm_ABI(ptemplate, creds, 0); }
+
+static inline int
+OrderTemplate_SetPrice( OrderTemplate_C *ptemplate, double price )
+{ return OrderTemplate_SetPrice_ABI(ptemplate, price, 0); }
+
+static inline int
+OrderTemplate_SetStopPrice( OrderTemplate_C *ptemplate, double stop_price )
+{ return OrderTemplate_SetStopPrice_ABI(ptemplate, stop_price, 0); }
+
+static inline int
+OrderTemplate_SetQuantity( OrderTemplate_C *ptemplate,
+                           size_t leg,
+                           size_t quantity )
+{ return OrderTemplate_SetQuantity_ABI(ptemplate, leg, quantity, 0); }
+
+static inline int
+OrderTemplate_AsJsonString( OrderTemplate_C *ptemplate, char **buf, size_t *n )
+{ return OrderTemplate_AsJsonString_ABI(ptemplate, buf, n, 0); }
+
+static inline int
+OrderTemplate_Send( OrderTemplate_C *ptemplate,
+                    struct Credentials *creds,
+                    char **buf,
+                    size_t *n )
+{ return OrderTemplate_Send_ABI(ptemplate, creds, buf, n, 0); }
+
+static inline int
+Execute_ConfigurePool( unsigned int size,
+                       unsigned long keepalive_sec,
+                       int latency_first )
+{ return Execute_ConfigurePool_ABI(size, keepalive_sec, latency_first, 0); }
+
+static inline int
+Execute_GetPoolConfig( unsigned int *size,
+                       unsigned long *keepalive_sec,
+                       int *latency_first )
+{ return Execute_GetPoolConfig_ABI(size, keepalive_sec, latency_first, 0); }
+
+static inline int
+Execute_WarmPool( struct Credentials *creds, const char* account_id )
+{ return Execute_WarmPool_ABI(creds, account_id, 0); }
+
 
 #else
 
@@ -4379,6 +4583,159 @@ Execute_CancelOrder( Credentials& creds,
     return static_cast<bool>(success);
 }
 
+/* returns the new order's id */
+inline std::string
+Execute_ReplaceOrder( Credentials& creds,
+                      const std::string& account_id,
+                      const std::string& order_id,
+                      const OrderTicket& order )
+{
+    return str_from_abi_vargs( Execute_ReplaceOrder_ABI, ALLOW_EXCEPTIONS,
+                               &creds, account_id.c_str(), order_id.c_str(),
+                               order.get_cproxy() );
+}
+
+/* (used by Execute_SendOrderAsync) */
+struct SendOrderAsyncCallback{
+    typedef std::pair<std::string, ExecuteTiming_C> result_ty;
+
+    static void
+    on_done( int err,
+             const char* buf,
+             size_t n,
+             const ExecuteTiming_C *timing,
+             void *ctx )
+    {
+        std::unique_ptr<std::promise<result_ty>> p(
+            reinterpret_cast<std::promise<result_ty>*>(ctx)
+            );
+        try{
+            if( err )
+                throw_error_exc( err, std::string(buf ? buf : ""), 0, "" );
+            p->set_value( std::make_pair(std::string(buf ? buf : ""),
+                                         *timing) );
+        }catch(...){
+            p->set_exception( std::current_exception() );
+        }
+    }
+};
+
+/*
+ * returns immediately w/ a future of (order id, timing); 'creds' MUST
+ * outlive the future's result
+ */
+inline std::future<std::pair<std::string, ExecuteTiming_C>>
+Execute_SendOrderAsync( Credentials& creds,
+                        const std::string& account_id,
+                        const OrderTicket& order )
+{
+    typedef SendOrderAsyncCallback::result_ty result_ty;
+    std::unique_ptr<std::promise<result_ty>> p( new std::promise<result_ty>() );
+    std::future<result_ty> f = p->get_future();
+    call_abi( Execute_SendOrderAsync_ABI, &creds, account_id.c_str(),
+              order.get_cproxy(), &SendOrderAsyncCallback::on_done,
+              reinterpret_cast<void*>(p.get()) );
+    p.release(); /* on_done owns it now */
+    return f;
+}
+
+// NON-VIRTUAL destructor, NO COPY
+class OrderTemplate{
+public:
+    typedef OrderTemplate_C CType;
+
+private:
+    std::unique_ptr<CType, CProxyDestroyer<CType>> _ctemplate;
+
+public:
+    OrderTemplate( const std::string& account_id, const OrderTicket& order )
+        :
+            _ctemplate( new CType{0,0},
+                        CProxyDestroyer<CType>(OrderTemplate_Destroy_ABI) )
+        {
+            call_abi( OrderTemplate_Create_ABI, account_id.c_str(),
+                      order.get_cproxy(), _ctemplate.get() );
+        }
+
+    OrderTemplate( OrderTemplate&& ) = default;
+
+    OrderTemplate&
+    operator=( OrderTemplate&& ) = default;
+
+    CType*
+    get_cproxy() const
+    { return _ctemplate.get(); }
+
+    void
+    warm(Credentials& creds)
+    { call_abi( OrderTemplate_Warm_ABI, _ctemplate.get(), &creds ); }
+
+    OrderTemplate&
+    set_price(double price)
+    {
+        call_abi( OrderTemplate_SetPrice_ABI, _ctemplate.get(), price );
+        return *this;
+    }
+
+    OrderTemplate&
+    set_stop_price(double stop_price)
+    {
+        call_abi( OrderTemplate_SetStopPrice_ABI, _ctemplate.get(),
+                  stop_price );
+        return *this;
+    }
+
+    OrderTemplate&
+    set_quantity(size_t leg, size_t quantity)
+    {
+        call_abi( OrderTemplate_SetQuantity_ABI, _ctemplate.get(), leg,
+                  quantity );
+        return *this;
+    }
+
+    std::string
+    as_json_string() const
+    { return str_from_abi(OrderTemplate_AsJsonString_ABI, _ctemplate.get()); }
+
+    json
+    as_json() const
+    { return json::parse( as_json_string() ); }
+
+    /* returns order id */
+    std::string
+    send(Credentials& creds)
+    {
+        return str_from_abi_vargs( OrderTemplate_Send_ABI, ALLOW_EXCEPTIONS,
+                                   _ctemplate.get(), &creds );
+    }
+};
+
+inline void
+Execute_ConfigurePool( unsigned int size,
+                       std::chrono::seconds keepalive = std::chrono::seconds(30),
+                       bool latency_first = false )
+{
+    call_abi( Execute_ConfigurePool_ABI, size,
+              static_cast<unsigned long>(keepalive.count()),
+              static_cast<int>(latency_first) );
+}
+
+/* (size, keepalive, latency_first) */
+inline std::tuple<unsigned int, std::chrono::seconds, bool>
+Execute_GetPoolConfig()
+{
+    unsigned int size;
+    unsigned long keepalive;
+    int latency_first;
+    call_abi( Execute_GetPoolConfig_ABI, &size, &keepalive, &latency_first );
+    return std::make_tuple( size, std::chrono::seconds(keepalive),
+                            static_cast<bool>(latency_first) );
+}
+
+inline void
+Execute_WarmPool( Credentials& creds, const std::string& account_id )
+{ call_abi( Execute_WarmPool_ABI, &creds, account_id.c_str() ); }
+
 } /* tdma */
 
 #endif /* __cplusplus */
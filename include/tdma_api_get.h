@@ -25,6 +25,9 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <set>
 #include <unordered_map>
 #include <iostream>
+#include <future>
+#include <memory>
+#include <functional>
 
 #endif /* __cplusplus */
 
@@ -168,6 +171,14 @@ DECL_C_CPP_TDMA_ENUM(OrderStatusType, 0, 14,
     BUILD_C_CPP_TDMA_ENUM_NAME(OrderStatusType, EXPIRED)
 );
 
+/* rate-limit buckets; every get draws from 'all' AND its own family */
+DECL_C_CPP_TDMA_ENUM(EndpointFamilyType, 0, 3,
+    BUILD_C_CPP_TDMA_ENUM_NAME(EndpointFamilyType, all),
+    BUILD_C_CPP_TDMA_ENUM_NAME(EndpointFamilyType, market_data),
+    BUILD_C_CPP_TDMA_ENUM_NAME(EndpointFamilyType, accounts),
+    BUILD_C_CPP_TDMA_ENUM_NAME(EndpointFamilyType, instruments)
+);
+
 typedef union {
     unsigned int n_atm;
     double single;
@@ -303,6 +314,55 @@ DECL_CGETTER_STRUCT(OrdersGetter_C);
 
 #undef DECL_CGETTER_STRUCT
 
+/*
+ * struct-of-arrays candles from HistoricalGetterBase_GetCandles_ABI
+ *
+ * the arrays are ONE block allocated by the library; call FreeCandles(_ABI)
+ * when done - DON'T free the individual arrays
+ */
+typedef struct {
+    long long *datetime; /* msec since epoch */
+    double *open;
+    double *high;
+    double *low;
+    double *close;
+    long long *volume;
+    size_t n;
+} Candles_C;
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+FreeCandles_ABI( Candles_C *pcandles, int allow_exceptions );
+
+/* one stored candle (see CandleStore) */
+typedef struct {
+    long long datetime; /* msec since epoch */
+    double open;
+    double high;
+    double low;
+    double close;
+    long long volume;
+} CandleRecord_C;
+
+/*
+ * read-only, zero-copy view of stored candles; 'records' points into the
+ * store's mapping which stays valid until FreeCandleView(_ABI)
+ */
+typedef struct {
+    const CandleRecord_C *records;
+    size_t n;
+    void *handle;
+} CandleView_C;
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+FreeCandleView_ABI( CandleView_C *pview, int allow_exceptions );
+
+/* empty string (default) disables the store */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+CandleStore_SetDirectory_ABI( const char* directory, int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+CandleStore_GetDirectory_ABI( char **buf, size_t *n, int allow_exceptions );
+
 
 EXTERN_C_SPEC_ DLL_SPEC_ int
 APIGetter_Get_ABI( Getter_C *pgetter,
@@ -310,6 +370,19 @@ APIGetter_Get_ABI( Getter_C *pgetter,
                    size_t *n,
                    int allow_exceptions );
 
+/*
+ * get_async callback: (error code, data OR error message, size w/ NULL
+ * term, ctx passed to GetAsync). Called once from a library thread; the
+ * buffer is only valid for the duration of the call. SHOULD NOT BLOCK.
+ */
+typedef void(*get_async_cb_ty)(int, const char*, size_t, void*);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetAsync_ABI( Getter_C *pgetter,
+                        get_async_cb_ty callback,
+                        void *ctx,
+                        int allow_exceptions );
+
 EXTERN_C_SPEC_ DLL_SPEC_ int
 APIGetter_Close_ABI(Getter_C *pgetter, int allow_exceptions);
 
@@ -328,6 +401,18 @@ APIGetter_GetDefWaitMSec_ABI(unsigned long long *msec, int allow_exceptions);
 EXTERN_C_SPEC_ DLL_SPEC_ int
 APIGetter_WaitRemaining_ABI(unsigned long long *msec, int allow_exceptions);
 
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetRateLimit_ABI( int endpoint_family,
+                            unsigned long long interval_msec,
+                            unsigned int burst,
+                            int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetRateLimit_ABI( int endpoint_family,
+                            unsigned long long *interval_msec,
+                            unsigned int *burst,
+                            int allow_exceptions );
+
 /* QuoteGetter */
 EXTERN_C_SPEC_ DLL_SPEC_ int
 QuoteGetter_Create_ABI( struct Credentials *pcreds,
@@ -508,6 +593,12 @@ HistoricalGetterBase_SetFrequency_ABI( Getter_C *pgetter,
                                        unsigned int frequency,
                                        int allow_exceptions );
 
+/* decodes the response straight to columns (no json parse) */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+HistoricalGetterBase_GetCandles_ABI( Getter_C *pgetter,
+                                     Candles_C *pcandles,
+                                     int allow_exceptions );
+
 /* HistoricalPeriodGetter */
 EXTERN_C_SPEC_ DLL_SPEC_ int
 HistoricalPeriodGetter_Create_ABI(
@@ -594,6 +685,62 @@ HistoricalRangeGetter_SetStartMSecSinceEpoch_ABI(
     unsigned long long start_msec,
     int allow_exceptions );
 
+/* fetches only what the candle store is missing, returns a view of it */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+HistoricalRangeGetter_GetStoredCandles_ABI( HistoricalRangeGetter_C *pgetter,
+                                            CandleView_C *pview,
+                                            int allow_exceptions );
+
+/* HistoricalBackfill */
+typedef struct {
+    size_t windows_total;
+    size_t windows_done; /* includes failed */
+    size_t windows_failed;
+    size_t symbols_total;
+    size_t symbols_done;
+    size_t candles;
+    unsigned long long bytes;
+    double elapsed_sec;
+    double windows_per_sec;
+    double candles_per_sec;
+} BackfillProgress_C;
+
+/*
+ * backfill symbol callback: (symbol, error code, error message OR NULL,
+ * candles, ctx). The callee OWNS the candles (free w/ FreeCandles) - empty
+ * on error.
+ */
+typedef void(*historical_backfill_symbol_cb_ty)(const char*, int,
+                                                const char*, Candles_C*,
+                                                void*);
+
+typedef void(*historical_backfill_progress_cb_ty)(const BackfillProgress_C*,
+                                                  void*);
+
+/*
+ * blocks until done; callbacks are called one at a time from library
+ * threads (either can be NULL)
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+HistoricalBackfill_ABI( struct Credentials *pcreds,
+                        const char **symbols,
+                        size_t nsymbols,
+                        int frequency_type,
+                        unsigned int frequency,
+                        unsigned long long start_msec_since_epoch,
+                        unsigned long long end_msec_since_epoch,
+                        int extended_hours,
+                        unsigned int nworkers,
+                        historical_backfill_symbol_cb_ty on_symbol,
+                        historical_backfill_progress_cb_ty on_progress,
+                        void *ctx,
+                        int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+HistoricalBackfill_GetWindowMSec_ABI( int frequency_type,
+                                      unsigned long long *msec,
+                                      int allow_exceptions );
+
 
 /* OptionChainGetter */
 EXTERN_C_SPEC_ DLL_SPEC_ int
@@ -1189,6 +1336,10 @@ static inline int
 APIGetter_Get(Getter_C *pgetter, char** buf, size_t *n)
 { return APIGetter_Get_ABI(pgetter, buf, n, 0); }
 
+static inline int
+APIGetter_GetAsync(Getter_C *pgetter, get_async_cb_ty callback, void *ctx)
+{ return APIGetter_GetAsync_ABI(pgetter, callback, ctx, 0); }
+
 static inline int
 APIGetter_Close(Getter_C *pgetter)
 { return APIGetter_Close_ABI(pgetter, 0); }
@@ -1213,6 +1364,24 @@ static inline int
 APIGetter_WaitRemaining(unsigned long long *msec)
 { return APIGetter_WaitRemaining_ABI(msec, 0); }
 
+static inline int
+APIGetter_SetRateLimit( EndpointFamilyType endpoint_family,
+                        unsigned long long interval_msec,
+                        unsigned int burst )
+{
+    return APIGetter_SetRateLimit_ABI( (int)endpoint_family, interval_msec,
+                                       burst, 0 );
+}
+
+static inline int
+APIGetter_GetRateLimit( EndpointFamilyType endpoint_family,
+                        unsigned long long *interval_msec,
+                        unsigned int *burst )
+{
+    return APIGetter_GetRateLimit_ABI( (int)endpoint_family, interval_msec,
+                                       burst, 0 );
+}
+
 /* declare derived versions of Get, Close, IsClosed for each getter*/
 #define DECL_WRAPPED_API_GETTER_BASE_FUNCS(name) \
 static inline int \
@@ -1412,6 +1581,23 @@ GetMovers( struct Credentials *pcreds,
 { CONVENIENCE_GET_FUNC_BODY(Movers, index, direction_type, change_type); }
 
 
+static inline int
+FreeCandles( Candles_C *pcandles )
+{ return FreeCandles_ABI(pcandles, 0); }
+
+static inline int
+FreeCandleView( CandleView_C *pview )
+{ return FreeCandleView_ABI(pview, 0); }
+
+static inline int
+CandleStore_SetDirectory( const char* directory )
+{ return CandleStore_SetDirectory_ABI(directory, 0); }
+
+static inline int
+CandleStore_GetDirectory( char **buf, size_t *n )
+{ return CandleStore_GetDirectory_ABI(buf, n, 0); }
+
+
 /* HistoricalPeriodGetter */
 static inline int
 HistoricalPeriodGetter_Create( struct Credentials *pcreds,
@@ -1436,6 +1622,11 @@ HistoricalPeriodGetter_Destroy( HistoricalPeriodGetter_C *pgetter )
 
 DECL_WRAPPED_API_GETTER_BASE_FUNCS(HistoricalPeriodGetter)
 
+static inline int
+HistoricalPeriodGetter_GetCandles( HistoricalPeriodGetter_C *pgetter,
+                                   Candles_C *pcandles )
+{ return HistoricalGetterBase_GetCandles_ABI( (Getter_C*)pgetter, pcandles, 0); }
+
 static inline int
 HistoricalPeriodGetter_GetSymbol( HistoricalPeriodGetter_C *pgetter,
                                   char **buf,
@@ -1548,6 +1739,16 @@ HistoricalRangeGetter_Destroy( HistoricalRangeGetter_C *pgetter )
 
 DECL_WRAPPED_API_GETTER_BASE_FUNCS(HistoricalRangeGetter)
 
+static inline int
+HistoricalRangeGetter_GetCandles( HistoricalRangeGetter_C *pgetter,
+                                  Candles_C *pcandles )
+{ return HistoricalGetterBase_GetCandles_ABI( (Getter_C*)pgetter, pcandles, 0); }
+
+static inline int
+HistoricalRangeGetter_GetStoredCandles( HistoricalRangeGetter_C *pgetter,
+                                        CandleView_C *pview )
+{ return HistoricalRangeGetter_GetStoredCandles_ABI(pgetter, pview, 0); }
+
 static inline int
 HistoricalRangeGetter_GetSymbol( HistoricalRangeGetter_C *pgetter,
                                  char **buf,
@@ -1629,6 +1830,33 @@ GetHistoricalRange( struct Credentials *pcreds,
                             start_msec_since_epoch, end_msec_since_epoch,
                             extended_hours); }
 
+/* HistoricalBackfill */
+static inline int
+HistoricalBackfill( struct Credentials *pcreds,
+                    const char **symbols,
+                    size_t nsymbols,
+                    FrequencyType frequency_type,
+                    unsigned int frequency,
+                    unsigned long long start_msec_since_epoch,
+                    unsigned long long end_msec_since_epoch,
+                    int extended_hours,
+                    unsigned int nworkers,
+                    historical_backfill_symbol_cb_ty on_symbol,
+                    historical_backfill_progress_cb_ty on_progress,
+                    void *ctx )
+{
+    return HistoricalBackfill_ABI( pcreds, symbols, nsymbols,
+                                   (int)frequency_type, frequency,
+                                   start_msec_since_epoch,
+                                   end_msec_since_epoch, extended_hours,
+                                   nworkers, on_symbol, on_progress, ctx, 0 );
+}
+
+static inline int
+HistoricalBackfill_GetWindowMSec( FrequencyType frequency_type,
+                                  unsigned long long *msec )
+{ return HistoricalBackfill_GetWindowMSec_ABI((int)frequency_type, msec, 0); }
+
 
 /* OptionChainGetter */
 static inline int
@@ -2480,6 +2708,21 @@ public:
 private:
     std::unique_ptr<CType, CProxyDestroyer<CType>> _cgetter;
 
+    static void
+    _on_get_async(int err, const char* buf, size_t n, void *ctx)
+    {
+        std::unique_ptr<std::promise<json>> p(
+            reinterpret_cast<std::promise<json>*>(ctx)
+            );
+        try{
+            if( err )
+                throw_error_exc( err, std::string(buf ? buf : ""), 0, "" );
+            p->set_value( (n > 1) ? json::parse(std::string(buf)) : json() );
+        }catch(...){
+            p->set_exception( std::current_exception() );
+        }
+    }
+
 protected:
     template<typename CTy=CType>
     CTy*
@@ -2558,6 +2801,26 @@ public:
         return std::chrono::milliseconds(w);
     }
 
+    static void
+    set_rate_limit( EndpointFamilyType endpoint_family,
+                    std::chrono::milliseconds interval,
+                    unsigned int burst = 1 )
+    {
+        call_abi( APIGetter_SetRateLimit_ABI,
+                  static_cast<int>(endpoint_family),
+                  static_cast<unsigned long long>(interval.count()), burst );
+    }
+
+    static std::pair<std::chrono::milliseconds, unsigned int>
+    get_rate_limit(EndpointFamilyType endpoint_family)
+    {
+        unsigned long long w;
+        unsigned int b;
+        call_abi( APIGetter_GetRateLimit_ABI,
+                  static_cast<int>(endpoint_family), &w, &b );
+        return std::make_pair(std::chrono::milliseconds(w), b);
+    }
+
     json
     get()
     {
@@ -2570,6 +2833,23 @@ public:
         return j;
     }
 
+    /*
+     * returns immediately; the request is driven by the library's async
+     * engine thread. Only one request per getter can be in flight, a
+     * second get/get_async blocks until the first completes. The getter
+     * MUST outlive the future's result.
+     */
+    std::future<json>
+    get_async()
+    {
+        std::unique_ptr<std::promise<json>> p( new std::promise<json>() );
+        std::future<json> f = p->get_future();
+        call_abi( APIGetter_GetAsync_ABI, _cgetter.get(),
+                  &APIGetter::_on_get_async, reinterpret_cast<void*>(p.get()) );
+        p.release(); /* _on_get_async owns it now */
+        return f;
+    }
+
     void
     close()
     { call_abi(APIGetter_Close_ABI, _cgetter.get() ); }
@@ -2789,6 +3069,150 @@ public:
 };
 
 
+/* owns the arrays of a Candles_C; move only */
+class Candles{
+    Candles_C _candles;
+
+public:
+    Candles()
+        : _candles()
+    {}
+
+    Candles( Candles&& c )
+        : _candles(c._candles)
+    { c._candles = Candles_C(); }
+
+    Candles&
+    operator=( Candles&& c )
+    {
+        if( this != &c ){
+            FreeCandles_ABI(&_candles, 0);
+            _candles = c._candles;
+            c._candles = Candles_C();
+        }
+        return *this;
+    }
+
+    Candles( const Candles& ) = delete;
+
+    Candles&
+    operator=( const Candles& ) = delete;
+
+    ~Candles()
+    { FreeCandles_ABI(&_candles, 0); }
+
+    size_t
+    size() const
+    { return _candles.n; }
+
+    bool
+    empty() const
+    { return _candles.n == 0; }
+
+    const long long*
+    datetime() const
+    { return _candles.datetime; }
+
+    const double*
+    open() const
+    { return _candles.open; }
+
+    const double*
+    high() const
+    { return _candles.high; }
+
+    const double*
+    low() const
+    { return _candles.low; }
+
+    const double*
+    close() const
+    { return _candles.close; }
+
+    const long long*
+    volume() const
+    { return _candles.volume; }
+
+    Candles_C*
+    get_cptr()
+    { return &_candles; }
+};
+
+
+/* owns a CandleView_C (and so the store mapping it points into); move only */
+class CandleView{
+    CandleView_C _view;
+
+public:
+    typedef const CandleRecord_C* const_iterator;
+
+    CandleView()
+        : _view()
+    {}
+
+    CandleView( CandleView&& v )
+        : _view(v._view)
+    { v._view = CandleView_C(); }
+
+    CandleView&
+    operator=( CandleView&& v )
+    {
+        if( this != &v ){
+            FreeCandleView_ABI(&_view, 0);
+            _view = v._view;
+            v._view = CandleView_C();
+        }
+        return *this;
+    }
+
+    CandleView( const CandleView& ) = delete;
+
+    CandleView&
+    operator=( const CandleView& ) = delete;
+
+    ~CandleView()
+    { FreeCandleView_ABI(&_view, 0); }
+
+    size_t
+    size() const
+    { return _view.n; }
+
+    bool
+    empty() const
+    { return _view.n == 0; }
+
+    const CandleRecord_C*
+    data() const
+    { return _view.records; }
+
+    const CandleRecord_C&
+    operator[](size_t i) const
+    { return _view.records[i]; }
+
+    const_iterator
+    begin() const
+    { return _view.records; }
+
+    const_iterator
+    end() const
+    { return _view.records + _view.n; }
+
+    CandleView_C*
+    get_cptr()
+    { return &_view; }
+};
+
+
+/* empty string (default) disables the store */
+inline void
+CandleStore_SetDirectory(const std::string& directory)
+{ call_abi( CandleStore_SetDirectory_ABI, directory.c_str() ); }
+
+inline std::string
+CandleStore_GetDirectory()
+{ return str_from_abi_vargs(CandleStore_GetDirectory_ABI, ALLOW_EXCEPTIONS); }
+
+
 class HistoricalGetterBase
         : public APIGetter {
 protected:
@@ -2860,6 +3284,15 @@ public:
                   static_cast<int>(extended_hours) );
     }
 
+    /* like get() but decoded straight to columns (no json parse) */
+    Candles
+    get_candles()
+    {
+        Candles c;
+        call_abi( HistoricalGetterBase_GetCandles_ABI, cgetter<>(),
+                  c.get_cptr() );
+        return c;
+    }
 
 };
 
@@ -2991,8 +3424,113 @@ public:
         call_abi( HistoricalRangeGetter_SetStartMSecSinceEpoch_ABI,
                   cgetter<CType>(), start_msec_since_epoch );
     }
+
+    /*
+     * fetch only the ranges the candle store doesn't have yet and return
+     * a zero-copy view of [start, end] (completed bars only)
+     */
+    CandleView
+    get_stored_candles()
+    {
+        CandleView v;
+        call_abi( HistoricalRangeGetter_GetStoredCandles_ABI,
+                  cgetter<CType>(), v.get_cptr() );
+        return v;
+    }
+};
+
+
+/*
+ * on_symbol: (symbol, candles, exception_ptr - null on success)
+ * BOTH are called one at a time from library threads
+ */
+typedef std::function<void(const std::string&, Candles&&, std::exception_ptr)>
+    historical_backfill_symbol_callback_ty;
+
+typedef std::function<void(const BackfillProgress_C&)>
+    historical_backfill_progress_callback_ty;
+
+/* (used by HistoricalBackfill) */
+struct HistoricalBackfillCallbacks{
+    historical_backfill_symbol_callback_ty on_symbol;
+    historical_backfill_progress_callback_ty on_progress;
+
+    static void
+    symbol( const char* symbol,
+            int err,
+            const char* msg,
+            Candles_C *pcandles,
+            void *ctx )
+    {
+        Candles c;
+        std::swap( *c.get_cptr(), *pcandles );
+        std::exception_ptr eptr;
+        if( err ){
+            try{
+                throw_error_exc( err, std::string(msg ? msg : ""), 0, "" );
+            }catch(...){
+                eptr = std::current_exception();
+            }
+        }
+        try{
+            reinterpret_cast<HistoricalBackfillCallbacks*>(ctx)->on_symbol(
+                std::string(symbol), std::move(c), eptr
+                );
+        }catch(...){
+        }
+    }
+
+    static void
+    progress(const BackfillProgress_C *p, void *ctx)
+    {
+        try{
+            reinterpret_cast<HistoricalBackfillCallbacks*>(ctx)->on_progress(*p);
+        }catch(...){
+        }
+    }
 };
 
+/*
+ * fetch [start, end] for all 'symbols' in per-request windows on 'nworkers'
+ * threads (0 for default) under the shared rate limits; blocks until done
+ */
+inline void
+HistoricalBackfill( Credentials& creds,
+                    const std::vector<std::string>& symbols,
+                    FrequencyType frequency_type,
+                    unsigned int frequency,
+                    unsigned long long start_msec_since_epoch,
+                    unsigned long long end_msec_since_epoch,
+                    historical_backfill_symbol_callback_ty on_symbol,
+                    historical_backfill_progress_callback_ty on_progress
+                        = nullptr,
+                    bool extended_hours = true,
+                    unsigned int nworkers = 0 )
+{
+    std::vector<const char*> syms;
+    for( auto& s : symbols )
+        syms.push_back( s.c_str() );
+
+    HistoricalBackfillCallbacks cbs{on_symbol, on_progress};
+    call_abi( HistoricalBackfill_ABI, &creds, syms.data(), syms.size(),
+              static_cast<int>(frequency_type), frequency,
+              start_msec_since_epoch, end_msec_since_epoch,
+              static_cast<int>(extended_hours), nworkers,
+              on_symbol ? &HistoricalBackfillCallbacks::symbol : nullptr,
+              on_progress ? &HistoricalBackfillCallbacks::progress : nullptr,
+              reinterpret_cast<void*>(&cbs) );
+}
+
+/* largest span one backfill request (window) covers */
+inline std::chrono::milliseconds
+HistoricalBackfillWindow(FrequencyType frequency_type)
+{
+    unsigned long long ms;
+    call_abi( HistoricalBackfill_GetWindowMSec_ABI,
+              static_cast<int>(frequency_type), &ms );
+    return std::chrono::milliseconds(ms);
+}
+
 
 class OptionStrikes {
 public:
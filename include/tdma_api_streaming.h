@@ -36,7 +36,7 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 
 #define BUILD_ENUM_NAME(n) \
     BUILD_C_CPP_TDMA_ENUM_NAME(StreamerServiceType, n)
-DECL_C_CPP_TDMA_ENUM(StreamerServiceType, 1, 19,
+DECL_C_CPP_TDMA_ENUM(StreamerServiceType, 1, 20,
     BUILD_ENUM_NAME( NONE ),
     BUILD_ENUM_NAME( QUOTE ),
     BUILD_ENUM_NAME( OPTION ),
@@ -56,10 +56,10 @@ DECL_C_CPP_TDMA_ENUM(StreamerServiceType, 1, 19,
     BUILD_ENUM_NAME( ACTIVES_NYSE ),
     BUILD_ENUM_NAME( ACTIVES_OTCBB ),
     BUILD_ENUM_NAME( ACTIVES_OPTIONS ),
-    BUILD_ENUM_NAME( ADMIN ) // <- NOTE THIS DOESNT MATCH TYPE_ID_SUB_[] consts
+    BUILD_ENUM_NAME( ADMIN ), // <- NOTE THIS DOESNT MATCH TYPE_ID_SUB_[] consts
+    BUILD_ENUM_NAME( ACCT_ACTIVITY )
     /* NOT IMPLEMENTED YET */
     //BUILD_ENUM_NAME( CHART_HISTORY_FUTURES),
-    //BUILD_ENUM_NAME( ACCT_ACTIVITY),
     /* NOT DOCUMENTED BY TDMA */
     //BUILD_ENUM_NAME( FOREX_BOOK,
     //BUILD_ENUM_NAME( FUTURES_BOOK),
@@ -391,6 +391,36 @@ DECL_C_CPP_TDMA_ENUM(TimesaleSubscriptionField, 0, 5,
     BUILD_C_CPP_TDMA_ENUM_NAME(TimesaleSubscriptionField, last_sequence)
     );
 
+/* the content keys of ACCT_ACTIVITY 'data' (all are subscribed) */
+DECL_C_CPP_TDMA_ENUM(AcctActivitySubscriptionField, 0, 3,
+    BUILD_C_CPP_TDMA_ENUM_NAME(AcctActivitySubscriptionField, subscription_key),
+    BUILD_C_CPP_TDMA_ENUM_NAME(AcctActivitySubscriptionField, account),
+    BUILD_C_CPP_TDMA_ENUM_NAME(AcctActivitySubscriptionField, message_type),
+    BUILD_C_CPP_TDMA_ENUM_NAME(AcctActivitySubscriptionField, message_data)
+    );
+
+/* ACCT_ACTIVITY message types ('other' for any we don't know) */
+#define BUILD_ENUM_NAME(n) \
+    BUILD_C_CPP_TDMA_ENUM_NAME(AcctActivityMessageType, n)
+DECL_C_CPP_TDMA_ENUM(AcctActivityMessageType, 0, 14,
+    BUILD_ENUM_NAME(other),
+    BUILD_ENUM_NAME(subscribed),
+    BUILD_ENUM_NAME(error),
+    BUILD_ENUM_NAME(broken_trade),
+    BUILD_ENUM_NAME(manual_execution),
+    BUILD_ENUM_NAME(order_activation),
+    BUILD_ENUM_NAME(order_cancel_replace_request),
+    BUILD_ENUM_NAME(order_cancel_request),
+    BUILD_ENUM_NAME(order_entry_request),
+    BUILD_ENUM_NAME(order_fill),
+    BUILD_ENUM_NAME(order_partial_fill),
+    BUILD_ENUM_NAME(order_rejection),
+    BUILD_ENUM_NAME(order_route),
+    BUILD_ENUM_NAME(too_late_to_cancel),
+    BUILD_ENUM_NAME(ur_out)
+    );
+#undef BUILD_ENUM_NAME
+
 DECL_C_CPP_TDMA_ENUM(StreamingCallbackType, 0, 6,
     BUILD_C_CPP_TDMA_ENUM_NAME(StreamingCallbackType, listening_start),
     BUILD_C_CPP_TDMA_ENUM_NAME(StreamingCallbackType, listening_stop),
@@ -402,6 +432,269 @@ DECL_C_CPP_TDMA_ENUM(StreamingCallbackType, 0, 6,
     );
 
 
+/*
+ * TYPED UPDATES - 'data' content decoded straight into structs (see
+ * StreamingSession_SetTypedCallbacks and StreamingSession_GetLevelOne).
+ * 'fields' has bit n set if field n
+ * (the service's [...]SubscriptionField value) was in the update; anything
+ * not set is zero. Strings are NUL-terminated and truncated to fit.
+ */
+
+#define STREAMING_SYMBOL_BUFFER_SIZE 32
+#define STREAMING_TEXT_BUFFER_SIZE 64
+
+/* QUOTE - QuotesSubscriptionField bits */
+typedef struct {
+    unsigned long long fields;
+    char symbol[STREAMING_SYMBOL_BUFFER_SIZE];
+    double bid_price;
+    double ask_price;
+    double last_price;
+    long long bid_size;
+    long long ask_size;
+    char ask_id;
+    char bid_id;
+    long long total_volume;
+    long long last_size;
+    long long trade_time;
+    long long quote_time;
+    double high_price;
+    double low_price;
+    char bid_tick;
+    double close_price;
+    char exchange_id;
+    int marginable;
+    int shortable;
+    double island_bid;
+    double island_ask;
+    long long island_volume;
+    long long quote_day;
+    long long trade_day;
+    double volatility;
+    char description[STREAMING_TEXT_BUFFER_SIZE];
+    char last_id;
+    long long digits;
+    double open_price;
+    double net_change;
+    double high_52_week;
+    double low_52_week;
+    double pe_ratio;
+    double dividend_amount;
+    double dividend_yeild;
+    long long island_bid_size;
+    long long island_ask_size;
+    double nav;
+    double fund_price;
+    char exchanged_name[STREAMING_SYMBOL_BUFFER_SIZE];
+    char dividend_date[STREAMING_SYMBOL_BUFFER_SIZE];
+    int regular_market_quote;
+    int regular_market_trade;
+    double regular_market_last_price;
+    long long regular_market_last_size;
+    long long regular_market_trade_time;
+    long long regular_market_trade_day;
+    double regular_market_net_change;
+    char security_status[STREAMING_SYMBOL_BUFFER_SIZE];
+    double mark;
+    long long quote_time_as_long;
+    long long trade_time_as_long;
+    long long regular_market_trade_time_as_long;
+} QuoteUpdate_C;
+
+/* OPTION - OptionsSubscriptionField bits */
+typedef struct {
+    unsigned long long fields;
+    char symbol[STREAMING_SYMBOL_BUFFER_SIZE];
+    char description[STREAMING_TEXT_BUFFER_SIZE];
+    double bid_price;
+    double ask_price;
+    double last_price;
+    double high_price;
+    double low_price;
+    double close_price;
+    long long total_volume;
+    long long open_interest;
+    double volatility;
+    long long quote_time;
+    long long trade_time;
+    double money_intrinsic_value;
+    long long quote_day;
+    long long trade_day;
+    long long expiration_year;
+    double multiplier;
+    long long digits;
+    double open_price;
+    long long bid_size;
+    long long ask_size;
+    long long last_size;
+    double net_change;
+    double strike_price;
+    char contract_type;
+    char underlying[STREAMING_SYMBOL_BUFFER_SIZE];
+    long long expiration_month;
+    char deliverables[STREAMING_TEXT_BUFFER_SIZE];
+    double time_value;
+    long long expiration_day;
+    long long days_to_expiration;
+    double delta;
+    double gamma;
+    double theta;
+    double vega;
+    double rho;
+    char security_status[STREAMING_SYMBOL_BUFFER_SIZE];
+    double theoretical_option_value;
+    double underlying_price;
+    char uv_expiration_type;
+    double mark;
+} OptionUpdate_C;
+
+/* LEVELONE_FUTURES - LevelOneFuturesSubscriptionField bits */
+typedef struct {
+    unsigned long long fields;
+    char symbol[STREAMING_SYMBOL_BUFFER_SIZE];
+    double bid_price;
+    double ask_price;
+    double last_price;
+    long long bid_size;
+    long long ask_size;
+    char ask_id;
+    char bid_id;
+    long long total_volume;
+    long long last_size;
+    long long quote_time;
+    long long trade_time;
+    double high_price;
+    double low_price;
+    double close_price;
+    char exchange_id;
+    char description[STREAMING_TEXT_BUFFER_SIZE];
+    char last_id;
+    double open_price;
+    double net_change;
+    double future_percent_change;
+    char exchange_name[STREAMING_SYMBOL_BUFFER_SIZE];
+    char security_status[STREAMING_SYMBOL_BUFFER_SIZE];
+    long long open_interest;
+    double mark;
+    double tick;
+    double tick_amount;
+    char product[STREAMING_SYMBOL_BUFFER_SIZE];
+    char future_price_format[STREAMING_SYMBOL_BUFFER_SIZE];
+    char future_trading_hours[STREAMING_TEXT_BUFFER_SIZE];
+    int future_is_tradable;
+    double future_multiplier;
+    int future_is_active;
+    double future_settlement_price;
+    char future_active_symbol[STREAMING_SYMBOL_BUFFER_SIZE];
+    long long future_expiration_date;
+} LevelOneFuturesUpdate_C;
+
+/* LEVELONE_FOREX - LevelOneForexSubscriptionField bits */
+typedef struct {
+    unsigned long long fields;
+    char symbol[STREAMING_SYMBOL_BUFFER_SIZE];
+    double bid_price;
+    double ask_price;
+    double last_price;
+    long long bid_size;
+    long long ask_size;
+    long long total_volume;
+    long long last_size;
+    long long quote_time;
+    long long trade_time;
+    double high_price;
+    double low_price;
+    double close_price;
+    char exchange_id;
+    char description[STREAMING_TEXT_BUFFER_SIZE];
+    double open_price;
+    double net_change;
+    double percent_change;
+    char exchange_name[STREAMING_SYMBOL_BUFFER_SIZE];
+    long long digits;
+    char security_status[STREAMING_SYMBOL_BUFFER_SIZE];
+    double tick;
+    double tick_amount;
+    char product[STREAMING_SYMBOL_BUFFER_SIZE];
+    char trading_hours[STREAMING_TEXT_BUFFER_SIZE];
+    int is_tradable;
+    char market_maker[STREAMING_SYMBOL_BUFFER_SIZE];
+    double high_52_week;
+    double low_52_week;
+    double mark;
+} LevelOneForexUpdate_C;
+
+/* TIMESALE_[] - TimesaleSubscriptionField bits */
+typedef struct {
+    unsigned long long fields;
+    char symbol[STREAMING_SYMBOL_BUFFER_SIZE];
+    long long trade_time;
+    double last_price;
+    double last_size;
+    long long last_sequence;
+} TimesaleTick_C;
+
+/*
+ * CHART_[] - ChartEquitySubscriptionField bits for ALL chart services
+ * (CHART_FUTURES/OPTIONS fields are mapped to the equivalent bits)
+ */
+typedef struct {
+    unsigned long long fields;
+    char symbol[STREAMING_SYMBOL_BUFFER_SIZE];
+    double open_price;
+    double high_price;
+    double low_price;
+    double close_price;
+    double volume;
+    long long sequence;
+    long long chart_time;
+    long long chart_day;
+} ChartBar_C;
+
+/*
+ * ACCT_ACTIVITY - one per message (AcctActivityMessageType); the order
+ * values are pulled from the message's XML and are zero/empty if it
+ * didn't have them. original_order_id is the order being replaced
+ * (order_cancel_replace_request); execution_[] and leaves_quantity are
+ * set by fills (leaves_quantity is -1 if the message didn't have it).
+ */
+typedef struct {
+    int message_type;
+    char account[STREAMING_SYMBOL_BUFFER_SIZE];
+    char order_id[STREAMING_SYMBOL_BUFFER_SIZE];
+    char original_order_id[STREAMING_SYMBOL_BUFFER_SIZE];
+    char symbol[STREAMING_SYMBOL_BUFFER_SIZE];
+    char instruction[STREAMING_SYMBOL_BUFFER_SIZE];
+    double quantity;
+    double limit_price;
+    double execution_quantity;
+    double execution_price;
+    double leaves_quantity;
+} AcctActivity_C;
+
+/*
+ * ORDER TRACKER - state of an order built from its ACCT_ACTIVITY messages
+ * (see StreamingSession_SetOrderTracker). status is an OrderStatusType
+ * (tdma_api_get.h); update_time is the last message's timestamp.
+ */
+typedef struct {
+    char order_id[STREAMING_SYMBOL_BUFFER_SIZE];
+    char account[STREAMING_SYMBOL_BUFFER_SIZE];
+    char symbol[STREAMING_SYMBOL_BUFFER_SIZE];
+    char instruction[STREAMING_SYMBOL_BUFFER_SIZE];
+    int status;
+    int last_message_type;
+    double quantity;
+    double filled_quantity;
+    double remaining_quantity;
+    double limit_price;
+    double average_fill_price;
+    double last_fill_price;
+    double last_fill_quantity;
+    unsigned long long update_time;
+} OrderState_C;
+
+
 static const int SUBSCRIPTION_MAX_FIELDS = 100;
 static const int SUBSCRIPTION_MAX_SYMBOLS = 5000;
 
@@ -425,6 +718,7 @@ DECL_CSUB_STRUCT(NasdaqActivesSubscription_C);
 DECL_CSUB_STRUCT(NYSEActivesSubscription_C);
 DECL_CSUB_STRUCT(OTCBBActivesSubscription_C);
 DECL_CSUB_STRUCT(OptionActivesSubscription_C);
+DECL_CSUB_STRUCT(AcctActivitySubscription_C);
 #undef DECL_CSUB_STRUCT
 
 /* SUBSCRIPTION CREATE METHODS */
@@ -465,6 +759,11 @@ OptionActivesSubscription_Create_ABI( int venue,
                                       OptionActivesSubscription_C *psub,
                                       int allow_exceptions );
 
+/* the session supplies the account's streamer subscription key */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+AcctActivitySubscription_Create_ABI( AcctActivitySubscription_C *psub,
+                                     int allow_exceptions );
+
 
 /* SUBSCRIPTION DESTROY METHODS */
 
@@ -489,6 +788,7 @@ DECL_CSUB_DESTROY_FUNC(NasdaqActivesSubscription);
 DECL_CSUB_DESTROY_FUNC(NYSEActivesSubscription);
 DECL_CSUB_DESTROY_FUNC(OTCBBActivesSubscription);
 DECL_CSUB_DESTROY_FUNC(OptionActivesSubscription);
+DECL_CSUB_DESTROY_FUNC(AcctActivitySubscription);
 #undef DECL_CSUB_DESTROY_FUNC
 
 /* Generic destroy (cast to StreamingSubscription_C*) */
@@ -610,6 +910,10 @@ OptionActivesSubscription_Create( VenueType venue,
 { return OptionActivesSubscription_Create_ABI((int)venue, (int)duration_type,
                                                psub, 0); }
 
+static inline int
+AcctActivitySubscription_Create( AcctActivitySubscription_C *psub )
+{ return AcctActivitySubscription_Create_ABI(psub, 0); }
+
 
 /* SUBSCRIPTION DESTROY METHODS */
 
@@ -635,6 +939,7 @@ DECL_CSUB_DESTROY_FUNC(NasdaqActivesSubscription);
 DECL_CSUB_DESTROY_FUNC(NYSEActivesSubscription);
 DECL_CSUB_DESTROY_FUNC(OTCBBActivesSubscription);
 DECL_CSUB_DESTROY_FUNC(OptionActivesSubscription);
+DECL_CSUB_DESTROY_FUNC(AcctActivitySubscription);
 #undef DECL_CSUB_DESTROY_FUNC
 
 /* Generic destroy (cast to StreamingSubscription_C*) */
@@ -668,6 +973,7 @@ DECL_CSUB_GET_SERVICE_FUNC(NasdaqActivesSubscription);
 DECL_CSUB_GET_SERVICE_FUNC(NYSEActivesSubscription);
 DECL_CSUB_GET_SERVICE_FUNC(OTCBBActivesSubscription);
 DECL_CSUB_GET_SERVICE_FUNC(OptionActivesSubscription);
+DECL_CSUB_GET_SERVICE_FUNC(AcctActivitySubscription);
 /* GetService generic method (cast to StreamerSubscription_C*) */
 DECL_CSUB_GET_SERVICE_FUNC(StreamingSubscription);
 #undef DECL_CSUB_GET_SERVICE_FUNC
@@ -696,6 +1002,7 @@ DECL_CSUB_GET_COMMAND_FUNC(NasdaqActivesSubscription);
 DECL_CSUB_GET_COMMAND_FUNC(NYSEActivesSubscription);
 DECL_CSUB_GET_COMMAND_FUNC(OTCBBActivesSubscription);
 DECL_CSUB_GET_COMMAND_FUNC(OptionActivesSubscription);
+DECL_CSUB_GET_COMMAND_FUNC(AcctActivitySubscription);
 /* GetCommand generic method (cast to StreamerSubscription_C*) */
 DECL_CSUB_GET_COMMAND_FUNC(StreamingSubscription);
 #undef DECL_CSUB_GET_COMMAND_FUNC
@@ -796,6 +1103,7 @@ struct StreamerInfo{
     std::string credentials_encoded;
     std::string url;
     std::string primary_acct_id;
+    std::string subscription_key; // ACCT_ACTIVITY 'keys'
 
     void
     encode_credentials();
@@ -1375,6 +1683,24 @@ public:
 
 };
 
+/* orders for the session's account(s); no symbols/fields to choose */
+class AcctActivitySubscription
+        : public StreamingSubscription {
+public:
+    typedef AcctActivitySubscription_C CType;
+
+    static const StreamerServiceType STREAMER_SERVICE_TYPE =
+        StreamerServiceType::ACCT_ACTIVITY;
+
+    AcctActivitySubscription()
+        :
+            StreamingSubscription( AcctActivitySubscription_C{},
+                                   AcctActivitySubscription_Create_ABI,
+                                   nullptr )
+        {
+        }
+};
+
 } /* tdma */
 
 #endif /* __cplusplus */
@@ -1387,10 +1713,62 @@ public:
 #define STREAMING_DEF_LISTENING_TIMEOUT 30000
 #define STREAMING_DEF_SUBSCRIBE_TIMEOUT 1500
 #define STREAMING_MAX_SUBSCRIPTIONS 50
+#define STREAMING_MAX_DISPATCH_THREADS 64
 
 
 typedef void(*streaming_cb_ty)(int, int, unsigned long long, const char*);
 
+/* (service type, timestamp, updates, n) - updates only valid in the call */
+typedef void(*quote_update_cb_ty)(int, unsigned long long,
+                                  const QuoteUpdate_C*, size_t);
+typedef void(*option_update_cb_ty)(int, unsigned long long,
+                                   const OptionUpdate_C*, size_t);
+typedef void(*timesale_tick_cb_ty)(int, unsigned long long,
+                                   const TimesaleTick_C*, size_t);
+typedef void(*chart_bar_cb_ty)(int, unsigned long long,
+                               const ChartBar_C*, size_t);
+typedef void(*acct_activity_cb_ty)(int, unsigned long long,
+                                   const AcctActivity_C*, size_t);
+
+/* NULL members use the generic (JSON) callback */
+typedef struct {
+    quote_update_cb_ty quote;
+    option_update_cb_ty option;
+    timesale_tick_cb_ty timesale;
+    chart_bar_cb_ty chart;
+    acct_activity_cb_ty acct_activity;
+} StreamingTypedCallbacks_C;
+
+/*
+ * per-shard callback dispatch stats (see StreamingSession_GetDispatchStats);
+ * callback times are for the callback(s) of one task - a shard's share of
+ * one 'data' message
+ */
+typedef struct {
+    unsigned long long tasks;
+    unsigned long long updates; // symbols (typed updates or content entries)
+    unsigned long long queue_depth; // tasks waiting, approximate
+    unsigned long long queue_max;
+    unsigned long long spilled; // tasks that found the queue's ring full
+    double callback_msec;
+    double callback_max_msec;
+} StreamingDispatchStats_C;
+
+/* conflation counts by service (see StreamingSession_GetConflationStats) */
+typedef struct {
+    unsigned long long updates; // symbol updates received while conflating
+    unsigned long long conflated; // merged into one not called back yet
+    unsigned long long delivered; // (coalesced) updates called back
+} StreamingConflationStats_C;
+
+/* bytes received by the current/last connection (see StreamingSession_GetWireStats) */
+typedef struct {
+    unsigned long long messages;
+    unsigned long long wire_bytes; // message payloads as received
+    unsigned long long decoded_bytes; // after inflating (if compressed)
+    int compressed; // permessage-deflate negotiated
+} StreamingWireStats_C;
+
 EXTERN_C_SPEC_ DLL_SPEC_ int
 StreamingSession_Create_ABI( struct Credentials *pcreds,
                              streaming_cb_ty callback,
@@ -1440,6 +1818,199 @@ StreamingSession_GetQOS_ABI( StreamingSession_C *psession,
                              int *qos,
                              int allow_exceptions );
 
+/* raw_data != 0: 'data' callbacks get the content as sent by the server */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetRawData_ABI( StreamingSession_C *psession,
+                                 int raw_data,
+                                 int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetRawData_ABI( StreamingSession_C *psession,
+                                 int *raw_data,
+                                 int allow_exceptions );
+
+/* NULL callbacks clears them all */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetTypedCallbacks_ABI(
+    StreamingSession_C *psession,
+    const StreamingTypedCallbacks_C *callbacks,
+    int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetTypedCallbacks_ABI(
+    StreamingSession_C *psession,
+    StreamingTypedCallbacks_C *callbacks,
+    int allow_exceptions );
+
+/*
+ * LEVEL ONE CACHE - latest full state of each QUOTE, OPTION,
+ * LEVELONE_FUTURES and LEVELONE_FOREX symbol (QuoteUpdate_C, OptionUpdate_C,
+ * LevelOneFuturesUpdate_C, LevelOneForexUpdate_C). Reads never block the
+ * session. Symbol ids (-1 if not in the cache) don't change.
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetLevelOneCache_ABI( StreamingSession_C *psession,
+                                       int on,
+                                       int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetLevelOneCache_ABI( StreamingSession_C *psession,
+                                       int *on,
+                                       int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetLevelOneSymbols_ABI( StreamingSession_C *psession,
+                                         int service,
+                                         char ***buffers,
+                                         size_t *n,
+                                         int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetLevelOneSymbolId_ABI( StreamingSession_C *psession,
+                                          int service,
+                                          const char* symbol,
+                                          long long *id,
+                                          int allow_exceptions );
+
+/* record_size must be sizeof the service's struct */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetLevelOne_ABI( StreamingSession_C *psession,
+                                  int service,
+                                  const char* symbol,
+                                  void *record,
+                                  size_t record_size,
+                                  int *found,
+                                  int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetLevelOneById_ABI( StreamingSession_C *psession,
+                                      int service,
+                                      long long id,
+                                      void *record,
+                                      size_t record_size,
+                                      int *found,
+                                      int allow_exceptions );
+
+/*
+ * ORDER TRACKER - state of each order (OrderState_C) seen on an
+ * ACCT_ACTIVITY subscription, by order id. Reads never block the session.
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetOrderTracker_ABI( StreamingSession_C *psession,
+                                      int on,
+                                      int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetOrderTracker_ABI( StreamingSession_C *psession,
+                                      int *on,
+                                      int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetOrderIds_ABI( StreamingSession_C *psession,
+                                  char ***buffers,
+                                  size_t *n,
+                                  int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetOrderState_ABI( StreamingSession_C *psession,
+                                    const char* order_id,
+                                    OrderState_C *state,
+                                    int *found,
+                                    int allow_exceptions );
+
+/*
+ * INLINE PROCESSING - on != 0: messages are parsed, and called back (or
+ * passed to the dispatch threads), on the connection's socket thread as
+ * they arrive instead of being queued for the listener thread. Takes
+ * effect the next time the session starts.
+ *
+ * While inline, callbacks MUST NOT stop the session: stopping waits for
+ * the socket thread, which is the one running the callback.
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetInlineProcessing_ABI( StreamingSession_C *psession,
+                                          int on,
+                                          int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetInlineProcessing_ABI( StreamingSession_C *psession,
+                                          int *on,
+                                          int allow_exceptions );
+
+/*
+ * COMPRESSION - on != 0: offer permessage-deflate when connecting; if the
+ * server accepts, messages are inflated on the socket thread. Takes effect
+ * the next time the session starts. Wire stats are for the current/last
+ * connection.
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetCompression_ABI( StreamingSession_C *psession,
+                                     int on,
+                                     int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetCompression_ABI( StreamingSession_C *psession,
+                                     int *on,
+                                     int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetWireStats_ABI( StreamingSession_C *psession,
+                                   StreamingWireStats_C *pstats,
+                                   int allow_exceptions );
+
+/*
+ * CALLBACK DISPATCH - with nthreads > 0 'data' callbacks (typed or not) run
+ * on nthreads worker threads instead of the listener thread. Each message
+ * is split by symbol; a symbol always goes to the same worker so its
+ * updates stay in order. Takes effect the next time the session starts.
+ * Stats are for the shards (workers) of the current/last start.
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetDispatchThreads_ABI( StreamingSession_C *psession,
+                                         size_t nthreads,
+                                         int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetDispatchThreads_ABI( StreamingSession_C *psession,
+                                         size_t *nthreads,
+                                         int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetDispatchShards_ABI( StreamingSession_C *psession,
+                                        size_t *nshards,
+                                        int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetDispatchStats_ABI( StreamingSession_C *psession,
+                                       size_t shard,
+                                       StreamingDispatchStats_C *pstats,
+                                       int allow_exceptions );
+
+/*
+ * CONFLATION - while a service is conflated each symbol's 'data' is merged
+ * into the latest state since it was last called back (union of the
+ * fields, latest values) and called back once - as soon as the dispatch
+ * worker, or the listener, gets to it - instead of once per update. Only
+ * QUOTE, OPTION, LEVELONE_[] and ACTIVES_[] can be conflated.
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetConflation_ABI( StreamingSession_C *psession,
+                                    int service,
+                                    int on,
+                                    int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetConflation_ABI( StreamingSession_C *psession,
+                                    int service,
+                                    int *on,
+                                    int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetConflationStats_ABI( StreamingSession_C *psession,
+                                         int service,
+                                         StreamingConflationStats_C *pstats,
+                                         int allow_exceptions );
+
 #ifndef __cplusplus
 
 /* C Interface */
@@ -1506,6 +2077,163 @@ static inline int
 StreamingSession_GetQOS( StreamingSession_C *psession, QOSType *qos)
 { return StreamingSession_GetQOS_ABI(psession, (int*)qos, 0); }
 
+static inline int
+StreamingSession_SetRawData( StreamingSession_C *psession, int raw_data )
+{ return StreamingSession_SetRawData_ABI(psession, raw_data, 0); }
+
+static inline int
+StreamingSession_GetRawData( StreamingSession_C *psession, int *raw_data )
+{ return StreamingSession_GetRawData_ABI(psession, raw_data, 0); }
+
+static inline int
+StreamingSession_SetTypedCallbacks( StreamingSession_C *psession,
+                                    const StreamingTypedCallbacks_C *callbacks )
+{ return StreamingSession_SetTypedCallbacks_ABI(psession, callbacks, 0); }
+
+static inline int
+StreamingSession_GetTypedCallbacks( StreamingSession_C *psession,
+                                    StreamingTypedCallbacks_C *callbacks )
+{ return StreamingSession_GetTypedCallbacks_ABI(psession, callbacks, 0); }
+
+static inline int
+StreamingSession_SetLevelOneCache( StreamingSession_C *psession, int on )
+{ return StreamingSession_SetLevelOneCache_ABI(psession, on, 0); }
+
+static inline int
+StreamingSession_GetLevelOneCache( StreamingSession_C *psession, int *on )
+{ return StreamingSession_GetLevelOneCache_ABI(psession, on, 0); }
+
+static inline int
+StreamingSession_GetLevelOneSymbols( StreamingSession_C *psession,
+                                     StreamerServiceType service,
+                                     char ***buffers,
+                                     size_t *n )
+{
+    return StreamingSession_GetLevelOneSymbols_ABI(psession, (int)service,
+                                                   buffers, n, 0);
+}
+
+static inline int
+StreamingSession_GetLevelOneSymbolId( StreamingSession_C *psession,
+                                      StreamerServiceType service,
+                                      const char* symbol,
+                                      long long *id )
+{
+    return StreamingSession_GetLevelOneSymbolId_ABI(psession, (int)service,
+                                                    symbol, id, 0);
+}
+
+static inline int
+StreamingSession_GetLevelOne( StreamingSession_C *psession,
+                              StreamerServiceType service,
+                              const char* symbol,
+                              void *record,
+                              size_t record_size,
+                              int *found )
+{
+    return StreamingSession_GetLevelOne_ABI(psession, (int)service, symbol,
+                                            record, record_size, found, 0);
+}
+
+static inline int
+StreamingSession_GetLevelOneById( StreamingSession_C *psession,
+                                  StreamerServiceType service,
+                                  long long id,
+                                  void *record,
+                                  size_t record_size,
+                                  int *found )
+{
+    return StreamingSession_GetLevelOneById_ABI(psession, (int)service, id,
+                                                record, record_size, found, 0);
+}
+
+static inline int
+StreamingSession_SetOrderTracker( StreamingSession_C *psession, int on )
+{ return StreamingSession_SetOrderTracker_ABI(psession, on, 0); }
+
+static inline int
+StreamingSession_GetOrderTracker( StreamingSession_C *psession, int *on )
+{ return StreamingSession_GetOrderTracker_ABI(psession, on, 0); }
+
+static inline int
+StreamingSession_GetOrderIds( StreamingSession_C *psession,
+                              char ***buffers,
+                              size_t *n )
+{ return StreamingSession_GetOrderIds_ABI(psession, buffers, n, 0); }
+
+static inline int
+StreamingSession_GetOrderState( StreamingSession_C *psession,
+                                const char* order_id,
+                                OrderState_C *state,
+                                int *found )
+{
+    return StreamingSession_GetOrderState_ABI(psession, order_id, state,
+                                              found, 0);
+}
+
+static inline int
+StreamingSession_SetInlineProcessing( StreamingSession_C *psession, int on )
+{ return StreamingSession_SetInlineProcessing_ABI(psession, on, 0); }
+
+static inline int
+StreamingSession_GetInlineProcessing( StreamingSession_C *psession, int *on )
+{ return StreamingSession_GetInlineProcessing_ABI(psession, on, 0); }
+
+static inline int
+StreamingSession_SetCompression( StreamingSession_C *psession, int on )
+{ return StreamingSession_SetCompression_ABI(psession, on, 0); }
+
+static inline int
+StreamingSession_GetCompression( StreamingSession_C *psession, int *on )
+{ return StreamingSession_GetCompression_ABI(psession, on, 0); }
+
+static inline int
+StreamingSession_GetWireStats( StreamingSession_C *psession,
+                               StreamingWireStats_C *pstats )
+{ return StreamingSession_GetWireStats_ABI(psession, pstats, 0); }
+
+static inline int
+StreamingSession_SetDispatchThreads( StreamingSession_C *psession,
+                                     size_t nthreads )
+{ return StreamingSession_SetDispatchThreads_ABI(psession, nthreads, 0); }
+
+static inline int
+StreamingSession_GetDispatchThreads( StreamingSession_C *psession,
+                                     size_t *nthreads )
+{ return StreamingSession_GetDispatchThreads_ABI(psession, nthreads, 0); }
+
+static inline int
+StreamingSession_GetDispatchShards( StreamingSession_C *psession,
+                                    size_t *nshards )
+{ return StreamingSession_GetDispatchShards_ABI(psession, nshards, 0); }
+
+static inline int
+StreamingSession_GetDispatchStats( StreamingSession_C *psession,
+                                   size_t shard,
+                                   StreamingDispatchStats_C *pstats )
+{ return StreamingSession_GetDispatchStats_ABI(psession, shard, pstats, 0); }
+
+static inline int
+StreamingSession_SetConflation( StreamingSession_C *psession,
+                                StreamerServiceType service,
+                                int on )
+{ return StreamingSession_SetConflation_ABI(psession, (int)service, on, 0); }
+
+static inline int
+StreamingSession_GetConflation( StreamingSession_C *psession,
+                                StreamerServiceType service,
+                                int *on )
+{ return StreamingSession_GetConflation_ABI(psession, (int)service, on, 0); }
+
+static inline int
+StreamingSession_GetConflationStats( StreamingSession_C *psession,
+                                     StreamerServiceType service,
+                                     StreamingConflationStats_C *pstats )
+{
+    return StreamingSession_GetConflationStats_ABI(psession, (int)service,
+                                                   pstats, 0);
+}
+
 #else
 
 /* C++ Interface */
@@ -1566,6 +2294,30 @@ private:
         return cpp_results;
     }
 
+    template<typename T>
+    bool
+    _get_level_one( StreamerServiceType service,
+                    const std::string& symbol,
+                    T& state ) const
+    {
+        int found;
+        call_abi( StreamingSession_GetLevelOne_ABI, _obj.get(),
+                  static_cast<int>(service), symbol.c_str(),
+                  static_cast<void*>(&state), sizeof(T), &found );
+        return static_cast<bool>(found);
+    }
+
+    template<typename T>
+    bool
+    _get_level_one(StreamerServiceType service, long long id, T& state) const
+    {
+        int found;
+        call_abi( StreamingSession_GetLevelOneById_ABI, _obj.get(),
+                  static_cast<int>(service), id,
+                  static_cast<void*>(&state), sizeof(T), &found );
+        return static_cast<bool>(found);
+    }
+
 public:
     static std::shared_ptr<StreamingSession>
     Create( Credentials& creds,
@@ -1642,6 +2394,260 @@ public:
                   static_cast<int>(qos), &result );
         return static_cast<bool>(result);
     }
+
+    bool
+    get_raw_data() const
+    {
+        int r;
+        call_abi( StreamingSession_GetRawData_ABI, _obj.get(), &r );
+        return static_cast<bool>(r);
+    }
+
+    void
+    set_raw_data(bool raw_data)
+    {
+        call_abi( StreamingSession_SetRawData_ABI, _obj.get(),
+                  static_cast<int>(raw_data) );
+    }
+
+    StreamingTypedCallbacks_C
+    get_typed_callbacks() const
+    {
+        StreamingTypedCallbacks_C cbs;
+        call_abi( StreamingSession_GetTypedCallbacks_ABI, _obj.get(), &cbs );
+        return cbs;
+    }
+
+    void
+    set_typed_callbacks(const StreamingTypedCallbacks_C& callbacks)
+    {
+        call_abi( StreamingSession_SetTypedCallbacks_ABI, _obj.get(),
+                  &callbacks );
+    }
+
+    bool
+    get_level_one_cache() const
+    {
+        int on;
+        call_abi( StreamingSession_GetLevelOneCache_ABI, _obj.get(), &on );
+        return static_cast<bool>(on);
+    }
+
+    void
+    set_level_one_cache(bool on)
+    {
+        call_abi( StreamingSession_SetLevelOneCache_ABI, _obj.get(),
+                  static_cast<int>(on) );
+    }
+
+    std::set<std::string>
+    get_level_one_symbols(StreamerServiceType service) const
+    {
+        char **buf;
+        size_t n;
+        std::set<std::string> symbols;
+        call_abi( StreamingSession_GetLevelOneSymbols_ABI, _obj.get(),
+                  static_cast<int>(service), &buf, &n );
+        if( buf ){
+            while(n--){
+                symbols.insert(buf[n]);
+                free(buf[n]);
+            }
+            free(buf);
+        }
+        return symbols;
+    }
+
+    long long
+    get_level_one_symbol_id( StreamerServiceType service,
+                             const std::string& symbol ) const
+    {
+        long long id;
+        call_abi( StreamingSession_GetLevelOneSymbolId_ABI, _obj.get(),
+                  static_cast<int>(service), symbol.c_str(), &id );
+        return id;
+    }
+
+    /* false if 'symbol'/'id' isn't in the cache */
+    bool
+    get_level_one(const std::string& symbol, QuoteUpdate_C& state) const
+    { return _get_level_one(StreamerServiceType::QUOTE, symbol, state); }
+
+    bool
+    get_level_one(const std::string& symbol, OptionUpdate_C& state) const
+    { return _get_level_one(StreamerServiceType::OPTION, symbol, state); }
+
+    bool
+    get_level_one( const std::string& symbol,
+                   LevelOneFuturesUpdate_C& state ) const
+    {
+        return _get_level_one(StreamerServiceType::LEVELONE_FUTURES, symbol,
+                              state);
+    }
+
+    bool
+    get_level_one( const std::string& symbol,
+                   LevelOneForexUpdate_C& state ) const
+    {
+        return _get_level_one(StreamerServiceType::LEVELONE_FOREX, symbol,
+                              state);
+    }
+
+    bool
+    get_level_one(long long id, QuoteUpdate_C& state) const
+    { return _get_level_one(StreamerServiceType::QUOTE, id, state); }
+
+    bool
+    get_level_one(long long id, OptionUpdate_C& state) const
+    { return _get_level_one(StreamerServiceType::OPTION, id, state); }
+
+    bool
+    get_level_one(long long id, LevelOneFuturesUpdate_C& state) const
+    { return _get_level_one(StreamerServiceType::LEVELONE_FUTURES, id, state); }
+
+    bool
+    get_level_one(long long id, LevelOneForexUpdate_C& state) const
+    { return _get_level_one(StreamerServiceType::LEVELONE_FOREX, id, state); }
+
+    bool
+    get_order_tracker() const
+    {
+        int on;
+        call_abi( StreamingSession_GetOrderTracker_ABI, _obj.get(), &on );
+        return static_cast<bool>(on);
+    }
+
+    void
+    set_order_tracker(bool on)
+    {
+        call_abi( StreamingSession_SetOrderTracker_ABI, _obj.get(),
+                  static_cast<int>(on) );
+    }
+
+    std::set<std::string>
+    get_order_ids() const
+    {
+        char **buf;
+        size_t n;
+        std::set<std::string> ids;
+        call_abi( StreamingSession_GetOrderIds_ABI, _obj.get(), &buf, &n );
+        if( buf ){
+            while(n--){
+                ids.insert(buf[n]);
+                free(buf[n]);
+            }
+            free(buf);
+        }
+        return ids;
+    }
+
+    /* false if 'order_id' isn't being tracked */
+    bool
+    get_order_state(const std::string& order_id, OrderState_C& state) const
+    {
+        int found;
+        call_abi( StreamingSession_GetOrderState_ABI, _obj.get(),
+                  order_id.c_str(), &state, &found );
+        return static_cast<bool>(found);
+    }
+
+    bool
+    get_inline_processing() const
+    {
+        int on;
+        call_abi( StreamingSession_GetInlineProcessing_ABI, _obj.get(), &on );
+        return static_cast<bool>(on);
+    }
+
+    /* takes effect the next time the session starts */
+    void
+    set_inline_processing(bool on)
+    {
+        call_abi( StreamingSession_SetInlineProcessing_ABI, _obj.get(),
+                  static_cast<int>(on) );
+    }
+
+    bool
+    get_compression() const
+    {
+        int on;
+        call_abi( StreamingSession_GetCompression_ABI, _obj.get(), &on );
+        return static_cast<bool>(on);
+    }
+
+    /* takes effect the next time the session starts */
+    void
+    set_compression(bool on)
+    {
+        call_abi( StreamingSession_SetCompression_ABI, _obj.get(),
+                  static_cast<int>(on) );
+    }
+
+    StreamingWireStats_C
+    get_wire_stats() const
+    {
+        StreamingWireStats_C stats;
+        call_abi( StreamingSession_GetWireStats_ABI, _obj.get(), &stats );
+        return stats;
+    }
+
+    size_t
+    get_dispatch_threads() const
+    {
+        size_t n;
+        call_abi( StreamingSession_GetDispatchThreads_ABI, _obj.get(), &n );
+        return n;
+    }
+
+    /* takes effect the next time the session starts */
+    void
+    set_dispatch_threads(size_t nthreads)
+    {
+        call_abi( StreamingSession_SetDispatchThreads_ABI, _obj.get(),
+                  nthreads );
+    }
+
+    size_t
+    get_dispatch_shards() const
+    {
+        size_t n;
+        call_abi( StreamingSession_GetDispatchShards_ABI, _obj.get(), &n );
+        return n;
+    }
+
+    StreamingDispatchStats_C
+    get_dispatch_stats(size_t shard) const
+    {
+        StreamingDispatchStats_C stats;
+        call_abi( StreamingSession_GetDispatchStats_ABI, _obj.get(), shard,
+                  &stats );
+        return stats;
+    }
+
+    bool
+    get_conflation(StreamerServiceType service) const
+    {
+        int on;
+        call_abi( StreamingSession_GetConflation_ABI, _obj.get(),
+                  static_cast<int>(service), &on );
+        return static_cast<bool>(on);
+    }
+
+    void
+    set_conflation(StreamerServiceType service, bool on)
+    {
+        call_abi( StreamingSession_SetConflation_ABI, _obj.get(),
+                  static_cast<int>(service), static_cast<int>(on) );
+    }
+
+    StreamingConflationStats_C
+    get_conflation_stats(StreamerServiceType service) const
+    {
+        StreamingConflationStats_C stats;
+        call_abi( StreamingSession_GetConflationStats_ABI, _obj.get(),
+                  static_cast<int>(service), &stats );
+        return stats;
+    }
 };
 
 } /* tdma */
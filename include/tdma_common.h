@@ -110,6 +110,7 @@ DECL_CPROXY_BASE_STRUCT(Getter_C);
 DECL_CPROXY_BASE_STRUCT(StreamingSubscription_C);
 DECL_CPROXY_BASE_STRUCT(OrderLeg_C);
 DECL_CPROXY_BASE_STRUCT(OrderTicket_C);
+DECL_CPROXY_BASE_STRUCT(OrderTemplate_C);
 
 #undef DECL_CPROXY_BASE_STRUCT
 
@@ -140,6 +141,43 @@ typedef struct{
 
 #define TDMA_API_UNKNOWN_EXCEPTION 1001
 
+/*
+ * RequestStats_C - per-endpoint request timing (see RequestStats_Get)
+ *
+ * phase times are the mean msec from the start of the request to the end
+ * of that phase (i.e cumulative, as curl reports them); a phase that was
+ * skipped on a re-used connection counts as 0.
+ *
+ * total_hist/throttle_hist bucket i counts values <
+ * REQUEST_LATENCY_BUCKET_MSEC[i] (and >= the bound before it); the last
+ * bucket counts everything >= the last bound.
+ */
+#define TDMA_API_LATENCY_BUCKETS 13
+
+static const double
+REQUEST_LATENCY_BUCKET_MSEC[TDMA_API_LATENCY_BUCKETS - 1] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+};
+
+typedef struct{
+    unsigned long long count;
+    unsigned long long errors; // curl error or non-2xx response
+    unsigned long long bytes_down;
+    unsigned long long bytes_up;
+    double namelookup_msec;
+    double connect_msec;
+    double appconnect_msec;
+    double starttransfer_msec;
+    double total_msec;
+    double total_max_msec;
+    unsigned long long total_hist[TDMA_API_LATENCY_BUCKETS];
+    /* time spent waiting on the rate limiter before the request */
+    unsigned long long throttle_count;
+    double throttle_msec;
+    double throttle_max_msec;
+    unsigned long long throttle_hist[TDMA_API_LATENCY_BUCKETS];
+} RequestStats_C;
+
 struct Credentials;
 
 /*
@@ -258,6 +296,21 @@ CheckOptionSymbol_ABI(const char* symbol, int allow_exceptions);
 EXTERN_C_SPEC_ DLL_SPEC_ int
 LibraryBuildDateTime_ABI(char **buf, size_t *n, int allow_exceptions);
 
+/* endpoints are "METHOD /v1/path" w/ ids, symbols etc. replaced by '{}' */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+RequestStats_GetEndpoints_ABI( char ***buffers,
+                               size_t *n,
+                               int allow_exceptions );
+
+/* endpoint == NULL (or "") for all endpoints combined; ValueError if unknown */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+RequestStats_Get_ABI( const char* endpoint,
+                      RequestStats_C *pstats,
+                      int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+RequestStats_Reset_ABI(int allow_exceptions);
+
 
 #ifndef __cplusplus
 /* C interface */
@@ -297,6 +350,18 @@ static inline int
 GetDefaultCertificateBundlePath(char **path, size_t *n )
 { return GetDefaultCertificateBundlePath_ABI(path, n, 0); }
 
+static inline int
+RequestStats_GetEndpoints(char ***buffers, size_t *n)
+{ return RequestStats_GetEndpoints_ABI(buffers, n, 0); }
+
+static inline int
+RequestStats_Get(const char* endpoint, RequestStats_C *pstats)
+{ return RequestStats_Get_ABI(endpoint, pstats, 0); }
+
+static inline int
+RequestStats_Reset()
+{ return RequestStats_Reset_ABI(0); }
+
 static inline int
 CloseCredentials(struct Credentials* pcreds )
 { return CloseCredentials_ABI(pcreds, 0); }
@@ -475,7 +540,8 @@ struct IsValidCProxy<ProxyTy, void>{
         || IsValidCProxy<ProxyTy, StreamingSubscription_C>::value
         || IsValidCProxy<ProxyTy, StreamingSession_C>::value
         || IsValidCProxy<ProxyTy, OrderLeg_C>::value
-        || IsValidCProxy<ProxyTy, OrderTicket_C>::value;
+        || IsValidCProxy<ProxyTy, OrderTicket_C>::value
+        || IsValidCProxy<ProxyTy, OrderTemplate_C>::value;
 };
 
 template<typename ProxyTy>
@@ -485,7 +551,8 @@ struct IsCProxyBase{
         || std::is_same<ProxyTy, StreamingSubscription_C>::value
         || std::is_same<ProxyTy, StreamingSession_C>::value
         || std::is_same<ProxyTy, OrderLeg_C>::value
-        || std::is_same<ProxyTy, OrderTicket_C>::value;
+        || std::is_same<ProxyTy, OrderTicket_C>::value
+        || std::is_same<ProxyTy, OrderTemplate_C>::value;
 };
 
 template<typename F, typename... Args>
@@ -593,6 +660,36 @@ inline std::string
 GetDefaultCertificateBundlePath()
 { return str_from_abi_vargs(GetDefaultCertificateBundlePath_ABI, ALLOW_EXCEPTIONS); }
 
+inline std::set<std::string>
+RequestStats_GetEndpoints()
+{
+    char **buf;
+    size_t n;
+    std::set<std::string> endpoints;
+    call_abi( RequestStats_GetEndpoints_ABI, &buf, &n );
+    if( buf ){
+        while(n--){
+            endpoints.insert(buf[n]);
+            free(buf[n]);
+        }
+        free(buf);
+    }
+    return endpoints;
+}
+
+/* "" for all endpoints combined */
+inline RequestStats_C
+RequestStats_Get(const std::string& endpoint = "")
+{
+    RequestStats_C stats;
+    call_abi( RequestStats_Get_ABI, endpoint.c_str(), &stats );
+    return stats;
+}
+
+inline void
+RequestStats_Reset()
+{ call_abi( RequestStats_Reset_ABI ); }
+
 inline int
 LastErrorCode()
 {
@@ -903,29 +1000,13 @@ public:
 };
 
 
+/* rebuild the exception, on the client side, from its error info */
 static void
-error_to_exc(int code)
+throw_error_exc( int code,
+                 std::string msg,
+                 int lineno,
+                 const std::string& fname )
 {
-    if( code == 0 )
-        return;
-
-    char *bufs[] = {nullptr, nullptr};
-    int lineno, c;
-    size_t n;
-
-    int err = LastErrorState_ABI(&c, &bufs[0], &n, &lineno, &bufs[1], &n, 0);
-    if( err ) {
-        throw std::runtime_error("failed to get last error state("
-                                 + std::to_string(err) + ")");
-    }
-    assert(bufs[0]);
-    assert(bufs[1]);
-    assert(code == c);
-    std::string msg(bufs[0]);
-    std::string fname(bufs[1]);
-    FreeBuffer_ABI(bufs[0], 0);
-    FreeBuffer_ABI(bufs[1], 0);
-
     // move original exc info -> what
     std::stringstream ss;
     ss << msg << " [error code: " << code << ", file: " << fname
@@ -954,6 +1035,33 @@ error_to_exc(int code)
 }
 
 
+static void
+error_to_exc(int code)
+{
+    if( code == 0 )
+        return;
+
+    char *bufs[] = {nullptr, nullptr};
+    int lineno, c;
+    size_t n;
+
+    int err = LastErrorState_ABI(&c, &bufs[0], &n, &lineno, &bufs[1], &n, 0);
+    if( err ) {
+        throw std::runtime_error("failed to get last error state("
+                                 + std::to_string(err) + ")");
+    }
+    assert(bufs[0]);
+    assert(bufs[1]);
+    assert(code == c);
+    std::string msg(bufs[0]);
+    std::string fname(bufs[1]);
+    FreeBuffer_ABI(bufs[0], 0);
+    FreeBuffer_ABI(bufs[1], 0);
+
+    throw_error_exc(code, msg, lineno, fname);
+}
+
+
 template<typename FromTy, typename ToTy>
 ToTy*
 set_to_new_array( const std::set<FromTy>& from, ToTy(*trans)(const FromTy&) )
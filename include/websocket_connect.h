@@ -23,21 +23,52 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <atomic>
 #include <signal.h>
 
 #include "_common.h"
 #include "../include/util.h"
 #include "threadsafe_queue.h"
+#include "spsc_ring.h"
 
 #include "../uWebSockets/uWS.h"
 
 namespace conn{
 
 class WebSocketClient{
+public:
+    /* written by the uWS thread only; read from any */
+    struct Stats{
+        std::atomic<bool> compressed; // permessage-deflate negotiated
+        std::atomic<unsigned long long> messages;
+        std::atomic<unsigned long long> wire_bytes; // payload, as received
+        std::atomic<unsigned long long> decoded_bytes; // after inflating
+
+        Stats()
+            : compressed(false), messages(0), wire_bytes(0), decoded_bytes(0)
+            {}
+
+        void
+        clear()
+        {
+            compressed = false;
+            messages = 0;
+            wire_bytes = 0;
+            decoded_bytes = 0;
+        }
+    };
+
+private:
     typedef uWS::WebSocket<uWS::CLIENT> uws_client_ty;
 
+    /*
+     * the client is the socket's user data (passed to Hub::connect) so
+     * each client's callbacks find their own state; no globals, any number
+     * of clients can run at once (each w/ its own Hub/loop/thread)
+     */
     struct Callbacks{
-        static WebSocketClient *wsc;
+        static WebSocketClient*
+        client(uws_client_ty *ws);
 
         static void
         on_connect(uws_client_ty *ws, uWS::HttpRequest r);
@@ -53,19 +84,32 @@ class WebSocketClient{
 
         static void
         on_signal(uS::Async *a);
+
+        static void
+        on_timer(uS::Timer *t);
     };
 
     uWS::Hub _hub;
     std::string _url;
+    /*
+     * closed/freed on the uWS thread once the socket is gone (epoll: w/ its
+     * eventfd, so sending after that would write to a closed/re-used fd);
+     * only sent through _send_signal
+     */
     uS::Async *_signal;
+    std::mutex _signal_mtx;
     std::thread _thread;
-    ThreadSafeQueue<std::string> _in_queue; // in from server
+    /*
+     * in from server: uWS thread -> ONE reader at a time (login/logout on
+     * the session's thread, otherwise its listener thread)
+     */
+    SPSCRing<std::string> _in_ring;
     ThreadSafeQueue<std::string> _out_queue; // out to server
     std::condition_variable _init_cond;
     bool _init_flag;
     std::mutex _init_mtx;
     uws_client_ty *_ws; // sync issues with is_connected() ?
-    Callbacks _callbacks;
+    Stats *_stats; // optional, owned by the caller
 
     enum class CloseType {
         none,
@@ -74,6 +118,51 @@ class WebSocketClient{
     };
     volatile CloseType _closing_state;
 
+    /*
+     * inline mode: messages go to the handlers on the uWS thread instead of
+     * _in_ring. The handlers are only touched on the uWS thread, so nothing
+     * is locked per message; other threads ask for a mode switch
+     * (_inline_next) and wait for on_signal to make it.
+     */
+    struct InlineHandlers{
+        std::function<void(std::string&)> on_message; // null: inline off
+        std::function<void()> on_timer;
+        std::chrono::milliseconds interval;
+    };
+    InlineHandlers _inline_handlers; // uWS thread only
+    std::atomic<bool> _inline; // written by the uWS thread only
+    std::string _inline_msg; // re-used
+    uS::Timer *_timer; // uWS thread only
+
+    /* mode switch handshake */
+    InlineHandlers _inline_next;
+    bool _inline_switching;
+    bool _inline_closed; // uWS thread won't switch anymore
+    std::mutex _inline_mtx;
+    std::condition_variable _inline_cond;
+
+    void
+    _close_timer();
+
+    /* ANY THREAD - false if the switch can't be made (disconnected) */
+    bool
+    _request_inline(InlineHandlers handlers);
+
+    /* uWS thread */
+    void
+    _switch_inline();
+
+    /* uWS thread - no more switches; wake anyone waiting on one */
+    void
+    _end_inline();
+
+    /* ANY THREAD - false if the signal is already closed */
+    bool
+    _send_signal();
+
+    void
+    _close_signal();
+
     struct SocketThreadTarget{
         WebSocketClient *_wsc;
         std::chrono::milliseconds _timeout;
@@ -82,7 +171,7 @@ class WebSocketClient{
         operator()(){
             util::debug_out("WebSocket", "SocketThreadTarget IN", _wsc,
                             std::cout);
-            _wsc->_hub.connect(_wsc->_url, nullptr, {}, _timeout.count());
+            _wsc->_hub.connect(_wsc->_url, _wsc, {}, _timeout.count());
             _wsc->_hub.run();
             util::debug_out("WebSocket", "SocketThreadTarget OUT", _wsc,
                             std::cout);
@@ -95,7 +184,10 @@ class WebSocketClient{
     };
 
 public:
-    WebSocketClient(std::string url);
+    /* compress: offer permessage-deflate (the server can decline) */
+    WebSocketClient( std::string url,
+                     bool compress = false,
+                     Stats *stats = nullptr );
 
     WebSocketClient( const WebSocketClient& ) = delete;
 
@@ -117,13 +209,53 @@ public:
     void
     send(std::string msg);
 
+    static const size_t IN_RING_CAPACITY = 1024;
+
+    typedef std::function<void(std::string&)> inline_message_cb_ty;
+    typedef std::function<void()> inline_timer_cb_ty;
+
+    /*
+     * INLINE MODE - from now on on_message(msg) is called on the uWS thread
+     * for each message (instead of queuing it for recv) and on_timer() every
+     * 'interval', until stop_inline. BLOCKS until the uWS thread has made
+     * the switch; messages already queued are passed to on_message first,
+     * so the caller must be the (only) reader. push_empty_message still
+     * reaches the reader, as does a disconnect. False if not connected.
+     *
+     * The handlers MUST NOT call start_inline/stop_inline, or wait on a
+     * thread that does (e.g. stop the session): the switch is made on the
+     * thread they run on.
+     */
+    bool
+    start_inline( inline_message_cb_ty on_message,
+                  inline_timer_cb_ty on_timer,
+                  std::chrono::milliseconds interval );
+
+    /* BLOCKS until the handlers aren't running; recv gets messages again */
+    void
+    stop_inline();
+
+    /* reader gets an empty message after those already received */
     void
     push_empty_message()
-    { _in_queue.push(""); }
+    { _in_ring.interrupt(); }
 
     size_t
     nready()
-    { return _in_queue.size(); }
+    { return _in_ring.size(); }
+
+    /*
+     * swap the next message into 'msg' - its old buffer is re-used for a
+     * later message - so hold on to 'msg' between calls
+     */
+    bool
+    recv(std::string& msg)
+    { return _in_ring.pop(msg); }
+
+    /* false on timeout */
+    bool
+    recv_or_wait_for(std::string& msg, std::chrono::milliseconds timeout)
+    { return _in_ring.pop_or_wait_for(msg, timeout); }
 
     std::string
     recv();
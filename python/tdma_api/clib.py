@@ -87,15 +87,20 @@ ERRORS = {
     }
 
 class CLibException(Exception):
-    def __init__(self, error_code):
+    def __init__(self, error_code, msg=None):
+        # msg is passed directly for errors that come back asynchronously
+        # (the global error state may belong to another call by then)
         self.error_code = error_code
-        msg = get_last_error_msg()
-        assert error_code == get_last_error_code()
-        lineno = get_last_error_lineno()
-        fname = get_last_error_filename()
-        info = " [error code: " + str(error_code) + ", line: " \
-             + str(lineno) + ", file: " + fname + ']'
-        super().__init__(ERRORS.get(error_code) + ": " + msg + info)
+        if msg is None:
+            msg = get_last_error_msg()
+            assert error_code == get_last_error_code()
+            lineno = get_last_error_lineno()
+            fname = get_last_error_filename()
+            info = " [error code: " + str(error_code) + ", line: " \
+                 + str(lineno) + ", file: " + fname + ']'
+        else:
+            info = " [error code: " + str(error_code) + ']'
+        super().__init__(str(ERRORS.get(error_code)) + ": " + msg + info)
         
 class LibraryNotLoaded(Exception):
     pass
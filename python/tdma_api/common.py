@@ -17,7 +17,7 @@
 
 """ tdma_api/common.py - functions/objects used across interfaces """
 
-from ctypes import c_uint, c_double
+from ctypes import c_uint, c_double, c_ulonglong, Structure as _Structure
 from . import clib
 
 def build_option_symbol(underlying, month, day, year, is_call, strike):
@@ -41,3 +41,55 @@ def check_option_symbol(symbol):
     (Note, this only checks the *format* not if the option actually exists.
     """
     clib.call("CheckOptionSymbol_ABI", clib.PCHAR(symbol))
+
+
+# upper bounds (msec) of the request stats histogram buckets; the last
+# bucket counts everything >= the last bound
+REQUEST_LATENCY_BUCKET_MSEC = (1, 2, 5, 10, 20, 50, 100, 200, 500, 1000,
+                               2000, 5000)
+
+class _RequestStats_C(_Structure):
+    _fields_ = [
+        ("count", c_ulonglong),
+        ("errors", c_ulonglong),
+        ("bytes_down", c_ulonglong),
+        ("bytes_up", c_ulonglong),
+        ("namelookup_msec", c_double),
+        ("connect_msec", c_double),
+        ("appconnect_msec", c_double),
+        ("starttransfer_msec", c_double),
+        ("total_msec", c_double),
+        ("total_max_msec", c_double),
+        ("total_hist", c_ulonglong * (len(REQUEST_LATENCY_BUCKET_MSEC) + 1)),
+        ("throttle_count", c_ulonglong),
+        ("throttle_msec", c_double),
+        ("throttle_max_msec", c_double),
+        ("throttle_hist", c_ulonglong * (len(REQUEST_LATENCY_BUCKET_MSEC) + 1))
+        ]
+
+def get_request_stats_endpoints():
+    """Returns list of endpoints w/ request stats e.g 'GET /v1/accounts/{}'."""
+    return clib.get_strs("RequestStats_GetEndpoints_ABI")
+
+def get_request_stats(endpoint=None):
+    """Returns dict of timing stats for 'endpoint' (None for all combined).
+
+    'count', 'errors', 'bytes_down', 'bytes_up' : totals
+    '*_msec' : mean msec from the start of the request to the end of the
+               phase, 'total_max_msec' the slowest request
+    'throttle_*' : time spent waiting on the rate limiter first
+    'total_hist', 'throttle_hist' : counts by REQUEST_LATENCY_BUCKET_MSEC
+
+    THROWS -> LibraryNotLoaded
+           -> CLibException (no stats for that endpoint)
+    """
+    s = _RequestStats_C()
+    clib.call("RequestStats_Get_ABI",
+              clib.PCHAR(endpoint) if endpoint else None, clib.REF(s))
+    d = {k:getattr(s,k) for k,_ in _RequestStats_C._fields_}
+    d['total_hist'] = list(s.total_hist)
+    d['throttle_hist'] = list(s.throttle_hist)
+    return d
+
+def reset_request_stats():
+    clib.call("RequestStats_Reset_ABI")
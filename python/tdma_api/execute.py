@@ -16,7 +16,11 @@
 #
 
 from ctypes import byref as _REF, c_int, c_size_t, c_double, c_uint, \
-                    c_char_p, POINTER
+                    c_char_p, c_ulong, c_longlong, c_void_p, POINTER, \
+                    CFUNCTYPE, Structure as _Structure
+from concurrent.futures import Future as _Future
+from itertools import count as _count
+from threading import Lock as _Lock
 import json
 
 from . import clib
@@ -98,6 +102,10 @@ class _OrderTicket_C(clib._CProxy2):
     """C struct representing OrderTicket_C type."""
     pass
 
+class _OrderTemplate_C(clib._CProxy2):
+    """C struct representing OrderTemplate_C type."""
+    pass
+
 def order_session_to_str(session):
     """Converts ORDER_SESSION_[] constant to str."""
     return clib.to_str("OrderSession_to_string_ABI", c_int, session)
@@ -154,6 +162,109 @@ def send_order(creds, account_id, order):
     return s
     
 
+def replace_order(creds, account_id, order_id, order):
+    """Replace active order w/ a new OrderTicket.
+
+    WARNING - SENDS A LIVE ORDER & HAS UNDERGONE LIMITED TESTING !
+
+    def replace_order(creds, account_id, order_id, order):
+
+        creds           :: Credentials :: instance received from auth.py
+        account_id      :: str         :: user account ID
+        order_id        :: str         :: order ID of order to replace
+        order           :: OrderTicket :: new order
+
+    RETURNS -> new order id str on success (throws CLibException on failure)
+
+    THROWS -> LibraryNotLoaded, CLibException
+    """
+    if not isinstance(order, OrderTicket):
+        raise TypeError("order not instance of 'OrderTicket'")
+    c = c_char_p()
+    n = c_size_t()
+    clib.call('Execute_ReplaceOrder_ABI', _REF(creds), PCHAR(account_id),
+              PCHAR(order_id), _REF(order._obj), _REF(c), _REF(n))
+    s = c.value.decode()
+    clib.free_buffer(c)
+    return s
+
+
+class _ExecuteTiming_C(_Structure):
+    _fields_ = [
+        ("send_usec", c_longlong),
+        ("first_byte_usec", c_longlong),
+        ("complete_usec", c_longlong)
+        ]
+
+# one permanent C callback for all send_order_async() calls; 'ctx' is the
+# key of the pending Future (so no ctypes thunk can be freed while running)
+_SEND_ORDER_ASYNC_CALLBACK_FUNC_TYPE = CFUNCTYPE(None, c_int, c_char_p,
+                                                 c_size_t,
+                                                 POINTER(_ExecuteTiming_C),
+                                                 c_void_p)
+_async_futures = {}
+_async_ids = _count(1)
+_async_lock = _Lock()
+
+def _on_send_order_async(err, buf, n, ptiming, ctx):
+    with _async_lock:
+        fut = _async_futures.pop(ctx, None)
+    if fut is None:
+        return
+    try:
+        s = buf.decode() if buf else ''
+        if err:
+            fut.set_exception(clib.CLibException(err, s))
+        else:
+            t = ptiming.contents
+            fut.set_result( (s, {"send_usec": t.send_usec,
+                                 "first_byte_usec": t.first_byte_usec,
+                                 "complete_usec": t.complete_usec}) )
+    except Exception as e:
+        fut.set_exception(e)
+
+_on_send_order_async_cb = \
+    _SEND_ORDER_ASYNC_CALLBACK_FUNC_TYPE(_on_send_order_async)
+
+
+def send_order_async(creds, account_id, order):
+    """Send OrderTicket for execution asynchronously; returns a Future.
+
+    WARNING - SENDS A LIVE ORDER & HAS UNDERGONE LIMITED TESTING !
+
+    def send_order_async(creds, account_id, order):
+
+        creds           :: Credentials :: instance received from auth.py
+        account_id      :: str         :: user account ID
+        order           :: OrderTicket :: order to send for execution
+
+    Returns immediately; many orders can be in flight at once, each on its
+    own (pooled if free) connection. The result (or CLibException) is set
+    on the Future from a library thread. 'creds' must stay alive until the
+    Future is done.
+
+    RETURNS -> Future of (order id str, timing dict) where timing is
+               {'send_usec', 'first_byte_usec', 'complete_usec'} (usec since
+               epoch; first_byte_usec is 0 if no response was received)
+
+    THROWS -> LibraryNotLoaded, CLibException
+    """
+    if not isinstance(order, OrderTicket):
+        raise TypeError("order not instance of 'OrderTicket'")
+    fut = _Future()
+    with _async_lock:
+        i = next(_async_ids)
+        _async_futures[i] = fut
+    try:
+        clib.call('Execute_SendOrderAsync_ABI', _REF(creds), PCHAR(account_id),
+                  _REF(order._obj), _on_send_order_async_cb, c_void_p(i))
+    except:
+        with _async_lock:
+            _async_futures.pop(i, None)
+        raise
+    return fut
+
+
 def cancel_order(creds, account_id, order_id):
     """Cancel active order.
     
@@ -173,6 +284,42 @@ def cancel_order(creds, account_id, order_id):
     clib.call('Execute_CancelOrder_ABI', _REF(creds), PCHAR(account_id),
               PCHAR(order_id), _REF(b))
     return bool(b.value)
+
+
+def configure_pool(size, keepalive_sec=30, latency_first=False):
+    """Configure the persistent connection pool used by send/replace/cancel.
+
+    def configure_pool(size, keepalive_sec=30, latency_first=False):
+
+        size          :: int  :: number of connections (0 disables the pool)
+        keepalive_sec :: int  :: ping idle connections this often (0 = never)
+        latency_first :: bool :: never wait for a pool connection; if all
+                                 are busy use a new (cold) one instead
+
+    THROWS -> LibraryNotLoaded, CLibException
+    """
+    clib.call('Execute_ConfigurePool_ABI', c_uint(size), c_ulong(keepalive_sec),
+              c_int(latency_first))
+
+
+def get_pool_config():
+    """Returns (size, keepalive_sec, latency_first) of the connection pool.
+
+    THROWS -> LibraryNotLoaded, CLibException
+    """
+    sz = c_uint()
+    ka = c_ulong()
+    lf = c_int()
+    clib.call('Execute_GetPoolConfig_ABI', _REF(sz), _REF(ka), _REF(lf))
+    return (sz.value, ka.value, bool(lf.value))
+
+
+def warm_pool(creds, account_id):
+    """Open and authorize the idle pool connections (GET on the account).
+
+    THROWS -> LibraryNotLoaded, CLibException
+    """
+    clib.call('Execute_WarmPool_ABI', _REF(creds), PCHAR(account_id))
     
 #
 # Careful - this is a shared base, unlike our C++ 'OrderObjectProxy'
@@ -438,6 +585,69 @@ class OrderTicket( _OrderObjectBase ):
         return self
 
 
+class OrderTemplate( clib._ProxyBase ):
+    """OrderTemplate - an order serialized ahead of time for fast sending.
+
+    The order's JSON is built once, w/ fixed-width slots for its price,
+    stop price and (top-level) leg quantities, and the template gets its
+    own connection. Sending only patches those slots and POSTs; child
+    orders are sent as they were when the template was created.
+
+    WARNING - SENDS A LIVE ORDER & HAS UNDERGONE LIMITED TESTING !
+
+        def __init__(self, account_id, order):
+
+            account_id :: str         :: user account ID
+            order      :: OrderTicket :: order (e.g from an OrderBuilder)
+
+        ALL METHODS THROW -> LibraryNotLoaded, CLibException
+    """
+    def __init__(self, account_id, order):
+        if not isinstance(order, OrderTicket):
+            raise TypeError("order not instance of 'OrderTicket'")
+        super().__init__( PCHAR(account_id), _REF(order._obj) )
+
+    @classmethod
+    def _cproxy_type(cls):
+        return _OrderTemplate_C
+
+    def warm(self, creds):
+        """Open and authorize the template's connection (account GET)."""
+        clib.call('OrderTemplate_Warm_ABI', _REF(self._obj), _REF(creds))
+
+    def set_price(self, price):
+        """Sets (limit) price; order must have had one. Returns self."""
+        clib.set_val('OrderTemplate_SetPrice_ABI', c_double, price, self._obj)
+        return self
+
+    def set_stop_price(self, price):
+        """Sets (stop) price; order must have had one. Returns self."""
+        clib.set_val('OrderTemplate_SetStopPrice_ABI', c_double, price,
+                     self._obj)
+        return self
+
+    def set_quantity(self, leg, quantity):
+        """Sets quantity of leg at index 'leg'. Returns self."""
+        clib.call('OrderTemplate_SetQuantity_ABI', _REF(self._obj),
+                  c_size_t(leg), c_size_t(quantity))
+        return self
+
+    def as_json(self):
+        """ Returns the json that will be sent - as dict. """
+        j = clib.get_str('OrderTemplate_AsJsonString_ABI', self._obj)
+        return json.loads(j) if j else None
+
+    def send(self, creds):
+        """Send the order; returns order id str."""
+        c = c_char_p()
+        n = c_size_t()
+        clib.call('OrderTemplate_Send_ABI', _REF(self._obj), _REF(creds),
+                  _REF(c), _REF(n))
+        s = c.value.decode()
+        clib.free_buffer(c)
+        return s
+
+
 class _OrderBuilder:
     @staticmethod
     def _abi_build(fname, *args):
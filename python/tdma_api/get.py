@@ -53,7 +53,13 @@ OptionStrategy static methods for the Option Getters).
 """
 
 from ctypes import byref as _REF, c_int, c_ulonglong, c_double, \
-                    Union as _Union, c_uint, c_longlong
+                    Union as _Union, c_uint, c_longlong, c_char_p, \
+                    c_size_t, c_void_p, CFUNCTYPE, Structure as _Structure, \
+                    POINTER as _PTR, string_at as _string_at, cast as _cast
+from array import array as _array
+from concurrent.futures import Future as _Future
+from itertools import count as _count
+from threading import Lock as _Lock
 import json
 
 from . import clib
@@ -166,6 +172,11 @@ ORDER_STATUS_TYPE_REPLACED = 12
 ORDER_STATUS_TYPE_FILLED = 13
 ORDER_STATUS_TYPE_EXPIRED = 14
 
+ENDPOINT_FAMILY_TYPE_ALL = 0
+ENDPOINT_FAMILY_TYPE_MARKET_DATA = 1
+ENDPOINT_FAMILY_TYPE_ACCOUNTS = 2
+ENDPOINT_FAMILY_TYPE_INSTRUMENTS = 3
+
 
 class _Getter_C(clib._CProxy2):
     """C struct representing Getter_C type."""
@@ -188,6 +199,44 @@ def wait_remaining():
     """milliseconds of waiting before .get() can be called without blocking"""
     return clib.get_val("APIGetter_WaitRemaining_ABI", c_ulonglong)
 
+def set_rate_limit(endpoint_family, interval_msec, burst=1):
+    """set token bucket for an ENDPOINT_FAMILY_TYPE_[] (0 msec disables)"""
+    clib.call('APIGetter_SetRateLimit_ABI', c_int(endpoint_family),
+              c_ulonglong(interval_msec), c_uint(burst))
+
+def get_rate_limit(endpoint_family):
+    """get (interval_msec, burst) for an ENDPOINT_FAMILY_TYPE_[]"""
+    i = c_ulonglong()
+    b = c_uint()
+    clib.call('APIGetter_GetRateLimit_ABI', c_int(endpoint_family),
+              _REF(i), _REF(b))
+    return (i.value, b.value)
+
+
+# one permanent C callback for all .get_async() calls; 'ctx' is the key of
+# the pending Future (so no ctypes thunk can be freed while it's running)
+_GET_ASYNC_CALLBACK_FUNC_TYPE = CFUNCTYPE(None, c_int, c_char_p, c_size_t,
+                                          c_void_p)
+_async_futures = {}
+_async_ids = _count(1)
+_async_lock = _Lock()
+
+def _on_get_async(err, buf, n, ctx):
+    with _async_lock:
+        fut = _async_futures.pop(ctx, None)
+    if fut is None:
+        return
+    try:
+        s = buf.decode() if buf else ''
+        if err:
+            fut.set_exception(clib.CLibException(err, s))
+        else:
+            fut.set_result(json.loads(s) if s else None)
+    except Exception as e:
+        fut.set_exception(e)
+
+_on_get_async_cb = _GET_ASYNC_CALLBACK_FUNC_TYPE(_on_get_async)
+
 
 class _APIGetter( clib._ProxyBase ):
     """_APIGetter - Base getter class. DO NOT INSTANTIATE!
@@ -227,6 +276,27 @@ class _APIGetter( clib._ProxyBase ):
         r = clib.get_str('APIGetter_Get_ABI', self._obj)
         return json.loads(r) if r else None
 
+    def get_async(self):
+        """Makes HTTPS/GET request asynchronously; returns a Future.
+
+        Returns immediately; the result(or CLibException) is set on the
+        Future from a library thread. Only one request per getter can
+        be in flight - another .get()/.get_async() blocks until it's done.
+        The getter must stay alive until the Future is done.
+        """
+        fut = _Future()
+        with _async_lock:
+            i = next(_async_ids)
+            _async_futures[i] = fut
+        try:
+            clib.call('APIGetter_GetAsync_ABI', _REF(self._obj),
+                      _on_get_async_cb, c_void_p(i))
+        except:
+            with _async_lock:
+                _async_futures.pop(i, None)
+            raise
+        return fut
+
     def close(self):
         """Closes underlying connection."""
         clib.call('APIGetter_Close_ABI', _REF(self._obj))
@@ -391,6 +461,110 @@ VALID_FREQUENCIES_BY_FREQUENCY_TYPE = {
     FREQUENCY_TYPE_MONTHLY : (1,)
     }
 
+class _Candles_C(_Structure):
+    """C struct representing Candles_C type."""
+    _fields_ = [
+        ("datetime", _PTR(c_longlong)),
+        ("open", _PTR(c_double)),
+        ("high", _PTR(c_double)),
+        ("low", _PTR(c_double)),
+        ("close", _PTR(c_double)),
+        ("volume", _PTR(c_longlong)),
+        ("n", c_size_t)
+        ]
+
+
+class CandleRecord(_Structure):
+    """One stored candle(datetime is msec since epoch)."""
+    _fields_ = [
+        ("datetime", c_longlong),
+        ("open", c_double),
+        ("high", c_double),
+        ("low", c_double),
+        ("close", c_double),
+        ("volume", c_longlong)
+        ]
+
+
+class _CandleView_C(_Structure):
+    """C struct representing CandleView_C type."""
+    _fields_ = [
+        ("records", _PTR(CandleRecord)),
+        ("n", c_size_t),
+        ("handle", c_void_p)
+        ]
+
+
+class CandleView:
+    """CandleView - Read-only, zero-copy view of stored candles.
+
+    Indexing returns CandleRecord objects that point directly into the
+    candle store's (memory-mapped) file; they, and .records, are only valid
+    until the view is closed(or garbage collected). Supports 'with'.
+    """
+    def __init__(self, view):
+        self._view = view
+        self._records = (CandleRecord * view.n).from_address(
+            _cast(view.records, c_void_p).value ) if view.n else ()
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, _1, _2, _3):
+        self.close()
+
+    def __len__(self):
+        return len(self._records)
+
+    def __getitem__(self, i):
+        return self._records[i]
+
+    def __iter__(self):
+        return iter(self._records)
+
+    @property
+    def records(self):
+        """ctypes array of CandleRecord over the mapping(no copy)."""
+        return self._records
+
+    def close(self):
+        """Releases the view(and the mapping it points into)."""
+        if hasattr(self, '_view') and self._view.handle:
+            self._records = ()
+            try:
+                clib.call('FreeCandleView_ABI', _REF(self._view))
+            except:
+                pass
+
+
+def set_candle_store_directory(directory):
+    """set directory of the on-disk candle store ('' disables it)"""
+    clib.set_str('CandleStore_SetDirectory_ABI', directory)
+
+def get_candle_store_directory():
+    """get directory of the on-disk candle store"""
+    return clib.get_str('CandleStore_GetDirectory_ABI')
+
+
+def _column(ptr, typecode, n):
+    a = _array(typecode)
+    if n:
+        a.frombytes( _string_at(ptr, n * a.itemsize) )
+    return a
+
+def _candles_to_dict(c):
+    n = c.n
+    return { 'datetime' : _column(c.datetime, 'q', n),
+             'open' : _column(c.open, 'd', n),
+             'high' : _column(c.high, 'd', n),
+             'low' : _column(c.low, 'd', n),
+             'close' : _column(c.close, 'd', n),
+             'volume' : _column(c.volume, 'q', n) }
+
+
 class _HistoricalGetterBase(_APIGetter):
     """_HistoricalGetterBase - Base getter class. DO NOT INSTANTIATE!
 
@@ -432,6 +606,22 @@ class _HistoricalGetterBase(_APIGetter):
         clib.set_val('HistoricalGetterBase_SetExtendedHours_ABI', c_int,
                  extended_hours, self._obj)
 
+    def get_candles(self):
+        """Makes HTTPS/GET request and returns candles by column.
+
+        Like .get() but the response is decoded straight to columns by the
+        library(no json.loads). Returns a dict of 'datetime', 'open', 'high',
+        'low', 'close', 'volume' -> array.array ('q' for datetime/volume,
+        'd' for prices; missing values are 0 and NaN, respectively).
+        """
+        c = _Candles_C()
+        clib.call('HistoricalGetterBase_GetCandles_ABI', _REF(self._obj),
+                  _REF(c))
+        try:
+            return _candles_to_dict(c)
+        finally:
+            clib.call('FreeCandles_ABI', _REF(c))
+
 
 class HistoricalPeriodGetter(_HistoricalGetterBase):
     """HistoricalPeriodGetter - Retrieve historical data over a certain period.
@@ -605,6 +795,108 @@ class HistoricalRangeGetter(_HistoricalGetterBase):
         clib.set_val(self._abi('SetStartMSecSinceEpoch'), c_ulonglong, msec,
                  self._obj)
 
+    def get_stored_candles(self):
+        """Returns a CandleView of the range from the candle store.
+
+        Only the parts of the range the store doesn't have yet are requested
+        (and added to the store); only completed bars are stored. Requires
+        set_candle_store_directory().
+        """
+        v = _CandleView_C()
+        clib.call(self._abi('GetStoredCandles'), _REF(self._obj), _REF(v))
+        return CandleView(v)
+
+
+class BackfillProgress(_Structure):
+    """Progress/throughput of a backfill(passed to 'progress_callback')."""
+    _fields_ = [
+        ("windows_total", c_size_t),
+        ("windows_done", c_size_t),
+        ("windows_failed", c_size_t),
+        ("symbols_total", c_size_t),
+        ("symbols_done", c_size_t),
+        ("candles", c_size_t),
+        ("bytes", c_ulonglong),
+        ("elapsed_sec", c_double),
+        ("windows_per_sec", c_double),
+        ("candles_per_sec", c_double)
+        ]
+
+
+_BACKFILL_SYMBOL_CALLBACK_FUNC_TYPE = CFUNCTYPE(None, c_char_p, c_int,
+                                                c_char_p, _PTR(_Candles_C),
+                                                c_void_p)
+_BACKFILL_PROGRESS_CALLBACK_FUNC_TYPE = CFUNCTYPE(None, _PTR(BackfillProgress),
+                                                  c_void_p)
+
+def backfill(creds, symbols, frequency_type, frequency, start_msec_since_epoch,
+             end_msec_since_epoch, progress_callback=None, extended_hours=True,
+             workers=0):
+    """Retrieve historical data for many symbols over a long date range.
+
+    The range is split into windows that a single request can cover for
+    'frequency_type' (see get_backfill_window_msec), which are fetched on
+    'workers' library threads(0 for default) under the shared rate limits.
+    Each symbol's windows are merged/deduped. Blocks until done.
+
+    def backfill(creds, symbols, frequency_type, frequency,
+                 start_msec_since_epoch, end_msec_since_epoch,
+                 progress_callback=None, extended_hours=True, workers=0):
+
+        creds                  :: Credentials :: instance class received from auth.py
+        symbols                :: [str]       :: symbols to get
+        frequency_type         :: int         :: FREQUENCY_TYPE_[] constant
+        frequency              :: int         :: # of frequency type in each candle
+        start_msec_since_epoch :: int         :: start of range (msec since epoch)
+        end_msec_since_epoch   :: int         :: end of range (msec since epoch)
+        progress_callback      :: callable    :: func(BackfillProgress)
+        extended_hours         :: bool        :: include extended hours data
+        workers                :: int         :: # of worker threads
+
+    returns -> ( {symbol : candles}, {symbol : CLibException} )
+               (candles are in the form returned by .get_candles())
+
+    THROWS -> LibraryNotLoaded, CLibException
+    """
+    candles = {}
+    errors = {}
+
+    def _on_symbol(sym, err, msg, pcandles, ctx):
+        c = pcandles.contents
+        try:
+            sym = sym.decode()
+            if err:
+                errors[sym] = clib.CLibException(err, msg.decode() if msg else '')
+            else:
+                candles[sym] = _candles_to_dict(c)
+        finally:
+            clib.call('FreeCandles_ABI', pcandles)
+
+    def _on_progress(p, ctx):
+        try:
+            progress_callback(p.contents)
+        except Exception as e:
+            print("exception in backfill progress callback:", str(e))
+
+    on_symbol = _BACKFILL_SYMBOL_CALLBACK_FUNC_TYPE(_on_symbol)
+    on_progress = _BACKFILL_PROGRESS_CALLBACK_FUNC_TYPE(_on_progress) \
+        if progress_callback else _BACKFILL_PROGRESS_CALLBACK_FUNC_TYPE()
+    syms = clib.PCHAR_BUFFER(symbols)
+    clib.call('HistoricalBackfill_ABI', _REF(creds), syms,
+              c_size_t(len(symbols)), c_int(frequency_type), c_uint(frequency),
+              c_ulonglong(start_msec_since_epoch),
+              c_ulonglong(end_msec_since_epoch), c_int(extended_hours),
+              c_uint(workers), on_symbol, on_progress, c_void_p(None))
+    return (candles, errors)
+
+def get_backfill_window_msec(frequency_type):
+    """Returns the msec one backfill request(window) covers for a
+       FREQUENCY_TYPE_[] constant."""
+    ms = c_ulonglong()
+    clib.call('HistoricalBackfill_GetWindowMSec_ABI', c_int(frequency_type),
+              _REF(ms))
+    return ms.value
+
 
 class OptionStrikesValue(_Union):
     """C Union representing StrikesValue argument type.(IMPLEMENTATION DETAIL)"""
@@ -46,7 +46,8 @@ See README_STREAMING.md for a more thorough explanation.
 """
 
 from ctypes import byref as _REF, c_int, c_void_p, c_ulonglong, CFUNCTYPE, \
-                    c_char_p, c_ulong, pointer, POINTER
+                    c_char_p, c_ulong, pointer, POINTER, c_size_t, c_double, \
+                    c_longlong, c_char, sizeof, Structure as _Structure
 from inspect import signature
                     
 import json
@@ -82,6 +83,7 @@ SERVICE_TYPE_ACTIVES_NYSE = 16
 SERVICE_TYPE_ACTIVES_OTCBB = 17
 SERVICE_TYPE_ACTIVES_OPTIONS = 18
 SERVICE_TYPE_ADMIN = 19
+SERVICE_TYPE_ACCT_ACTIVITY = 20
 
 QOS_EXPRESS = 0 
 QOS_REAL_TIME = 1
@@ -98,6 +100,22 @@ CALLBACK_TYPE_NOTIFY = 4
 CALLBACK_TYPE_TIMEOUT = 5
 CALLBACK_TYPE_ERROR = 6
 
+ACCT_ACTIVITY_OTHER = 0
+ACCT_ACTIVITY_SUBSCRIBED = 1
+ACCT_ACTIVITY_ERROR = 2
+ACCT_ACTIVITY_BROKEN_TRADE = 3
+ACCT_ACTIVITY_MANUAL_EXECUTION = 4
+ACCT_ACTIVITY_ORDER_ACTIVATION = 5
+ACCT_ACTIVITY_ORDER_CANCEL_REPLACE_REQUEST = 6
+ACCT_ACTIVITY_ORDER_CANCEL_REQUEST = 7
+ACCT_ACTIVITY_ORDER_ENTRY_REQUEST = 8
+ACCT_ACTIVITY_ORDER_FILL = 9
+ACCT_ACTIVITY_ORDER_PARTIAL_FILL = 10
+ACCT_ACTIVITY_ORDER_REJECTION = 11
+ACCT_ACTIVITY_ORDER_ROUTE = 12
+ACCT_ACTIVITY_TOO_LATE_TO_CANCEL = 13
+ACCT_ACTIVITY_UR_OUT = 14
+
 
 def service_type_to_str(service):
     """Converts SERVICE_TYPE_[] constant to str."""
@@ -106,6 +124,11 @@ def service_type_to_str(service):
 def callback_type_to_str(cb_type):
     """Converts CALLBACK_TYPE_[] constant to str."""
     return clib.to_str("StreamingCallbackType_to_string_ABI", c_int, cb_type)
+
+def acct_activity_type_to_str(message_type):
+    """Converts ACCT_ACTIVITY_[] constant to str (as the server sends it)."""
+    return clib.to_str("AcctActivityMessageType_to_string_ABI", c_int,
+                       message_type)
     
 
 class _StreamingSession_C(clib._CProxy3): 
@@ -118,6 +141,359 @@ class _StreamingSubscription_C(clib._CProxy2):
     pass                              
 
 
+_SYMBOL_BUFFER_SIZE = 32
+_TEXT_BUFFER_SIZE = 64
+
+class _TypedUpdate(_Structure):
+    """Base of the typed callback and level one cache structs. DO NOT INSTANTIATE!
+    
+    Bit n of .fields is set if field n was in the update; the rest are zero.
+    """
+    def as_dict(self):
+        """Returns dict of the fields in the update (bytes -> str)."""
+        d = {}
+        for i, (name, _) in enumerate(self._fields_[1:]):
+            if self.fields & (1 << i):
+                v = getattr(self, name)
+                d[name] = v.decode() if isinstance(v, bytes) else v
+        return d
+
+
+class QuoteUpdate(_TypedUpdate):
+    """QUOTE update; bit n of .fields <-> QuotesSubscription.FIELD_[] n."""
+    _fields_ = [
+        ("fields", c_ulonglong),
+        ("symbol", c_char * _SYMBOL_BUFFER_SIZE),
+        ("bid_price", c_double),
+        ("ask_price", c_double),
+        ("last_price", c_double),
+        ("bid_size", c_longlong),
+        ("ask_size", c_longlong),
+        ("ask_id", c_char),
+        ("bid_id", c_char),
+        ("total_volume", c_longlong),
+        ("last_size", c_longlong),
+        ("trade_time", c_longlong),
+        ("quote_time", c_longlong),
+        ("high_price", c_double),
+        ("low_price", c_double),
+        ("bid_tick", c_char),
+        ("close_price", c_double),
+        ("exchange_id", c_char),
+        ("marginable", c_int),
+        ("shortable", c_int),
+        ("island_bid", c_double),
+        ("island_ask", c_double),
+        ("island_volume", c_longlong),
+        ("quote_day", c_longlong),
+        ("trade_day", c_longlong),
+        ("volatility", c_double),
+        ("description", c_char * _TEXT_BUFFER_SIZE),
+        ("last_id", c_char),
+        ("digits", c_longlong),
+        ("open_price", c_double),
+        ("net_change", c_double),
+        ("high_52_week", c_double),
+        ("low_52_week", c_double),
+        ("pe_ratio", c_double),
+        ("dividend_amount", c_double),
+        ("dividend_yeild", c_double),
+        ("island_bid_size", c_longlong),
+        ("island_ask_size", c_longlong),
+        ("nav", c_double),
+        ("fund_price", c_double),
+        ("exchanged_name", c_char * _SYMBOL_BUFFER_SIZE),
+        ("dividend_date", c_char * _SYMBOL_BUFFER_SIZE),
+        ("regular_market_quote", c_int),
+        ("regular_market_trade", c_int),
+        ("regular_market_last_price", c_double),
+        ("regular_market_last_size", c_longlong),
+        ("regular_market_trade_time", c_longlong),
+        ("regular_market_trade_day", c_longlong),
+        ("regular_market_net_change", c_double),
+        ("security_status", c_char * _SYMBOL_BUFFER_SIZE),
+        ("mark", c_double),
+        ("quote_time_as_long", c_longlong),
+        ("trade_time_as_long", c_longlong),
+        ("regular_market_trade_time_as_long", c_longlong)
+        ]
+
+
+class OptionUpdate(_TypedUpdate):
+    """OPTION update; bit n of .fields <-> OptionsSubscription.FIELD_[] n."""
+    _fields_ = [
+        ("fields", c_ulonglong),
+        ("symbol", c_char * _SYMBOL_BUFFER_SIZE),
+        ("description", c_char * _TEXT_BUFFER_SIZE),
+        ("bid_price", c_double),
+        ("ask_price", c_double),
+        ("last_price", c_double),
+        ("high_price", c_double),
+        ("low_price", c_double),
+        ("close_price", c_double),
+        ("total_volume", c_longlong),
+        ("open_interest", c_longlong),
+        ("volatility", c_double),
+        ("quote_time", c_longlong),
+        ("trade_time", c_longlong),
+        ("money_intrinsic_value", c_double),
+        ("quote_day", c_longlong),
+        ("trade_day", c_longlong),
+        ("expiration_year", c_longlong),
+        ("multiplier", c_double),
+        ("digits", c_longlong),
+        ("open_price", c_double),
+        ("bid_size", c_longlong),
+        ("ask_size", c_longlong),
+        ("last_size", c_longlong),
+        ("net_change", c_double),
+        ("strike_price", c_double),
+        ("contract_type", c_char),
+        ("underlying", c_char * _SYMBOL_BUFFER_SIZE),
+        ("expiration_month", c_longlong),
+        ("deliverables", c_char * _TEXT_BUFFER_SIZE),
+        ("time_value", c_double),
+        ("expiration_day", c_longlong),
+        ("days_to_expiration", c_longlong),
+        ("delta", c_double),
+        ("gamma", c_double),
+        ("theta", c_double),
+        ("vega", c_double),
+        ("rho", c_double),
+        ("security_status", c_char * _SYMBOL_BUFFER_SIZE),
+        ("theoretical_option_value", c_double),
+        ("underlying_price", c_double),
+        ("uv_expiration_type", c_char),
+        ("mark", c_double)
+        ]
+
+
+class LevelOneFuturesUpdate(_TypedUpdate):
+    """LEVELONE_FUTURES update; bit n of .fields <-> LevelOneFuturesSubscription.FIELD_[] n."""
+    _fields_ = [
+        ("fields", c_ulonglong),
+        ("symbol", c_char * _SYMBOL_BUFFER_SIZE),
+        ("bid_price", c_double),
+        ("ask_price", c_double),
+        ("last_price", c_double),
+        ("bid_size", c_longlong),
+        ("ask_size", c_longlong),
+        ("ask_id", c_char),
+        ("bid_id", c_char),
+        ("total_volume", c_longlong),
+        ("last_size", c_longlong),
+        ("quote_time", c_longlong),
+        ("trade_time", c_longlong),
+        ("high_price", c_double),
+        ("low_price", c_double),
+        ("close_price", c_double),
+        ("exchange_id", c_char),
+        ("description", c_char * _TEXT_BUFFER_SIZE),
+        ("last_id", c_char),
+        ("open_price", c_double),
+        ("net_change", c_double),
+        ("future_percent_change", c_double),
+        ("exchange_name", c_char * _SYMBOL_BUFFER_SIZE),
+        ("security_status", c_char * _SYMBOL_BUFFER_SIZE),
+        ("open_interest", c_longlong),
+        ("mark", c_double),
+        ("tick", c_double),
+        ("tick_amount", c_double),
+        ("product", c_char * _SYMBOL_BUFFER_SIZE),
+        ("future_price_format", c_char * _SYMBOL_BUFFER_SIZE),
+        ("future_trading_hours", c_char * _TEXT_BUFFER_SIZE),
+        ("future_is_tradable", c_int),
+        ("future_multiplier", c_double),
+        ("future_is_active", c_int),
+        ("future_settlement_price", c_double),
+        ("future_active_symbol", c_char * _SYMBOL_BUFFER_SIZE),
+        ("future_expiration_date", c_longlong)
+        ]
+
+
+class LevelOneForexUpdate(_TypedUpdate):
+    """LEVELONE_FOREX update; bit n of .fields <-> LevelOneForexSubscription.FIELD_[] n."""
+    _fields_ = [
+        ("fields", c_ulonglong),
+        ("symbol", c_char * _SYMBOL_BUFFER_SIZE),
+        ("bid_price", c_double),
+        ("ask_price", c_double),
+        ("last_price", c_double),
+        ("bid_size", c_longlong),
+        ("ask_size", c_longlong),
+        ("total_volume", c_longlong),
+        ("last_size", c_longlong),
+        ("quote_time", c_longlong),
+        ("trade_time", c_longlong),
+        ("high_price", c_double),
+        ("low_price", c_double),
+        ("close_price", c_double),
+        ("exchange_id", c_char),
+        ("description", c_char * _TEXT_BUFFER_SIZE),
+        ("open_price", c_double),
+        ("net_change", c_double),
+        ("percent_change", c_double),
+        ("exchange_name", c_char * _SYMBOL_BUFFER_SIZE),
+        ("digits", c_longlong),
+        ("security_status", c_char * _SYMBOL_BUFFER_SIZE),
+        ("tick", c_double),
+        ("tick_amount", c_double),
+        ("product", c_char * _SYMBOL_BUFFER_SIZE),
+        ("trading_hours", c_char * _TEXT_BUFFER_SIZE),
+        ("is_tradable", c_int),
+        ("market_maker", c_char * _SYMBOL_BUFFER_SIZE),
+        ("high_52_week", c_double),
+        ("low_52_week", c_double),
+        ("mark", c_double)
+        ]
+
+
+class TimesaleTick(_TypedUpdate):
+    """TIMESALE_[] tick; bit n of .fields <-> TimesaleEquitySubscription.FIELD_[] n."""
+    _fields_ = [
+        ("fields", c_ulonglong),
+        ("symbol", c_char * _SYMBOL_BUFFER_SIZE),
+        ("trade_time", c_longlong),
+        ("last_price", c_double),
+        ("last_size", c_double),
+        ("last_sequence", c_longlong)
+        ]
+
+
+class ChartBar(_TypedUpdate):
+    """CHART_[] bar; bit n of .fields <-> ChartEquitySubscription.FIELD_[] n."""
+    _fields_ = [
+        ("fields", c_ulonglong),
+        ("symbol", c_char * _SYMBOL_BUFFER_SIZE),
+        ("open_price", c_double),
+        ("high_price", c_double),
+        ("low_price", c_double),
+        ("close_price", c_double),
+        ("volume", c_double),
+        ("sequence", c_longlong),
+        ("chart_time", c_longlong),
+        ("chart_day", c_longlong)
+        ]
+
+
+class AcctActivity(_Structure):
+    """ACCT_ACTIVITY message; .message_type is an ACCT_ACTIVITY_[] constant.
+    
+    Order values the message didn't have are zero/empty; .leaves_quantity
+    is -1 if the message didn't have it.
+    """
+    _fields_ = [
+        ("message_type", c_int),
+        ("account", c_char * _SYMBOL_BUFFER_SIZE),
+        ("order_id", c_char * _SYMBOL_BUFFER_SIZE),
+        ("original_order_id", c_char * _SYMBOL_BUFFER_SIZE),
+        ("symbol", c_char * _SYMBOL_BUFFER_SIZE),
+        ("instruction", c_char * _SYMBOL_BUFFER_SIZE),
+        ("quantity", c_double),
+        ("limit_price", c_double),
+        ("execution_quantity", c_double),
+        ("execution_price", c_double),
+        ("leaves_quantity", c_double)
+        ]
+
+    def as_dict(self):
+        """Returns dict of the fields (bytes -> str)."""
+        return _struct_as_dict(self)
+
+
+class OrderState(_Structure):
+    """Order tracker state; .status is a get.ORDER_STATUS_TYPE_[] constant."""
+    _fields_ = [
+        ("order_id", c_char * _SYMBOL_BUFFER_SIZE),
+        ("account", c_char * _SYMBOL_BUFFER_SIZE),
+        ("symbol", c_char * _SYMBOL_BUFFER_SIZE),
+        ("instruction", c_char * _SYMBOL_BUFFER_SIZE),
+        ("status", c_int),
+        ("last_message_type", c_int),
+        ("quantity", c_double),
+        ("filled_quantity", c_double),
+        ("remaining_quantity", c_double),
+        ("limit_price", c_double),
+        ("average_fill_price", c_double),
+        ("last_fill_price", c_double),
+        ("last_fill_quantity", c_double),
+        ("update_time", c_ulonglong)
+        ]
+
+    def as_dict(self):
+        """Returns dict of the fields (bytes -> str)."""
+        return _struct_as_dict(self)
+
+
+def _struct_as_dict(s):
+    d = {}
+    for name, _ in s._fields_:
+        v = getattr(s, name)
+        d[name] = v.decode() if isinstance(v, bytes) else v
+    return d
+
+
+def _typed_callback_func_type(update_type):
+    return CFUNCTYPE(None, c_int, c_ulonglong, POINTER(update_type), c_size_t)
+
+QUOTE_CALLBACK_FUNC_TYPE = _typed_callback_func_type(QuoteUpdate)
+OPTION_CALLBACK_FUNC_TYPE = _typed_callback_func_type(OptionUpdate)
+TIMESALE_CALLBACK_FUNC_TYPE = _typed_callback_func_type(TimesaleTick)
+CHART_CALLBACK_FUNC_TYPE = _typed_callback_func_type(ChartBar)
+ACCT_ACTIVITY_CALLBACK_FUNC_TYPE = _typed_callback_func_type(AcctActivity)
+TYPED_CALLBACK_NARGS = 3
+
+class _StreamingTypedCallbacks_C(_Structure):
+    """C struct representing StreamingTypedCallbacks_C type."""
+    _fields_ = [
+        ("quote", QUOTE_CALLBACK_FUNC_TYPE),
+        ("option", OPTION_CALLBACK_FUNC_TYPE),
+        ("timesale", TIMESALE_CALLBACK_FUNC_TYPE),
+        ("chart", CHART_CALLBACK_FUNC_TYPE),
+        ("acct_activity", ACCT_ACTIVITY_CALLBACK_FUNC_TYPE)
+        ]
+
+
+class _StreamingDispatchStats_C(_Structure):
+    """C struct representing StreamingDispatchStats_C type."""
+    _fields_ = [
+        ("tasks", c_ulonglong),
+        ("updates", c_ulonglong),
+        ("queue_depth", c_ulonglong),
+        ("queue_max", c_ulonglong),
+        ("spilled", c_ulonglong),
+        ("callback_msec", c_double),
+        ("callback_max_msec", c_double)
+        ]
+
+
+class _StreamingWireStats_C(_Structure):
+    """C struct representing StreamingWireStats_C type."""
+    _fields_ = [
+        ("messages", c_ulonglong),
+        ("wire_bytes", c_ulonglong),
+        ("decoded_bytes", c_ulonglong),
+        ("compressed", c_int)
+        ]
+
+
+class _StreamingConflationStats_C(_Structure):
+    """C struct representing StreamingConflationStats_C type."""
+    _fields_ = [
+        ("updates", c_ulonglong),
+        ("conflated", c_ulonglong),
+        ("delivered", c_ulonglong)
+        ]
+
+
+_LEVEL_ONE_UPDATE_TYPES = {
+    SERVICE_TYPE_QUOTE : QuoteUpdate,
+    SERVICE_TYPE_OPTION : OptionUpdate,
+    SERVICE_TYPE_LEVELONE_FUTURES : LevelOneFuturesUpdate,
+    SERVICE_TYPE_LEVELONE_FOREX : LevelOneForexUpdate
+    }
+
+
 class StreamingSession( clib._ProxyBase ):
     """StreamingSession - object used for accessing the Streaming interface.
     
@@ -172,6 +548,10 @@ class StreamingSession( clib._ProxyBase ):
         self._creds = creds   
         self._cb_raw = callback
         self._cb_wrapper = self._build_callback_wrapper(callback)
+        self._typed_cbs = {'quote':None, 'option':None, 
+                           'timesale':None, 'chart':None, 
+                           'acct_activity':None}
+        self._typed_cbs_c = []
         super().__init__(_REF(creds), self._cb_wrapper, 
                          c_ulong(connect_timeout), c_ulong(listening_timeout), 
                          c_ulong(subscribe_timeout))                                    
@@ -190,6 +570,17 @@ class StreamingSession( clib._ProxyBase ):
             raise TypeError("callback requires %i args" % CALLBACK_NARGS)
         f = lambda a,b,c,d : cb(a,b,c, json.loads(d.decode()) if d else None)
         return CALLBACK_FUNC_TYPE(f)
+
+    @classmethod
+    def _build_typed_callback_wrapper(cls, cb, func_type, update_type):
+        if cb is None:
+            return func_type()
+        if len(signature(cb).parameters) != TYPED_CALLBACK_NARGS:
+            raise TypeError("typed callback requires %i args" 
+                            % TYPED_CALLBACK_NARGS)
+        f = lambda a,b,p,n : cb(a,b, [update_type.from_buffer_copy(p[i]) 
+                                      for i in range(n)])
+        return func_type(f)
     
     @classmethod
     def _check_subs(cls, subs):
@@ -260,6 +651,330 @@ class StreamingSession( clib._ProxyBase ):
         """Returns the quality-of-service."""
         return clib.get_val(self._abi("GetQOS"), c_int, self._obj)            
 
+    def set_raw_data(self, raw_data):
+        """Pass 'data' content to the callback as sent by the server.
+        
+            def set_raw_data(self, raw_data):
+            
+                raw_data :: bool :: skip the library's parse/re-serialize
+                                    of 'data' frames
+                                           
+            returns -> None
+            throws   -> LibraryNotLoaded, CLibException 
+        """
+        clib.call(self._abi("SetRawData"), _REF(self._obj), c_int(raw_data))
+        
+    def get_raw_data(self):
+        """Returns if 'data' content is passed through as sent by the server."""
+        return bool(clib.get_val(self._abi("GetRawData"), c_int, self._obj))
+
+    def set_typed_callbacks(self, quote=None, option=None, timesale=None,
+                            chart=None, acct_activity=None):
+        """Decode 'data' of those services into structs for these callbacks.
+        
+            def set_typed_callbacks(self, quote=None, option=None, 
+                                    timesale=None, chart=None,
+                                    acct_activity=None):
+            
+                quote         :: func :: callback for QUOTE updates
+                option        :: func :: callback for OPTION updates
+                timesale      :: func :: callback for TIMESALE_[] ticks
+                chart         :: func :: callback for CHART_[] bars
+                acct_activity :: func :: callback for ACCT_ACTIVITY messages
+                                         (order entry, fills, cancels etc.)
+            
+            Each callback is of the form:
+            
+                def callback(int, int, list)
+                
+                    arg1 :: int  :: SERVICE_TYPE_[] constant
+                    arg2 :: int  :: timestamp
+                    arg3 :: list :: QuoteUpdate, OptionUpdate, TimesaleTick,
+                                    ChartBar or AcctActivity objects (copies)
+                                    
+            Services w/o a typed callback (None) go to the session callback.
+            
+            returns -> None
+            throws   -> LibraryNotLoaded, CLibException 
+        """
+        cbs = _StreamingTypedCallbacks_C(
+            self._build_typed_callback_wrapper(
+                quote, QUOTE_CALLBACK_FUNC_TYPE, QuoteUpdate),
+            self._build_typed_callback_wrapper(
+                option, OPTION_CALLBACK_FUNC_TYPE, OptionUpdate),
+            self._build_typed_callback_wrapper(
+                timesale, TIMESALE_CALLBACK_FUNC_TYPE, TimesaleTick),
+            self._build_typed_callback_wrapper(
+                chart, CHART_CALLBACK_FUNC_TYPE, ChartBar),
+            self._build_typed_callback_wrapper(
+                acct_activity, ACCT_ACTIVITY_CALLBACK_FUNC_TYPE, AcctActivity)
+            )
+        clib.call(self._abi("SetTypedCallbacks"), _REF(self._obj), _REF(cbs))
+        # the listener thread can still be in an old one; keep them all alive
+        self._typed_cbs_c.append(cbs)
+        self._typed_cbs = {'quote':quote, 'option':option, 
+                           'timesale':timesale, 'chart':chart,
+                           'acct_activity':acct_activity}
+
+    def get_typed_callbacks(self):
+        """Returns dict of the typed callbacks (see set_typed_callbacks)."""
+        return dict(self._typed_cbs)
+
+    def set_level_one_cache(self, on):
+        """Keep the latest full state of each level one symbol.
+
+            def set_level_one_cache(self, on):
+
+                on :: bool :: cache QUOTE, OPTION, LEVELONE_FUTURES and
+                              LEVELONE_FOREX updates (clears nothing)
+
+            returns -> None
+            throws   -> LibraryNotLoaded, CLibException
+        """
+        clib.call(self._abi("SetLevelOneCache"), _REF(self._obj), c_int(on))
+
+    def get_level_one_cache(self):
+        """Returns if level one updates are being cached."""
+        return bool(clib.get_val(self._abi("GetLevelOneCache"), c_int,
+                                 self._obj))
+
+    def get_level_one_symbols(self, service):
+        """Returns list of symbols in the level one cache for 'service'."""
+        p = POINTER(c_char_p)()
+        n = c_size_t()
+        clib.call(self._abi("GetLevelOneSymbols"), _REF(self._obj),
+                  c_int(service), _REF(p), _REF(n))
+        symbols = [p[i].decode() for i in range(n.value)]
+        clib.free_buffers(p, n)
+        return symbols
+
+    def get_level_one_symbol_id(self, service, symbol):
+        """Returns the (fixed) cache id of 'symbol', -1 if not cached."""
+        i = c_longlong()
+        clib.call(self._abi("GetLevelOneSymbolId"), _REF(self._obj),
+                  c_int(service), PCHAR(symbol), _REF(i))
+        return i.value
+
+    def get_level_one(self, service, symbol):
+        """Returns the cached state of 'symbol'.
+
+            def get_level_one(self, service, symbol):
+
+                service :: int :: SERVICE_TYPE_QUOTE, SERVICE_TYPE_OPTION,
+                                  SERVICE_TYPE_LEVELONE_FUTURES or
+                                  SERVICE_TYPE_LEVELONE_FOREX
+                symbol  :: str :: symbol
+
+            returns -> QuoteUpdate, OptionUpdate, LevelOneFuturesUpdate or
+                       LevelOneForexUpdate object (a copy); None if
+                       'symbol' isn't cached
+            throws   -> LibraryNotLoaded, CLibException
+        """
+        return self._get_level_one("GetLevelOne", service, PCHAR(symbol))
+
+    def get_level_one_by_id(self, service, id_):
+        """Returns the cached state of symbol id 'id_' (see get_level_one)."""
+        return self._get_level_one("GetLevelOneById", service,
+                                   c_longlong(id_))
+
+    def _get_level_one(self, fname, service, key):
+        try:
+            ty = _LEVEL_ONE_UPDATE_TYPES[service]
+        except KeyError:
+            raise ValueError("no level one cache for service: %i" % service)
+        record = ty()
+        found = c_int()
+        clib.call(self._abi(fname), _REF(self._obj), c_int(service), key,
+                  _REF(record), c_size_t(sizeof(ty)), _REF(found))
+        return record if found.value else None
+
+    def set_order_tracker(self, on):
+        """Track the state of each order seen on ACCT_ACTIVITY.
+
+            def set_order_tracker(self, on):
+
+                on :: bool :: apply ACCT_ACTIVITY messages to the tracker
+                              (clears nothing)
+
+            Needs an AcctActivitySubscription. 
+
+            returns -> None
+            throws   -> LibraryNotLoaded, CLibException
+        """
+        clib.call(self._abi("SetOrderTracker"), _REF(self._obj), c_int(on))
+
+    def get_order_tracker(self):
+        """Returns if ACCT_ACTIVITY messages are being tracked."""
+        return bool(clib.get_val(self._abi("GetOrderTracker"), c_int,
+                                 self._obj))
+
+    def get_order_ids(self):
+        """Returns list of the order ids being tracked."""
+        p = POINTER(c_char_p)()
+        n = c_size_t()
+        clib.call(self._abi("GetOrderIds"), _REF(self._obj), _REF(p), _REF(n))
+        ids = [p[i].decode() for i in range(n.value)]
+        clib.free_buffers(p, n)
+        return ids
+
+    def get_order_state(self, order_id):
+        """Returns the tracked state of 'order_id'.
+
+            def get_order_state(self, order_id):
+
+                order_id :: str :: order id
+
+            returns -> OrderState object (a copy); None if 'order_id'
+                       isn't being tracked
+            throws   -> LibraryNotLoaded, CLibException
+        """
+        state = OrderState()
+        found = c_int()
+        clib.call(self._abi("GetOrderState"), _REF(self._obj),
+                  PCHAR(order_id), _REF(state), _REF(found))
+        return state if found.value else None
+
+    def set_inline_processing(self, on):
+        """Parse and call back on the connection's socket thread.
+
+            def set_inline_processing(self, on):
+
+                on :: bool :: skip the hand-off to the listener thread
+
+            Messages are handled as they arrive, on the thread reading the
+            socket, instead of being queued for the listener thread. Takes
+            effect the next time the session starts. While inline,
+            callbacks must not stop the session (it would deadlock).
+
+            returns -> None
+            throws   -> LibraryNotLoaded, CLibException
+        """
+        clib.call(self._abi("SetInlineProcessing"), _REF(self._obj),
+                  c_int(on))
+
+    def get_inline_processing(self):
+        """Returns if messages will be processed inline (next start)."""
+        return bool(clib.get_val(self._abi("GetInlineProcessing"), c_int,
+                                 self._obj))
+
+    def set_compression(self, on):
+        """Offer permessage-deflate when connecting.
+
+            def set_compression(self, on):
+
+                on :: bool :: offer compression (the server can decline)
+
+            If the server accepts, messages are inflated as they're read.
+            Takes effect the next time the session starts.
+
+            returns -> None
+            throws   -> LibraryNotLoaded, CLibException
+        """
+        clib.call(self._abi("SetCompression"), _REF(self._obj), c_int(on))
+
+    def get_compression(self):
+        """Returns if compression will be offered (next start)."""
+        return bool(clib.get_val(self._abi("GetCompression"), c_int,
+                                 self._obj))
+
+    def get_wire_stats(self):
+        """Returns dict of bytes received by the current/last connection.
+
+        'messages' : messages received
+        'wire_bytes' : message payloads as received
+        'decoded_bytes' : after inflating (if compressed)
+        'compressed' : permessage-deflate was negotiated
+        """
+        s = _StreamingWireStats_C()
+        clib.call(self._abi("GetWireStats"), _REF(self._obj), _REF(s))
+        d = {k:getattr(s,k) for k,_ in _StreamingWireStats_C._fields_}
+        d['compressed'] = bool(d['compressed'])
+        return d
+
+    def set_dispatch_threads(self, nthreads):
+        """Run 'data' callbacks on worker threads, sharded by symbol.
+
+            def set_dispatch_threads(self, nthreads):
+
+                nthreads :: int :: number of workers, 0 (the default) to
+                                   call back on the listener thread
+
+            Each symbol always goes to the same worker, so its updates stay
+            in order; different symbols can be called back concurrently.
+            Takes effect the next time the session starts.
+
+            returns -> None
+            throws   -> LibraryNotLoaded, CLibException
+        """
+        clib.call(self._abi("SetDispatchThreads"), _REF(self._obj),
+                  c_size_t(nthreads))
+
+    def get_dispatch_threads(self):
+        """Returns the number of dispatch threads for the next start."""
+        return clib.get_val(self._abi("GetDispatchThreads"), c_size_t,
+                            self._obj)
+
+    def get_dispatch_shards(self):
+        """Returns the number of dispatch shards of the current/last start."""
+        return clib.get_val(self._abi("GetDispatchShards"), c_size_t,
+                            self._obj)
+
+    def get_dispatch_stats(self, shard):
+        """Returns dict of callback dispatch stats for 'shard'.
+
+        'tasks' : a shard's share of a 'data' message (one callback)
+        'updates' : symbols (typed updates or content entries) called back
+        'queue_depth', 'queue_max' : tasks waiting now (approx.), at most
+        'spilled' : tasks that found the queue's ring full
+        'callback_msec', 'callback_max_msec' : mean/max msec per task
+
+        THROWS -> LibraryNotLoaded
+               -> CLibException (invalid shard)
+        """
+        s = _StreamingDispatchStats_C()
+        clib.call(self._abi("GetDispatchStats"), _REF(self._obj),
+                  c_size_t(shard), _REF(s))
+        return {k:getattr(s,k) for k,_ in _StreamingDispatchStats_C._fields_}
+
+    def set_conflation(self, service, on):
+        """Conflate a service's 'data': one (merged) update per symbol.
+
+            def set_conflation(self, service, on):
+
+                service :: int  :: SERVICE_TYPE_QUOTE, SERVICE_TYPE_OPTION,
+                                   SERVICE_TYPE_LEVELONE_[] or
+                                   SERVICE_TYPE_ACTIVES_[]
+                on      :: bool :: conflate
+
+            Updates to a symbol that haven't been called back yet are merged
+            (union of the fields, latest values) and called back once, when
+            the dispatch worker (or listener) gets to it.
+
+            returns -> None
+            throws   -> LibraryNotLoaded, CLibException
+        """
+        clib.call(self._abi("SetConflation"), _REF(self._obj),
+                  c_int(service), c_int(on))
+
+    def get_conflation(self, service):
+        """Returns if 'service' is conflated."""
+        on = c_int()
+        clib.call(self._abi("GetConflation"), _REF(self._obj),
+                  c_int(service), _REF(on))
+        return bool(on.value)
+
+    def get_conflation_stats(self, service):
+        """Returns dict of conflation counts for 'service'.
+
+        'updates' : symbol updates received while conflating
+        'conflated' : merged into one that wasn't called back yet
+        'delivered' : (merged) updates called back
+        """
+        s = _StreamingConflationStats_C()
+        clib.call(self._abi("GetConflationStats"), _REF(self._obj),
+                  c_int(service), _REF(s))
+        return {k:getattr(s,k) for k,_ in _StreamingConflationStats_C._fields_}
+
 
 class _StreamingSubscription( clib._ProxyBase ):
     """_StreamingSubscription - Base Subscription class. DO NOT INSTANTIATE!
@@ -805,6 +1520,24 @@ class OptionActivesSubscription(_ActivesSubscriptionBase):
     VENUE_TYPE_OPTS_DESC = 3 # descending
     VENUE_TYPE_CALLS_DESC = 4 # descending
     VENUE_TYPE_PUTS_DESC = 5 # descending
+
+
+class AcctActivitySubscription(_StreamingSubscription):
+    """AcctActivitySubscription - order activity for the session's account(s).
+
+    def __init__(self):
+
+        The session supplies the streamer subscription key.
+
+        throws -> LibraryNotLoaded, CLibException
+    """
+    def __init__(self):
+        super().__init__()
+
+    FIELD_SUBSCRIPTION_KEY = 0
+    FIELD_ACCOUNT = 1
+    FIELD_MESSAGE_TYPE = 2
+    FIELD_MESSAGE_DATA = 3
     
     
 SERVICE_TO_SUBSCRIPTION = {
@@ -825,6 +1558,7 @@ SERVICE_TO_SUBSCRIPTION = {
     SERVICE_TYPE_ACTIVES_NYSE : NYSEActivesSubscription,
     SERVICE_TYPE_ACTIVES_OTCBB : OTCBBActivesSubscription,
     SERVICE_TYPE_ACTIVES_OPTIONS : OptionActivesSubscription,
-    SERVICE_TYPE_ADMIN : None
+    SERVICE_TYPE_ADMIN : None,
+    SERVICE_TYPE_ACCT_ACTIVITY : AcctActivitySubscription
     }  
     
@@ -583,15 +583,10 @@ generate_token_expiration_sec(long life)
     return sse.count() + life;
 }
 
-} /* namespace */
-
-
-namespace tdma {
-
 void
-LoadCredentialsImpl( const string& path,
-                     const string& password,
-                     Credentials *pcreds )
+load_credentials_or_backup( const string& path,
+                            const string& password,
+                            Credentials *pcreds )
 {
     fstream file(path, ios_base::in | ios_base::binary );
     if( file.is_open() ){
@@ -626,6 +621,22 @@ LoadCredentialsImpl( const string& path,
     }
 }
 
+} /* namespace */
+
+
+namespace tdma {
+
+void
+LoadCredentialsImpl( const string& path,
+                     const string& password,
+                     Credentials *pcreds )
+{
+    load_credentials_or_backup(path, password, pcreds);
+    /* we don't know how old the access token is; get a fresh one (and its
+       lifetime) in the background so it's refreshed before it expires */
+    load_cached_access_token(*pcreds);
+}
+
 void
 StoreCredentialsImpl( const string& path,
                       const string& password,
@@ -684,10 +695,16 @@ RequestAccessTokenImpl( const string& code,
         TDMA_API_THROW(LocalCredentialException,
                        "creds.epoch_sec_toke_expiration contains invalid value");
     };
+
+    auto exp = r_json.find("expires_in");
+    update_cached_access_token( *pcreds,
+                                (exp != r_json.end() && exp->is_number())
+                                    ? exp->get<long long>()
+                                    : 0 );
 }
 
-void
-RefreshAccessTokenImpl(Credentials* creds)
+long long
+refresh_access_token(Credentials* creds)
 {
     if( creds->epoch_sec_token_expiration < TOKEN_EARLIEST_EXPIRATION ||
         creds->epoch_sec_token_expiration > TOKEN_LATEST_EXPIRATION )
@@ -734,6 +751,19 @@ RefreshAccessTokenImpl(Credentials* creds)
     if( string(creds->access_token).empty() ){
         TDMA_API_THROW(LocalCredentialException,"creds.access_token is empty");
     }
+
+    auto exp = r_json.find("expires_in");
+    return (exp != r_json.end() && exp->is_number())
+           ? exp->get<long long>()
+           : 0;
+}
+
+void
+RefreshAccessTokenImpl(Credentials* creds)
+{
+    long long life = refresh_access_token(creds);
+    /* so connections pick up the new token (and it refreshes in time) */
+    update_cached_access_token(*creds, life);
 }
 
 void
@@ -20,6 +20,12 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 
 #include "../include/curl_connect.h"
 #include "../include/util.h"
@@ -47,6 +53,49 @@ class CurlConnection::CurlConnectionImpl_ {
         ~Init() { curl_global_cleanup(); }
     }_init;
 
+    /*
+     * process-wide share handle so every connection (getters, execute,
+     * auth) uses the same DNS cache and SSL session cache; a new getter's
+     * first request can then resume a warm TLS session rather than doing a
+     * full handshake.
+     *
+     * The connection cache is NOT shared: handles are used from many
+     * threads at once and libcurl doesn't support sharing it between
+     * concurrent threads. Each handle keeps (and re-uses) its own
+     * connection instead.
+     *
+     * MUST be defined after _init (static init/destruct order)
+     */
+    static struct Share {
+        CURLSH *handle;
+        std::mutex mtxs[CURL_LOCK_DATA_LAST];
+
+        static void
+        lock(CURL *h, curl_lock_data data, curl_lock_access a, void *ptr)
+        { reinterpret_cast<Share*>(ptr)->mtxs[data].lock(); }
+
+        static void
+        unlock(CURL *h, curl_lock_data data, void *ptr)
+        { reinterpret_cast<Share*>(ptr)->mtxs[data].unlock(); }
+
+        Share()
+            : handle( curl_share_init() )
+        {
+            if( !handle )
+                return;
+            curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, &Share::lock);
+            curl_share_setopt(handle, CURLSHOPT_UNLOCKFUNC, &Share::unlock);
+            curl_share_setopt(handle, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(handle, CURLSHOPT_SHARE,
+                              CURL_LOCK_DATA_SSL_SESSION);
+        }
+
+        /* if an easy handle outlives us this fails w/ CURLSHE_IN_USE; fine */
+        ~Share()
+        { if( handle ) curl_share_cleanup(handle); }
+    }_share;
+
     struct curl_slist *_header;
     CURL *_handle;
     map<CURLoption, string> _options;
@@ -55,26 +104,232 @@ class CurlConnection::CurlConnectionImpl_ {
     template<typename T, typename Dummy = void>
     struct to;
 
+    /*
+     * reused across requests; the body is sized up front from the
+     * Content-Length (or the size of the last response) so it doesn't have
+     * to be grown/copied as the data comes in
+     */
+    ResponseBuffer _body;
+    ResponseBuffer _head;
+    size_t _size_hint;
+    RequestTiming _timing;
+
     struct WriteCallback {
-        std::stringbuf _buf;
+        ResponseBuffer *_buf;
+        CURL *_handle; // null if we don't want to size from Content-Length
+        size_t _hint;
+
+        WriteCallback(ResponseBuffer *buf, CURL *handle = nullptr,
+                      size_t hint = 0)
+            : _buf(buf), _handle(handle), _hint(hint)
+            {}
 
         static size_t
         write( char* input, size_t sz, size_t n, void* output )
         {
-            std::stringbuf& buf = ((WriteCallback*)output)->_buf;
-            std::streamsize ssz = buf.sputn(input, sz*n);
-            assert(ssz >= 0);
-            return ssz;
+            WriteCallback *cb = reinterpret_cast<WriteCallback*>(output);
+            size_t len = sz * n;
+            try{
+                if( cb->_handle && cb->_buf->empty() ){
+                    size_t hint = cb->_hint;
+#if LIBCURL_VERSION_NUM >= 0x073700
+                    /* CURLINFO_CONTENT_LENGTH_DOWNLOAD_T added in 7.55.0 */
+                    curl_off_t cl = -1;
+                    curl_easy_getinfo( cb->_handle,
+                                       CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,
+                                       &cl );
+                    if( cl > 0 )
+                        hint = static_cast<size_t>(cl);
+#endif
+                    cb->_buf->reserve( std::max(hint, len) );
+                }
+                cb->_buf->append(input, len);
+            }catch( std::bad_alloc& ){
+                return 0; /* curl fails the transfer w/ CURLE_WRITE_ERROR */
+            }
+            return len;
         }
+    };
 
-        string
-        str()
-        { return _buf.str(); }
+    void
+    _prepare_execute( bool return_header_data,
+                      WriteCallback& cb_data,
+                      WriteCallback& cb_header )
+    {
+        if (!_handle)
+            throw CurlException("connection/handle has been closed");
+
+        cb_data._buf->clear();
+        cb_header._buf->clear();
+
+        set_option(CURLOPT_WRITEFUNCTION, &WriteCallback::write);
+        set_option(CURLOPT_WRITEDATA, &cb_data);
+
+        /*
+         * always (re)set; otherwise a request w/o return_header_data would
+         * write into the (stale) cb_header of an earlier one
+         */
+        set_option(CURLOPT_HEADERFUNCTION, &WriteCallback::write);
+        set_option(CURLOPT_HEADERDATA, &cb_header);
+    }
+
+    static long long
+    _time_usec(CURL *handle, CURLINFO info)
+    {
+        double sec = 0;
+        curl_easy_getinfo(handle, info, &sec);
+        return static_cast<long long>(sec * 1000000);
+    }
+
+    static unsigned long long
+    _size_bytes(CURL *handle, bool down)
+    {
+#if LIBCURL_VERSION_NUM >= 0x073700
+        /* CURLINFO_SIZE_*_T added in 7.55.0 */
+        curl_off_t n = 0;
+        curl_easy_getinfo( handle, down ? CURLINFO_SIZE_DOWNLOAD_T
+                                        : CURLINFO_SIZE_UPLOAD_T, &n );
+#else
+        double n = 0;
+        curl_easy_getinfo( handle, down ? CURLINFO_SIZE_DOWNLOAD
+                                        : CURLINFO_SIZE_UPLOAD, &n );
+#endif
+        return n > 0 ? static_cast<unsigned long long>(n) : 0;
+    }
+
+    string
+    _method() const
+    {
+#if LIBCURL_VERSION_NUM >= 0x074800
+        /* CURLINFO_EFFECTIVE_METHOD added in 7.72.0 */
+        char *m = nullptr;
+        curl_easy_getinfo(_handle, CURLINFO_EFFECTIVE_METHOD, &m);
+        if( m )
+            return m;
+#endif
+        auto c = _options.find(CURLOPT_CUSTOMREQUEST);
+        if( c != _options.end() && !c->second.empty() )
+            return c->second;
+        return _options.count(CURLOPT_POST) ? "POST" : "GET";
+    }
+
+    void
+    _set_timing(CURLcode ccode)
+    {
+        RequestTiming t;
+        char *url = nullptr;
+        curl_easy_getinfo(_handle, CURLINFO_EFFECTIVE_URL, &url);
+        if( url )
+            t.url = url;
+        t.method = _method();
+        curl_easy_getinfo(_handle, CURLINFO_RESPONSE_CODE, &t.code);
+        t.curl_code = ccode;
+        t.namelookup_usec = _time_usec(_handle, CURLINFO_NAMELOOKUP_TIME);
+        t.connect_usec = _time_usec(_handle, CURLINFO_CONNECT_TIME);
+        t.appconnect_usec = _time_usec(_handle, CURLINFO_APPCONNECT_TIME);
+        t.starttransfer_usec = _time_usec(_handle,
+                                          CURLINFO_STARTTRANSFER_TIME);
+        t.total_usec = _time_usec(_handle, CURLINFO_TOTAL_TIME);
+        t.bytes_down = _size_bytes(_handle, true);
+        t.bytes_up = _size_bytes(_handle, false);
+        _timing = std::move(t);
+    }
+
+    execute_buffer_result_ty
+    _finish_execute( CURLcode ccode,
+                     bool return_header_data,
+                     WriteCallback& cb_data,
+                     WriteCallback& cb_header )
+    {
+        auto tp = clock_ty::now();
+        _set_timing(ccode);
+        if (ccode != CURLE_OK)
+            throw CurlConnectionError(ccode);
+
+        _size_hint = cb_data._buf->size();
+        /* take the buffer as is - no copy */
+        ResponseBuffer res( std::move(*cb_data._buf) );
+        long c;
+        curl_easy_getinfo(_handle, CURLINFO_RESPONSE_CODE, &c);
+
+        string head;
+        if( return_header_data ){
+            head = cb_header._buf->str();
+            cb_header._buf->clear();
+        }
+
+        return execute_buffer_result_ty(c, std::move(res), move(head), tp);
+    }
+
+    /*
+     * one curl_multi handle driven by one event-loop thread (started on
+     * first use) for ALL async requests, plus one worker thread (also
+     * started on first use) for blocking jobs the event loop can't run
+     *
+     * MUST be defined after _share (static init/destruct order)
+     */
+    static class AsyncEngine {
+        struct Request{
+            CurlConnectionImpl_ *impl;
+            bool return_header_data;
+            execute_cb_ty callback;
+            clock_ty::time_point not_before;
+            ResponseBuffer data;
+            ResponseBuffer head;
+            WriteCallback cb_data;
+            WriteCallback cb_header;
+
+            Request(CURL *handle, size_t hint)
+                : cb_data(&data, handle, hint), cb_header(&head)
+                {}
+        };
+
+        CURLM *_multi;
+        std::thread _thread;
+        std::mutex _mtx;
+        std::condition_variable _cond; /* only for pre-7.68 wakeup */
+        std::vector<std::unique_ptr<Request>> _incoming;
+        std::vector<std::unique_ptr<Request>> _waiting;
+        std::map<CURL*, std::unique_ptr<Request>> _running;
+        bool _stop;
+
+        std::thread _worker;
+        std::condition_variable _jobs_cond;
+        std::deque<std::function<void()>> _jobs;
 
         void
-        clear()
-        { _buf.str(""); }
-    };
+        _wakeup();
+
+        void
+        _run();
+
+        void
+        _start_ready();
+
+        void
+        _finish_done();
+
+        void
+        _run_jobs();
+
+        static void
+        _complete(Request& r, CURLcode ccode);
+
+    public:
+        AsyncEngine()
+            : _multi(nullptr), _stop(false)
+        {}
+
+        ~AsyncEngine();
+
+        void
+        submit(std::unique_ptr<Request> r);
+
+        void
+        post(std::function<void()> job);
+
+        friend class CurlConnectionImpl_;
+    }_async_engine;
 
 public:
     CurlConnectionImpl_(string url)
@@ -84,8 +339,12 @@ public:
     CurlConnectionImpl_()
         :
             _header(nullptr),
-            _handle(curl_easy_init())
-        { set_option(CURLOPT_NOSIGNAL, 1L); }
+            _handle(curl_easy_init()),
+            _size_hint(0)
+        {
+            set_option(CURLOPT_NOSIGNAL, 1L);
+            SET_share();
+        }
     
     ~CurlConnectionImpl_()
         { close(); }
@@ -98,7 +357,11 @@ public:
         :
             _header(connection._header),
             _handle(connection._handle),
-            _options(move(connection._options))
+            _options(move(connection._options)),
+            _body(std::move(connection._body)),
+            _head(std::move(connection._head)),
+            _size_hint(connection._size_hint),
+            _timing(std::move(connection._timing))
         {
             connection._header = nullptr;
             connection._handle = nullptr;
@@ -117,6 +380,10 @@ public:
             _header = connection._header;
             _handle = connection._handle;
             _options = move(connection._options);
+            _body = std::move(connection._body);
+            _head = std::move(connection._head);
+            _size_hint = connection._size_hint;
+            _timing = std::move(connection._timing);
             connection._header = nullptr;
             connection._handle = nullptr;
         }
@@ -164,35 +431,47 @@ public:
     tuple<long, string, string, clock_ty::time_point>
     execute( bool return_header_data )
     {
-        if (!_handle)
-            throw CurlException("connection/handle has been closed");
+        execute_buffer_result_ty r = execute_buffer(return_header_data);
+        ResponseBuffer& buf = std::get<1>(r);
+        string data = buf.str();
 
-        WriteCallback cb_data, cb_header;
-        set_option(CURLOPT_WRITEFUNCTION, &WriteCallback::write);
-        set_option(CURLOPT_WRITEDATA, &cb_data);
+        /* keep the allocation for the next request */
+        _body = std::move(buf);
+        _body.clear();
 
-        if( return_header_data ){
-            set_option(CURLOPT_HEADERFUNCTION, &WriteCallback::write);
-            set_option(CURLOPT_HEADERDATA, &cb_header);
-        }
+        return make_tuple( std::get<0>(r), move(data), move(std::get<2>(r)),
+                           std::get<3>(r) );
+    }
+
+    execute_buffer_result_ty
+    execute_buffer( bool return_header_data )
+    {
+        WriteCallback cb_data(&_body, _handle, _size_hint);
+        WriteCallback cb_header(&_head);
+        _prepare_execute(return_header_data, cb_data, cb_header);
 
         CURLcode ccode = curl_easy_perform(_handle);
-        auto tp = clock_ty::now();
-        if (ccode != CURLE_OK)
-            throw CurlConnectionError(ccode);
+        return _finish_execute(ccode, return_header_data, cb_data, cb_header);
+    }
 
-        string res = cb_data.str();
-        cb_data.clear();
-        long c;
-        curl_easy_getinfo(_handle, CURLINFO_RESPONSE_CODE, &c);
+    void
+    execute_async( bool return_header_data,
+                   execute_cb_ty callback,
+                   clock_ty::time_point not_before );
 
-        string head;
-        if( return_header_data ){
-            head = cb_header.str();
-            cb_data.clear();
-        }
+    static void
+    execute_blocking(std::function<void()> job)
+    { _async_engine.post( move(job) ); }
 
-        return make_tuple(c, res, head, tp);
+    const RequestTiming&
+    last_timing() const
+    { return _timing; }
+
+    string
+    GET_url() const
+    {
+        auto u = _options.find(CURLOPT_URL);
+        return u != _options.end() ? u->second : string();
     }
 
     void
@@ -220,6 +499,38 @@ public:
     SET_url(string url)
     { set_option(CURLOPT_URL, url.c_str()); }
 
+    void
+    SET_share()
+    {
+        if( _share.handle )
+            set_option(CURLOPT_SHARE, _share.handle);
+    }
+
+    void
+    SET_method(const string& method, const string& fields)
+    {
+        /* reset anything a previous request on this handle may have set */
+        if( method == "GET" ){
+            set_option(CURLOPT_CUSTOMREQUEST, (const char*)nullptr);
+            set_option(CURLOPT_HTTPGET, 1L);
+            return;
+        }
+        if( method == "POST" ){
+            set_option(CURLOPT_CUSTOMREQUEST, (const char*)nullptr);
+            set_option(CURLOPT_POST, 1L);
+            set_option(CURLOPT_COPYPOSTFIELDS, fields.c_str());
+            return;
+        }
+        /* DELETE, PUT etc. - body (if any) sent as w/ POST */
+        if( fields.empty() ){
+            set_option(CURLOPT_HTTPGET, 1L);
+        }else{
+            set_option(CURLOPT_POST, 1L);
+            set_option(CURLOPT_COPYPOSTFIELDS, fields.c_str());
+        }
+        set_option(CURLOPT_CUSTOMREQUEST, method.c_str());
+    }
+
     void
     SET_ssl_verify()
     {
@@ -340,10 +651,12 @@ public:
     RESET_options()
     {
         RESET_headers();
+        _options.clear();
         if (_handle) {
+            /* curl_easy_reset drops CURLOPT_SHARE, put it back */
             curl_easy_reset(_handle);
+            SET_share();
         }
-        _options.clear();
     }
 
     ostream&
@@ -351,6 +664,267 @@ public:
 };
 
 CurlConnection::CurlConnectionImpl_::Init CurlConnection::CurlConnectionImpl_::_init;
+CurlConnection::CurlConnectionImpl_::Share
+    CurlConnection::CurlConnectionImpl_::_share;
+CurlConnection::CurlConnectionImpl_::AsyncEngine
+    CurlConnection::CurlConnectionImpl_::_async_engine;
+
+
+void
+CurlConnection::CurlConnectionImpl_::execute_async(
+    bool return_header_data,
+    execute_cb_ty callback,
+    clock_ty::time_point not_before )
+{
+    std::unique_ptr<AsyncEngine::Request> r(
+        new AsyncEngine::Request(_handle, _size_hint)
+        );
+    r->impl = this;
+    r->return_header_data = return_header_data;
+    r->callback = callback;
+    r->not_before = not_before;
+    _prepare_execute(return_header_data, r->cb_data, r->cb_header);
+    _async_engine.submit( move(r) );
+}
+
+
+void
+CurlConnection::CurlConnectionImpl_::AsyncEngine::submit(
+    std::unique_ptr<Request> r )
+{
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        if( _stop )
+            throw CurlException("async engine has been stopped");
+
+        if( !_multi ){
+            _multi = curl_multi_init();
+            if( !_multi )
+                throw CurlException("curl_multi_init failed");
+            _thread = std::thread( &AsyncEngine::_run, this );
+        }
+        _incoming.push_back( move(r) );
+    }
+    _wakeup();
+}
+
+
+void
+CurlConnection::CurlConnectionImpl_::AsyncEngine::post(
+    std::function<void()> job )
+{
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        if( _stop )
+            throw CurlException("async engine has been stopped");
+
+        if( !_worker.joinable() )
+            _worker = std::thread( &AsyncEngine::_run_jobs, this );
+        _jobs.push_back( move(job) );
+    }
+    _jobs_cond.notify_one();
+}
+
+
+void
+CurlConnection::CurlConnectionImpl_::AsyncEngine::_run_jobs()
+{
+    while( true ){
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> l(_mtx);
+            _jobs_cond.wait(l, [this](){ return _stop || !_jobs.empty(); });
+            if( _stop )
+                return;
+            job = move(_jobs.front());
+            _jobs.pop_front();
+        }
+        /* jobs report their own errors (through their callbacks) */
+        try{
+            job();
+        }catch(...){
+        }
+    }
+}
+
+
+CurlConnection::CurlConnectionImpl_::AsyncEngine::~AsyncEngine()
+{
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _stop = true;
+    }
+    _jobs_cond.notify_all();
+    if( _worker.joinable() )
+        _worker.join();
+    _jobs.clear();
+
+    if( !_multi )
+        return;
+
+    _wakeup();
+    if( _thread.joinable() )
+        _thread.join();
+
+    /*
+     * static destruction; DON'T call back into code that may already be
+     * gone, just detach anything still running
+     */
+    for( auto& p : _running )
+        curl_multi_remove_handle(_multi, p.first);
+
+    curl_multi_cleanup(_multi);
+}
+
+
+void
+CurlConnection::CurlConnectionImpl_::AsyncEngine::_wakeup()
+{
+#if LIBCURL_VERSION_NUM >= 0x074400
+    /* curl_multi_wakeup added in 7.68.0 */
+    if( _multi )
+        curl_multi_wakeup(_multi);
+#else
+    _cond.notify_one();
+#endif
+}
+
+
+void
+CurlConnection::CurlConnectionImpl_::AsyncEngine::_run()
+{
+    using namespace std::chrono;
+
+    static const milliseconds MAX_WAIT(1000);
+
+    while( true ){
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            if( _stop )
+                return;
+            for( auto& r : _incoming )
+                _waiting.push_back( move(r) );
+            _incoming.clear();
+        }
+
+        _start_ready();
+
+        int nrunning = 0;
+        curl_multi_perform(_multi, &nrunning);
+        _finish_done();
+
+        /* sleep until there's socket activity, a wakeup or a throttled
+         * request is ready to go out */
+        milliseconds wait = MAX_WAIT;
+        auto now = clock_ty::now();
+        for( auto& r : _waiting ){
+            wait = std::min( wait,
+                std::max( milliseconds(0),
+                          duration_cast<milliseconds>(r->not_before - now) )
+                );
+        }
+
+#if LIBCURL_VERSION_NUM >= 0x074400
+        curl_multi_poll(_multi, nullptr, 0, static_cast<int>(wait.count()),
+                        nullptr);
+#else
+        if( _running.empty() ){
+            std::unique_lock<std::mutex> l(_mtx);
+            _cond.wait_for(l, wait,
+                           [this](){ return _stop || !_incoming.empty(); });
+        }else{
+            /* no wakeup before 7.68.0; poll w/ a short timeout */
+            curl_multi_wait(_multi, nullptr, 0,
+                            static_cast<int>(std::min(wait, milliseconds(10)).count()),
+                            nullptr);
+        }
+#endif
+    }
+}
+
+
+void
+CurlConnection::CurlConnectionImpl_::AsyncEngine::_start_ready()
+{
+    auto now = clock_ty::now();
+    for( auto i = _waiting.begin(); i != _waiting.end(); ){
+        if( (*i)->not_before > now ){
+            ++i;
+            continue;
+        }
+        std::unique_ptr<Request> r = move(*i);
+        i = _waiting.erase(i);
+
+        CURL *h = r->impl->_handle;
+        CURLMcode mc = curl_multi_add_handle(_multi, h);
+        if( mc != CURLM_OK ){
+            r->callback( execute_result_ty(),
+                         std::make_exception_ptr( CurlException(
+                             string("curl_multi_add_handle failed: ")
+                             + curl_multi_strerror(mc) ) ) );
+            continue;
+        }
+        _running[h] = move(r);
+    }
+}
+
+
+void
+CurlConnection::CurlConnectionImpl_::AsyncEngine::_finish_done()
+{
+    int nmsgs = 0;
+    CURLMsg *msg;
+    while( (msg = curl_multi_info_read(_multi, &nmsgs)) ){
+        if( msg->msg != CURLMSG_DONE )
+            continue;
+
+        CURL *h = msg->easy_handle;
+        CURLcode ccode = msg->data.result;
+        curl_multi_remove_handle(_multi, h);
+
+        auto i = _running.find(h);
+        assert( i != _running.end() );
+        std::unique_ptr<Request> r = move(i->second);
+        _running.erase(i);
+
+        _complete(*r, ccode);
+    }
+}
+
+
+void
+CurlConnection::CurlConnectionImpl_::AsyncEngine::_complete(
+    Request& r,
+    CURLcode ccode )
+{
+    /* callback last; it may destroy the connection */
+    execute_result_ty res;
+    std::exception_ptr eptr;
+    try{
+        execute_buffer_result_ty rb =
+            r.impl->_finish_execute( ccode, r.return_header_data,
+                                     r.cb_data, r.cb_header );
+        res = make_tuple( std::get<0>(rb), std::get<1>(rb).str(),
+                          move(std::get<2>(rb)), std::get<3>(rb) );
+    }catch(...){
+        eptr = std::current_exception();
+    }
+
+    try{
+        r.callback( move(res), eptr );
+        return;
+    }catch(...){
+        if( eptr )
+            return; /* nowhere left to report it */
+        eptr = std::current_exception();
+    }
+
+    /* callback failed on the result; give it the error instead */
+    try{
+        r.callback( execute_result_ty(), eptr );
+    }catch(...){
+    }
+}
 
 template<typename T, typename Dummy>
 struct CurlConnection::CurlConnectionImpl_::to {
@@ -361,7 +935,7 @@ struct CurlConnection::CurlConnectionImpl_::to {
 template<typename Dummy>
 struct CurlConnection::CurlConnectionImpl_::to<const char*, Dummy> {
     static string str(const char* s)
-    { return string(s); }
+    { return s ? string(s) : string(); }
 };
 
 template<typename T, typename Dummy>
@@ -427,6 +1001,28 @@ tuple<long, string, string, clock_ty::time_point>
 CurlConnection::execute( bool return_header_data )
 { return _pimpl->execute(return_header_data); }
 
+execute_buffer_result_ty
+CurlConnection::execute_buffer( bool return_header_data )
+{ return _pimpl->execute_buffer(return_header_data); }
+
+void
+CurlConnection::execute_async( bool return_header_data,
+                               execute_cb_ty callback,
+                               clock_ty::time_point not_before )
+{ _pimpl->execute_async(return_header_data, callback, not_before); }
+
+void
+CurlConnection::execute_blocking(std::function<void()> job)
+{ CurlConnectionImpl_::execute_blocking( move(job) ); }
+
+RequestTiming
+CurlConnection::last_timing() const
+{ return _pimpl->last_timing(); }
+
+string
+CurlConnection::GET_url() const
+{ return _pimpl->GET_url(); }
+
 void
 CurlConnection::close()
 { _pimpl->close(); }
@@ -567,6 +1163,114 @@ HTTPSDeleteConnection::_set()
 }
 
 
+RequestTiming::RequestTiming()
+    :
+        code(0),
+        curl_code(CURLE_OK),
+        namelookup_usec(0),
+        connect_usec(0),
+        appconnect_usec(0),
+        starttransfer_usec(0),
+        total_usec(0),
+        bytes_down(0),
+        bytes_up(0)
+    {}
+
+
+ResponseBuffer::ResponseBuffer()
+    :
+        _data(nullptr),
+        _size(0),
+        _capacity(0)
+    {
+    }
+
+ResponseBuffer::ResponseBuffer( ResponseBuffer&& buffer )
+    :
+        _data(buffer._data),
+        _size(buffer._size),
+        _capacity(buffer._capacity)
+    {
+        buffer._data = nullptr;
+        buffer._size = buffer._capacity = 0;
+    }
+
+ResponseBuffer&
+ResponseBuffer::operator=( ResponseBuffer&& buffer )
+{
+    if( this != &buffer ){
+        free(_data);
+        _data = buffer._data;
+        _size = buffer._size;
+        _capacity = buffer._capacity;
+        buffer._data = nullptr;
+        buffer._size = buffer._capacity = 0;
+    }
+    return *this;
+}
+
+ResponseBuffer::~ResponseBuffer()
+{ free(_data); }
+
+void
+ResponseBuffer::reserve(size_t n)
+{
+    if( n <= _capacity )
+        return;
+
+    /* +1 so release() can always NUL-terminate in place */
+    char *d = reinterpret_cast<char*>( realloc(_data, n + 1) );
+    if( !d )
+        throw std::bad_alloc();
+    _data = d;
+    _capacity = n;
+}
+
+void
+ResponseBuffer::append(const char* data, size_t n)
+{
+    if( _size + n > _capacity )
+        reserve( std::max(_size + n, _capacity * 2) );
+    memcpy(_data + _size, data, n);
+    _size += n;
+}
+
+char*
+ResponseBuffer::release(size_t *n)
+{
+    if( !_data )
+        reserve(1);
+
+    char *d = _data;
+    d[_size] = 0;
+    *n = _size + 1;
+
+    _data = nullptr;
+    _size = _capacity = 0;
+    return d;
+}
+
+
+HTTPSExecuteConnection::HTTPSExecuteConnection()
+    : HTTPSConnection()
+    { _set(); }
+
+HTTPSExecuteConnection::HTTPSExecuteConnection(string url)
+    : HTTPSConnection(url)
+    { _set(); }
+
+void
+HTTPSExecuteConnection::_set()
+{
+    SET_encoding(DEFAULT_ENCODING);
+    SET_keepalive();
+}
+
+void
+HTTPSExecuteConnection::SET_method(const string& method, const string& fields)
+{ _pimpl->SET_method(method, fields); }
+
+
 CurlException::CurlException(string what)
     : _what(what)
     {}
@@ -702,7 +1406,11 @@ const map<CURLoption, string> CurlConnection::option_strings = {
     { CURLOPT_WRITEFUNCTION, "CURLOPT_WRITEFUNCTION"},
     { CURLOPT_WRITEDATA, "CURLOPT_WRITEDATA"},
     { CURLOPT_HTTPHEADER, "CURLOPT_HTTPHEADER"},
-    { CURLOPT_NOSIGNAL, "CURLOPT_NOSIGNAL"}
+    { CURLOPT_NOSIGNAL, "CURLOPT_NOSIGNAL"},
+    { CURLOPT_SHARE, "CURLOPT_SHARE"},
+    { CURLOPT_HEADERFUNCTION, "CURLOPT_HEADERFUNCTION"},
+    { CURLOPT_HEADERDATA, "CURLOPT_HEADERDATA"},
+    { CURLOPT_CUSTOMREQUEST, "CURLOPT_CUSTOMREQUEST"}
 };
 
 
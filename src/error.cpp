@@ -58,6 +58,23 @@ get_error_state()
                       last_error_filename);
 }
 
+void
+error_from_exception(std::exception_ptr eptr, int *code, string *msg)
+{
+    try{
+        std::rethrow_exception(eptr);
+    }catch( APIException& e ){
+        *code = e.error_code();
+        *msg = e.what();
+    }catch( std::exception& e ){
+        *code = TDMA_API_STD_EXCEPTION;
+        *msg = e.what();
+    }catch( ... ){
+        *code = TDMA_API_UNKNOWN_EXCEPTION;
+        *msg = "unknown exception";
+    }
+}
+
 } /* tdma */
 
 
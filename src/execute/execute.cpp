@@ -15,6 +15,7 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see http://www.gnu.org/licenses.
 */
 #include <iostream>
+#include <functional>
 
 #include "../../include/_tdma_api.h"
 #include "../../include/_execute.h"
@@ -23,6 +24,32 @@ using std::string;
 
 namespace {
 
+long long
+usec_since_epoch()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(
+        system_clock::now().time_since_epoch() ).count();
+}
+
+/* anchor curl's (relative) phase times to when the request completed */
+ExecuteTiming_C
+execute_timing(const conn::RequestTiming& rt, long long send_usec)
+{
+    ExecuteTiming_C t;
+    t.send_usec = send_usec;
+    t.complete_usec = usec_since_epoch();
+    t.first_byte_usec = rt.starttransfer_usec > 0
+        ? t.complete_usec - (rt.total_usec - rt.starttransfer_usec)
+        : 0;
+    return t;
+}
+
+} /* namespace */
+
+
+namespace tdma{
+
 string
 order_id_from_header(const string& header)
 {
@@ -40,10 +67,6 @@ order_id_from_header(const string& header)
     return "";
 }
 
-} /* namespace */
-
-
-namespace tdma{
 
 string
 Execute_SendOrderImpl( Credentials& creds,
@@ -56,9 +79,11 @@ Execute_SendOrderImpl( Credentials& creds,
     if( body.empty() )
         TDMA_API_THROW(ValueException, "order json is empty");
 
-    conn::HTTPSPostConnection connection;
+    /* persistent, pre-warmed connection if one is available */
+    ExecutePool::Lease lease = ExecutePool::instance().acquire();
+    auto& connection = lease.connection();
     connection.SET_url(url);
-    connection.SET_fields(body);
+    connection.SET_method("POST", body);
 
     string r_head;
     conn::clock_ty::time_point r_tp;
@@ -68,6 +93,75 @@ Execute_SendOrderImpl( Credentials& creds,
 }
 
 
+/* returns the id of the new order */
+string
+Execute_ReplaceOrderImpl( Credentials& creds,
+                          const string& account_id,
+                          const string& order_id,
+                          const OrderTicketImpl& order )
+{
+    string url = URL_ACCOUNTS + util::url_encode(account_id)
+               + "/orders/" + util::url_encode(order_id);
+    string body = order.as_json_string();
+
+    if( body.empty() )
+        TDMA_API_THROW(ValueException, "order json is empty");
+
+    ExecutePool::Lease lease = ExecutePool::instance().acquire();
+    auto& connection = lease.connection();
+    connection.SET_url(url);
+    connection.SET_method("PUT", body);
+
+    string r_head;
+    conn::clock_ty::time_point r_tp;
+    tie(r_head, r_tp) =
+        connect_execute(connection, creds, conn::HTTP_RESPONSE_CREATED);
+    return order_id_from_header(r_head);
+}
+
+
+/* called once, from a library thread, w/ order id or exception */
+typedef std::function<void(string, ExecuteTiming_C, std::exception_ptr)>
+    send_order_async_impl_cb_ty;
+
+void
+Execute_SendOrderAsyncImpl( Credentials& creds,
+                            const string& account_id,
+                            const OrderTicketImpl& order,
+                            send_order_async_impl_cb_ty callback )
+{
+    string url = URL_ACCOUNTS + util::url_encode(account_id) + "/orders";
+    string body = order.as_json_string();
+
+    if( body.empty() )
+        TDMA_API_THROW(ValueException, "order json is empty");
+
+    /*
+     * never wait on the pool; if every slot is busy the order goes out on
+     * its own connection. The lease lives until the request completes.
+     */
+    std::shared_ptr<ExecutePool::Lease> lease(
+        new ExecutePool::Lease( ExecutePool::instance().acquire(false) )
+        );
+    auto& connection = lease->connection();
+    connection.SET_url(url);
+    connection.SET_method("POST", body);
+
+    long long send_usec = usec_since_epoch();
+    connect_execute_async(
+        connection, creds, conn::HTTP_RESPONSE_CREATED,
+        [lease, send_usec, callback](string head, std::exception_ptr e){
+            ExecuteTiming_C t = execute_timing(lease->connection().last_timing(),
+                                               send_usec);
+            string id;
+            if( !e )
+                id = order_id_from_header(head);
+            callback(id, t, e);
+        }
+    );
+}
+
+
 bool
 Execute_CancelOrderImpl( Credentials& creds,
                          const string& account_id,
@@ -76,8 +170,10 @@ Execute_CancelOrderImpl( Credentials& creds,
     string url = URL_ACCOUNTS + util::url_encode(account_id)
                + "/orders/" + util::url_encode(order_id); // encode uncessary
 
-    conn::HTTPSDeleteConnection connection;
+    ExecutePool::Lease lease = ExecutePool::instance().acquire();
+    auto& connection = lease.connection();
     connection.SET_url(url);
+    connection.SET_method("DELETE");
 
     // TODO catch exceptions and return fail state ??
     connect_execute(connection, creds, conn::HTTP_RESPONSE_OK);
@@ -121,6 +217,78 @@ Execute_SendOrder_ABI( Credentials *creds,
     return to_new_char_buffer(r, buf, n, allow_exceptions);
 }
 
+int
+Execute_ReplaceOrder_ABI( Credentials *creds,
+                          const char* account_id,
+                          const char* order_id,
+                          OrderTicket_C *porder,
+                          char** buf,
+                          size_t *n,
+                          int allow_exceptions )
+{
+    int err = proxy_is_callable<OrderTicketImpl>(porder, allow_exceptions);
+    if( err )
+         return err;
+
+    CHECK_PTR(account_id, "account id", allow_exceptions);
+    CHECK_PTR(order_id, "order id", allow_exceptions);
+    CHECK_PTR(buf, "buf", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    static auto meth =
+        +[]( Credentials *c, const char* aid, const char* oid,
+             OrderTicket_C* porder ){
+            return Execute_ReplaceOrderImpl(
+                *c, aid, oid, *reinterpret_cast<OrderTicketImpl*>(porder->obj)
+                );
+        };
+
+    string r;
+    std::tie(r,err) = CallImplFromABI( allow_exceptions, meth, creds,
+                                       account_id, order_id, porder );
+    if( err )
+        return err;
+
+    return to_new_char_buffer(r, buf, n, allow_exceptions);
+}
+
+int
+Execute_SendOrderAsync_ABI( Credentials *creds,
+                            const char* account_id,
+                            OrderTicket_C *porder,
+                            send_order_async_cb_ty callback,
+                            void *ctx,
+                            int allow_exceptions )
+{
+    int err = proxy_is_callable<OrderTicketImpl>(porder, allow_exceptions);
+    if( err )
+         return err;
+
+    CHECK_PTR(account_id, "account id", allow_exceptions);
+    CHECK_PTR(callback, "callback", allow_exceptions);
+
+    static auto meth =
+        +[]( Credentials *c, const char* id, OrderTicket_C* porder,
+             send_order_async_cb_ty cb, void *ctx ){
+            Execute_SendOrderAsyncImpl(
+                *c, id, *reinterpret_cast<OrderTicketImpl*>(porder->obj),
+                [cb, ctx](string s, ExecuteTiming_C t, std::exception_ptr eptr){
+                    if( !eptr ){
+                        cb(0, s.c_str(), s.size() + 1, &t, ctx);
+                        return;
+                    }
+                    int code;
+                    string msg;
+                    error_from_exception(eptr, &code, &msg);
+                    cb(code, msg.c_str(), msg.size() + 1, &t, ctx);
+                }
+            );
+        };
+
+    return CallImplFromABI( allow_exceptions, meth, creds, account_id, porder,
+                            callback, ctx );
+}
+
 int
 Execute_CancelOrder_ABI( Credentials *creds,
                          const char* account_id,
@@ -0,0 +1,337 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#include <iostream>
+
+#include "../../include/_tdma_api.h"
+#include "../../include/_execute.h"
+#include "../../include/_get.h" /* APIGetterImpl::reserve */
+
+using std::string;
+using std::chrono::seconds;
+
+namespace tdma{
+
+const unsigned int ExecutePool::DEF_SIZE = 2;
+const seconds ExecutePool::DEF_KEEPALIVE(30);
+
+
+ExecutePool::Slot::Slot()
+    :
+        connection(),
+        busy(false),
+        last_used(conn::clock_ty::now())
+    {
+    }
+
+
+ExecutePool::Lease::Lease(ExecutePool *pool, std::shared_ptr<Slot> slot)
+    :
+        _pool(pool),
+        _slot(slot),
+        _temp()
+    {
+    }
+
+ExecutePool::Lease::Lease(std::unique_ptr<conn::HTTPSExecuteConnection> temp)
+    :
+        _pool(nullptr),
+        _slot(),
+        _temp( std::move(temp) )
+    {
+    }
+
+ExecutePool::Lease::~Lease()
+{
+    if( _slot )
+        _pool->_release(_slot);
+}
+
+conn::HTTPSExecuteConnection&
+ExecutePool::Lease::connection()
+{ return _slot ? _slot->connection : *_temp; }
+
+
+ExecutePool&
+ExecutePool::instance()
+{
+    static ExecutePool pool;
+    return pool;
+}
+
+ExecutePool::ExecutePool()
+    :
+        _slots(),
+        _keepalive(DEF_KEEPALIVE),
+        _latency_first(false),
+        _keepalive_url(),
+        _mtx(),
+        _slot_cond(),
+        _keepalive_cond(),
+        _stop(false),
+        _keepalive_thread()
+    {
+        for( unsigned int i = 0; i < DEF_SIZE; ++i )
+            _slots.emplace_back( new Slot() );
+        _keepalive_thread = std::thread(&ExecutePool::_keepalive_loop, this);
+    }
+
+ExecutePool::~ExecutePool()
+{
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _stop = true;
+    }
+    _keepalive_cond.notify_all();
+    if( _keepalive_thread.joinable() )
+        _keepalive_thread.join();
+}
+
+
+ExecutePool::Lease
+ExecutePool::acquire(bool wait)
+{
+    std::unique_lock<std::mutex> l(_mtx);
+    while( true ){
+        for( auto& slot : _slots ){
+            if( !slot->busy ){
+                slot->busy = true;
+                return Lease(this, slot);
+            }
+        }
+        if( !wait || _latency_first || _slots.empty() )
+            break;
+        _slot_cond.wait(l);
+    }
+    l.unlock();
+
+    /* cold, one-off connection (the old behavior) */
+    std::unique_ptr<conn::HTTPSExecuteConnection> temp(
+        new conn::HTTPSExecuteConnection
+        );
+    return Lease( std::move(temp) );
+}
+
+
+void
+ExecutePool::_release(std::shared_ptr<Slot>& slot)
+{
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        slot->busy = false;
+        slot->last_used = conn::clock_ty::now();
+    }
+    /* (if the slot was dropped by configure() it dies w/ the lease) */
+    _slot_cond.notify_one();
+}
+
+
+void
+ExecutePool::configure( unsigned int size,
+                        seconds keepalive,
+                        bool latency_first )
+{
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _latency_first = latency_first;
+        _keepalive = keepalive;
+
+        while( _slots.size() > size )
+            _slots.pop_back();
+        while( _slots.size() < size )
+            _slots.emplace_back( new Slot() );
+    }
+    _slot_cond.notify_all();
+    _keepalive_cond.notify_all();
+}
+
+
+unsigned int
+ExecutePool::get_size() const
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    return static_cast<unsigned int>(_slots.size());
+}
+
+
+seconds
+ExecutePool::get_keepalive() const
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    return _keepalive;
+}
+
+
+bool
+ExecutePool::is_latency_first() const
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    return _latency_first;
+}
+
+
+void
+ExecutePool::warm(Credentials& creds, const string& account_id)
+{
+    string url = URL_ACCOUNTS + util::url_encode(account_id);
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _keepalive_url = url;
+    }
+
+    /* take every idle slot at once so each gets its own connection */
+    std::vector<Lease> leases;
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        for( auto& slot : _slots ){
+            if( !slot->busy ){
+                slot->busy = true;
+                leases.emplace_back( Lease(this, slot) );
+            }
+        }
+    }
+
+    for( auto& lease : leases ){
+        auto& c = lease.connection();
+        c.SET_url(url);
+        c.SET_method("GET");
+        connect_execute(c, creds, conn::HTTP_RESPONSE_OK);
+    }
+}
+
+
+void
+ExecutePool::_keepalive_loop()
+{
+    /* only ping connections that have been authorized/opened */
+    auto next_stale = [this](){
+        auto now = conn::clock_ty::now();
+        for( auto& slot : _slots ){
+            if( !slot->busy && slot->connection.has_headers()
+                && now - slot->last_used >= _keepalive )
+            {
+                return slot;
+            }
+        }
+        return std::shared_ptr<Slot>();
+    };
+
+    std::unique_lock<std::mutex> l(_mtx);
+    while( !_stop ){
+        if( _keepalive.count() <= 0 ){
+            _keepalive_cond.wait(l);
+            continue;
+        }
+
+        _keepalive_cond.wait_for(l, seconds(1));
+
+        /*
+         * ONE slot at a time so the rest of the pool stays available, and
+         * each ping draws from the getters' 'accounts' rate limit
+         */
+        while( !_stop && _keepalive.count() > 0 && !_keepalive_url.empty()
+               && next_stale() )
+        {
+            string url = _keepalive_url;
+            l.unlock();
+            auto tp = APIGetterImpl::reserve(EndpointFamilyType::accounts);
+            record_throttle_wait(url, tp - conn::clock_ty::now());
+            l.lock();
+            if( _keepalive_cond.wait_until(l, tp, [this](){ return _stop; }) )
+                break;
+
+            std::shared_ptr<Slot> slot = next_stale();
+            if( !slot )
+                break;
+            slot->busy = true;
+            url = _keepalive_url;
+            l.unlock();
+
+            /*
+             * we only care that the connection stays open; uses whatever
+             * auth header the slot already has and ignores the response
+             */
+            auto& c = slot->connection;
+            try{
+                c.SET_url(url);
+                c.SET_method("GET");
+                c.execute(false);
+                record_request( c.last_timing() );
+            }catch( conn::CurlConnectionError& ){
+                record_request( c.last_timing() );
+            }catch(...){
+            }
+            _release(slot);
+            l.lock();
+        }
+    }
+}
+
+} /* tdma */
+
+
+using namespace tdma;
+
+int
+Execute_ConfigurePool_ABI( unsigned int size,
+                           unsigned long keepalive_sec,
+                           int latency_first,
+                           int allow_exceptions )
+{
+    static auto meth = +[]( unsigned int sz, unsigned long ka, int lf ){
+        ExecutePool::instance().configure( sz, seconds(ka),
+                                           static_cast<bool>(lf) );
+    };
+
+    return CallImplFromABI( allow_exceptions, meth, size, keepalive_sec,
+                            latency_first );
+}
+
+
+int
+Execute_GetPoolConfig_ABI( unsigned int *size,
+                           unsigned long *keepalive_sec,
+                           int *latency_first,
+                           int allow_exceptions )
+{
+    CHECK_PTR(size, "size", allow_exceptions);
+    CHECK_PTR(keepalive_sec, "keepalive_sec", allow_exceptions);
+    CHECK_PTR(latency_first, "latency_first", allow_exceptions);
+
+    ExecutePool& pool = ExecutePool::instance();
+    *size = pool.get_size();
+    *keepalive_sec = static_cast<unsigned long>(pool.get_keepalive().count());
+    *latency_first = static_cast<int>(pool.is_latency_first());
+    return 0;
+}
+
+
+int
+Execute_WarmPool_ABI( Credentials *creds,
+                      const char* account_id,
+                      int allow_exceptions )
+{
+    CHECK_PTR(creds, "credentials", allow_exceptions);
+    CHECK_PTR(account_id, "account id", allow_exceptions);
+
+    static auto meth = +[]( Credentials *c, const char* id ){
+        ExecutePool::instance().warm(*c, id);
+    };
+
+    return CallImplFromABI( allow_exceptions, meth, creds, account_id );
+}
+
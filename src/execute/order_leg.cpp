@@ -92,7 +92,30 @@ OrderLegImpl::as_json() const
 
 string
 OrderLegImpl::as_json_string() const
-{ return as_json().dump(); }
+{
+    static thread_local JsonWriter writer;
+    writer.clear();
+    write_json(writer);
+    return writer.str();
+}
+
+/* keys in the order json (std::map) sorts them */
+void
+OrderLegImpl::write_json(JsonWriter& writer, size_t *quantity_slot) const
+{
+    writer.begin_object();
+    writer.key("instruction").value( enum_name(_instruction) );
+    writer.key("instrument").begin_object();
+    writer.key("assetType").value( enum_name(_asset_type) );
+    writer.key("symbol").value( _symbol );
+    writer.end_object();
+    writer.key("quantity");
+    if( quantity_slot )
+        *quantity_slot = writer.slot(OrderSlots::QUANTITY_WIDTH);
+    else
+        writer.value( static_cast<unsigned long long>(_quantity) );
+    writer.end_object();
+}
 
 typename OrderLegImpl::ProxyType::CType // need to call Destroy when done
 OrderLegImpl::as_ctype() const
@@ -0,0 +1,295 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#include <cstdio>
+
+#include "../../include/_tdma_api.h"
+#include "../../include/_execute.h"
+
+using std::string;
+
+namespace tdma{
+
+OrderTemplateImpl::OrderTemplateImpl( const string& account_id,
+                                      const OrderTicketImpl& order )
+    :
+        _account_url( URL_ACCOUNTS + util::url_encode(account_id) ),
+        _orders_url( _account_url + "/orders" ),
+        _body(),
+        _slots(),
+        _connection(),
+        _mtx()
+    {
+        if( account_id.empty() )
+            TDMA_API_THROW(ValueException, "empty account id");
+
+        JsonWriter writer;
+        order.write_json(writer, &_slots);
+        _body = writer.str();
+
+        /* fill the slots w/ the order's current values */
+        if( _slots.price != string::npos )
+            _patch_price(_slots.price, order.get_price(), "price");
+        if( _slots.stop_price != string::npos )
+            _patch_price( _slots.stop_price, order.get_stop_price(),
+                          "stop price" );
+        for( size_t i = 0; i < _slots.quantities.size(); ++i )
+            set_quantity(i, order.get_leg(i).get_quantity());
+
+        _connection.SET_url(_orders_url);
+    }
+
+
+void
+OrderTemplateImpl::_patch( size_t off,
+                           size_t width,
+                           const char* s,
+                           int n,
+                           const char* what )
+{
+    if( n < 0 || !JsonWriter::patch(_body, off, width, s, n) ){
+        TDMA_API_THROW( ValueException,
+                        string(what) + " too wide for order template" );
+    }
+}
+
+
+void
+OrderTemplateImpl::_patch_price(size_t off, double price, const char* what)
+{
+    /* 0.0 is never valid (the ticket wouldn't have had the field) */
+    if( price == 0.0 )
+        TDMA_API_THROW(ValueException, string("invalid ") + what);
+
+    char tmp[OrderSlots::PRICE_WIDTH + 1];
+    int n = std::snprintf(tmp, sizeof(tmp), "\"%.4f\"", price);
+    _patch(off, OrderSlots::PRICE_WIDTH, tmp, n, what);
+}
+
+
+void
+OrderTemplateImpl::warm(Credentials& creds)
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    _connection.SET_url(_account_url);
+    _connection.SET_method("GET");
+    try{
+        connect_execute(_connection, creds, conn::HTTP_RESPONSE_OK);
+    }catch(...){
+        _connection.SET_url(_orders_url);
+        throw;
+    }
+    _connection.SET_url(_orders_url);
+}
+
+
+void
+OrderTemplateImpl::set_price(double price)
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    if( _slots.price == string::npos )
+        TDMA_API_THROW(ValueException, "order template has no price");
+    _patch_price(_slots.price, price, "price");
+}
+
+
+void
+OrderTemplateImpl::set_stop_price(double stop_price)
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    if( _slots.stop_price == string::npos )
+        TDMA_API_THROW(ValueException, "order template has no stop price");
+    _patch_price(_slots.stop_price, stop_price, "stop price");
+}
+
+
+void
+OrderTemplateImpl::set_quantity(size_t leg, size_t quantity)
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    if( leg >= _slots.quantities.size() )
+        TDMA_API_THROW(ValueException, "invalid leg index");
+    if( quantity == 0 )
+        TDMA_API_THROW(ValueException, "0 quantity");
+
+    char tmp[OrderSlots::QUANTITY_WIDTH + 1];
+    int n = std::snprintf( tmp, sizeof(tmp), "%llu",
+                           static_cast<unsigned long long>(quantity) );
+    _patch(_slots.quantities[leg], OrderSlots::QUANTITY_WIDTH, tmp, n,
+           "quantity");
+}
+
+
+string
+OrderTemplateImpl::as_json_string() const
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    return _body;
+}
+
+
+string
+OrderTemplateImpl::send(Credentials& creds)
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    _connection.SET_method("POST", _body);
+
+    string r_head;
+    conn::clock_ty::time_point r_tp;
+    tie(r_head, r_tp) =
+        connect_execute(_connection, creds, conn::HTTP_RESPONSE_CREATED);
+    return order_id_from_header(r_head);
+}
+
+} /* tdma */
+
+
+using namespace tdma;
+
+int
+OrderTemplate_Create_ABI( const char* account_id,
+                          OrderTicket_C *porder,
+                          OrderTemplate_C *ptemplate,
+                          int allow_exceptions )
+{
+    CHECK_PTR(ptemplate, "template", allow_exceptions);
+    CHECK_PTR_KILL_PROXY(account_id, "account id", allow_exceptions,
+                         ptemplate);
+
+    int err = proxy_is_callable<OrderTicketImpl>(porder, allow_exceptions);
+    if( err ){
+        kill_proxy(ptemplate);
+        return err;
+    }
+
+    static auto meth = +[]( const char* id, void *obj ){
+        return new OrderTemplateImpl(
+            id, *reinterpret_cast<OrderTicketImpl*>(obj)
+            );
+    };
+
+    OrderTemplateImpl *obj;
+    std::tie(obj, err) = CallImplFromABI( allow_exceptions, meth, account_id,
+                                          porder->obj );
+    if( err ){
+        kill_proxy(ptemplate);
+        return err;
+    }
+
+    ptemplate->obj = reinterpret_cast<void*>(obj);
+    ptemplate->type_id = OrderTemplateImpl::TYPE_ID_LOW;
+    return 0;
+}
+
+int
+OrderTemplate_Destroy_ABI( OrderTemplate_C *ptemplate, int allow_exceptions )
+{ return destroy_proxy<OrderTemplateImpl>(ptemplate, allow_exceptions); }
+
+int
+OrderTemplate_Warm_ABI( OrderTemplate_C *ptemplate,
+                        Credentials *creds,
+                        int allow_exceptions )
+{
+    int err = proxy_is_callable<OrderTemplateImpl>(ptemplate, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(creds, "credentials", allow_exceptions);
+
+    static auto meth = +[]( void *obj, Credentials *c ){
+        reinterpret_cast<OrderTemplateImpl*>(obj)->warm(*c);
+    };
+
+    return CallImplFromABI( allow_exceptions, meth, ptemplate->obj, creds );
+}
+
+int
+OrderTemplate_SetPrice_ABI( OrderTemplate_C *ptemplate,
+                            double price,
+                            int allow_exceptions )
+{
+    return ImplAccessor<double>::template
+        set<OrderTemplateImpl>( ptemplate, &OrderTemplateImpl::set_price,
+                                price, allow_exceptions );
+}
+
+int
+OrderTemplate_SetStopPrice_ABI( OrderTemplate_C *ptemplate,
+                                double stop_price,
+                                int allow_exceptions )
+{
+    return ImplAccessor<double>::template
+        set<OrderTemplateImpl>( ptemplate, &OrderTemplateImpl::set_stop_price,
+                                stop_price, allow_exceptions );
+}
+
+int
+OrderTemplate_SetQuantity_ABI( OrderTemplate_C *ptemplate,
+                               size_t leg,
+                               size_t quantity,
+                               int allow_exceptions )
+{
+    int err = proxy_is_callable<OrderTemplateImpl>(ptemplate, allow_exceptions);
+    if( err )
+        return err;
+
+    static auto meth = +[]( void *obj, size_t l, size_t q ){
+        reinterpret_cast<OrderTemplateImpl*>(obj)->set_quantity(l, q);
+    };
+
+    return CallImplFromABI( allow_exceptions, meth, ptemplate->obj, leg,
+                            quantity );
+}
+
+int
+OrderTemplate_AsJsonString_ABI( OrderTemplate_C *ptemplate,
+                                char **buf,
+                                size_t *n,
+                                int allow_exceptions )
+{
+    return ImplAccessor<char**>::template
+        get<OrderTemplateImpl>( ptemplate, &OrderTemplateImpl::as_json_string,
+                                buf, n, allow_exceptions );
+}
+
+int
+OrderTemplate_Send_ABI( OrderTemplate_C *ptemplate,
+                        Credentials *creds,
+                        char **buf,
+                        size_t *n,
+                        int allow_exceptions )
+{
+    int err = proxy_is_callable<OrderTemplateImpl>(ptemplate, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(creds, "credentials", allow_exceptions);
+    CHECK_PTR(buf, "buf", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    static auto meth = +[]( void *obj, Credentials *c ){
+        return reinterpret_cast<OrderTemplateImpl*>(obj)->send(*c);
+    };
+
+    string r;
+    std::tie(r, err) = CallImplFromABI( allow_exceptions, meth, ptemplate->obj,
+                                        creds );
+    if( err )
+        return err;
+
+    return to_new_char_buffer(r, buf, n, allow_exceptions);
+}
@@ -129,9 +129,81 @@ OrderTicketImpl::as_json() const
     return j;
 }
 
+/*
+ * written straight from the fields (no DOM) into a per-thread buffer that
+ * keeps its capacity, so sending an order doesn't allocate for every node
+ */
 string
 OrderTicketImpl::as_json_string() const
-{ return as_json().dump(); }
+{
+    static thread_local JsonWriter writer;
+    writer.clear();
+    write_json(writer);
+    return writer.str();
+}
+
+/* same fields/conditions as as_json(), keys in the order it sorts them */
+void
+OrderTicketImpl::write_json(JsonWriter& writer, OrderSlots *slots) const
+{
+    writer.begin_object();
+
+    if( _duration == OrderDuration::GOOD_TILL_CANCEL )
+        writer.key("cancelTime").value(_cancel_time);
+
+    if( !_children.empty() ){
+        writer.key("childOrderStrategies").begin_array();
+        for(auto& c : _children)
+            c.write_json(writer);
+        writer.end_array();
+    }
+
+    if( _complex_strategy_type != ComplexOrderStrategyType::NONE )
+        writer.key("complexOrderStrategyType")
+              .value( enum_name(_complex_strategy_type) );
+
+    if( _duration != OrderDuration::NONE )
+        writer.key("duration").value( enum_name(_duration) );
+
+    if( !_legs.empty() ){
+        writer.key("orderLegCollection").begin_array();
+        for(auto& l : _legs){
+            if( slots ){
+                slots->quantities.push_back(0);
+                l.write_json(writer, &slots->quantities.back());
+            }else{
+                l.write_json(writer);
+            }
+        }
+        writer.end_array();
+    }
+
+    writer.key("orderStrategyType").value( enum_name(_strategy_type) );
+
+    if( _type != OrderType::NONE )
+        writer.key("orderType").value( enum_name(_type) );
+
+    if( _price ){
+        writer.key("price");
+        if( slots )
+            slots->price = writer.slot(OrderSlots::PRICE_WIDTH);
+        else
+            writer.fixedpoint_value(_price);
+    }
+
+    if( _session != OrderSession::NONE )
+        writer.key("session").value( enum_name(_session) );
+
+    if( _stop_price ){
+        writer.key("stopPrice");
+        if( slots )
+            slots->stop_price = writer.slot(OrderSlots::PRICE_WIDTH);
+        else
+            writer.fixedpoint_value(_stop_price);
+    }
+
+    writer.end_object();
+}
 
 OrderSession
 OrderTicketImpl::get_session() const
@@ -0,0 +1,479 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+#include "../../include/_tdma_api.h"
+#include "../../include/_get.h"
+
+using std::string;
+using std::vector;
+using std::cerr;
+using std::endl;
+
+namespace {
+
+using namespace tdma;
+
+typedef std::chrono::steady_clock clock_ty;
+
+const unsigned int DEF_NWORKERS = 4;
+
+const unsigned long long MSEC_PER_DAY = 24ULL * 60 * 60 * 1000;
+
+/* (generous) length of each PeriodType unit */
+unsigned long long
+period_type_msec(PeriodType period_type)
+{
+    switch( period_type ){
+    case PeriodType::day: return MSEC_PER_DAY;
+    case PeriodType::month: return MSEC_PER_DAY * 31;
+    case PeriodType::year: return MSEC_PER_DAY * 366;
+    case PeriodType::ytd: return MSEC_PER_DAY * 366;
+    default: return 0;
+    }
+}
+
+
+struct Window{
+    size_t symbol;
+    unsigned long long start;
+    unsigned long long end;
+};
+
+
+struct SymbolState{
+    vector<CandleColumns> parts; // by window, in time order
+    size_t remaining;
+    std::exception_ptr error;
+};
+
+
+/*
+ * windows are fetched in time order so the common case is already sorted;
+ * otherwise sort by datetime and keep the LAST (i.e later window's) candle
+ * of any duplicates
+ */
+CandleColumns
+merge_candles(vector<CandleColumns>& parts)
+{
+    if( parts.size() == 1 )
+        return std::move(parts[0]);
+
+    CandleColumns all;
+    size_t n = 0;
+    for( auto& p : parts )
+        n += p.size();
+    all.reserve(n);
+
+    bool ordered = true;
+    for( auto& p : parts ){
+        for( size_t i = 0; i < p.size(); ++i ){
+            if( all.size() && p.datetime[i] <= all.datetime.back() )
+                ordered = false;
+            all.push_back( p.datetime[i], p.open[i], p.high[i], p.low[i],
+                           p.close[i], p.volume[i] );
+        }
+        p.clear();
+    }
+    if( ordered )
+        return all;
+
+    vector<size_t> idx(all.size());
+    std::iota(idx.begin(), idx.end(), 0);
+    std::stable_sort( idx.begin(), idx.end(),
+        [&all](size_t l, size_t r){ return all.datetime[l] < all.datetime[r]; }
+        );
+
+    CandleColumns merged;
+    merged.reserve(all.size());
+    for( size_t i : idx ){
+        if( merged.size() && merged.datetime.back() == all.datetime[i] ){
+            merged.open.back() = all.open[i];
+            merged.high.back() = all.high[i];
+            merged.low.back() = all.low[i];
+            merged.close.back() = all.close[i];
+            merged.volume.back() = all.volume[i];
+            continue;
+        }
+        merged.push_back( all.datetime[i], all.open[i], all.high[i],
+                          all.low[i], all.close[i], all.volume[i] );
+    }
+    return merged;
+}
+
+
+class Backfill{
+    Credentials& _creds;
+    const vector<string>& _symbols;
+    FrequencyType _frequency_type;
+    unsigned int _frequency;
+    bool _extended_hours;
+    backfill_symbol_cb_ty _on_symbol;
+    backfill_progress_cb_ty _on_progress;
+
+    vector<Window> _windows;
+    vector<size_t> _first_window; // index of each symbol's first window
+    vector<SymbolState> _states;
+    std::atomic<size_t> _next;
+
+    std::mutex _state_mtx;
+    std::mutex _callback_mtx; // callbacks are called one at a time
+    BackfillProgress_C _progress; // _callback_mtx
+    clock_ty::time_point _start_tp;
+
+    void
+    _report( size_t ncandles,
+             unsigned long long nbytes,
+             bool failed,
+             bool symbol_done )
+    {
+        std::lock_guard<std::mutex> _(_callback_mtx);
+        ++_progress.windows_done;
+        if( failed )
+            ++_progress.windows_failed;
+        if( symbol_done )
+            ++_progress.symbols_done;
+        _progress.candles += ncandles;
+        _progress.bytes += nbytes;
+
+        std::chrono::duration<double> d = clock_ty::now() - _start_tp;
+        _progress.elapsed_sec = d.count();
+        if( d.count() > 0 ){
+            _progress.windows_per_sec = _progress.windows_done / d.count();
+            _progress.candles_per_sec = _progress.candles / d.count();
+        }
+
+        if( _on_progress ){
+            try{
+                _on_progress(_progress);
+            }catch( ... ){
+                cerr<< "exception in backfill progress callback" << endl;
+            }
+        }
+    }
+
+    void
+    _emit(size_t sym, CandleColumns&& candles, std::exception_ptr error)
+    {
+        std::lock_guard<std::mutex> _(_callback_mtx);
+        if( _on_symbol ){
+            try{
+                _on_symbol(_symbols[sym], std::move(candles), error);
+            }catch( ... ){
+                cerr<< "exception in backfill symbol callback" << endl;
+            }
+        }
+    }
+
+    void
+    _work()
+    {
+        /*
+         * own copy of creds: the connection code may swap in a new access
+         * token; the token cache is shared by client_id so a refresh by
+         * one worker is picked up by the rest
+         */
+        Credentials creds(_creds);
+        HistoricalRangeFetcher fetcher( creds, _frequency_type, _frequency,
+                                        _extended_hours );
+
+        size_t i;
+        while( (i = _next++) < _windows.size() ){
+            const Window& w = _windows[i];
+            SymbolState& state = _states[w.symbol];
+
+            bool skip;
+            {
+                std::lock_guard<std::mutex> _(_state_mtx);
+                skip = static_cast<bool>(state.error);
+            }
+
+            CandleColumns part;
+            size_t nbytes = 0;
+            std::exception_ptr error;
+            if( !skip ){
+                try{
+                    nbytes = fetcher.fetch( _symbols[w.symbol], w.start,
+                                            w.end, part );
+                }catch( ... ){
+                    error = std::current_exception();
+                }
+            }
+
+            size_t ncandles = part.size();
+            bool done;
+            vector<CandleColumns> parts;
+            std::exception_ptr sym_error;
+            {
+                std::lock_guard<std::mutex> _(_state_mtx);
+                if( error && !state.error )
+                    state.error = error;
+                state.parts[i - _first_window[w.symbol]] = std::move(part);
+                done = (--state.remaining == 0);
+                if( done ){
+                    parts.swap(state.parts);
+                    sym_error = state.error;
+                }
+            }
+
+            if( done ){
+                CandleColumns merged;
+                if( !sym_error )
+                    merged = merge_candles(parts);
+                _emit(w.symbol, std::move(merged), sym_error);
+            }
+            _report(ncandles, nbytes, static_cast<bool>(error || skip), done);
+        }
+    }
+
+public:
+    Backfill( Credentials& creds,
+              const vector<string>& symbols,
+              FrequencyType frequency_type,
+              unsigned int frequency,
+              unsigned long long start_msec_since_epoch,
+              unsigned long long end_msec_since_epoch,
+              bool extended_hours,
+              backfill_symbol_cb_ty on_symbol,
+              backfill_progress_cb_ty on_progress )
+        :
+            _creds(creds),
+            _symbols(symbols),
+            _frequency_type(frequency_type),
+            _frequency(frequency),
+            _extended_hours(extended_hours),
+            _on_symbol(on_symbol),
+            _on_progress(on_progress),
+            _windows(),
+            _first_window(),
+            _states(symbols.size()),
+            _next(0),
+            _progress()
+        {
+            unsigned long long span = backfill_window_msec(frequency_type);
+
+            /* symbol-major so symbols finish (and free their parts) early */
+            for( size_t s = 0; s < symbols.size(); ++s ){
+                _first_window.push_back( _windows.size() );
+                unsigned long long beg = start_msec_since_epoch;
+                do{
+                    unsigned long long end = beg + span - 1;
+                    if( end < beg || end > end_msec_since_epoch )
+                        end = end_msec_since_epoch;
+                    _windows.push_back( {s, beg, end} );
+                    beg = end + 1;
+                }while( beg <= end_msec_since_epoch && beg != 0 );
+
+                _states[s].remaining = _windows.size() - _first_window[s];
+                _states[s].parts.resize( _states[s].remaining );
+            }
+
+            _progress.windows_total = _windows.size();
+            _progress.symbols_total = symbols.size();
+        }
+
+    void
+    run(unsigned int nworkers)
+    {
+        if( _windows.empty() )
+            return;
+
+        if( nworkers == 0 )
+            nworkers = DEF_NWORKERS;
+        nworkers = static_cast<unsigned int>(
+            std::min<size_t>(nworkers, _windows.size())
+            );
+
+        _start_tp = clock_ty::now();
+        vector<std::thread> workers;
+        for( unsigned int i = 0; i < nworkers; ++i )
+            workers.emplace_back( &Backfill::_work, this );
+        for( auto& t : workers )
+            t.join();
+    }
+};
+
+} /* namespace */
+
+
+namespace tdma{
+
+using std::to_string;
+
+unsigned long long
+backfill_window_msec(FrequencyType frequency_type)
+{
+    /* the longest valid period of any period type that allows it */
+    unsigned long long span = 0;
+    for( auto& p : VALID_PERIODS_BY_PERIOD_TYPE ){
+        auto f = VALID_FREQUENCY_TYPES_BY_PERIOD_TYPE.find(p.first);
+        if( f == VALID_FREQUENCY_TYPES_BY_PERIOD_TYPE.end()
+            || f->second.count(frequency_type) == 0
+            || p.second.empty() )
+        {
+            continue;
+        }
+        span = std::max( span, *p.second.rbegin() * period_type_msec(p.first) );
+    }
+
+    if( span == 0 ){
+        TDMA_API_THROW(ValueException,
+            "invalid frequency type(" + to_string(frequency_type) + ")");
+    }
+    return span;
+}
+
+
+void
+backfill_history( Credentials& creds,
+                  const vector<string>& symbols,
+                  FrequencyType frequency_type,
+                  unsigned int frequency,
+                  unsigned long long start_msec_since_epoch,
+                  unsigned long long end_msec_since_epoch,
+                  bool extended_hours,
+                  unsigned int nworkers,
+                  backfill_symbol_cb_ty on_symbol,
+                  backfill_progress_cb_ty on_progress )
+{
+    if( start_msec_since_epoch > end_msec_since_epoch )
+        TDMA_API_THROW(ValueException, "start datetime after end datetime");
+
+    auto valid = VALID_FREQUENCIES_BY_FREQUENCY_TYPE.find(frequency_type);
+    if( valid == VALID_FREQUENCIES_BY_FREQUENCY_TYPE.end()
+        || valid->second.count(frequency) == 0 )
+    {
+        TDMA_API_THROW(ValueException,
+            "invalid frequency(" + to_string(frequency)
+            + ") for frequency type(" + to_string(frequency_type) + ")"
+            );
+    }
+
+    for( auto& s : symbols ){
+        if( s.empty() )
+            TDMA_API_THROW(ValueException, "empty symbol");
+    }
+
+    Backfill( creds, symbols, frequency_type, frequency,
+              start_msec_since_epoch, end_msec_since_epoch, extended_hours,
+              on_symbol, on_progress ).run(nworkers);
+}
+
+} /* tdma */
+
+
+using namespace tdma;
+
+int
+HistoricalBackfill_ABI( struct Credentials *pcreds,
+                        const char **symbols,
+                        size_t nsymbols,
+                        int frequency_type,
+                        unsigned int frequency,
+                        unsigned long long start_msec_since_epoch,
+                        unsigned long long end_msec_since_epoch,
+                        int extended_hours,
+                        unsigned int nworkers,
+                        historical_backfill_symbol_cb_ty on_symbol,
+                        historical_backfill_progress_cb_ty on_progress,
+                        void *ctx,
+                        int allow_exceptions )
+{
+    CHECK_PTR(pcreds, "credentials", allow_exceptions);
+    if( nsymbols )
+        CHECK_PTR(symbols, "symbols", allow_exceptions);
+    CHECK_ENUM(FrequencyType, frequency_type, allow_exceptions);
+
+    static auto meth = +[]( Credentials *c, const char **syms, size_t nsyms,
+                            int ft, unsigned int f, unsigned long long sm,
+                            unsigned long long em, int eh, unsigned int nw,
+                            historical_backfill_symbol_cb_ty scb,
+                            historical_backfill_progress_cb_ty pcb,
+                            void *ctx ){
+        vector<string> s;
+        for( size_t i = 0; i < nsyms; ++i ){
+            if( !syms[i] )
+                TDMA_API_THROW(ValueException, "null symbol");
+            s.emplace_back( util::toupper(syms[i]) );
+        }
+
+        backfill_symbol_cb_ty on_symbol;
+        if( scb ){
+            on_symbol = [scb, ctx]( const string& symbol,
+                                    CandleColumns&& candles,
+                                    std::exception_ptr eptr ){
+                Candles_C c = Candles_C();
+                if( !eptr ){
+                    try{
+                        candles_to_abi(candles, &c, true);
+                    }catch(...){
+                        eptr = std::current_exception();
+                    }
+                }
+                if( !eptr ){
+                    scb(symbol.c_str(), 0, nullptr, &c, ctx);
+                    return;
+                }
+                /* error code and message in place of the candles */
+                int code;
+                string msg;
+                error_from_exception(eptr, &code, &msg);
+                scb(symbol.c_str(), code, msg.c_str(), &c, ctx);
+            };
+        }
+
+        backfill_progress_cb_ty on_progress;
+        if( pcb ){
+            on_progress = [pcb, ctx](const BackfillProgress_C& p){
+                pcb(&p, ctx);
+            };
+        }
+
+        backfill_history( *c, s, static_cast<FrequencyType>(ft), f, sm, em,
+                          static_cast<bool>(eh), nw, on_symbol, on_progress );
+    };
+
+    return CallImplFromABI( allow_exceptions, meth, pcreds, symbols, nsymbols,
+                            frequency_type, frequency, start_msec_since_epoch,
+                            end_msec_since_epoch, extended_hours, nworkers,
+                            on_symbol, on_progress, ctx );
+}
+
+int
+HistoricalBackfill_GetWindowMSec_ABI( int frequency_type,
+                                      unsigned long long *msec,
+                                      int allow_exceptions )
+{
+    CHECK_PTR(msec, "msec", allow_exceptions);
+    CHECK_ENUM(FrequencyType, frequency_type, allow_exceptions);
+
+    static auto meth = +[]( int ft ){
+        return backfill_window_msec( static_cast<FrequencyType>(ft) );
+    };
+
+    int err;
+    std::tie(*msec, err) = CallImplFromABI( allow_exceptions, meth,
+                                            frequency_type );
+    return err;
+}
+
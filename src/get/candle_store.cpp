@@ -0,0 +1,658 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif /* _WIN32 */
+
+#include "../../include/_tdma_api.h"
+#include "../../include/_get.h"
+#include "../../include/candle_store.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+
+using namespace tdma;
+
+const char DATA_MAGIC[8] = {'T','D','M','A','C','N','D','L'};
+const char INDEX_MAGIC[8] = {'T','D','M','A','C','I','D','X'};
+const uint32_t VERSION = 1;
+
+const unsigned long long MSEC_PER_MINUTE = 60 * 1000;
+const unsigned long long MSEC_PER_DAY = MSEC_PER_MINUTE * 60 * 24;
+
+struct DataHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t count;
+    uint64_t reserved;
+};
+
+static_assert( sizeof(DataHeader) == 32, "DataHeader should be 32 bytes" );
+static_assert( sizeof(CandleRecord_C) == 48,
+               "CandleRecord_C should be 48 bytes" );
+
+void
+throw_io(const string& what, const string& path)
+{ TDMA_API_THROW(APIException, "candle store: " + what + " (" + path + ")"); }
+
+unsigned long long
+bar_msec(FrequencyType frequency_type, unsigned int frequency)
+{
+    switch( frequency_type ){
+    case FrequencyType::minute: return MSEC_PER_MINUTE * frequency;
+    case FrequencyType::daily: return MSEC_PER_DAY * frequency;
+    case FrequencyType::weekly: return MSEC_PER_DAY * 7 * frequency;
+    case FrequencyType::monthly: return MSEC_PER_DAY * 31 * frequency;
+    default: return MSEC_PER_DAY;
+    }
+}
+
+bool
+datetime_less(const CandleRecord_C& l, const CandleRecord_C& r)
+{ return l.datetime < r.datetime; }
+
+/* FILE* that closes itself */
+class File{
+    FILE *_f;
+public:
+    File(const string& path, const char* mode)
+        : _f( fopen(path.c_str(), mode) )
+        {}
+
+    ~File()
+    { if( _f ) fclose(_f); }
+
+    FILE*
+    get() const
+    { return _f; }
+
+    /* explicit close to catch write errors */
+    bool
+    close()
+    {
+        int r = fclose(_f);
+        _f = nullptr;
+        return r == 0;
+    }
+};
+
+void
+write_or_throw(FILE *f, const void* data, size_t n, const string& path)
+{
+    if( n && fwrite(data, n, 1, f) != 1 )
+        throw_io("write failed", path);
+}
+
+/*
+ * replace 'to' w/ 'from'; on windows this fails if 'to' is mapped (see
+ * CandleStoreFile::_rewrite)
+ */
+void
+replace_file(const string& from, const string& to)
+{
+#ifdef _WIN32
+    if( !MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) )
+        throw_io("failed to replace", to);
+#else
+    if( rename(from.c_str(), to.c_str()) )
+        throw_io("failed to replace", to);
+#endif /* _WIN32 */
+}
+
+/* 64 bit offsets; long (ftell/fseek) is 32 bits on windows */
+int
+seek64(FILE *f, unsigned long long off, int whence)
+{
+#ifdef _WIN32
+    return _fseeki64(f, static_cast<__int64>(off), whence);
+#else
+    return fseeko(f, static_cast<off_t>(off), whence);
+#endif /* _WIN32 */
+}
+
+long long
+tell64(FILE *f)
+{
+#ifdef _WIN32
+    return _ftelli64(f);
+#else
+    return static_cast<long long>( ftello(f) );
+#endif /* _WIN32 */
+}
+
+} /* namespace */
+
+
+namespace tdma{
+
+MappedFile::MappedFile(const string& path, size_t size)
+    :
+        _data(nullptr),
+        _size(size),
+        _retired_path()
+#ifdef _WIN32
+        , _hmap(nullptr)
+#endif /* _WIN32 */
+    {
+#ifdef _WIN32
+        HANDLE hfile = CreateFileA( path.c_str(), GENERIC_READ,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE
+                                    | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL, NULL );
+        if( hfile == INVALID_HANDLE_VALUE )
+            throw_io("failed to open", path);
+        _hmap = CreateFileMappingA(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(hfile);
+        if( !_hmap )
+            throw_io("failed to map", path);
+        _data = reinterpret_cast<const char*>(
+            MapViewOfFile(_hmap, FILE_MAP_READ, 0, 0, size)
+            );
+        if( !_data ){
+            CloseHandle(_hmap);
+            throw_io("failed to map", path);
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if( fd < 0 )
+            throw_io("failed to open", path);
+        void *p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if( p == MAP_FAILED )
+            throw_io("failed to map", path);
+        _data = reinterpret_cast<const char*>(p);
+#endif /* _WIN32 */
+    }
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(_hmap);
+    if( !_retired_path.empty() )
+        DeleteFileA( _retired_path.c_str() );
+#else
+    munmap( const_cast<char*>(_data), _size );
+#endif /* _WIN32 */
+}
+
+
+CandleStoreFile::CandleStoreFile( const string& base_path,
+                                  unsigned long long bar_msec )
+    :
+        _data_path( base_path + ".candles" ),
+        _index_path( base_path + ".index" ),
+        _bar_msec(bar_msec),
+        _coverage(),
+        _mapping(),
+        _count(0),
+        _generation(0),
+        _mtx()
+    {
+        _load();
+    }
+
+
+const CandleRecord_C*
+CandleStoreFile::_records() const
+{
+    if( !_mapping )
+        return nullptr;
+    return reinterpret_cast<const CandleRecord_C*>(
+        _mapping->data() + sizeof(DataHeader)
+        );
+}
+
+
+void
+CandleStoreFile::_load()
+{
+    {
+        File f(_data_path, "rb");
+        if( f.get() ){
+            DataHeader h;
+            if( fread(&h, sizeof(h), 1, f.get()) != 1
+                || memcmp(h.magic, DATA_MAGIC, sizeof(DATA_MAGIC))
+                || h.version != VERSION
+                || h.record_size != sizeof(CandleRecord_C) )
+            {
+                throw_io("invalid data file", _data_path);
+            }
+            seek64(f.get(), 0, SEEK_END);
+            long long sz = tell64(f.get());
+            if( sz < 0 || static_cast<unsigned long long>(sz)
+                < sizeof(DataHeader) + h.count * sizeof(CandleRecord_C) )
+            {
+                throw_io("truncated data file", _data_path);
+            }
+            _count = static_cast<size_t>(h.count);
+        }
+    }
+    _map();
+
+    File f(_index_path, "rb");
+    if( !f.get() )
+        return;
+
+    char magic[8];
+    uint64_t n;
+    if( fread(magic, sizeof(magic), 1, f.get()) != 1
+        || memcmp(magic, INDEX_MAGIC, sizeof(INDEX_MAGIC))
+        || fread(&n, sizeof(n), 1, f.get()) != 1 )
+    {
+        throw_io("invalid index file", _index_path);
+    }
+    for( uint64_t i = 0; i < n; ++i ){
+        uint64_t r[2];
+        if( fread(r, sizeof(r), 1, f.get()) != 1 )
+            throw_io("truncated index file", _index_path);
+        _coverage.emplace_back(r[0], r[1]);
+    }
+}
+
+
+void
+CandleStoreFile::_map()
+{
+    /* views of the old mapping keep it alive */
+    _mapping.reset();
+    if( _count ){
+        _mapping = std::make_shared<const MappedFile>(
+            _data_path, sizeof(DataHeader) + _count * sizeof(CandleRecord_C)
+            );
+    }
+}
+
+
+void
+CandleStoreFile::_append(const vector<CandleRecord_C>& records)
+{
+    DataHeader h;
+    memcpy(h.magic, DATA_MAGIC, sizeof(DATA_MAGIC));
+    h.version = VERSION;
+    h.record_size = sizeof(CandleRecord_C);
+    h.count = _count + records.size();
+    h.reserved = 0;
+
+    {
+        File f(_data_path, _count ? "r+b" : "wb");
+        if( !f.get() )
+            throw_io("failed to open", _data_path);
+
+        /* records first so a crash leaves the old count (and data) valid */
+        if( seek64(f.get(), sizeof(DataHeader)
+                   + static_cast<unsigned long long>(_count)
+                     * sizeof(CandleRecord_C), SEEK_SET) )
+        {
+            throw_io("seek failed", _data_path);
+        }
+        write_or_throw( f.get(), records.data(),
+                        records.size() * sizeof(CandleRecord_C), _data_path );
+        fflush(f.get());
+        if( seek64(f.get(), 0, SEEK_SET) )
+            throw_io("seek failed", _data_path);
+        write_or_throw(f.get(), &h, sizeof(h), _data_path);
+        if( !f.close() )
+            throw_io("write failed", _data_path);
+    }
+
+    _count = static_cast<size_t>(h.count);
+    _map();
+}
+
+
+void
+CandleStoreFile::_rewrite(const vector<CandleRecord_C>& records)
+{
+    /* merge; on equal datetime the new record wins */
+    const CandleRecord_C *old = _records();
+    vector<CandleRecord_C> merged;
+    merged.reserve(_count + records.size());
+
+    size_t i = 0, j = 0;
+    while( i < _count || j < records.size() ){
+        if( j == records.size()
+            || (i < _count && old[i].datetime < records[j].datetime) )
+        {
+            merged.push_back(old[i++]);
+        }else{
+            if( i < _count && old[i].datetime == records[j].datetime )
+                ++i;
+            merged.push_back(records[j++]);
+        }
+    }
+
+    DataHeader h;
+    memcpy(h.magic, DATA_MAGIC, sizeof(DATA_MAGIC));
+    h.version = VERSION;
+    h.record_size = sizeof(CandleRecord_C);
+    h.count = merged.size();
+    h.reserved = 0;
+
+    string tmp = _data_path + ".tmp";
+    {
+        File f(tmp, "wb");
+        if( !f.get() )
+            throw_io("failed to open", tmp);
+        write_or_throw(f.get(), &h, sizeof(h), tmp);
+        write_or_throw( f.get(), merged.data(),
+                        merged.size() * sizeof(CandleRecord_C), tmp );
+        if( !f.close() )
+            throw_io("write failed", tmp);
+    }
+
+#ifdef _WIN32
+    /*
+     * a mapped file can't be replaced (or deleted) on windows, but it can
+     * be renamed: retire the current generation to its own name, deleted
+     * once the last view of it is gone, and move the new one in
+     */
+    if( _mapping ){
+        string retired = _data_path + ".old" + std::to_string(++_generation);
+        if( !MoveFileExA( _data_path.c_str(), retired.c_str(),
+                          MOVEFILE_REPLACE_EXISTING ) )
+        {
+            throw_io("failed to retire", _data_path);
+        }
+        if( !MoveFileExA(tmp.c_str(), _data_path.c_str(), 0) ){
+            MoveFileExA(retired.c_str(), _data_path.c_str(), 0);
+            throw_io("failed to replace", _data_path);
+        }
+        _mapping->retire(retired);
+    }else{
+        replace_file(tmp, _data_path);
+    }
+#else
+    /* views of the old file stay valid after the rename */
+    replace_file(tmp, _data_path);
+#endif /* _WIN32 */
+
+    _mapping.reset();
+    _count = merged.size();
+    _map();
+}
+
+
+void
+CandleStoreFile::_cover(unsigned long long start, unsigned long long end)
+{
+    _coverage.emplace_back(start, end);
+    std::sort( _coverage.begin(), _coverage.end() );
+
+    /* merge overlapping/adjacent */
+    vector<range_ty> merged;
+    for( auto& r : _coverage ){
+        if( !merged.empty() && r.first <= merged.back().second + 1 )
+            merged.back().second = std::max(merged.back().second, r.second);
+        else
+            merged.push_back(r);
+    }
+    _coverage.swap(merged);
+}
+
+
+void
+CandleStoreFile::_write_index() const
+{
+    string tmp = _index_path + ".tmp";
+    {
+        File f(tmp, "wb");
+        if( !f.get() )
+            throw_io("failed to open", tmp);
+        uint64_t n = _coverage.size();
+        write_or_throw(f.get(), INDEX_MAGIC, sizeof(INDEX_MAGIC), tmp);
+        write_or_throw(f.get(), &n, sizeof(n), tmp);
+        for( auto& r : _coverage ){
+            uint64_t rr[2] = {r.first, r.second};
+            write_or_throw(f.get(), rr, sizeof(rr), tmp);
+        }
+        if( !f.close() )
+            throw_io("write failed", tmp);
+    }
+    replace_file(tmp, _index_path);
+}
+
+
+unsigned long long
+CandleStoreFile::last_complete_msec() const
+{
+    using namespace std::chrono;
+    unsigned long long now = static_cast<unsigned long long>(
+        duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+            .count()
+        );
+    return (now > _bar_msec) ? now - _bar_msec : 0;
+}
+
+
+vector<CandleStoreFile::range_ty>
+CandleStoreFile::missing(unsigned long long start, unsigned long long end) const
+{
+    end = std::min(end, last_complete_msec());
+
+    vector<range_ty> gaps;
+    if( start > end )
+        return gaps;
+
+    std::lock_guard<std::mutex> _(_mtx);
+    unsigned long long cur = start;
+    for( auto& r : _coverage ){
+        if( r.second < cur )
+            continue;
+        if( r.first > end )
+            break;
+        if( r.first > cur )
+            gaps.emplace_back(cur, r.first - 1);
+        if( r.second >= end )
+            return gaps;
+        cur = r.second + 1;
+    }
+    gaps.emplace_back(cur, end);
+    return gaps;
+}
+
+
+void
+CandleStoreFile::insert( unsigned long long start,
+                         unsigned long long end,
+                         const CandleColumns& candles )
+{
+    end = std::min(end, last_complete_msec());
+    if( start > end )
+        return;
+
+    vector<CandleRecord_C> records;
+    records.reserve( candles.size() );
+    for( size_t i = 0; i < candles.size(); ++i ){
+        long long dt = candles.datetime[i];
+        if( dt < 0 || static_cast<unsigned long long>(dt) < start
+            || static_cast<unsigned long long>(dt) > end )
+        {
+            continue;
+        }
+        records.push_back( {dt, candles.open[i], candles.high[i],
+                            candles.low[i], candles.close[i],
+                            candles.volume[i]} );
+    }
+
+    /* should already be sorted */
+    if( !std::is_sorted(records.begin(), records.end(), datetime_less) )
+        std::stable_sort(records.begin(), records.end(), datetime_less);
+    records.erase(
+        std::unique( records.begin(), records.end(),
+            [](const CandleRecord_C& l, const CandleRecord_C& r){
+                return l.datetime == r.datetime;
+            } ),
+        records.end()
+        );
+
+    std::lock_guard<std::mutex> _(_mtx);
+    if( !records.empty() ){
+        if( _count == 0
+            || records.front().datetime > _records()[_count - 1].datetime )
+        {
+            _append(records);
+        }else{
+            _rewrite(records);
+        }
+    }
+    _cover(start, end);
+    _write_index();
+}
+
+
+CandleStoreView
+CandleStoreFile::view(unsigned long long start, unsigned long long end) const
+{
+    std::lock_guard<std::mutex> _(_mtx);
+
+    const CandleRecord_C *b = _records();
+    const CandleRecord_C *e = b + _count;
+    if( b ){
+        const unsigned long long MAX_DT =
+            static_cast<unsigned long long>(
+                std::numeric_limits<long long>::max()
+                );
+        CandleRecord_C s = {}, t = {};
+        s.datetime = static_cast<long long>( std::min(start, MAX_DT) );
+        t.datetime = static_cast<long long>( std::min(end, MAX_DT) );
+        b = std::lower_bound(b, e, s, datetime_less);
+        e = std::upper_bound(b, e, t, datetime_less);
+    }
+    return { _mapping, b, static_cast<size_t>(e - b) };
+}
+
+
+size_t
+CandleStoreFile::size() const
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    return _count;
+}
+
+
+CandleStore&
+CandleStore::instance()
+{
+    static CandleStore store;
+    return store;
+}
+
+
+void
+CandleStore::set_directory(const string& directory)
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    if( directory != _directory ){
+        _directory = directory;
+        _files.clear();
+    }
+}
+
+
+string
+CandleStore::get_directory() const
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    return _directory;
+}
+
+
+std::shared_ptr<CandleStoreFile>
+CandleStore::open( const string& symbol,
+                   FrequencyType frequency_type,
+                   unsigned int frequency,
+                   bool extended_hours )
+{
+    /* SPY.minute5.ext, BRK%2FB.daily1 etc. */
+    string name = util::url_encode( util::toupper(symbol) ) + "."
+                + to_string(frequency_type) + std::to_string(frequency)
+                + (extended_hours ? ".ext" : "");
+
+    std::lock_guard<std::mutex> _(_mtx);
+    if( _directory.empty() )
+        TDMA_API_THROW(APIException, "candle store directory not set");
+
+    auto f = _files.find(name);
+    if( f != _files.end() )
+        return f->second;
+
+    string base = _directory;
+    if( base.back() != '/' && base.back() != '\\' )
+        base.push_back('/');
+    base += name;
+
+    auto file = std::make_shared<CandleStoreFile>(
+        base, bar_msec(frequency_type, frequency)
+        );
+    _files.insert( {name, file} );
+    return file;
+}
+
+} /* tdma */
+
+
+using namespace tdma;
+
+int
+CandleStore_SetDirectory_ABI(const char* directory, int allow_exceptions)
+{
+    CHECK_PTR(directory, "directory", allow_exceptions);
+
+    static auto meth = +[](const char* d){
+        CandleStore::instance().set_directory(d);
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, directory);
+}
+
+int
+CandleStore_GetDirectory_ABI(char **buf, size_t *n, int allow_exceptions)
+{
+    CHECK_PTR(buf, "buf", allow_exceptions);
+
+    string d = CandleStore::instance().get_directory();
+    return to_new_char_buffer(d, buf, n, allow_exceptions);
+}
+
+int
+FreeCandleView_ABI(CandleView_C *pview, int allow_exceptions)
+{
+    if( pview ){
+        /* 'handle' keeps the mapping alive */
+        delete reinterpret_cast<std::shared_ptr<const MappedFile>*>(
+            pview->handle
+            );
+        memset(pview, 0, sizeof(CandleView_C));
+    }
+    return 0;
+}
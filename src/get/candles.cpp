@@ -0,0 +1,328 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#include <string>
+#include <limits>
+#include <cstring>
+#include <cstdlib>
+
+#include "../../include/_tdma_api.h"
+#include "../../include/_get.h"
+#include "../../include/json_scanner.h"
+
+using std::string;
+
+namespace {
+
+using namespace tdma;
+
+/*
+ * CandleScanner - pulls the 'candles' array out of a pricehistory response
+ * w/o building a DOM:
+ *
+ *   {"candles":[{"open":1.0,"high":...,"datetime":1540000000000},...],
+ *    "symbol":"SPY","empty":false}
+ *
+ * Candle fields can be in any order; unknown fields/values are skipped.
+ * Each candle goes to Sink::push_back(datetime, open, high, low, close,
+ * volume).
+ */
+class CandleScanner
+        : private JsonScanner {
+
+    /* null -> NaN */
+    double
+    _number()
+    {
+        slice_ty s = _literal();
+        if( _is(s, "null", 4) )
+            return std::numeric_limits<double>::quiet_NaN();
+
+        /* copy out; the buffer isn't NUL-terminated */
+        char buf[64];
+        if( s.second >= sizeof(buf) )
+            throw Fail();
+        memcpy(buf, s.first, s.second);
+        buf[s.second] = 0;
+
+        char *e;
+        double d = strtod(buf, &e);
+        if( *e != 0 )
+            throw Fail();
+        return d;
+    }
+
+    template<typename Sink>
+    void
+    _candle(Sink& sink)
+    {
+        static const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+        double dt = NaN, o = NaN, h = NaN, l = NaN, c = NaN, v = NaN;
+
+        _expect('{');
+        if( !_consume('}') ){
+            do{
+                slice_ty k = _string();
+                _expect(':');
+                if( _is(k, "datetime", 8) ) dt = _number();
+                else if( _is(k, "open", 4) ) o = _number();
+                else if( _is(k, "high", 4) ) h = _number();
+                else if( _is(k, "low", 3) ) l = _number();
+                else if( _is(k, "close", 5) ) c = _number();
+                else if( _is(k, "volume", 6) ) v = _number();
+                else _skip_value();
+            }while( _consume(',') );
+            _expect('}');
+        }
+
+        sink.push_back( dt == dt ? static_cast<long long>(dt) : 0,
+                        o, h, l, c,
+                        v == v ? static_cast<long long>(v) : 0 );
+    }
+
+    /* only counts; candles are skipped, not decoded */
+    struct Counter{
+        size_t n;
+    };
+
+    void
+    _candle(Counter& counter)
+    {
+        _skip_value();
+        ++counter.n;
+    }
+
+    template<typename Sink>
+    void
+    _scan(Sink& sink)
+    {
+        _expect('{');
+        if( _consume('}') )
+            return;
+        do{
+            slice_ty k = _string();
+            _expect(':');
+            if( !_is(k, "candles", 7) ){
+                _skip_value();
+                continue;
+            }
+            _expect('[');
+            if( _consume(']') )
+                continue;
+            do{
+                _candle(sink);
+            }while( _consume(',') );
+            _expect(']');
+        }while( _consume(',') );
+        _expect('}');
+    }
+
+public:
+    CandleScanner(const char* data, size_t n)
+        : JsonScanner(data, n)
+        {}
+
+    template<typename Sink>
+    void
+    scan(Sink& sink)
+    {
+        try{
+            _scan(sink);
+        }catch( Fail& ){
+            TDMA_API_THROW(ValueException, "failed to decode candles");
+        }
+    }
+
+    size_t
+    count()
+    {
+        Counter counter{0};
+        scan(counter);
+        return counter.n;
+    }
+};
+
+
+/* writes straight into a Candles_C block sized by CandleScanner::count */
+struct CandleBlock{
+    Candles_C *pcandles;
+    size_t i;
+
+    void
+    push_back( long long dt,
+               double o,
+               double h,
+               double l,
+               double c,
+               long long v )
+    {
+        if( i >= pcandles->n )
+            TDMA_API_THROW(ValueException, "failed to decode candles");
+        pcandles->datetime[i] = dt;
+        pcandles->open[i] = o;
+        pcandles->high[i] = h;
+        pcandles->low[i] = l;
+        pcandles->close[i] = c;
+        pcandles->volume[i] = v;
+        ++i;
+    }
+};
+
+
+/* ONE block - [datetime][open][high][low][close][volume] */
+int
+alloc_candles(size_t n, Candles_C *pcandles, bool allow_exceptions)
+{
+    static_assert( sizeof(long long) == sizeof(double),
+                   "Candles_C block layout assumes 8 byte fields" );
+
+    pcandles->n = n;
+
+    char *block;
+    int err = alloc_to_buffer(&block, (n ? n : 1) * sizeof(double) * 6,
+                              allow_exceptions);
+    if( err ){
+        memset(pcandles, 0, sizeof(Candles_C));
+        return err;
+    }
+
+    size_t sz = n * sizeof(double);
+    pcandles->datetime = reinterpret_cast<long long*>(block);
+    pcandles->open = reinterpret_cast<double*>(block + sz);
+    pcandles->high = reinterpret_cast<double*>(block + sz * 2);
+    pcandles->low = reinterpret_cast<double*>(block + sz * 3);
+    pcandles->close = reinterpret_cast<double*>(block + sz * 4);
+    pcandles->volume = reinterpret_cast<long long*>(block + sz * 5);
+    return 0;
+}
+
+} /* namespace */
+
+
+namespace tdma{
+
+void
+CandleColumns::reserve(size_t n)
+{
+    datetime.reserve(n);
+    open.reserve(n);
+    high.reserve(n);
+    low.reserve(n);
+    close.reserve(n);
+    volume.reserve(n);
+}
+
+void
+CandleColumns::clear()
+{
+    datetime.clear();
+    open.clear();
+    high.clear();
+    low.clear();
+    close.clear();
+    volume.clear();
+}
+
+void
+CandleColumns::push_back( long long dt,
+                          double o,
+                          double h,
+                          double l,
+                          double c,
+                          long long v )
+{
+    datetime.push_back(dt);
+    open.push_back(o);
+    high.push_back(h);
+    low.push_back(l);
+    close.push_back(c);
+    volume.push_back(v);
+}
+
+void
+decode_candles(const char* data, size_t n, CandleColumns& columns)
+{
+    if( !data || n == 0 )
+        return;
+
+    /*
+     * one candle is ~100 bytes of json; reserving up front means the
+     * columns are (usually) allocated once
+     */
+    columns.reserve( columns.size() + n / 96 );
+    CandleScanner(data, n).scan(columns);
+}
+
+void
+decode_candles(const char* data, size_t n, Candles_C *pcandles)
+{
+    memset(pcandles, 0, sizeof(Candles_C));
+
+    /* count first so the block is allocated once, at its final size */
+    size_t ncandles = (data && n) ? CandleScanner(data, n).count() : 0;
+    alloc_candles(ncandles, pcandles, true);
+    if( !ncandles )
+        return;
+
+    CandleBlock sink{pcandles, 0};
+    try{
+        CandleScanner(data, n).scan(sink);
+    }catch(...){
+        FreeCandles_ABI(pcandles, 0);
+        throw;
+    }
+}
+
+int
+candles_to_abi( const CandleColumns& columns,
+                Candles_C *pcandles,
+                bool allow_exceptions )
+{
+    size_t n = columns.size();
+    int err = alloc_candles(n, pcandles, allow_exceptions);
+    if( err )
+        return err;
+
+    if( n ){
+        size_t sz = n * sizeof(double);
+        memcpy(pcandles->datetime, columns.datetime.data(), sz);
+        memcpy(pcandles->open, columns.open.data(), sz);
+        memcpy(pcandles->high, columns.high.data(), sz);
+        memcpy(pcandles->low, columns.low.data(), sz);
+        memcpy(pcandles->close, columns.close.data(), sz);
+        memcpy(pcandles->volume, columns.volume.data(), sz);
+    }
+    return 0;
+}
+
+} /* tdma */
+
+
+using namespace tdma;
+
+int
+FreeCandles_ABI( Candles_C *pcandles, int allow_exceptions )
+{
+    if( pcandles ){
+        /* 'datetime' is the start of the block */
+        if( pcandles->datetime )
+            free( (void*)pcandles->datetime );
+        memset(pcandles, 0, sizeof(Candles_C));
+    }
+    return 0;
+}
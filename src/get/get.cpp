@@ -20,6 +20,7 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <regex>
 #include <cctype>
 #include <mutex>
+#include <thread>
 #include <string.h>
 
 #include "../../include/_tdma_api.h"
@@ -34,100 +35,207 @@ namespace tdma{
 
 const milliseconds APIGetterImpl::DEF_WAIT_MSEC(500);
 
-milliseconds APIGetterImpl::wait_msec(APIGetterImpl::DEF_WAIT_MSEC);
-milliseconds APIGetterImpl::last_get_msec(
-    util::get_msec_since_epoch<conn::clock_ty>()
-    );
-
-std::mutex APIGetterImpl::get_mtx;
+/*
+ * 'all' is the global budget (the old wait_msec behavior) and every get
+ * draws from it; the per-family buckets are disabled (0 msec) by default
+ */
+RateLimiter APIGetterImpl::rate_limiters[] = {
+    {APIGetterImpl::DEF_WAIT_MSEC, 1}, /* all */
+    {milliseconds(0), 1}, /* market_data */
+    {milliseconds(0), 1}, /* accounts */
+    {milliseconds(0), 1} /* instruments */
+};
 
 APIGetterImpl::APIGetterImpl( Credentials& creds,
                               api_on_error_cb_ty on_error_callback )
     :
         _on_error_callback(on_error_callback),
         _credentials(creds),
-        _connection()
+        _connection(),
+        _endpoint_family(EndpointFamilyType::all),
+        _in_flight( new InFlightGuard() )
     {
     }
 
+APIGetterImpl::~APIGetterImpl()
+{
+    if( _in_flight ){
+        _in_flight->acquire();
+        _in_flight->release();
+    }
+}
+
 void
 APIGetterImpl::set_url(string url)
-{ _connection.SET_url(url); }
+{
+    _connection.SET_url(url);
+    _endpoint_family = endpoint_family_from_url(url);
+}
 
 string
 APIGetterImpl::get()
+{ return get_buffer().str(); }
+
+conn::ResponseBuffer
+APIGetterImpl::get_buffer()
 {
     if( is_closed() )
         TDMA_API_THROW(APIException, "connection is closed");
 
-    assert( !_connection.is_closed() );
-    return APIGetterImpl::throttled_get(*this);
+    if( !_check_request() )
+        return conn::ResponseBuffer();
+
+    _in_flight->acquire();
+    try{
+        conn::ResponseBuffer b = APIGetterImpl::throttled_get(*this);
+        _in_flight->release();
+        return b;
+    }catch(...){
+        _in_flight->release();
+        throw;
+    }
+}
+
+void
+APIGetterImpl::get_async(connect_async_cb_ty callback)
+{
+    _in_flight->acquire();
+    if( is_closed() ){
+        _in_flight->release();
+        TDMA_API_THROW(APIException, "connection is closed");
+    }
+
+    InFlightGuard *guard = _in_flight.get();
+    try{
+        if( !_check_request() ){
+            /* nothing to request; still call back from a library thread */
+            conn::CurlConnection::execute_blocking(
+                [guard, callback](){
+                    guard->release();
+                    callback(string(), nullptr);
+                } );
+            return;
+        }
+    }catch(...){
+        guard->release();
+        throw;
+    }
+
+    /* throttle by delaying the start inside the engine, not by sleeping */
+    auto tp = reserve(_endpoint_family);
+    record_throttle_wait( _connection.GET_url(), tp - conn::clock_ty::now() );
+
+    try{
+        connect_get_async( _connection, _credentials, _on_error_callback,
+                           [guard, callback](string s, std::exception_ptr e){
+                               /* release first, callback may destroy us */
+                               guard->release();
+                               callback(s, e);
+                           },
+                           tp );
+    }catch(...){
+        guard->release();
+        throw;
+    }
 }
 
 void
 APIGetterImpl::close()
-{ _connection.close(); }
+{
+    if( _in_flight )
+        _in_flight->acquire();
+    _connection.close();
+    if( _in_flight )
+        _in_flight->release();
+}
 
 bool
 APIGetterImpl::is_closed() const
 { return !_connection; }
 
-string
-APIGetterImpl::throttled_get(APIGetterImpl& getter)
+EndpointFamilyType
+APIGetterImpl::endpoint_family_from_url(const string& url)
+{
+    if( url.compare(0, URL_MARKETDATA.size(), URL_MARKETDATA) == 0 )
+        return EndpointFamilyType::market_data;
+    if( url.compare(0, URL_INSTRUMENTS.size(), URL_INSTRUMENTS) == 0 )
+        return EndpointFamilyType::instruments;
+    /* accounts/ and userprincipals */
+    return EndpointFamilyType::accounts;
+}
+
+conn::clock_ty::time_point
+APIGetterImpl::reserve(EndpointFamilyType endpoint_family)
 {
     /*
-     * get_mtx allows threaded api execution from different getters in
-     * different threads AND the same getter in different threads.
-     *
-     * IT DOESN'T HANDLE OTHER OTHER SYNC ISSUES INSIDE THE CurlConnection
-     * CLASSES.
+     * reserve from the family bucket first and chain into the global one
+     * so the 'all' slots are handed out in the order requests actually go
+     * out. NO lock is held while we sleep or do I/O.
      */
-    std::lock_guard<std::mutex> _(get_mtx);
-    auto remaining = throttled_wait_remaining();
-    if( remaining.count() > 0 ){
-        /*
-         * wait_msec and last_get_msec provide a global throttling mechanism
-         * for ALL get requests to avoid excessive calls to TDMA servers
-         */
-        assert( remaining <= wait_msec );
-        std::this_thread::sleep_for( remaining );
-    }
-
-    string s;
-    conn::clock_ty::time_point tp;
-    tie(s, tp) = connect_get( getter._connection, getter._credentials,
-                              getter._on_error_callback );
-
-    last_get_msec =
-        std::chrono::duration_cast<milliseconds>(tp.time_since_epoch());
-    return s;
+    auto tp = RateLimiter::clock_ty::now();
+    if( endpoint_family != EndpointFamilyType::all )
+        tp = rate_limiters[static_cast<int>(endpoint_family)].reserve(tp);
+    return rate_limiters[static_cast<int>(EndpointFamilyType::all)].reserve(tp);
 }
 
-milliseconds
-APIGetterImpl::throttled_wait_remaining()
+void
+APIGetterImpl::throttle(EndpointFamilyType endpoint_family)
+{ std::this_thread::sleep_until( reserve(endpoint_family) ); }
+
+conn::ResponseBuffer
+APIGetterImpl::throttled_get(APIGetterImpl& getter)
 {
-    auto elapsed = util::get_msec_since_epoch<conn::clock_ty>() - last_get_msec;
-    assert( elapsed.count() >= 0 );
-    return wait_msec - elapsed;
+    /*
+     * reserve() only paces requests across getters/threads; it doesn't
+     * serialize them. The caller MUST hold the getter's _in_flight guard:
+     * the connection (curl handle, response buffer) isn't thread-safe.
+     */
+    auto tp = reserve(getter._endpoint_family);
+    record_throttle_wait( getter._connection.GET_url(),
+                          tp - conn::clock_ty::now() );
+    std::this_thread::sleep_until(tp);
+
+    return connect_get_buffer( getter._connection, getter._credentials,
+                               getter._on_error_callback ).first;
 }
 
 milliseconds
 APIGetterImpl::wait_remaining()
 {
-    static const milliseconds ms0(0);
-    return max(throttled_wait_remaining(), ms0);
+    return rate_limiters[static_cast<int>(EndpointFamilyType::all)]
+        .wait_remaining();
 }
 
 void
 APIGetterImpl::set_wait_msec(milliseconds msec)
 {
-    std::lock_guard<std::mutex> _(get_mtx);
-    wait_msec = msec;
+    rate_limiters[static_cast<int>(EndpointFamilyType::all)]
+        .set_interval(msec);
 }
 
 milliseconds
 APIGetterImpl::get_wait_msec()
-{ return wait_msec; }
+{
+    return rate_limiters[static_cast<int>(EndpointFamilyType::all)]
+        .get_interval();
+}
+
+void
+APIGetterImpl::set_rate_limit( EndpointFamilyType endpoint_family,
+                               milliseconds interval,
+                               unsigned int burst )
+{
+    if( burst == 0 )
+        TDMA_API_THROW(ValueException, "burst == 0");
+    rate_limiters[static_cast<int>(endpoint_family)].set(interval, burst);
+}
+
+std::pair<milliseconds, unsigned int>
+APIGetterImpl::get_rate_limit(EndpointFamilyType endpoint_family)
+{
+    auto& rl = rate_limiters[static_cast<int>(endpoint_family)];
+    return std::make_pair(rl.get_interval(), rl.get_burst());
+}
 
 } /* tdma */
 
@@ -140,10 +248,61 @@ APIGetter_Get_ABI( Getter_C *pgetter,
                    size_t *n,
                    int allow_exceptions )
 {
-    return ImplAccessor<char**>::template
-        get<APIGetterImpl>(
-            pgetter, &APIGetterImpl::get, buf, n, allow_exceptions
+    int err = proxy_is_callable<APIGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(buf, "buf", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    static auto meth = +[](void* obj){
+        return reinterpret_cast<APIGetterImpl*>(obj)->get_buffer();
+    };
+
+    conn::ResponseBuffer r;
+    std::tie(r, err) = CallImplFromABI(allow_exceptions, meth, pgetter->obj);
+    if( err )
+        return err;
+
+    /* hand the client the buffer curl wrote into (freed by FreeBuffer_ABI) */
+    try{
+        *buf = r.release(n);
+    }catch( std::bad_alloc& ){
+        return HANDLE_ERROR( MemoryError, "failed to allocate buffer memory",
+                             allow_exceptions );
+    }
+    return 0;
+}
+
+int
+APIGetter_GetAsync_ABI( Getter_C *pgetter,
+                        get_async_cb_ty callback,
+                        void *ctx,
+                        int allow_exceptions )
+{
+    int err = proxy_is_callable<APIGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(callback, "callback", allow_exceptions);
+
+    static auto meth = +[](void* obj, get_async_cb_ty cb, void *ctx){
+        reinterpret_cast<APIGetterImpl*>(obj)->get_async(
+            [cb, ctx](string s, std::exception_ptr eptr){
+                if( !eptr ){
+                    cb(0, s.c_str(), s.size() + 1, ctx);
+                    return;
+                }
+                /* error code and message in place of the data */
+                int code;
+                string msg;
+                error_from_exception(eptr, &code, &msg);
+                cb(code, msg.c_str(), msg.size() + 1, ctx);
+            }
         );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, pgetter->obj, callback, ctx);
 }
 
 int
@@ -222,6 +381,41 @@ APIGetter_WaitRemaining_ABI(unsigned long long *msec, int allow_exceptions)
     return 0;
 }
 
+int
+APIGetter_SetRateLimit_ABI( int endpoint_family,
+                            unsigned long long interval_msec,
+                            unsigned int burst,
+                            int allow_exceptions )
+{
+    CHECK_ENUM(EndpointFamilyType, endpoint_family, allow_exceptions);
+
+    static auto meth = +[](int f, unsigned long long i, unsigned int b){
+        APIGetterImpl::set_rate_limit( static_cast<EndpointFamilyType>(f),
+                                       milliseconds(i), b );
+    };
+
+    return CallImplFromABI( allow_exceptions, meth, endpoint_family,
+                            interval_msec, burst );
+}
+
+int
+APIGetter_GetRateLimit_ABI( int endpoint_family,
+                            unsigned long long *interval_msec,
+                            unsigned int *burst,
+                            int allow_exceptions )
+{
+    CHECK_ENUM(EndpointFamilyType, endpoint_family, allow_exceptions);
+    CHECK_PTR(interval_msec, "interval_msec", allow_exceptions);
+    CHECK_PTR(burst, "burst", allow_exceptions);
+
+    auto rl = APIGetterImpl::get_rate_limit(
+        static_cast<EndpointFamilyType>(endpoint_family)
+        );
+    *interval_msec = static_cast<unsigned long long>(rl.first.count());
+    *burst = rl.second;
+    return 0;
+}
+
 int
 PeriodType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
 {
@@ -579,3 +773,22 @@ OrderStatusType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
         throw std::runtime_error("invalid OrderStatusType");
     }
 }
+
+int
+EndpointFamilyType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
+{
+    CHECK_ENUM(EndpointFamilyType, v, allow_exceptions);
+
+    switch(static_cast<EndpointFamilyType>(v)){
+    case EndpointFamilyType::all:
+        return to_new_char_buffer("all", buf, n, allow_exceptions);
+    case EndpointFamilyType::market_data:
+        return to_new_char_buffer("market_data", buf, n, allow_exceptions);
+    case EndpointFamilyType::accounts:
+        return to_new_char_buffer("accounts", buf, n, allow_exceptions);
+    case EndpointFamilyType::instruments:
+        return to_new_char_buffer("instruments", buf, n, allow_exceptions);
+    default:
+        throw std::runtime_error("invalid EndpointFamilyType");
+    }
+}
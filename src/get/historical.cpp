@@ -24,6 +24,7 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 
 #include "../../include/_tdma_api.h"
 #include "../../include/_get.h"
+#include "../../include/candle_store.h"
 
 using std::string;
 using std::vector;
@@ -129,6 +130,14 @@ public:
         build();
     }
 
+    /* decode the response buffer straight into the ABI block; no json DOM */
+    void
+    get_candles(Candles_C *pcandles)
+    {
+        conn::ResponseBuffer b = get_buffer();
+        decode_candles(b.data(), b.size(), pcandles);
+    }
+
 };
 
 
@@ -192,6 +201,17 @@ class HistoricalPeriodGetterImpl
         }
     }
 
+    bool
+    _check_request()
+    {
+        _throw_if_invalid_frequency_type(_period_type, get_frequency_type());
+        /* NOTE - we have to wait to check frequency type against period_type
+         *        until here to allow the client to make both set calls without
+         *        the first triggering an exception from the stale values
+         *        to be changed by the second call */
+        return HistoricalGetterBaseImpl::_check_request();
+    }
+
 public:
     typedef HistoricalPeriodGetter ProxyType;
     static const int TYPE_ID_LOW = TYPE_ID_GETTER_HISTORICAL_PERIOD;
@@ -244,17 +264,6 @@ public:
     long long
     get_msec_since_epoch() const
     { return _msec_since_epoch; }
-
-    string
-    get()
-    {
-        _throw_if_invalid_frequency_type(_period_type, get_frequency_type());
-        /* NOTE - we have to wait to check frequency type against period_type
-         *        until here to allow the client to make both set calls without
-         *        the first triggering an exception from the stale values
-         *        to be changed by the second call */
-        return HistoricalGetterBaseImpl::get();
-    }
 };
 
 
@@ -334,8 +343,100 @@ public:
        _start_msec_since_epoch = start_msec_since_epoch;
        build();
    }
+
+   /*
+    * fetch only what the candle store is missing for [start, end] (in
+    * windows, throttled as usual), store it, and return a zero-copy view
+    * of the stored range
+    */
+   CandleStoreView
+   get_stored_candles()
+   {
+       std::shared_ptr<CandleStoreFile> file = CandleStore::instance().open(
+           get_symbol(), get_frequency_type(), get_frequency(),
+           is_extended_hours()
+           );
+
+       unsigned long long start = _start_msec_since_epoch;
+       unsigned long long end = _end_msec_since_epoch;
+       unsigned long long span = backfill_window_msec( get_frequency_type() );
+
+       try{
+           for( auto& gap : file->missing(start, end) ){
+               unsigned long long beg = gap.first;
+               do{
+                   unsigned long long wend = beg + span - 1;
+                   if( wend < beg || wend > gap.second )
+                       wend = gap.second;
+
+                   _start_msec_since_epoch = beg;
+                   _end_msec_since_epoch = wend;
+                   _build();
+
+                   conn::ResponseBuffer b = get_buffer();
+                   CandleColumns c;
+                   decode_candles(b.data(), b.size(), c);
+                   file->insert(beg, wend, c);
+
+                   beg = wend + 1;
+               }while( beg <= gap.second && beg != 0 );
+           }
+       }catch(...){
+           _start_msec_since_epoch = start;
+           _end_msec_since_epoch = end;
+           _build();
+           throw;
+       }
+
+       _start_msec_since_epoch = start;
+       _end_msec_since_epoch = end;
+       _build();
+       return file->view(start, end);
+   }
 };
 
+
+HistoricalRangeFetcher::HistoricalRangeFetcher( Credentials& creds,
+                                                FrequencyType frequency_type,
+                                                unsigned int frequency,
+                                                bool extended_hours )
+    :
+        _creds(creds),
+        _frequency_type(frequency_type),
+        _frequency(frequency),
+        _extended_hours(extended_hours),
+        _getter()
+    {
+    }
+
+HistoricalRangeFetcher::~HistoricalRangeFetcher()
+{}
+
+size_t
+HistoricalRangeFetcher::fetch( const string& symbol,
+                               unsigned long long start_msec_since_epoch,
+                               unsigned long long end_msec_since_epoch,
+                               CandleColumns& columns )
+{
+    /* the getter (and its connection) is created once and reused */
+    if( !_getter ){
+        _getter.reset(
+            new HistoricalRangeGetterImpl( _creds, symbol, _frequency_type,
+                                           _frequency, start_msec_since_epoch,
+                                           end_msec_since_epoch,
+                                           _extended_hours )
+            );
+    }else{
+        _getter->set_symbol(symbol);
+        _getter->set_start_msec_since_epoch(start_msec_since_epoch);
+        _getter->set_end_msec_since_epoch(end_msec_since_epoch);
+    }
+
+    conn::ResponseBuffer b = _getter->get_buffer();
+    decode_candles(b.data(), b.size(), columns);
+    return b.size();
+}
+
 } /* tdma */
 
 
@@ -352,6 +453,25 @@ HistoricalGetterBase_GetSymbol_ABI( Getter_C *pgetter,
         );
 }
 
+int
+HistoricalGetterBase_GetCandles_ABI( Getter_C *pgetter,
+                                     Candles_C *pcandles,
+                                     int allow_exceptions )
+{
+    int err = proxy_is_callable<HistoricalGetterBaseImpl>(pgetter,
+                                                          allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(pcandles, "candles", allow_exceptions);
+
+    static auto meth = +[](void* obj, Candles_C *p){
+        reinterpret_cast<HistoricalGetterBaseImpl*>(obj)->get_candles(p);
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, pgetter->obj, pcandles);
+}
+
 int
 HistoricalGetterBase_SetSymbol_ABI( Getter_C *pgetter,
                                     const char *symbol,
@@ -593,6 +713,36 @@ HistoricalRangeGetter_Create_ABI( struct Credentials *pcreds,
     return 0;
 }
 
+int
+HistoricalRangeGetter_GetStoredCandles_ABI( HistoricalRangeGetter_C *pgetter,
+                                            CandleView_C *pview,
+                                            int allow_exceptions )
+{
+    int err = proxy_is_callable<HistoricalRangeGetterImpl>(pgetter,
+                                                           allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(pview, "view", allow_exceptions);
+
+    static auto meth = +[](void* obj){
+        return reinterpret_cast<HistoricalRangeGetterImpl*>(obj)
+            ->get_stored_candles();
+    };
+
+    CandleStoreView v;
+    std::tie(v, err) = CallImplFromABI(allow_exceptions, meth, pgetter->obj);
+    if( err )
+        return err;
+
+    pview->records = v.records;
+    pview->n = v.n;
+    pview->handle = reinterpret_cast<void*>(
+        new std::shared_ptr<const MappedFile>(v.mapping)
+        );
+    return 0;
+}
+
 int
 HistoricalRangeGetter_Destroy_ABI( HistoricalRangeGetter_C *pgetter,
                                    int allow_exceptions )
@@ -107,6 +107,10 @@ class QuotesGetterImpl
             _throw_if_bad_input(s);
     }
 
+    bool
+    _check_request()
+    { return !_symbols.empty(); }
+
 public:
     typedef QuotesGetter ProxyType;
     static const int TYPE_ID_LOW = TYPE_ID_GETTER_QUOTES;
@@ -121,10 +125,6 @@ public:
             _build();
         }
 
-    string
-    get()
-    { return _symbols.empty() ? string() : APIGetterImpl::get(); }
-
     set<string>
     get_symbols() const
     { return _symbols; }
@@ -0,0 +1,327 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#include <string>
+#include <map>
+#include <set>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+#include "../include/_tdma_api.h"
+
+using std::string;
+
+namespace {
+
+using namespace tdma;
+
+/* path segments we keep; anything else (ids, symbols etc.) -> '{}' */
+const std::set<string> ENDPOINT_WORDS = {
+    "v1", "marketdata", "quotes", "pricehistory", "chains", "hours",
+    "movers", "accounts", "orders", "savedorders", "transactions",
+    "instruments", "userprincipals", "preferences",
+    "streamersubscriptionkeys", "watchlists", "oauth2", "token"
+};
+
+/*
+ * "GET", "https://api.tdameritrade.com/v1/accounts/123/orders?x=y"
+ *     -> "GET /v1/accounts/{}/orders"
+ */
+string
+endpoint_from_url(const string& method, const string& url)
+{
+    size_t beg = url.find("://");
+    beg = url.find('/', beg == string::npos ? 0 : beg + 3);
+    if( beg == string::npos )
+        return method + " /";
+
+    size_t end = std::min(url.find('?', beg), url.find('#', beg));
+    if( end == string::npos )
+        end = url.size();
+
+    string path;
+    while( beg < end ){
+        size_t next = std::min(url.find('/', beg + 1), end);
+        string seg = url.substr(beg + 1, next - beg - 1);
+        if( !seg.empty() )
+            path += '/' + (ENDPOINT_WORDS.count(seg) ? seg : string("{}"));
+        beg = next;
+    }
+    return method + ' ' + (path.empty() ? string("/") : path);
+}
+
+size_t
+latency_bucket(double msec)
+{
+    size_t i = 0;
+    while( i < TDMA_API_LATENCY_BUCKETS - 1
+           && msec >= REQUEST_LATENCY_BUCKET_MSEC[i] )
+    {
+        ++i;
+    }
+    return i;
+}
+
+/*
+ * RequestStats - totals/maxes/histograms by endpoint; sums are kept in
+ * usec and only turned into means (msec) on the way out. Entry is POD so
+ * _entries[] and Entry() zero it.
+ */
+class RequestStats{
+    struct Entry{
+        unsigned long long count;
+        unsigned long long errors;
+        unsigned long long bytes_down;
+        unsigned long long bytes_up;
+        long long namelookup_usec;
+        long long connect_usec;
+        long long appconnect_usec;
+        long long starttransfer_usec;
+        long long total_usec;
+        long long total_max_usec;
+        unsigned long long total_hist[TDMA_API_LATENCY_BUCKETS];
+        unsigned long long throttle_count;
+        long long throttle_usec;
+        long long throttle_max_usec;
+        unsigned long long throttle_hist[TDMA_API_LATENCY_BUCKETS];
+
+        void
+        add(const Entry& e);
+
+        void
+        to_abi(RequestStats_C *pstats) const;
+    };
+
+    std::map<string, Entry> _entries;
+    mutable std::mutex _mtx;
+
+public:
+    void
+    record_request(const conn::RequestTiming& t);
+
+    void
+    record_throttle_wait(const string& url, long long usec);
+
+    std::set<string>
+    endpoints() const;
+
+    /* "" for all endpoints combined */
+    void
+    get(const string& endpoint, RequestStats_C *pstats) const;
+
+    void
+    reset();
+};
+
+/*
+ * never destroyed; the async engine (and other library threads) can
+ * still be recording while statics are torn down at exit
+ */
+RequestStats&
+request_stats()
+{
+    static RequestStats *stats = new RequestStats();
+    return *stats;
+}
+
+
+void
+RequestStats::Entry::add(const Entry& e)
+{
+    count += e.count;
+    errors += e.errors;
+    bytes_down += e.bytes_down;
+    bytes_up += e.bytes_up;
+    namelookup_usec += e.namelookup_usec;
+    connect_usec += e.connect_usec;
+    appconnect_usec += e.appconnect_usec;
+    starttransfer_usec += e.starttransfer_usec;
+    total_usec += e.total_usec;
+    total_max_usec = std::max(total_max_usec, e.total_max_usec);
+    throttle_count += e.throttle_count;
+    throttle_usec += e.throttle_usec;
+    throttle_max_usec = std::max(throttle_max_usec, e.throttle_max_usec);
+    for( size_t i = 0; i < TDMA_API_LATENCY_BUCKETS; ++i ){
+        total_hist[i] += e.total_hist[i];
+        throttle_hist[i] += e.throttle_hist[i];
+    }
+}
+
+void
+RequestStats::Entry::to_abi(RequestStats_C *pstats) const
+{
+    double n = count ? static_cast<double>(count) : 1.0;
+    pstats->count = count;
+    pstats->errors = errors;
+    pstats->bytes_down = bytes_down;
+    pstats->bytes_up = bytes_up;
+    pstats->namelookup_msec = namelookup_usec / n / 1000.0;
+    pstats->connect_msec = connect_usec / n / 1000.0;
+    pstats->appconnect_msec = appconnect_usec / n / 1000.0;
+    pstats->starttransfer_msec = starttransfer_usec / n / 1000.0;
+    pstats->total_msec = total_usec / n / 1000.0;
+    pstats->total_max_msec = total_max_usec / 1000.0;
+    pstats->throttle_count = throttle_count;
+    pstats->throttle_msec =
+        throttle_usec / (throttle_count ? throttle_count : 1.0) / 1000.0;
+    pstats->throttle_max_msec = throttle_max_usec / 1000.0;
+    memcpy(pstats->total_hist, total_hist, sizeof(total_hist));
+    memcpy(pstats->throttle_hist, throttle_hist, sizeof(throttle_hist));
+}
+
+void
+RequestStats::record_request(const conn::RequestTiming& t)
+{
+    string endpoint = endpoint_from_url(t.method, t.url);
+    bool ok = t.curl_code == CURLE_OK && t.code >= 200 && t.code < 300;
+
+    std::lock_guard<std::mutex> _(_mtx);
+    Entry& e = _entries[endpoint];
+    ++e.count;
+    if( !ok )
+        ++e.errors;
+    e.bytes_down += t.bytes_down;
+    e.bytes_up += t.bytes_up;
+    e.namelookup_usec += t.namelookup_usec;
+    e.connect_usec += t.connect_usec;
+    e.appconnect_usec += t.appconnect_usec;
+    e.starttransfer_usec += t.starttransfer_usec;
+    e.total_usec += t.total_usec;
+    e.total_max_usec = std::max(e.total_max_usec, t.total_usec);
+    ++e.total_hist[ latency_bucket(t.total_usec / 1000.0) ];
+}
+
+void
+RequestStats::record_throttle_wait(const string& url, long long usec)
+{
+    string endpoint = endpoint_from_url("GET", url);
+
+    std::lock_guard<std::mutex> _(_mtx);
+    Entry& e = _entries[endpoint];
+    ++e.throttle_count;
+    e.throttle_usec += usec;
+    e.throttle_max_usec = std::max(e.throttle_max_usec, usec);
+    ++e.throttle_hist[ latency_bucket(usec / 1000.0) ];
+}
+
+std::set<string>
+RequestStats::endpoints() const
+{
+    std::set<string> endpoints;
+    std::lock_guard<std::mutex> _(_mtx);
+    for( auto& e : _entries )
+        endpoints.insert(e.first);
+    return endpoints;
+}
+
+void
+RequestStats::get(const string& endpoint, RequestStats_C *pstats) const
+{
+    Entry total = Entry();
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        if( endpoint.empty() ){
+            for( auto& e : _entries )
+                total.add(e.second);
+        }else{
+            auto e = _entries.find(endpoint);
+            if( e == _entries.end() ){
+                TDMA_API_THROW( ValueException,
+                                "no stats for endpoint: " + endpoint );
+            }
+            total = e->second;
+        }
+    }
+    total.to_abi(pstats);
+}
+
+void
+RequestStats::reset()
+{
+    std::lock_guard<std::mutex> _(_mtx);
+    _entries.clear();
+}
+
+} /* namespace */
+
+
+namespace tdma{
+
+void
+record_request(const conn::RequestTiming& timing)
+{ request_stats().record_request(timing); }
+
+void
+record_throttle_wait(const string& url, conn::clock_ty::duration wait)
+{
+    using namespace std::chrono;
+    long long usec = duration_cast<microseconds>(wait).count();
+    request_stats().record_throttle_wait(url, usec > 0 ? usec : 0);
+}
+
+} /* tdma */
+
+
+using namespace tdma;
+
+int
+RequestStats_GetEndpoints_ABI( char ***buffers,
+                               size_t *n,
+                               int allow_exceptions )
+{
+    CHECK_PTR(buffers, "buffers", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    static auto meth = +[](){ return request_stats().endpoints(); };
+
+    int err;
+    std::set<string> endpoints;
+    std::tie(endpoints, err) = CallImplFromABI(allow_exceptions, meth);
+    if( err ){
+        *buffers = nullptr;
+        *n = 0;
+        return err;
+    }
+    return to_new_char_buffers(endpoints, buffers, n, allow_exceptions);
+}
+
+int
+RequestStats_Get_ABI( const char* endpoint,
+                      RequestStats_C *pstats,
+                      int allow_exceptions )
+{
+    CHECK_PTR(pstats, "stats", allow_exceptions);
+
+    static auto meth = +[](const char* e, RequestStats_C *p){
+        request_stats().get(e ? e : "", p);
+    };
+
+    int err = CallImplFromABI(allow_exceptions, meth, endpoint, pstats);
+    if( err )
+        memset(pstats, 0, sizeof(RequestStats_C));
+    return err;
+}
+
+int
+RequestStats_Reset_ABI(int allow_exceptions)
+{
+    static auto meth = +[](){ request_stats().reset(); };
+
+    return CallImplFromABI(allow_exceptions, meth);
+}
@@ -95,6 +95,10 @@ get_streamer_info(Credentials& creds)
         string addr = sinfo.at("streamerSocketUrl");
         si.url = "wss://" + addr + "/ws";
         si.primary_acct_id = j.at("primaryAccountId");
+        /* not fatal; only needed for ACCT_ACTIVITY */
+        auto i_keys = j.find("streamerSubscriptionKeys");
+        if( i_keys != j.end() && !i_keys->value("keys", json()).empty() )
+            si.subscription_key = (*i_keys)["keys"][0].at("key");
         si.encode_credentials();
     }catch(json::exception& e){
         TDMA_API_THROW(APIException,"failed to convert UserPrincipals JSON to"
@@ -167,6 +171,8 @@ streamer_service_from_str(string service_name)
         return StreamerServiceType::TIMESALE_FOREX;
     else if( service_name == "TIMESALE_OPTIONS" )
         return StreamerServiceType::TIMESALE_OPTIONS;
+    else if( service_name == "ACCT_ACTIVITY" )
+        return StreamerServiceType::ACCT_ACTIVITY;
     else
         TDMA_API_THROW(ValueException,"invalid service name: " + service_name);
 }
@@ -334,11 +340,58 @@ StreamerServiceType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
         return to_new_char_buffer("TIMESALE_FOREX", buf, n, allow_exceptions);
     case StreamerServiceType::TIMESALE_OPTIONS:
         return to_new_char_buffer("TIMESALE_OPTIONS", buf, n, allow_exceptions);
+    case StreamerServiceType::ACCT_ACTIVITY:
+        return to_new_char_buffer("ACCT_ACTIVITY", buf, n, allow_exceptions);
     default:
         throw std::runtime_error("Invalid StreamerServiceType");
     }
 }
 
+int
+AcctActivityMessageType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
+{
+    CHECK_ENUM(AcctActivityMessageType, v, allow_exceptions);
+
+    /* the names the server uses */
+    switch(static_cast<AcctActivityMessageType>(v)){
+    case AcctActivityMessageType::other:
+        return to_new_char_buffer("OTHER", buf, n, allow_exceptions);
+    case AcctActivityMessageType::subscribed:
+        return to_new_char_buffer("SUBSCRIBED", buf, n, allow_exceptions);
+    case AcctActivityMessageType::error:
+        return to_new_char_buffer("ERROR", buf, n, allow_exceptions);
+    case AcctActivityMessageType::broken_trade:
+        return to_new_char_buffer("BrokenTrade", buf, n, allow_exceptions);
+    case AcctActivityMessageType::manual_execution:
+        return to_new_char_buffer("ManualExecution", buf, n, allow_exceptions);
+    case AcctActivityMessageType::order_activation:
+        return to_new_char_buffer("OrderActivation", buf, n, allow_exceptions);
+    case AcctActivityMessageType::order_cancel_replace_request:
+        return to_new_char_buffer("OrderCancelReplaceRequest", buf, n,
+                                  allow_exceptions);
+    case AcctActivityMessageType::order_cancel_request:
+        return to_new_char_buffer("OrderCancelRequest", buf, n,
+                                  allow_exceptions);
+    case AcctActivityMessageType::order_entry_request:
+        return to_new_char_buffer("OrderEntryRequest", buf, n,
+                                  allow_exceptions);
+    case AcctActivityMessageType::order_fill:
+        return to_new_char_buffer("OrderFill", buf, n, allow_exceptions);
+    case AcctActivityMessageType::order_partial_fill:
+        return to_new_char_buffer("OrderPartialFill", buf, n, allow_exceptions);
+    case AcctActivityMessageType::order_rejection:
+        return to_new_char_buffer("OrderRejection", buf, n, allow_exceptions);
+    case AcctActivityMessageType::order_route:
+        return to_new_char_buffer("OrderRoute", buf, n, allow_exceptions);
+    case AcctActivityMessageType::too_late_to_cancel:
+        return to_new_char_buffer("TooLateToCancel", buf, n, allow_exceptions);
+    case AcctActivityMessageType::ur_out:
+        return to_new_char_buffer("UROUT", buf, n, allow_exceptions);
+    default:
+        throw std::runtime_error("Invalid AcctActivityMessageType");
+    }
+}
+
 
 /* TODO return actual strings for fields */
 #define DEF_TEMP_FIELD_TO_STRING(name) \
@@ -360,6 +413,7 @@ DEF_TEMP_FIELD_TO_STRING(NewsHeadlineSubscriptionField)
 DEF_TEMP_FIELD_TO_STRING(ChartEquitySubscriptionField)
 DEF_TEMP_FIELD_TO_STRING(ChartSubscriptionField)
 DEF_TEMP_FIELD_TO_STRING(TimesaleSubscriptionField)
+DEF_TEMP_FIELD_TO_STRING(AcctActivitySubscriptionField)
 
 #undef DEF_TEMP_FIELD_TO_STRING
 
@@ -0,0 +1,802 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "../../include/_streaming.h"
+#include "../../include/json_scanner.h"
+
+using std::vector;
+using std::string;
+
+namespace {
+
+using namespace tdma;
+
+enum class FieldKind : int {
+    text,      // char[] - truncated, NUL-terminated
+    character, // char - first char of a string
+    integer,   // long long
+    real,      // double
+    boolean    // int
+};
+
+/* where field 'field' of a service goes in its struct, and its bit */
+struct FieldSlot{
+    int field;
+    FieldKind kind;
+    size_t offset;
+    size_t size;
+    int bit;
+};
+
+/* a slot's field has to be its index in the table */
+template<size_t N>
+constexpr bool
+in_field_order(const FieldSlot (&table)[N], size_t i = 0)
+{ return i == N || (table[i].field == static_cast<int>(i)
+                    && in_field_order(table, i + 1)); }
+
+/* S::f gets field E::f (and sets bit b) */
+#define SLOT_EX(S, E, f, k, b) \
+    {static_cast<int>(E::f), FieldKind::k, offsetof(S, f), sizeof(S::f), \
+     static_cast<int>(b)}
+
+#define SLOT(S, E, f, k) SLOT_EX(S, E, f, k, E::f)
+
+#define Q(f, k) SLOT(QuoteUpdate_C, QuotesSubscriptionField, f, k)
+constexpr FieldSlot QUOTE_SLOTS[] = {
+    Q(symbol, text),
+    Q(bid_price, real),
+    Q(ask_price, real),
+    Q(last_price, real),
+    Q(bid_size, integer),
+    Q(ask_size, integer),
+    Q(ask_id, character),
+    Q(bid_id, character),
+    Q(total_volume, integer),
+    Q(last_size, integer),
+    Q(trade_time, integer),
+    Q(quote_time, integer),
+    Q(high_price, real),
+    Q(low_price, real),
+    Q(bid_tick, character),
+    Q(close_price, real),
+    Q(exchange_id, character),
+    Q(marginable, boolean),
+    Q(shortable, boolean),
+    Q(island_bid, real),
+    Q(island_ask, real),
+    Q(island_volume, integer),
+    Q(quote_day, integer),
+    Q(trade_day, integer),
+    Q(volatility, real),
+    Q(description, text),
+    Q(last_id, character),
+    Q(digits, integer),
+    Q(open_price, real),
+    Q(net_change, real),
+    Q(high_52_week, real),
+    Q(low_52_week, real),
+    Q(pe_ratio, real),
+    Q(dividend_amount, real),
+    Q(dividend_yeild, real),
+    Q(island_bid_size, integer),
+    Q(island_ask_size, integer),
+    Q(nav, real),
+    Q(fund_price, real),
+    Q(exchanged_name, text),
+    Q(dividend_date, text),
+    Q(regular_market_quote, boolean),
+    Q(regular_market_trade, boolean),
+    Q(regular_market_last_price, real),
+    Q(regular_market_last_size, integer),
+    Q(regular_market_trade_time, integer),
+    Q(regular_market_trade_day, integer),
+    Q(regular_market_net_change, real),
+    Q(security_status, text),
+    Q(mark, real),
+    Q(quote_time_as_long, integer),
+    Q(trade_time_as_long, integer),
+    Q(regular_market_trade_time_as_long, integer)
+};
+#undef Q
+
+#define O(f, k) SLOT(OptionUpdate_C, OptionsSubscriptionField, f, k)
+constexpr FieldSlot OPTION_SLOTS[] = {
+    O(symbol, text),
+    O(description, text),
+    O(bid_price, real),
+    O(ask_price, real),
+    O(last_price, real),
+    O(high_price, real),
+    O(low_price, real),
+    O(close_price, real),
+    O(total_volume, integer),
+    O(open_interest, integer),
+    O(volatility, real),
+    O(quote_time, integer),
+    O(trade_time, integer),
+    O(money_intrinsic_value, real),
+    O(quote_day, integer),
+    O(trade_day, integer),
+    O(expiration_year, integer),
+    O(multiplier, real),
+    O(digits, integer),
+    O(open_price, real),
+    O(bid_size, integer),
+    O(ask_size, integer),
+    O(last_size, integer),
+    O(net_change, real),
+    O(strike_price, real),
+    O(contract_type, character),
+    O(underlying, text),
+    O(expiration_month, integer),
+    O(deliverables, text),
+    O(time_value, real),
+    O(expiration_day, integer),
+    O(days_to_expiration, integer),
+    O(delta, real),
+    O(gamma, real),
+    O(theta, real),
+    O(vega, real),
+    O(rho, real),
+    O(security_status, text),
+    O(theoretical_option_value, real),
+    O(underlying_price, real),
+    O(uv_expiration_type, character),
+    O(mark, real)
+};
+#undef O
+
+#define F(f, k) \
+    SLOT(LevelOneFuturesUpdate_C, LevelOneFuturesSubscriptionField, f, k)
+constexpr FieldSlot FUTURES_SLOTS[] = {
+    F(symbol, text),
+    F(bid_price, real),
+    F(ask_price, real),
+    F(last_price, real),
+    F(bid_size, integer),
+    F(ask_size, integer),
+    F(ask_id, character),
+    F(bid_id, character),
+    F(total_volume, integer),
+    F(last_size, integer),
+    F(quote_time, integer),
+    F(trade_time, integer),
+    F(high_price, real),
+    F(low_price, real),
+    F(close_price, real),
+    F(exchange_id, character),
+    F(description, text),
+    F(last_id, character),
+    F(open_price, real),
+    F(net_change, real),
+    F(future_percent_change, real),
+    F(exchange_name, text),
+    F(security_status, text),
+    F(open_interest, integer),
+    F(mark, real),
+    F(tick, real),
+    F(tick_amount, real),
+    F(product, text),
+    F(future_price_format, text),
+    F(future_trading_hours, text),
+    F(future_is_tradable, boolean),
+    F(future_multiplier, real),
+    F(future_is_active, boolean),
+    F(future_settlement_price, real),
+    F(future_active_symbol, text),
+    F(future_expiration_date, integer)
+};
+#undef F
+
+#define X(f, k) \
+    SLOT(LevelOneForexUpdate_C, LevelOneForexSubscriptionField, f, k)
+constexpr FieldSlot FOREX_SLOTS[] = {
+    X(symbol, text),
+    X(bid_price, real),
+    X(ask_price, real),
+    X(last_price, real),
+    X(bid_size, integer),
+    X(ask_size, integer),
+    X(total_volume, integer),
+    X(last_size, integer),
+    X(quote_time, integer),
+    X(trade_time, integer),
+    X(high_price, real),
+    X(low_price, real),
+    X(close_price, real),
+    X(exchange_id, character),
+    X(description, text),
+    X(open_price, real),
+    X(net_change, real),
+    X(percent_change, real),
+    X(exchange_name, text),
+    X(digits, integer),
+    X(security_status, text),
+    X(tick, real),
+    X(tick_amount, real),
+    X(product, text),
+    X(trading_hours, text),
+    X(is_tradable, boolean),
+    X(market_maker, text),
+    X(high_52_week, real),
+    X(low_52_week, real),
+    X(mark, real)
+};
+#undef X
+
+#define T(f, k) SLOT(TimesaleTick_C, TimesaleSubscriptionField, f, k)
+constexpr FieldSlot TIMESALE_SLOTS[] = {
+    T(symbol, text),
+    T(trade_time, integer),
+    T(last_price, real),
+    T(last_size, real),
+    T(last_sequence, integer)
+};
+#undef T
+
+#define CE(f, k) SLOT(ChartBar_C, ChartEquitySubscriptionField, f, k)
+constexpr FieldSlot CHART_EQUITY_SLOTS[] = {
+    CE(symbol, text),
+    CE(open_price, real),
+    CE(high_price, real),
+    CE(low_price, real),
+    CE(close_price, real),
+    CE(volume, real),
+    CE(sequence, integer),
+    CE(chart_time, integer),
+    CE(chart_day, integer)
+};
+#undef CE
+
+/* CHART_FUTURES/OPTIONS fields -> the ChartEquitySubscriptionField bits */
+#define C(f, k) \
+    SLOT_EX(ChartBar_C, ChartSubscriptionField, f, k, \
+            ChartEquitySubscriptionField::f)
+constexpr FieldSlot CHART_SLOTS[] = {
+    C(symbol, text),
+    C(chart_time, integer),
+    C(open_price, real),
+    C(high_price, real),
+    C(low_price, real),
+    C(close_price, real),
+    C(volume, real)
+};
+#undef C
+
+#undef SLOT
+#undef SLOT_EX
+
+/* every field, in order, up to the last one the enum has */
+#define CHECK_SLOTS(slots, last) \
+static_assert( in_field_order(slots) \
+               && sizeof(slots) / sizeof(FieldSlot) \
+                   == static_cast<size_t>(last) + 1, \
+               #slots " don't match " #last )
+
+CHECK_SLOTS(QUOTE_SLOTS,
+            QuotesSubscriptionField::regular_market_trade_time_as_long);
+CHECK_SLOTS(OPTION_SLOTS, OptionsSubscriptionField::mark);
+CHECK_SLOTS(FUTURES_SLOTS,
+            LevelOneFuturesSubscriptionField::future_expiration_date);
+CHECK_SLOTS(FOREX_SLOTS, LevelOneForexSubscriptionField::mark);
+CHECK_SLOTS(TIMESALE_SLOTS, TimesaleSubscriptionField::last_sequence);
+CHECK_SLOTS(CHART_EQUITY_SLOTS, ChartEquitySubscriptionField::chart_day);
+CHECK_SLOTS(CHART_SLOTS, ChartSubscriptionField::volume);
+
+#undef CHECK_SLOTS
+
+
+/*
+ * ContentDecoder - decodes the 'content' array of a 'data' response:
+ *
+ *   [{"key":"SPY","delayed":false,"1":270.1,"2":270.11,...},...]
+ *
+ * into one struct per object. "key" is the symbol (field 0), numbered keys
+ * go through the slot table, anything else is skipped.
+ */
+class ContentDecoder
+        : private JsonScanner {
+
+    /* NUL-terminated copy of a literal/string for strtod etc. */
+    static bool
+    _copy(const slice_ty& s, char *buf, size_t n)
+    {
+        if( s.second == 0 || s.second >= n )
+            return false;
+        memcpy(buf, s.first, s.second);
+        buf[s.second] = 0;
+        return true;
+    }
+
+    static bool
+    _to_real(const slice_ty& s, double *d)
+    {
+        char buf[64];
+        char *e;
+        if( !_copy(s, buf, sizeof(buf)) )
+            return false;
+        *d = strtod(buf, &e);
+        return *e == 0;
+    }
+
+    static bool
+    _to_integer(const slice_ty& s, long long *ll)
+    {
+        char buf[64];
+        char *e;
+        if( !_copy(s, buf, sizeof(buf)) )
+            return false;
+        *ll = strtoll(buf, &e, 10);
+        if( *e == 0 )
+            return true;
+        /* e.g "100.0" */
+        double d = strtod(buf, &e);
+        *ll = static_cast<long long>(d);
+        return *e == 0;
+    }
+
+    static unsigned long
+    _hex4(const slice_ty& s, size_t j)
+    {
+        if( j + 4 > s.second )
+            throw Fail();
+        unsigned long cp = 0;
+        for( size_t k = j; k < j + 4; ++k ){
+            char c = s.first[k];
+            cp <<= 4;
+            if( c >= '0' && c <= '9' )
+                cp |= c - '0';
+            else if( c >= 'a' && c <= 'f' )
+                cp |= c - 'a' + 10;
+            else if( c >= 'A' && c <= 'F' )
+                cp |= c - 'A' + 10;
+            else
+                throw Fail();
+        }
+        return cp;
+    }
+
+    /*
+     * \uXXXX at s[j] ('u'), w/ the low half of a surrogate pair after it;
+     * leaves 'j' on the last hex digit. Lone surrogates fail (as in json)
+     */
+    static unsigned long
+    _code_point(const slice_ty& s, size_t& j)
+    {
+        unsigned long cp = _hex4(s, j + 1);
+        j += 4;
+        if( cp >= 0xDC00 && cp <= 0xDFFF )
+            throw Fail();
+        if( cp >= 0xD800 && cp <= 0xDBFF ){
+            if( j + 2 >= s.second || s.first[j + 1] != '\\'
+                || s.first[j + 2] != 'u' )
+            {
+                throw Fail();
+            }
+            unsigned long lo = _hex4(s, j + 3);
+            if( lo < 0xDC00 || lo > 0xDFFF )
+                throw Fail();
+            j += 6;
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+        }
+        return cp;
+    }
+
+    static size_t
+    _to_utf8(unsigned long cp, char *out)
+    {
+        if( cp < 0x80 ){
+            out[0] = static_cast<char>(cp);
+            return 1;
+        }
+        if( cp < 0x800 ){
+            out[0] = static_cast<char>(0xC0 | (cp >> 6));
+            out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+            return 2;
+        }
+        if( cp < 0x10000 ){
+            out[0] = static_cast<char>(0xE0 | (cp >> 12));
+            out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<char>(0xF0 | (cp >> 18));
+        out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 4;
+    }
+
+    /* unescaped into 'buf' (\uXXXX -> UTF-8); truncated w/o splitting one */
+    static void
+    _to_text(const slice_ty& s, char *buf, size_t n)
+    {
+        size_t i = 0;
+        for( size_t j = 0; j < s.second && i < n - 1; ++j ){
+            char c = s.first[j];
+            if( c == '\\' && j + 1 < s.second ){
+                c = s.first[++j];
+                switch( c ){
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u':{
+                    char u[4];
+                    size_t m = _to_utf8(_code_point(s, j), u);
+                    if( i + m > n - 1 ){
+                        buf[i] = 0;
+                        return;
+                    }
+                    memcpy(buf + i, u, m);
+                    i += m;
+                    continue;
+                }
+                }
+            }
+            buf[i++] = c;
+        }
+        buf[i] = 0;
+    }
+
+    /* false if the value is null (field stays unset) */
+    bool
+    _value(const FieldSlot& slot, char *base)
+    {
+        char *dest = base + slot.offset;
+        bool is_str = (_peek() == '"');
+        slice_ty v = is_str ? _string() : _literal();
+        if( !is_str && _is(v, "null", 4) )
+            return false;
+
+        switch( slot.kind ){
+        case FieldKind::text:
+            _to_text(v, dest, slot.size);
+            return true;
+        case FieldKind::character:
+            *dest = v.second ? v.first[0] : 0;
+            return true;
+        case FieldKind::integer:
+            if( _is(v, "true", 4) || _is(v, "false", 5) )
+                *reinterpret_cast<long long*>(dest) = (v.second == 4);
+            else if( !_to_integer(v, reinterpret_cast<long long*>(dest)) )
+                throw Fail();
+            return true;
+        case FieldKind::real:
+            if( !_to_real(v, reinterpret_cast<double*>(dest)) )
+                throw Fail();
+            return true;
+        case FieldKind::boolean:
+            if( _is(v, "true", 4) || _is(v, "false", 5) ){
+                *reinterpret_cast<int*>(dest) = (v.second == 4);
+            }else{
+                double d;
+                if( !_to_real(v, &d) )
+                    throw Fail();
+                *reinterpret_cast<int*>(dest) = (d != 0);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /* numbered key -> field index, or -1 */
+    static int
+    _field(const slice_ty& k)
+    {
+        if( k.second == 0 || k.second > 3 )
+            return -1;
+        int f = 0;
+        for( size_t i = 0; i < k.second; ++i ){
+            if( k.first[i] < '0' || k.first[i] > '9' )
+                return -1;
+            f = f * 10 + (k.first[i] - '0');
+        }
+        return f;
+    }
+
+    template<typename T, size_t N>
+    void
+    _object(const FieldSlot (&slots)[N], T& t)
+    {
+        char *base = reinterpret_cast<char*>(&t);
+        _expect('{');
+        if( _consume('}') )
+            return;
+        do{
+            auto k = _string();
+            _expect(':');
+            int f = _field(k);
+            const FieldSlot *slot = nullptr;
+            if( f >= 0 && f < static_cast<int>(N) )
+                slot = &slots[f];
+            else if( _is(k, "key", 3) )
+                slot = &slots[0];
+
+            if( !slot )
+                _skip_value();
+            else if( _value(*slot, base) )
+                t.fields |= (1ULL << slot->bit);
+        }while( _consume(',') );
+        _expect('}');
+    }
+
+public:
+    ContentDecoder(const char* data, size_t n)
+        : JsonScanner(data, n)
+        {}
+
+    template<typename T, size_t N>
+    void
+    decode(const FieldSlot (&slots)[N], vector<T>& out)
+    {
+        out.clear();
+        try{
+            _expect('[');
+            if( !_consume(']') ){
+                do{
+                    out.emplace_back( T() );
+                    _object(slots, out.back());
+                }while( _consume(',') );
+                _expect(']');
+            }
+            _skip_ws();
+            if( _p != _end )
+                throw Fail();
+        }catch( Fail& ){
+            TDMA_API_THROW( StreamingException,
+                            "failed to decode 'data' content" );
+        }
+    }
+};
+
+
+/* copy the fields set in 'update' over 'state' */
+template<typename T, size_t N>
+void
+merge(const FieldSlot (&slots)[N], T& state, const T& update)
+{
+    const char *from = reinterpret_cast<const char*>(&update);
+    char *to = reinterpret_cast<char*>(&state);
+    for( auto& slot : slots ){
+        if( update.fields & (1ULL << slot.bit) )
+            memcpy(to + slot.offset, from + slot.offset, slot.size);
+    }
+    state.fields |= update.fields;
+}
+
+
+/*
+ * ACCT_ACTIVITY 'data' ("3") is an XML message. We only need the text of a
+ * few elements so we just search for them; 'scope' limits the search to
+ * the element a value belongs to (e.g. the fill's <Quantity> is inside
+ * <ExecutionInformation>, the contra's isn't).
+ */
+typedef std::pair<const char*, const char*> xml_range_ty;
+
+/* contents of the first <tag ...>...</tag> in 'r'; {nullptr,nullptr} if none */
+xml_range_ty
+xml_element(xml_range_ty r, const char* tag)
+{
+    static const xml_range_ty NONE(nullptr, nullptr);
+
+    size_t n = strlen(tag);
+    for( const char *p = r.first; p && r.second - p > static_cast<long>(n);
+         ++p )
+    {
+        p = static_cast<const char*>( memchr(p, '<', r.second - p) );
+        if( !p || r.second - p <= static_cast<long>(n + 1) )
+            return NONE;
+        if( strncmp(p + 1, tag, n) )
+            continue;
+
+        const char *e = p + 1 + n;
+        if( *e != '>' && *e != ' ' && *e != '/' )
+            continue;
+        e = static_cast<const char*>( memchr(e, '>', r.second - e) );
+        if( !e )
+            return NONE;
+        if( e[-1] == '/' ) // <tag/>
+            return xml_range_ty(e, e);
+
+        const char *b = ++e;
+        string close = "</" + string(tag) + ">";
+        for( ; r.second - e >= static_cast<long>(close.size()); ++e ){
+            if( *e == '<' && !strncmp(e, close.c_str(), close.size()) )
+                return xml_range_ty(b, e);
+        }
+        return NONE;
+    }
+    return NONE;
+}
+
+void
+xml_text(xml_range_ty scope, const char* tag, char *buf, size_t n)
+{
+    xml_range_ty v = xml_element(scope, tag);
+    size_t len = 0;
+    if( v.first ){
+        len = std::min<size_t>(v.second - v.first, n - 1);
+        memcpy(buf, v.first, len);
+    }
+    buf[len] = 0;
+}
+
+double
+xml_real(xml_range_ty scope, const char* tag)
+{
+    char buf[64];
+    xml_text(scope, tag, buf, sizeof(buf));
+    return strtod(buf, nullptr);
+}
+
+AcctActivityMessageType
+acct_activity_message_type(const string& name)
+{
+    static const std::unordered_map<string, AcctActivityMessageType> TYPES{
+        {"SUBSCRIBED", AcctActivityMessageType::subscribed},
+        {"ERROR", AcctActivityMessageType::error},
+        {"BrokenTrade", AcctActivityMessageType::broken_trade},
+        {"ManualExecution", AcctActivityMessageType::manual_execution},
+        {"OrderActivation", AcctActivityMessageType::order_activation},
+        {"OrderCancelReplaceRequest",
+            AcctActivityMessageType::order_cancel_replace_request},
+        {"OrderCancelRequest", AcctActivityMessageType::order_cancel_request},
+        {"OrderEntryRequest", AcctActivityMessageType::order_entry_request},
+        {"OrderFill", AcctActivityMessageType::order_fill},
+        {"OrderPartialFill", AcctActivityMessageType::order_partial_fill},
+        {"OrderRejection", AcctActivityMessageType::order_rejection},
+        {"OrderRoute", AcctActivityMessageType::order_route},
+        {"TooLateToCancel", AcctActivityMessageType::too_late_to_cancel},
+        {"UROUT", AcctActivityMessageType::ur_out}
+    };
+
+    auto i = TYPES.find(name);
+    return (i == TYPES.end()) ? AcctActivityMessageType::other : i->second;
+}
+
+void
+decode_acct_activity_message(const json& j, AcctActivity_C& m)
+{
+    string acct = j.value("1", "");
+    string type = j.value("2", "");
+    string data = j.value("3", "");
+
+    m.message_type = static_cast<int>( acct_activity_message_type(type) );
+    m.leaves_quantity = -1;
+    strncpy(m.account, acct.c_str(), sizeof(m.account) - 1);
+
+    xml_range_ty all(data.c_str(), data.c_str() + data.size());
+    xml_range_ty order = xml_element(all, "Order");
+    if( !order.first )
+        return;
+
+    xml_text(order, "OrderKey", m.order_id, sizeof(m.order_id));
+    xml_text(order, "Symbol", m.symbol, sizeof(m.symbol));
+    xml_text(order, "OrderInstructions", m.instruction,
+             sizeof(m.instruction));
+    xml_text(all, "OriginalOrderId", m.original_order_id,
+             sizeof(m.original_order_id));
+    m.quantity = xml_real(order, "OriginalQuantity");
+    m.limit_price = xml_real(xml_element(order, "OrderPricing"), "Limit");
+
+    xml_range_ty exec = xml_element(all, "ExecutionInformation");
+    if( exec.first ){
+        m.execution_quantity = xml_real(exec, "Quantity");
+        m.execution_price = xml_real(exec, "ExecutionPrice");
+        if( xml_element(exec, "LeavesQuantity").first )
+            m.leaves_quantity = xml_real(exec, "LeavesQuantity");
+    }
+}
+
+} /* namespace */
+
+
+namespace tdma{
+
+void
+decode_quote_updates( const char* content,
+                      size_t n,
+                      vector<QuoteUpdate_C>& updates )
+{ ContentDecoder(content, n).decode(QUOTE_SLOTS, updates); }
+
+void
+decode_option_updates( const char* content,
+                       size_t n,
+                       vector<OptionUpdate_C>& updates )
+{ ContentDecoder(content, n).decode(OPTION_SLOTS, updates); }
+
+void
+decode_futures_updates( const char* content,
+                        size_t n,
+                        vector<LevelOneFuturesUpdate_C>& updates )
+{ ContentDecoder(content, n).decode(FUTURES_SLOTS, updates); }
+
+void
+decode_forex_updates( const char* content,
+                      size_t n,
+                      vector<LevelOneForexUpdate_C>& updates )
+{ ContentDecoder(content, n).decode(FOREX_SLOTS, updates); }
+
+void
+decode_timesale_ticks( const char* content,
+                       size_t n,
+                       vector<TimesaleTick_C>& ticks )
+{ ContentDecoder(content, n).decode(TIMESALE_SLOTS, ticks); }
+
+void
+decode_chart_bars( StreamerServiceType service,
+                   const char* content,
+                   size_t n,
+                   vector<ChartBar_C>& bars )
+{
+    if( service == StreamerServiceType::CHART_EQUITY )
+        ContentDecoder(content, n).decode(CHART_EQUITY_SLOTS, bars);
+    else
+        ContentDecoder(content, n).decode(CHART_SLOTS, bars);
+}
+
+void
+decode_acct_activity( const char* content,
+                      size_t n,
+                      vector<AcctActivity_C>& messages )
+{
+    /* low volume; json does the (XML) string unescaping for us */
+    messages.clear();
+    try{
+        json j = json::parse(content, content + n);
+        if( j.is_array() ){
+            for( auto& o : j ){
+                messages.emplace_back( AcctActivity_C() );
+                decode_acct_activity_message(o, messages.back());
+            }
+            return;
+        }
+    }catch( json::exception& ){
+    }
+    TDMA_API_THROW( StreamingException,
+                    "failed to decode ACCT_ACTIVITY 'data' content" );
+}
+
+void
+merge_update(QuoteUpdate_C& state, const QuoteUpdate_C& update)
+{ merge(QUOTE_SLOTS, state, update); }
+
+void
+merge_update(OptionUpdate_C& state, const OptionUpdate_C& update)
+{ merge(OPTION_SLOTS, state, update); }
+
+void
+merge_update( LevelOneFuturesUpdate_C& state,
+              const LevelOneFuturesUpdate_C& update )
+{ merge(FUTURES_SLOTS, state, update); }
+
+void
+merge_update( LevelOneForexUpdate_C& state,
+              const LevelOneForexUpdate_C& update )
+{ merge(FOREX_SLOTS, state, update); }
+
+} /* tdma */
@@ -22,11 +22,20 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <queue>
 #include <mutex>
 #include <memory>
+#include <atomic>
 #include <condition_variable>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <exception>
 
 #include "../../include/_streaming.h"
 #include "../../include/util.h"
 #include "../../include/websocket_connect.h"
+#include "../../include/json_scanner.h"
+#include "../../include/level_one_cache.h"
+#include "../../include/order_tracker.h"
+#include "../../include/callback_dispatcher.h"
 
 using std::string;
 using std::vector;
@@ -67,7 +76,342 @@ D(string msg, StreamingSessionImpl *obj)
 { util::debug_out("StreamingSessionImpl", msg, obj, cout); }
 
 
-set<string> active_accounts;
+/*
+ * primary accounts w/ an active session (one session per account); sessions
+ * for different accounts can start/stop from different threads
+ */
+class ActiveAccounts{
+    set<string> _accounts;
+    mutex _mtx;
+
+public:
+    /* false if already active */
+    bool
+    insert(const string& acct)
+    {
+        std::lock_guard<mutex> _(_mtx);
+        return _accounts.insert(acct).second;
+    }
+
+    void
+    erase(const string& acct)
+    {
+        std::lock_guard<mutex> _(_mtx);
+        _accounts.erase(acct);
+    }
+} active_accounts;
+
+
+/*
+ * DataFrameScanner - finds each entry of a 'data' frame w/o building a DOM:
+ *
+ *   {"data":[{"service":"QUOTE","timestamp":1540000000000,"command":"SUBS",
+ *             "content":[{"key":"SPY","1":270.1,...},...]},...]}
+ *
+ * For each entry we only pull out the service, the timestamp and the raw
+ * [begin, end) of the 'content' value. Anything else - other frame types,
+ * missing fields, bad JSON - returns false and the caller falls back to
+ * json::parse.
+ */
+class DataFrameScanner
+        : private JsonScanner {
+    const char *_begin;
+
+    unsigned long long
+    _timestamp()
+    {
+        auto n = _literal();
+        unsigned long long ts = 0;
+        for( size_t i = 0; i < n.second; ++i ){
+            char c = n.first[i];
+            if( c < '0' || c > '9' )
+                throw Fail();
+            ts = ts * 10 + (c - '0');
+        }
+        return ts;
+    }
+
+public:
+    struct Entry{
+        string service;
+        unsigned long long timestamp;
+        size_t content_offset; // [offset, offset + size) of the frame
+        size_t content_size;
+    };
+
+    DataFrameScanner(const char* data, size_t n)
+        : JsonScanner(data, n), _begin(data)
+        {}
+
+    bool
+    scan(vector<Entry>& entries)
+    {
+        entries.clear();
+        try{
+            _expect('{');
+            if( !_is(_string(), "data", 4) )
+                return false;
+            _expect(':');
+            _expect('[');
+            if( !_consume(']') ){
+                do{
+                    Entry e = {string(), 0, 0, 0};
+                    bool has_ts = false;
+                    _expect('{');
+                    do{
+                        auto k = _string();
+                        _expect(':');
+                        if( _is(k, "service", 7) ){
+                            auto s = _string();
+                            e.service.assign(s.first, s.second);
+                        }else if( _is(k, "timestamp", 9) ){
+                            e.timestamp = _timestamp();
+                            has_ts = true;
+                        }else if( _is(k, "content", 7) ){
+                            _peek();
+                            e.content_offset = _p - _begin;
+                            _skip_value();
+                            e.content_size = (_p - _begin) - e.content_offset;
+                        }else{
+                            _skip_value();
+                        }
+                    }while( _consume(',') );
+                    _expect('}');
+                    if( e.service.empty() || !has_ts || !e.content_size )
+                        return false;
+                    entries.push_back( std::move(e) );
+                }while( _consume(',') );
+                _expect(']');
+            }
+            _expect('}');
+            _skip_ws();
+            return _p == _end;
+        }catch( Fail& ){
+            return false;
+        }
+    }
+};
+
+
+/*
+ * ContentSplitter - finds each entry of a 'data' content array, and its
+ * "key", w/o building a DOM:
+ *
+ *   [{"key":"SPY","1":270.1,...},{"key":"QQQ",...}]
+ *
+ * Anything else returns false.
+ */
+class ContentSplitter
+        : private JsonScanner {
+    const char *_begin;
+
+public:
+    struct Entry{
+        size_t offset; // [offset, offset + size) of the content
+        size_t size;
+        const char *key; // raw, escapes left in place; nullptr if none
+        size_t key_size;
+    };
+
+    ContentSplitter(const char* data, size_t n)
+        : JsonScanner(data, n), _begin(data)
+        {}
+
+    bool
+    scan(vector<Entry>& entries)
+    {
+        entries.clear();
+        try{
+            _expect('[');
+            if( !_consume(']') ){
+                do{
+                    Entry e = {0, 0, nullptr, 0};
+                    _peek();
+                    e.offset = _p - _begin;
+                    _expect('{');
+                    if( !_consume('}') ){
+                        do{
+                            auto k = _string();
+                            _expect(':');
+                            if( _is(k, "key", 3) && _peek() == '"' ){
+                                auto v = _string();
+                                e.key = v.first;
+                                e.key_size = v.second;
+                            }else{
+                                _skip_value();
+                            }
+                        }while( _consume(',') );
+                        _expect('}');
+                    }
+                    e.size = (_p - _begin) - e.offset;
+                    entries.push_back(e);
+                }while( _consume(',') );
+                _expect(']');
+            }
+            _skip_ws();
+            return _p == _end;
+        }catch( Fail& ){
+            return false;
+        }
+    }
+};
+
+
+class Conflator;
+struct ConflatedEntry;
+
+/*
+ * DispatchTask - a dispatch shard's share of one 'data' message: JSON
+ * content (NUL-terminated) or 'n' packed typed updates for 'callback'; or
+ * a conflated entry that's waiting to be taken
+ */
+struct DispatchTask{
+    enum class Kind{
+        text, // pass as is
+        json_text, // parse and re-serialize first (like the DOM path)
+        quote,
+        option,
+        timesale,
+        chart,
+        acct_activity,
+        conflated
+    };
+
+    Kind kind;
+    StreamerServiceType service;
+    unsigned long long timestamp;
+    void(*callback)(); // the typed callback, by kind
+    size_t n;
+    vector<char> data;
+    Conflator *conflator;
+    ConflatedEntry *entry;
+
+    DispatchTask()
+        :
+            kind(Kind::text),
+            service(StreamerServiceType::NONE),
+            timestamp(0),
+            callback(nullptr),
+            n(0),
+            data(),
+            conflator(nullptr),
+            entry(nullptr)
+        {}
+};
+
+
+/*
+ * ConflatedEntry - what's changed for a service/symbol since the consumer
+ * last took it: a typed update ('record', by kind) w/ the union of the
+ * fields and their latest values, or the JSON content entry ('object')
+ */
+struct ConflatedEntry{
+    StreamerServiceType service;
+    bool dirty;
+    unsigned long long timestamp;
+    DispatchTask::Kind kind; // quote, option or json_text
+    void(*callback)(); // typed callback
+    vector<char> record;
+    json object;
+
+    ConflatedEntry()
+        :
+            service(StreamerServiceType::NONE),
+            dirty(false),
+            timestamp(0),
+            kind(DispatchTask::Kind::json_text),
+            callback(nullptr),
+            record(),
+            object()
+        {}
+};
+
+
+/*
+ * Conflator - a ConflatedEntry for each service/symbol, for ONE producer
+ * and ONE consumer:
+ *
+ * 1) the producer merges each update into its entry; only the first
+ *    update since the entry was last taken (it becomes 'dirty') needs to
+ *    be passed to the consumer, the rest are conflated into it.
+ *
+ * 2) the consumer takes what's there and the entry starts over, so a slow
+ *    consumer gets one (coalesced) update per symbol instead of a backlog.
+ *
+ * Entries aren't removed; their addresses don't change.
+ */
+class Conflator{
+    struct Key{
+        StreamerServiceType service;
+        string symbol;
+
+        bool
+        operator==(const Key& k) const
+        { return service == k.service && symbol == k.symbol; }
+    };
+
+    struct KeyHash{
+        size_t
+        operator()(const Key& k) const
+        {
+            return std::hash<string>()(k.symbol) * 31
+                   + static_cast<size_t>(k.service);
+        }
+    };
+
+    std::unordered_map<Key, ConflatedEntry, KeyHash> _entries;
+    mutex _mtx;
+
+public:
+    /*
+     * PRODUCER - merge(ConflatedEntry&) into the service/symbol entry;
+     * returns the entry if it just became dirty, nullptr if conflated
+     */
+    template<typename F>
+    ConflatedEntry*
+    merge(StreamerServiceType service, const string& symbol, F merge)
+    {
+        std::lock_guard<mutex> _(_mtx);
+        ConflatedEntry& e = _entries[ Key{service, symbol} ];
+        e.service = service;
+        merge(e);
+        if( e.dirty )
+            return nullptr;
+        e.dirty = true;
+        return &e;
+    }
+
+    /* CONSUMER - false if already taken */
+    bool
+    take(ConflatedEntry *e, ConflatedEntry& out)
+    {
+        std::lock_guard<mutex> _(_mtx);
+        if( !e->dirty )
+            return false;
+        out.service = e->service;
+        out.timestamp = e->timestamp;
+        out.kind = e->kind;
+        out.callback = e->callback;
+        out.record = e->record;
+        std::fill(e->record.begin(), e->record.end(), 0);
+        out.object = std::move(e->object);
+        e->object = json();
+        e->dirty = false;
+        return true;
+    }
+};
+
+/* FNV-1a; a symbol always maps to the same shard */
+size_t
+dispatch_shard(const char* symbol, size_t n, size_t nshards)
+{
+    unsigned long long h = 14695981039346656037ULL;
+    for( size_t i = 0; i < n; ++i ){
+        h ^= static_cast<unsigned char>(symbol[i]);
+        h *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(h % nshards);
+}
 
 
 class AdminSubscriptionImpl
@@ -170,10 +514,12 @@ public:
         {
         }
 
+    /* ACCT_ACTIVITY 'keys' is the (session's) subscription key */
     StreamingRequest( const StreamingSubscriptionImpl& subscription,
                       const string& account_id,
                       const string& source_id,
-                      int request_id )
+                      int request_id,
+                      const string& subscription_key )
         :
             _service( subscription.get_service() ),
             _command( subscription.get_command() ),
@@ -182,6 +528,13 @@ public:
             _request_id( request_id ),
             _parameters( subscription.get_parameters() )
         {
+            if( _service == StreamerServiceType::ACCT_ACTIVITY ){
+                if( subscription_key.empty() ){
+                    TDMA_API_THROW( StreamingException,
+                        "no streamer subscription key for ACCT_ACTIVITY" );
+                }
+                _parameters["keys"] = subscription_key;
+            }
         }
 
     json
@@ -210,13 +563,15 @@ public:
     StreamingRequests( const vector<StreamingSubscriptionImpl>& subscriptions,
                        const string& account_id,
                        const string& source_id,
-                       const vector<int>& request_ids )
+                       const vector<int>& request_ids,
+                       const string& subscription_key = "" )
         {
             assert( subscriptions.size() == request_ids.size() );
 
             for( size_t i = 0; i < subscriptions.size(); ++i ){
                 _requests.emplace_back( subscriptions[i], account_id,
-                                        source_id, request_ids[i] );
+                                        source_id, request_ids[i],
+                                        subscription_key );
             }
         }
 
@@ -260,7 +615,62 @@ class StreamingSessionImpl{
     int _next_request_id;
     bool _logged_in;
     bool _listening;
+    std::atomic<bool> _account_active; // we hold our entry in active_accounts
     QOSType _qos;
+    std::atomic<bool> _raw_data; // pass 'data' content through w/o a DOM
+    std::atomic<bool> _inline_processing; // for the next start
+    std::atomic<bool> _compression; // for the next start
+    conn::WebSocketClient::Stats _wire_stats; // current/last connection
+
+    struct TypedCallbacks{
+        std::atomic<quote_update_cb_ty> quote;
+        std::atomic<option_update_cb_ty> option;
+        std::atomic<timesale_tick_cb_ty> timesale;
+        std::atomic<chart_bar_cb_ty> chart;
+        std::atomic<acct_activity_cb_ty> acct_activity;
+
+        TypedCallbacks()
+            :
+                quote(nullptr),
+                option(nullptr),
+                timesale(nullptr),
+                chart(nullptr),
+                acct_activity(nullptr)
+            {}
+
+        bool
+        any() const
+        { return quote || option || timesale || chart || acct_activity; }
+    } _typed_callbacks;
+
+    std::atomic<bool> _level_one_cache_on;
+    LevelOneCache _level_one;
+    std::atomic<bool> _order_tracker_on;
+    OrderTracker _orders;
+    static const size_t DISPATCH_RING_CAPACITY = 1024;
+    std::atomic<size_t> _dispatch_threads; // for the next start
+    /* replaced before the listener thread starts; lock is for stats readers */
+    std::unique_ptr<CallbackDispatcher<DispatchTask>> _dispatcher;
+    mutable mutex _dispatcher_mtx;
+
+    static const int MAX_SERVICE_TYPE = 31;
+    static_assert( static_cast<int>(StreamerServiceType::ACCT_ACTIVITY)
+                   <= MAX_SERVICE_TYPE, "MAX_SERVICE_TYPE too small" );
+
+    struct ConflationCounts{
+        std::atomic<unsigned long long> updates;
+        std::atomic<unsigned long long> conflated;
+        std::atomic<unsigned long long> delivered;
+
+        ConflationCounts()
+            : updates(0), conflated(0), delivered(0)
+            {}
+    };
+
+    std::atomic<unsigned long> _conflate; // bit per StreamerServiceType
+    ConflationCounts _conflation_counts[MAX_SERVICE_TYPE + 1];
+    /* one per dispatch shard (or just the listener's); like _dispatcher */
+    vector<std::unique_ptr<Conflator>> _conflators;
     unsigned long long _last_heartbeat;
     ThreadSafeHashMap<int, PendingResponse> _responses_pending;
 
@@ -269,8 +679,27 @@ class StreamingSessionImpl{
         static const string RESPONSE_NOTIFY;
         static const string RESPONSE_SNAPSHOT;
         static const string RESPONSE_DATA;
+        /* most taken per pass w/o blocking, so conflated updates go out */
+        static const size_t MAX_BATCH_MESSAGES;
+        static const milliseconds MAX_BATCH_TIME;
 
         StreamingSessionImpl *_ss;
+        /* re-used across frames */
+        vector<DataFrameScanner::Entry> _data_entries;
+        vector<QuoteUpdate_C> _quotes;
+        vector<OptionUpdate_C> _options;
+        vector<LevelOneFuturesUpdate_C> _futures;
+        vector<LevelOneForexUpdate_C> _forex;
+        vector<TimesaleTick_C> _ticks;
+        vector<ChartBar_C> _bars;
+        vector<AcctActivity_C> _activity;
+        vector<ContentSplitter::Entry> _content_entries;
+        vector<size_t> _shard_of;
+        vector<ConflatedEntry*> _dirty; // w/o dispatch threads
+        /* inline mode; uWS thread only between start_/stop_inline */
+        bool _inline;
+        std::chrono::steady_clock::time_point _last_message;
+        std::exception_ptr _inline_error;
 
         class Timeout
             : public StreamingException {
@@ -281,8 +710,65 @@ class StreamingSessionImpl{
         void
         exec();
 
+        /* parse/callback on the client's uWS thread; we wait for the end */
+        void
+        exec_inline();
+
+        void
+        parse_inline(string& responses);
+
+        void
+        check_inline_timeout();
+
+        /* responses is scratch; raw data slices are NUL-terminated in place */
+        void
+        parse(string& responses);
+
+        bool
+        parse_data_scanned(string& responses);
+
+        bool
+        exec_decoded( StreamerServiceType service,
+                      unsigned long long timestamp,
+                      const char* content,
+                      size_t n );
+
+        template<typename T, typename F>
+        void
+        exec_typed( DispatchTask::Kind kind,
+                    F callback,
+                    StreamerServiceType service,
+                    unsigned long long timestamp,
+                    const vector<T>& updates );
+
         void
-        parse(const string& responses);
+        dispatch_content( DispatchTask::Kind kind,
+                          StreamerServiceType service,
+                          unsigned long long timestamp,
+                          const char* content,
+                          size_t n );
+
+        template<typename F>
+        void
+        conflate( StreamerServiceType service,
+                  const string& symbol,
+                  F merge );
+
+        template<typename T, typename F>
+        void
+        conflate_typed( DispatchTask::Kind kind,
+                        F callback,
+                        StreamerServiceType service,
+                        unsigned long long timestamp,
+                        const vector<T>& updates );
+
+        void
+        conflate_content( StreamerServiceType service,
+                          unsigned long long timestamp,
+                          const json& content );
+
+        void
+        flush_conflated();
 
         void
         parse_response_to_request(const json& response);
@@ -298,7 +784,12 @@ class StreamingSessionImpl{
 
     public:
         ListenerThreadTarget( StreamingSessionImpl *ss )
-            : _ss(ss) {}
+            :
+                _ss(ss),
+                _inline(ss->_inline_processing),
+                _last_message(),
+                _inline_error()
+            {}
 
         void
         operator()();
@@ -323,6 +814,21 @@ class StreamingSessionImpl{
     _subscribe( const vector<StreamingSubscriptionImpl>& subscriptions,
                 PendingResponse::response_cb_ty callback = nullptr );
 
+    /* on a dispatch worker */
+    void
+    _exec_dispatched(DispatchTask& task);
+
+    /* on a dispatch worker, or the listener w/o them */
+    void
+    _exec_conflated(Conflator& conflator, ConflatedEntry *entry);
+
+    bool
+    _conflating(StreamerServiceType service) const
+    {
+        return _conflate.load(std::memory_order_relaxed)
+               & (1UL << static_cast<int>(service));
+    }
+
     void
     _exec_callback( StreamingCallbackType cb_type,
                     StreamerServiceType ss_type,
@@ -360,7 +866,21 @@ public:
             _next_request_id(0),
             _logged_in(false),
             _listening(false),
+            _account_active(false),
             _qos( QOSType::fast ),
+            _raw_data(false),
+            _inline_processing(false),
+            _compression(false),
+            _wire_stats(),
+            _level_one_cache_on(false),
+            _level_one(),
+            _order_tracker_on(false),
+            _orders(),
+            _dispatch_threads(0),
+            _dispatcher(),
+            _dispatcher_mtx(),
+            _conflate(0),
+            _conflators(),
             _last_heartbeat(0),
             _responses_pending()
         {
@@ -403,6 +923,167 @@ public:
     bool
     set_qos(const QOSType& qos);
 
+    bool
+    get_raw_data() const
+    { return _raw_data; }
+
+    void
+    set_raw_data(bool raw_data)
+    { _raw_data = raw_data; }
+
+    bool
+    get_inline_processing() const
+    { return _inline_processing; }
+
+    /* takes effect the next time the session starts */
+    void
+    set_inline_processing(bool on)
+    { _inline_processing = on; }
+
+    bool
+    get_compression() const
+    { return _compression; }
+
+    /* takes effect the next time the session starts */
+    void
+    set_compression(bool on)
+    { _compression = on; }
+
+    void
+    get_wire_stats(StreamingWireStats_C *pstats) const
+    {
+        pstats->messages = _wire_stats.messages;
+        pstats->wire_bytes = _wire_stats.wire_bytes;
+        pstats->decoded_bytes = _wire_stats.decoded_bytes;
+        pstats->compressed = static_cast<int>(_wire_stats.compressed);
+    }
+
+    StreamingTypedCallbacks_C
+    get_typed_callbacks() const
+    {
+        return { _typed_callbacks.quote, _typed_callbacks.option,
+                 _typed_callbacks.timesale, _typed_callbacks.chart,
+                 _typed_callbacks.acct_activity };
+    }
+
+    void
+    set_typed_callbacks(const StreamingTypedCallbacks_C& callbacks)
+    {
+        _typed_callbacks.quote = callbacks.quote;
+        _typed_callbacks.option = callbacks.option;
+        _typed_callbacks.timesale = callbacks.timesale;
+        _typed_callbacks.chart = callbacks.chart;
+        _typed_callbacks.acct_activity = callbacks.acct_activity;
+    }
+
+    bool
+    get_level_one_cache() const
+    { return _level_one_cache_on; }
+
+    /* turning it off stops updates; what's there can still be read */
+    void
+    set_level_one_cache(bool on)
+    { _level_one_cache_on = on; }
+
+    const LevelOneCache&
+    level_one() const
+    { return _level_one; }
+
+    bool
+    get_order_tracker() const
+    { return _order_tracker_on; }
+
+    /* like the level one cache: off stops updates, state stays readable */
+    void
+    set_order_tracker(bool on)
+    { _order_tracker_on = on; }
+
+    const OrderTracker&
+    orders() const
+    { return _orders; }
+
+    size_t
+    get_dispatch_threads() const
+    { return _dispatch_threads; }
+
+    /* takes effect the next time the session starts */
+    void
+    set_dispatch_threads(size_t nthreads)
+    {
+        if( nthreads > STREAMING_MAX_DISPATCH_THREADS ){
+            TDMA_API_THROW( ValueException,
+                            "nthreads > STREAMING_MAX_DISPATCH_THREADS" );
+        }
+        _dispatch_threads = nthreads;
+    }
+
+    size_t
+    get_dispatch_shards() const
+    {
+        std::lock_guard<mutex> _(_dispatcher_mtx);
+        return _dispatcher ? _dispatcher->size() : 0;
+    }
+
+    /* services whose 'data' is state (not events) */
+    static bool
+    can_conflate(StreamerServiceType service)
+    {
+        switch( service ){
+        case StreamerServiceType::QUOTE:
+        case StreamerServiceType::OPTION:
+        case StreamerServiceType::LEVELONE_FUTURES:
+        case StreamerServiceType::LEVELONE_FOREX:
+        case StreamerServiceType::LEVELONE_FUTURES_OPTIONS:
+        case StreamerServiceType::ACTIVES_NASDAQ:
+        case StreamerServiceType::ACTIVES_NYSE:
+        case StreamerServiceType::ACTIVES_OTCBB:
+        case StreamerServiceType::ACTIVES_OPTIONS:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool
+    get_conflation(StreamerServiceType service) const
+    { return _conflating(service); }
+
+    void
+    set_conflation(StreamerServiceType service, bool on)
+    {
+        if( !can_conflate(service) ){
+            TDMA_API_THROW( ValueException,
+                            "can not conflate service: " + to_string(service) );
+        }
+        unsigned long bit = 1UL << static_cast<int>(service);
+        if( on )
+            _conflate.fetch_or(bit);
+        else
+            _conflate.fetch_and(~bit);
+    }
+
+    void
+    get_conflation_stats( StreamerServiceType service,
+                          StreamingConflationStats_C *pstats ) const
+    {
+        const ConflationCounts& c =
+            _conflation_counts[static_cast<int>(service)];
+        pstats->updates = c.updates;
+        pstats->conflated = c.conflated;
+        pstats->delivered = c.delivered;
+    }
+
+    void
+    get_dispatch_stats(size_t shard, StreamingDispatchStats_C *pstats) const
+    {
+        std::lock_guard<mutex> _(_dispatcher_mtx);
+        if( !_dispatcher ){
+            TDMA_API_THROW( ValueException,
+                            "invalid dispatch shard: " + to_string(shard) );
+        }
+        _dispatcher->stats(shard, pstats);
+    }
+
     string
     get_primary_account_id() const
     { return _streamer_info.primary_acct_id; }
@@ -413,6 +1094,8 @@ const string StreamingSessionImpl::ListenerThreadTarget::RESPONSE_TO_REQUEST("re
 const string StreamingSessionImpl::ListenerThreadTarget::RESPONSE_NOTIFY("notify");
 const string StreamingSessionImpl::ListenerThreadTarget::RESPONSE_SNAPSHOT("snapshot");
 const string StreamingSessionImpl::ListenerThreadTarget::RESPONSE_DATA("data");
+const size_t StreamingSessionImpl::ListenerThreadTarget::MAX_BATCH_MESSAGES(1000);
+const milliseconds StreamingSessionImpl::ListenerThreadTarget::MAX_BATCH_TIME(50);
 
 
 void
@@ -424,11 +1107,17 @@ StreamingSessionImpl::ListenerThreadTarget::operator()()
     _ss->_exec_callback( StreamingCallbackType::listening_start,
                         StreamerServiceType::NONE, 0, json() );
 
+    if( _ss->_dispatcher )
+        _ss->_dispatcher->start();
+
     StreamingCallbackType cb_t = StreamingCallbackType::listening_stop;
     json cb_j;
 
     try{
-        exec();
+        if( _inline )
+            exec_inline();
+        else
+            exec();
 
     }catch( Timeout& e ){
         /*
@@ -455,9 +1144,15 @@ StreamingSessionImpl::ListenerThreadTarget::operator()()
          */
         D(string("listening thread EXCEPTION: ") + e.what(), _ss);
         _ss->_reset();
+        if( _ss->_dispatcher )
+            _ss->_dispatcher->stop();
         throw;
     }
 
+    /* let the workers finish what's been dispatched */
+    if( _ss->_dispatcher )
+        _ss->_dispatcher->stop();
+
     _ss->_listening = false;
 
     D("call back (" + to_string(cb_t) + ")", _ss);
@@ -470,6 +1165,9 @@ void
 StreamingSessionImpl::ListenerThreadTarget::exec()
 {
     D("begin listening loop", _ss);
+
+    /* swapped w/ the client's ring slots; its buffer keeps getting re-used */
+    string res;
     while( _ss->_listening ){
 
         /* _client should *always* be connected while listening */
@@ -479,15 +1177,16 @@ StreamingSessionImpl::ListenerThreadTarget::exec()
         }
 
         /* BLOCK for _listening_timeout msec until we get at least 1 message */
-        auto results = _ss->_client->recv_atleast_n_or_wait_for( 1,
-                           _ss->_listening_timeout
-                        );
-
-        if( results.empty() ) /* TIMED OUT */
+        if( !_ss->_client->recv_or_wait_for(res, _ss->_listening_timeout) )
             throw Timeout("exec timeout", __LINE__, __FILE__);
 
-        /* each message can have mutliple results */
-        for(string& res : results){
+        /*
+         * then take whatever else is ready w/o blocking - up to a point,
+         * a steady stream would never let us flush conflated updates
+         */
+        auto batch_end = std::chrono::steady_clock::now() + MAX_BATCH_TIME;
+        size_t nbatch = 0;
+        do{
             if( res.empty() ){
                 /* empty message is the signal to stop listening */
                 D("stop-listening message", _ss);
@@ -515,15 +1214,119 @@ StreamingSessionImpl::ListenerThreadTarget::exec()
                      << '\t' << e.what() << endl
                      << '\t' << res << endl;
             }
-        }
+            if( ++nbatch >= MAX_BATCH_MESSAGES
+                || std::chrono::steady_clock::now() >= batch_end )
+            {
+                break;
+            }
+        }while( _ss->_client->recv(res) );
+
+        /* conflated updates once what was waiting (or a batch) was merged */
+        flush_conflated();
     }
     D("end listening loop", _ss);
 }
 
 
 void
-StreamingSessionImpl::ListenerThreadTarget::parse(const string& responses)
+StreamingSessionImpl::ListenerThreadTarget::exec_inline()
+{
+    D("begin listening (inline)", _ss);
+
+    /* checked every quarter timeout: caught w/in 1.25x of it */
+    _last_message = std::chrono::steady_clock::now();
+    bool started = _ss->_client->start_inline(
+        [this](string& res){ parse_inline(res); },
+        [this](){ check_inline_timeout(); },
+        milliseconds( _ss->_listening_timeout.count() / 4 )
+        );
+    if( !started ){
+        TDMA_API_THROW( StreamingException,
+                        "client connection ended unexpectedly" );
+    }
+
+    /*
+     * all we get now is the empty message: from stop(), a disconnect, or
+     * the uWS thread after a timeout/exception (in _inline_error)
+     */
+    string res;
+    for( ;; ){
+        if( _ss->_client->recv_or_wait_for(res, _ss->_listening_timeout) ){
+            if( res.empty() )
+                break;
+        }else if( !_ss->_client->is_connected() ){
+            break;
+        }
+    }
+
+    /* after this the uWS thread is done w/ us */
+    _ss->_client->stop_inline();
+    _ss->_listening = false;
+    D("end listening (inline)", _ss);
+
+    if( _inline_error )
+        std::rethrow_exception(_inline_error);
+
+    if( !_ss->_client->is_connected() ){
+        TDMA_API_THROW( StreamingException,
+                        "client connection ended unexpectedly" );
+    }
+}
+
+
+void
+StreamingSessionImpl::ListenerThreadTarget::parse_inline(string& res)
+{
+    if( _inline_error ) /* listener is on its way out */
+        return;
+
+    _last_message = std::chrono::steady_clock::now();
+    try{
+        try{
+            parse(res);
+        }catch( json::exception& e ){
+            cerr << "Error Parsing Json: " << endl
+                 << '\t' << e.what() << endl
+                 << '\t' << res << endl;
+        }
+        /* no batches to wait for on this thread */
+        flush_conflated();
+    }catch( ... ){
+        /* can't throw through uWS; hand it to the listener */
+        _inline_error = std::current_exception();
+        _ss->_client->push_empty_message();
+    }
+}
+
+
+void
+StreamingSessionImpl::ListenerThreadTarget::check_inline_timeout()
+{
+    if( _inline_error )
+        return;
+
+    if( std::chrono::steady_clock::now() - _last_message
+        > _ss->_listening_timeout )
+    {
+        D("inline TIMEOUT", _ss);
+        _inline_error = std::make_exception_ptr(
+            Timeout("exec timeout", __LINE__, __FILE__) );
+        _ss->_client->push_empty_message();
+    }
+}
+
+
+void
+StreamingSessionImpl::ListenerThreadTarget::parse(string& responses)
 {
+    if( (_ss->_raw_data || _ss->_typed_callbacks.any()
+         || _ss->_level_one_cache_on || _ss->_order_tracker_on
+         || _ss->_dispatcher)
+        && parse_data_scanned(responses) )
+    {
+        return;
+    }
+
     auto resp = json::parse(responses);
     auto r = resp.begin();
     if( r == resp.end() )
@@ -629,19 +1432,588 @@ StreamingSessionImpl::ListenerThreadTarget::parse_response_data(
 {
     try{
         string service = response.at("service");
-        _ss->_exec_callback( StreamingCallbackType::data,
-                             streamer_service_from_str(service),
-                             response.at("timestamp"), response.at("content") );
+        StreamerServiceType ss_type = streamer_service_from_str(service);
+        unsigned long long ts = response.at("timestamp");
+        const json& content = response.at("content");
+        if( _ss->_typed_callbacks.any() || _ss->_level_one_cache_on
+            || _ss->_order_tracker_on || _ss->_dispatcher )
+        {
+            string s = content.dump();
+            if( exec_decoded(ss_type, ts, s.data(), s.size()) )
+                return;
+            if( _ss->_dispatcher && !_ss->_conflating(ss_type) ){
+                dispatch_content( DispatchTask::Kind::text, ss_type, ts,
+                                  s.data(), s.size() );
+                return;
+            }
+        }
+        if( _ss->_conflating(ss_type) ){
+            conflate_content(ss_type, ts, content);
+            return;
+        }
+        _ss->_exec_callback(StreamingCallbackType::data, ss_type, ts, content);
     }catch(std::exception& e){
         TDMA_API_THROW( StreamingException,
                         "invalid 'data' response: " + string(e.what()) );
     }
 }
 
+
+/*
+ * if 'responses' is a (well formed) data frame call back w/ each entry's
+ * typed updates, or raw content - the bytes off the wire - instead of a DOM
+ * round-trip; false means it wasn't, nothing was called back and it should
+ * be parsed normally
+ */
 bool
-StreamingSessionImpl::_login()
+StreamingSessionImpl::ListenerThreadTarget::parse_data_scanned(
+    string& responses
+    )
 {
-    D("login", this);
+    auto& entries = _data_entries;
+    if( !DataFrameScanner(responses.data(), responses.size()).scan(entries) )
+        return false;
+
+    for( auto& e : entries ){
+        StreamerServiceType service;
+        try{
+            service = streamer_service_from_str(e.service);
+        }catch(std::exception& ex){
+            TDMA_API_THROW( StreamingException,
+                            "invalid 'data' response: " + string(ex.what()) );
+        }
+
+        char *content = &responses[e.content_offset];
+        if( exec_decoded(service, e.timestamp, content, e.content_size)
+            || !_ss->_callback )
+        {
+            continue;
+        }
+
+        if( _ss->_conflating(service) ){
+            conflate_content( service, e.timestamp,
+                              json::parse(content, content + e.content_size) );
+            continue;
+        }
+
+        if( _ss->_dispatcher ){
+            /* the workers parse/re-serialize their share */
+            dispatch_content( _ss->_raw_data ? DispatchTask::Kind::text
+                                             : DispatchTask::Kind::json_text,
+                              service, e.timestamp, content, e.content_size );
+            continue;
+        }
+
+        if( !_ss->_raw_data ){
+            _ss->_exec_callback( StreamingCallbackType::data, service,
+                                 e.timestamp,
+                                 json::parse(content, content + e.content_size) );
+            continue;
+        }
+
+        /* content is always followed by at least '}]}' but be safe */
+        size_t end = e.content_offset + e.content_size;
+        char c = 0;
+        if( end != responses.size() ){
+            c = responses[end];
+            responses[end] = 0;
+        }
+        _ss->_callback( static_cast<int>(StreamingCallbackType::data),
+                        static_cast<int>(service), e.timestamp, content );
+        if( end != responses.size() )
+            responses[end] = c;
+    }
+    return true;
+}
+
+
+namespace {
+
+template<typename T>
+void
+update_level_one(SeqlockTable<T>& table, const vector<T>& updates)
+{
+    for( auto& u : updates ){
+        if( u.symbol[0] )
+            table.update(u.symbol, [&](T& state){ merge_update(state, u); });
+    }
+}
+
+/* false if 'content' won't decode; logged like a json parse error */
+template<typename F>
+bool
+try_decode(F decode, const char* content, size_t n)
+{
+    try{
+        decode();
+        return true;
+    }catch( StreamingException& e ){
+        cerr << "Error Decoding Content: " << endl
+             << '\t' << e.what() << endl
+             << '\t' << string(content, n) << endl;
+        return false;
+    }
+}
+
+} /* namespace */
+
+/*
+ * decode 'content' if the level one cache or a typed callback needs it;
+ * false if there's no typed callback for 'service' or 'content' didn't
+ * decode (it goes to the json callback instead)
+ */
+bool
+StreamingSessionImpl::ListenerThreadTarget::exec_decoded(
+    StreamerServiceType service,
+    unsigned long long timestamp,
+    const char* content,
+    size_t n
+    )
+{
+    bool cache = _ss->_level_one_cache_on;
+    LevelOneCache& level_one = _ss->_level_one;
+
+    switch( service ){
+    case StreamerServiceType::QUOTE: {
+        auto cb = _ss->_typed_callbacks.quote.load();
+        if( !cb && !cache )
+            break;
+        if( !try_decode([&](){ decode_quote_updates(content, n, _quotes); },
+                        content, n) )
+        {
+            return false;
+        }
+        if( cache )
+            update_level_one(level_one.quotes, _quotes);
+        if( cb ){
+            if( _ss->_conflating(service) ){
+                conflate_typed(DispatchTask::Kind::quote, cb, service,
+                               timestamp, _quotes);
+            }else{
+                exec_typed(DispatchTask::Kind::quote, cb, service, timestamp,
+                           _quotes);
+            }
+            return true;
+        }
+        break;
+    }
+    case StreamerServiceType::OPTION: {
+        auto cb = _ss->_typed_callbacks.option.load();
+        if( !cb && !cache )
+            break;
+        if( !try_decode([&](){ decode_option_updates(content, n, _options); },
+                        content, n) )
+        {
+            return false;
+        }
+        if( cache )
+            update_level_one(level_one.options, _options);
+        if( cb ){
+            if( _ss->_conflating(service) ){
+                conflate_typed(DispatchTask::Kind::option, cb, service,
+                               timestamp, _options);
+            }else{
+                exec_typed(DispatchTask::Kind::option, cb, service, timestamp,
+                           _options);
+            }
+            return true;
+        }
+        break;
+    }
+    case StreamerServiceType::LEVELONE_FUTURES:
+        if( cache && try_decode(
+                [&](){ decode_futures_updates(content, n, _futures); },
+                content, n) )
+        {
+            update_level_one(level_one.futures, _futures);
+        }
+        break;
+    case StreamerServiceType::LEVELONE_FOREX:
+        if( cache && try_decode(
+                [&](){ decode_forex_updates(content, n, _forex); },
+                content, n) )
+        {
+            update_level_one(level_one.forex, _forex);
+        }
+        break;
+    case StreamerServiceType::TIMESALE_EQUITY:
+    case StreamerServiceType::TIMESALE_FOREX:
+    case StreamerServiceType::TIMESALE_FUTURES:
+    case StreamerServiceType::TIMESALE_OPTIONS:
+        if( auto cb = _ss->_typed_callbacks.timesale.load() ){
+            if( !try_decode([&](){ decode_timesale_ticks(content, n, _ticks); },
+                            content, n) )
+            {
+                return false;
+            }
+            exec_typed(DispatchTask::Kind::timesale, cb, service, timestamp,
+                       _ticks);
+            return true;
+        }
+        break;
+    case StreamerServiceType::CHART_EQUITY:
+    case StreamerServiceType::CHART_FUTURES:
+    case StreamerServiceType::CHART_OPTIONS:
+        if( auto cb = _ss->_typed_callbacks.chart.load() ){
+            if( !try_decode(
+                    [&](){ decode_chart_bars(service, content, n, _bars); },
+                    content, n) )
+            {
+                return false;
+            }
+            exec_typed(DispatchTask::Kind::chart, cb, service, timestamp,
+                       _bars);
+            return true;
+        }
+        break;
+    case StreamerServiceType::ACCT_ACTIVITY: {
+        auto cb = _ss->_typed_callbacks.acct_activity.load();
+        bool track = _ss->_order_tracker_on;
+        if( !cb && !track )
+            break;
+        if( !try_decode([&](){ decode_acct_activity(content, n, _activity); },
+                        content, n) )
+        {
+            return false;
+        }
+        /* before the callback, so it sees the new state */
+        if( track ){
+            for( auto& m : _activity )
+                _ss->_orders.apply(timestamp, m);
+        }
+        if( cb ){
+            exec_typed(DispatchTask::Kind::acct_activity, cb, service,
+                       timestamp, _activity);
+            return true;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return false;
+}
+
+/*
+ * call back w/ the typed updates, or push each dispatch shard its share
+ * (packed, in order)
+ */
+template<typename T, typename F>
+void
+StreamingSessionImpl::ListenerThreadTarget::exec_typed(
+    DispatchTask::Kind kind,
+    F callback,
+    StreamerServiceType service,
+    unsigned long long timestamp,
+    const vector<T>& updates
+    )
+{
+    auto *d = _ss->_dispatcher.get();
+    if( !d ){
+        callback( static_cast<int>(service), timestamp, updates.data(),
+                  updates.size() );
+        return;
+    }
+
+    size_t nshards = d->size();
+    _shard_of.clear();
+    for( auto& u : updates )
+        _shard_of.push_back( dispatch_shard(u.symbol, strlen(u.symbol), nshards) );
+
+    for( size_t shard = 0; shard < nshards; ++shard ){
+        size_t n = std::count(_shard_of.begin(), _shard_of.end(), shard);
+        if( !n )
+            continue;
+        d->push( shard, n, [&](DispatchTask& t){
+            t.kind = kind;
+            t.service = service;
+            t.timestamp = timestamp;
+            t.callback = reinterpret_cast<void(*)()>(callback);
+            t.n = n;
+            t.data.resize(n * sizeof(T));
+            char *out = t.data.data();
+            for( size_t i = 0; i < updates.size(); ++i ){
+                if( _shard_of[i] == shard ){
+                    memcpy(out, &updates[i], sizeof(T));
+                    out += sizeof(T);
+                }
+            }
+        });
+    }
+}
+
+/*
+ * push each dispatch shard a content array of its entries (by "key"), in
+ * order; content that isn't an array of entries goes to shard 0 whole
+ */
+void
+StreamingSessionImpl::ListenerThreadTarget::dispatch_content(
+    DispatchTask::Kind kind,
+    StreamerServiceType service,
+    unsigned long long timestamp,
+    const char* content,
+    size_t n
+    )
+{
+    auto *d = _ss->_dispatcher.get();
+    auto& entries = _content_entries;
+    auto set_header = [&](DispatchTask& t){
+        t.kind = kind;
+        t.service = service;
+        t.timestamp = timestamp;
+        t.callback = nullptr;
+        t.n = 0;
+        t.data.clear();
+    };
+
+    if( !ContentSplitter(content, n).scan(entries) ){
+        d->push( 0, 1, [&](DispatchTask& t){
+            set_header(t);
+            t.data.insert(t.data.end(), content, content + n);
+            t.data.push_back(0);
+        });
+        return;
+    }
+
+    size_t nshards = d->size();
+    _shard_of.clear();
+    for( auto& e : entries ){
+        _shard_of.push_back( e.key ? dispatch_shard(e.key, e.key_size, nshards)
+                                   : 0 );
+    }
+
+    for( size_t shard = 0; shard < nshards; ++shard ){
+        size_t nentries = std::count(_shard_of.begin(), _shard_of.end(), shard);
+        if( !nentries )
+            continue;
+        d->push( shard, nentries, [&](DispatchTask& t){
+            set_header(t);
+            t.data.push_back('[');
+            for( size_t i = 0; i < entries.size(); ++i ){
+                if( _shard_of[i] != shard )
+                    continue;
+                if( t.data.size() > 1 )
+                    t.data.push_back(',');
+                const char *e = content + entries[i].offset;
+                t.data.insert(t.data.end(), e, e + entries[i].size);
+            }
+            t.data.push_back(']');
+            t.data.push_back(0);
+        });
+    }
+}
+
+
+/*
+ * merge into the symbol's conflated entry (on its dispatch shard); if
+ * that made it dirty have the shard's worker - or the listener after
+ * this batch of messages - take it
+ */
+template<typename F>
+void
+StreamingSessionImpl::ListenerThreadTarget::conflate(
+    StreamerServiceType service,
+    const string& symbol,
+    F merge
+    )
+{
+    auto *d = _ss->_dispatcher.get();
+    size_t shard = d ? dispatch_shard(symbol.data(), symbol.size(), d->size())
+                     : 0;
+    Conflator& conflator = *_ss->_conflators[shard];
+    auto& counts = _ss->_conflation_counts[static_cast<int>(service)];
+
+    ++counts.updates;
+    ConflatedEntry *e = conflator.merge(service, symbol, merge);
+    if( !e ){
+        ++counts.conflated;
+        return;
+    }
+
+    if( !d ){
+        _dirty.push_back(e);
+        return;
+    }
+    d->push( shard, 1, [&](DispatchTask& t){
+        t.kind = DispatchTask::Kind::conflated;
+        t.service = service;
+        t.conflator = &conflator;
+        t.entry = e;
+    });
+}
+
+template<typename T, typename F>
+void
+StreamingSessionImpl::ListenerThreadTarget::conflate_typed(
+    DispatchTask::Kind kind,
+    F callback,
+    StreamerServiceType service,
+    unsigned long long timestamp,
+    const vector<T>& updates
+    )
+{
+    for( auto& u : updates ){
+        conflate( service, u.symbol, [&](ConflatedEntry& e){
+            if( e.kind != kind || e.record.size() != sizeof(T) ){
+                e.kind = kind;
+                e.record.assign(sizeof(T), 0);
+            }
+            e.callback = reinterpret_cast<void(*)()>(callback);
+            e.timestamp = timestamp;
+            T state;
+            memcpy(&state, e.record.data(), sizeof(T));
+            merge_update(state, u);
+            memcpy(e.record.data(), &state, sizeof(T));
+        });
+    }
+}
+
+/*
+ * conflate each content entry by "key" (later fields replace earlier ones);
+ * anything w/o a key is called back as is
+ */
+void
+StreamingSessionImpl::ListenerThreadTarget::conflate_content(
+    StreamerServiceType service,
+    unsigned long long timestamp,
+    const json& content
+    )
+{
+    json rest = json::array();
+    if( content.is_array() ){
+        for( auto& c : content ){
+            auto k = c.is_object() ? c.find("key") : c.end();
+            if( k == c.end() || !k->is_string() ){
+                rest.push_back(c);
+                continue;
+            }
+            conflate( service, k->get<string>(), [&](ConflatedEntry& e){
+                if( e.kind != DispatchTask::Kind::json_text ){
+                    e.kind = DispatchTask::Kind::json_text;
+                    e.record.clear();
+                    e.object = json();
+                }
+                e.timestamp = timestamp;
+                for( auto f = c.begin(); f != c.end(); ++f )
+                    e.object[f.key()] = f.value();
+            });
+        }
+    }else{
+        rest = content;
+    }
+
+    if( rest.empty() )
+        return;
+
+    if( _ss->_dispatcher ){
+        string s = rest.dump();
+        dispatch_content( DispatchTask::Kind::text, service, timestamp,
+                          s.data(), s.size() );
+    }else{
+        _ss->_exec_callback(StreamingCallbackType::data, service, timestamp,
+                            rest);
+    }
+}
+
+void
+StreamingSessionImpl::ListenerThreadTarget::flush_conflated()
+{
+    if( _dirty.empty() )
+        return;
+    Conflator& conflator = *_ss->_conflators[0];
+    for( auto e : _dirty )
+        _ss->_exec_conflated(conflator, e);
+    _dirty.clear();
+}
+
+
+void
+StreamingSessionImpl::_exec_dispatched(DispatchTask& t)
+{
+    int s = static_cast<int>(t.service);
+    const char *data = t.data.data();
+
+    switch( t.kind ){
+    case DispatchTask::Kind::text:
+        if( _callback ){
+            _callback( static_cast<int>(StreamingCallbackType::data), s,
+                       t.timestamp, data );
+        }
+        break;
+    case DispatchTask::Kind::json_text:
+        try{
+            _exec_callback( StreamingCallbackType::data, t.service,
+                            t.timestamp, json::parse(data) );
+        }catch( json::exception& e ){
+            cerr << "Error Parsing Json: " << endl
+                 << '\t' << e.what() << endl
+                 << '\t' << data << endl;
+        }
+        break;
+    case DispatchTask::Kind::quote:
+        reinterpret_cast<quote_update_cb_ty>(t.callback)(
+            s, t.timestamp, reinterpret_cast<const QuoteUpdate_C*>(data), t.n );
+        break;
+    case DispatchTask::Kind::option:
+        reinterpret_cast<option_update_cb_ty>(t.callback)(
+            s, t.timestamp, reinterpret_cast<const OptionUpdate_C*>(data), t.n );
+        break;
+    case DispatchTask::Kind::timesale:
+        reinterpret_cast<timesale_tick_cb_ty>(t.callback)(
+            s, t.timestamp, reinterpret_cast<const TimesaleTick_C*>(data), t.n );
+        break;
+    case DispatchTask::Kind::chart:
+        reinterpret_cast<chart_bar_cb_ty>(t.callback)(
+            s, t.timestamp, reinterpret_cast<const ChartBar_C*>(data), t.n );
+        break;
+    case DispatchTask::Kind::acct_activity:
+        reinterpret_cast<acct_activity_cb_ty>(t.callback)(
+            s, t.timestamp, reinterpret_cast<const AcctActivity_C*>(data), t.n );
+        break;
+    case DispatchTask::Kind::conflated:
+        _exec_conflated(*t.conflator, t.entry);
+        break;
+    }
+}
+
+
+void
+StreamingSessionImpl::_exec_conflated( Conflator& conflator,
+                                       ConflatedEntry *entry )
+{
+    ConflatedEntry e;
+    if( !conflator.take(entry, e) )
+        return;
+
+    ++_conflation_counts[static_cast<int>(e.service)].delivered;
+
+    int s = static_cast<int>(e.service);
+    switch( e.kind ){
+    case DispatchTask::Kind::quote:
+        reinterpret_cast<quote_update_cb_ty>(e.callback)(
+            s, e.timestamp,
+            reinterpret_cast<const QuoteUpdate_C*>(e.record.data()), 1 );
+        break;
+    case DispatchTask::Kind::option:
+        reinterpret_cast<option_update_cb_ty>(e.callback)(
+            s, e.timestamp,
+            reinterpret_cast<const OptionUpdate_C*>(e.record.data()), 1 );
+        break;
+    default:{
+        json content = json::array();
+        content.push_back( std::move(e.object) );
+        _exec_callback( StreamingCallbackType::data, e.service, e.timestamp,
+                        content );
+        break;
+    }
+    }
+}
+
+
+bool
+StreamingSessionImpl::_login()
+{
+    D("login", this);
 
     map<string, string> params{
         {"token", _streamer_info.credentials.token},
@@ -891,7 +2263,8 @@ StreamingSessionImpl::_subscribe(
         req_ids.push_back( _next_request_id++ );
 
     StreamingRequests requests( subscriptions, _account_id,
-                                _streamer_info.credentials.app_id, req_ids );
+                                _streamer_info.credentials.app_id, req_ids,
+                                _streamer_info.subscription_key );
 
     auto msg = requests.to_json().dump();
     _client->send( msg );
@@ -975,31 +2348,43 @@ StreamingSessionImpl::start(
     if( subscriptions.empty() )
         TDMA_API_THROW(StreamingException,"subscriptions is empty");
 
+    /*
+     * claim the account up front (check-and-insert under one lock) so two
+     * threads can't both start a session for it; give it back if we fail
+     * to connect or login
+     */
     D("check unique session", this);
     string acct = get_primary_account_id();
-    if( active_accounts.count(acct) ){
+    if( !active_accounts.insert(acct) ){
         TDMA_API_THROW( StreamingException,
                         "Can not start Session; one is already active "
                         "for this primary account: " + acct );
     }
+    _account_active = true;
 
-    D("_client->reset", this);
-    _client.reset( new conn::WebSocketClient(_streamer_info.url) );
+    try{
+        D("_client->reset", this);
+        _wire_stats.clear();
+        _client.reset( new conn::WebSocketClient(_streamer_info.url,
+                                                 _compression, &_wire_stats) );
+
+        D("_client->connect", this);
+        _client->connect( _connect_timeout );
+        if( !_client->is_connected() ){
+            _client.reset();
+            TDMA_API_THROW( StreamingException,
+                            "streaming session failed to connect" );
+        }
 
-    D("_client->connect", this);
-    _client->connect( _connect_timeout );
-    if( !_client->is_connected() ){
-        _client.reset();
-        TDMA_API_THROW( StreamingException,
-                        "streaming session failed to connect" );
+        _logged_in = _login();
+        if( !_logged_in )
+            TDMA_API_THROW(StreamingException,"login failed");
+    }catch(...){
+        if( _account_active.exchange(false) )
+            active_accounts.erase(acct);
+        throw;
     }
 
-    _logged_in = _login();
-    if( !_logged_in )
-        TDMA_API_THROW(StreamingException,"login failed");
-
-    /* only after connect AND login do we consider this an active session */
-    active_accounts.insert(acct);
     _start_listener_thread();
     return add_subscriptions(subscriptions);
 }
@@ -1033,9 +2418,12 @@ StreamingSessionImpl::_reset()
     _client.reset();
     _responses_pending.clear();
     _server_id.clear();
-    try{
-        active_accounts.erase( get_primary_account_id() );
-    }catch(...){}
+    /* can be called from the listener thread AND stop(); release once */
+    if( _account_active.exchange(false) ){
+        try{
+            active_accounts.erase( get_primary_account_id() );
+        }catch(...){}
+    }
 }
 
 
@@ -1049,6 +2437,21 @@ StreamingSessionImpl::_start_listener_thread()
     if( _listener_thread.joinable() )
         _listener_thread.join();
 
+    /* new workers (and stats) for this listener */
+    {
+        std::lock_guard<mutex> _(_dispatcher_mtx);
+        size_t n = _dispatch_threads;
+        _conflators.clear();
+        for( size_t i = 0; i < std::max<size_t>(n, 1); ++i )
+            _conflators.emplace_back( new Conflator() );
+        _dispatcher.reset( n ? new CallbackDispatcher<DispatchTask>(
+                                   n, DISPATCH_RING_CAPACITY,
+                                   [this](DispatchTask& t){
+                                       _exec_dispatched(t);
+                                   } )
+                             : nullptr );
+    }
+
     D("move new listener thread", this);
     _listener_thread = std::move( std::thread(ListenerThreadTarget(this)) );
 }
@@ -1291,3 +2694,579 @@ StreamingSession_GetQOS_ABI( StreamingSession_C *psession,
     tie(*qos, err) = CallImplFromABI(allow_exceptions, meth, psession->obj);
     return err;
 }
+
+int
+StreamingSession_SetRawData_ABI( StreamingSession_C *psession,
+                                 int raw_data,
+                                 int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    auto meth = +[](void *obj, int r){
+        reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->set_raw_data( static_cast<bool>(r) );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, raw_data);
+}
+
+int
+StreamingSession_GetRawData_ABI( StreamingSession_C *psession,
+                                 int *raw_data,
+                                 int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(raw_data, "raw_data", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->get_raw_data()
+            );
+    };
+
+    tie(*raw_data, err) = CallImplFromABI(allow_exceptions, meth,
+                                          psession->obj);
+    return err;
+}
+
+int
+StreamingSession_SetTypedCallbacks_ABI(
+    StreamingSession_C *psession,
+    const StreamingTypedCallbacks_C *callbacks,
+    int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    auto meth = +[](void *obj, const StreamingTypedCallbacks_C *cbs){
+        reinterpret_cast<StreamingSessionImpl*>(obj)->set_typed_callbacks(
+            cbs ? *cbs : StreamingTypedCallbacks_C()
+            );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, callbacks);
+}
+
+int
+StreamingSession_GetTypedCallbacks_ABI(
+    StreamingSession_C *psession,
+    StreamingTypedCallbacks_C *callbacks,
+    int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(callbacks, "callbacks", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->get_typed_callbacks();
+    };
+
+    tie(*callbacks, err) = CallImplFromABI(allow_exceptions, meth,
+                                           psession->obj);
+    return err;
+}
+
+int
+StreamingSession_SetLevelOneCache_ABI( StreamingSession_C *psession,
+                                       int on,
+                                       int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    auto meth = +[](void *obj, int o){
+        reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->set_level_one_cache( static_cast<bool>(o) );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, on);
+}
+
+int
+StreamingSession_GetLevelOneCache_ABI( StreamingSession_C *psession,
+                                       int *on,
+                                       int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(on, "on", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->get_level_one_cache()
+            );
+    };
+
+    tie(*on, err) = CallImplFromABI(allow_exceptions, meth, psession->obj);
+    return err;
+}
+
+int
+StreamingSession_GetLevelOneSymbols_ABI( StreamingSession_C *psession,
+                                         int service,
+                                         char ***buffers,
+                                         size_t *n,
+                                         int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(StreamerServiceType, service, allow_exceptions);
+    CHECK_PTR(buffers, "buffers", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    auto meth = +[](void *obj, int s){
+        auto symbols = reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->level_one().symbols( static_cast<StreamerServiceType>(s) );
+        return set<string>(symbols.begin(), symbols.end());
+    };
+
+    set<string> symbols;
+    tie(symbols, err) = CallImplFromABI(allow_exceptions, meth,
+                                        psession->obj, service);
+    if( err ){
+        *buffers = nullptr;
+        *n = 0;
+        return err;
+    }
+    return to_new_char_buffers(symbols, buffers, n, allow_exceptions);
+}
+
+int
+StreamingSession_GetLevelOneSymbolId_ABI( StreamingSession_C *psession,
+                                          int service,
+                                          const char* symbol,
+                                          long long *id,
+                                          int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(StreamerServiceType, service, allow_exceptions);
+    CHECK_PTR(symbol, "symbol", allow_exceptions);
+    CHECK_PTR(id, "id", allow_exceptions);
+
+    auto meth = +[](void *obj, int s, const char* sym){
+        return reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->level_one().id( static_cast<StreamerServiceType>(s), sym );
+    };
+
+    tie(*id, err) = CallImplFromABI(allow_exceptions, meth, psession->obj,
+                                    service, symbol);
+    return err;
+}
+
+int
+StreamingSession_GetLevelOne_ABI( StreamingSession_C *psession,
+                                  int service,
+                                  const char* symbol,
+                                  void *record,
+                                  size_t record_size,
+                                  int *found,
+                                  int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(StreamerServiceType, service, allow_exceptions);
+    CHECK_PTR(symbol, "symbol", allow_exceptions);
+    CHECK_PTR(record, "record", allow_exceptions);
+    CHECK_PTR(found, "found", allow_exceptions);
+
+    auto meth = +[](void *obj, int s, const char* sym, void *r, size_t n){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->level_one().get(
+                static_cast<StreamerServiceType>(s), string(sym), r, n )
+            );
+    };
+
+    tie(*found, err) = CallImplFromABI(allow_exceptions, meth, psession->obj,
+                                       service, symbol, record, record_size);
+    return err;
+}
+
+int
+StreamingSession_GetLevelOneById_ABI( StreamingSession_C *psession,
+                                      int service,
+                                      long long id,
+                                      void *record,
+                                      size_t record_size,
+                                      int *found,
+                                      int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(StreamerServiceType, service, allow_exceptions);
+    CHECK_PTR(record, "record", allow_exceptions);
+    CHECK_PTR(found, "found", allow_exceptions);
+
+    if( id < 0 )
+        return HANDLE_ERROR(ValueException, "id < 0", allow_exceptions);
+
+    auto meth = +[](void *obj, int s, long long i, void *r, size_t n){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->level_one().get(
+                static_cast<StreamerServiceType>(s), static_cast<size_t>(i),
+                r, n )
+            );
+    };
+
+    tie(*found, err) = CallImplFromABI(allow_exceptions, meth, psession->obj,
+                                       service, id, record, record_size);
+    return err;
+}
+
+int
+StreamingSession_SetOrderTracker_ABI( StreamingSession_C *psession,
+                                      int on,
+                                      int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    auto meth = +[](void *obj, int o){
+        reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->set_order_tracker( static_cast<bool>(o) );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, on);
+}
+
+int
+StreamingSession_GetOrderTracker_ABI( StreamingSession_C *psession,
+                                      int *on,
+                                      int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(on, "on", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->get_order_tracker()
+            );
+    };
+
+    tie(*on, err) = CallImplFromABI(allow_exceptions, meth, psession->obj);
+    return err;
+}
+
+int
+StreamingSession_GetOrderIds_ABI( StreamingSession_C *psession,
+                                  char ***buffers,
+                                  size_t *n,
+                                  int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(buffers, "buffers", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        auto ids = reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->orders().order_ids();
+        return set<string>(ids.begin(), ids.end());
+    };
+
+    set<string> ids;
+    tie(ids, err) = CallImplFromABI(allow_exceptions, meth, psession->obj);
+    if( err ){
+        *buffers = nullptr;
+        *n = 0;
+        return err;
+    }
+    return to_new_char_buffers(ids, buffers, n, allow_exceptions);
+}
+
+int
+StreamingSession_GetOrderState_ABI( StreamingSession_C *psession,
+                                    const char* order_id,
+                                    OrderState_C *state,
+                                    int *found,
+                                    int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(order_id, "order_id", allow_exceptions);
+    CHECK_PTR(state, "state", allow_exceptions);
+    CHECK_PTR(found, "found", allow_exceptions);
+
+    auto meth = +[](void *obj, const char* id, OrderState_C *s){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->orders().get(
+                string(id), *s )
+            );
+    };
+
+    tie(*found, err) = CallImplFromABI(allow_exceptions, meth, psession->obj,
+                                       order_id, state);
+    return err;
+}
+
+int
+StreamingSession_SetInlineProcessing_ABI( StreamingSession_C *psession,
+                                          int on,
+                                          int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    auto meth = +[](void *obj, int o){
+        reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->set_inline_processing( static_cast<bool>(o) );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, on);
+}
+
+int
+StreamingSession_GetInlineProcessing_ABI( StreamingSession_C *psession,
+                                          int *on,
+                                          int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(on, "on", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->get_inline_processing()
+            );
+    };
+
+    tie(*on, err) = CallImplFromABI(allow_exceptions, meth, psession->obj);
+    return err;
+}
+
+int
+StreamingSession_SetCompression_ABI( StreamingSession_C *psession,
+                                     int on,
+                                     int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    auto meth = +[](void *obj, int o){
+        reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->set_compression( static_cast<bool>(o) );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, on);
+}
+
+int
+StreamingSession_GetCompression_ABI( StreamingSession_C *psession,
+                                     int *on,
+                                     int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(on, "on", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->get_compression()
+            );
+    };
+
+    tie(*on, err) = CallImplFromABI(allow_exceptions, meth, psession->obj);
+    return err;
+}
+
+int
+StreamingSession_GetWireStats_ABI( StreamingSession_C *psession,
+                                   StreamingWireStats_C *pstats,
+                                   int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(pstats, "stats", allow_exceptions);
+
+    auto meth = +[](void *obj, StreamingWireStats_C *p){
+        reinterpret_cast<StreamingSessionImpl*>(obj)->get_wire_stats(p);
+    };
+
+    err = CallImplFromABI(allow_exceptions, meth, psession->obj, pstats);
+    if( err )
+        memset(pstats, 0, sizeof(StreamingWireStats_C));
+    return err;
+}
+
+int
+StreamingSession_SetDispatchThreads_ABI( StreamingSession_C *psession,
+                                         size_t nthreads,
+                                         int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    auto meth = +[](void *obj, size_t n){
+        reinterpret_cast<StreamingSessionImpl*>(obj)->set_dispatch_threads(n);
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, nthreads);
+}
+
+int
+StreamingSession_GetDispatchThreads_ABI( StreamingSession_C *psession,
+                                         size_t *nthreads,
+                                         int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(nthreads, "nthreads", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->get_dispatch_threads();
+    };
+
+    tie(*nthreads, err) = CallImplFromABI(allow_exceptions, meth,
+                                          psession->obj);
+    return err;
+}
+
+int
+StreamingSession_GetDispatchShards_ABI( StreamingSession_C *psession,
+                                        size_t *nshards,
+                                        int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(nshards, "nshards", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->get_dispatch_shards();
+    };
+
+    tie(*nshards, err) = CallImplFromABI(allow_exceptions, meth,
+                                         psession->obj);
+    return err;
+}
+
+int
+StreamingSession_GetDispatchStats_ABI( StreamingSession_C *psession,
+                                       size_t shard,
+                                       StreamingDispatchStats_C *pstats,
+                                       int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(pstats, "stats", allow_exceptions);
+
+    auto meth = +[](void *obj, size_t i, StreamingDispatchStats_C *p){
+        reinterpret_cast<StreamingSessionImpl*>(obj)->get_dispatch_stats(i, p);
+    };
+
+    err = CallImplFromABI(allow_exceptions, meth, psession->obj, shard, pstats);
+    if( err )
+        memset(pstats, 0, sizeof(StreamingDispatchStats_C));
+    return err;
+}
+
+int
+StreamingSession_SetConflation_ABI( StreamingSession_C *psession,
+                                    int service,
+                                    int on,
+                                    int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(StreamerServiceType, service, allow_exceptions);
+
+    auto meth = +[](void *obj, int s, int o){
+        reinterpret_cast<StreamingSessionImpl*>(obj)->set_conflation(
+            static_cast<StreamerServiceType>(s), static_cast<bool>(o) );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, service, on);
+}
+
+int
+StreamingSession_GetConflation_ABI( StreamingSession_C *psession,
+                                    int service,
+                                    int *on,
+                                    int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(StreamerServiceType, service, allow_exceptions);
+    CHECK_PTR(on, "on", allow_exceptions);
+
+    auto meth = +[](void *obj, int s){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->get_conflation(
+                static_cast<StreamerServiceType>(s) )
+            );
+    };
+
+    tie(*on, err) = CallImplFromABI(allow_exceptions, meth, psession->obj,
+                                    service);
+    return err;
+}
+
+int
+StreamingSession_GetConflationStats_ABI( StreamingSession_C *psession,
+                                         int service,
+                                         StreamingConflationStats_C *pstats,
+                                         int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(StreamerServiceType, service, allow_exceptions);
+    CHECK_PTR(pstats, "stats", allow_exceptions);
+
+    auto meth = +[](void *obj, int s, StreamingConflationStats_C *p){
+        reinterpret_cast<StreamingSessionImpl*>(obj)->get_conflation_stats(
+            static_cast<StreamerServiceType>(s), p );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, service,
+                           pstats);
+}
@@ -590,6 +590,24 @@ public:
 };
 
 
+/* 'keys' (the subscription key) is filled in by the session */
+class AcctActivitySubscriptionImpl
+        : public StreamingSubscriptionImpl {
+public:
+    typedef AcctActivitySubscription ProxyType;
+    static const int TYPE_ID_LOW = TYPE_ID_SUB_ACCT_ACTIVITY;
+    static const int TYPE_ID_HIGH = TYPE_ID_SUB_ACCT_ACTIVITY;
+
+    AcctActivitySubscriptionImpl()
+        :
+            StreamingSubscriptionImpl( StreamerServiceType::ACCT_ACTIVITY,
+                                       "SUBS",
+                                       {{"keys", ""}, {"fields", "0,1,2,3"}} )
+        {
+        }
+};
+
+
 function<bool(int)> QuotesSubscriptionImpl::is_valid_field =
     QuotesSubscriptionField_is_valid;
 
@@ -662,6 +680,8 @@ C_sub_ptr_to_impl_ptr(StreamingSubscription_C *psub)
         return reinterpret_cast<OTCBBActivesSubscriptionImpl*>(psub->obj);
     case TYPE_ID_SUB_ACTIVES_OPTION:
         return reinterpret_cast<OptionActivesSubscriptionImpl*>(psub->obj);
+    case TYPE_ID_SUB_ACCT_ACTIVITY:
+        return reinterpret_cast<AcctActivitySubscriptionImpl*>(psub->obj);
     default:
         TDMA_API_THROW(TypeException,"invalid C subscription type_id");
     }
@@ -842,6 +862,7 @@ DEFINE_CSUB_DESTROY_FUNC(NasdaqActivesSubscription);
 DEFINE_CSUB_DESTROY_FUNC(NYSEActivesSubscription);
 DEFINE_CSUB_DESTROY_FUNC(OTCBBActivesSubscription);
 DEFINE_CSUB_DESTROY_FUNC(OptionActivesSubscription);
+DEFINE_CSUB_DESTROY_FUNC(AcctActivitySubscription);
 #undef DEFINE_CSUB_DESTROY_FUNC
 
 /* Generic Destroy */
@@ -1262,5 +1283,29 @@ OptionActivesSubscription_Create_ABI( int venue,
     return 0;
 }
 
+int
+AcctActivitySubscription_Create_ABI( AcctActivitySubscription_C *psub,
+                                     int allow_exceptions )
+{
+    int err = subscription_is_creatable<AcctActivitySubscriptionImpl>(
+        psub, allow_exceptions
+        );
+    if( err )
+        return err;
+
+    static auto meth = +[](){ return new AcctActivitySubscriptionImpl(); };
+
+    AcctActivitySubscriptionImpl *obj;
+    tie(obj, err) = CallImplFromABI(allow_exceptions, meth);
+    if( err ){
+        kill_proxy(psub);
+        return err;
+    }
+
+    psub->obj = reinterpret_cast<void*>(obj);
+    psub->type_id = AcctActivitySubscriptionImpl::TYPE_ID_LOW;
+    return 0;
+}
+
 
 
@@ -52,6 +52,18 @@ error_msg_about_token_expiration(const string& msg)
         && std::regex_search(msg, EXPIRE_RX);
 }
 
+bool
+is_curl_connection_error(std::exception_ptr eptr)
+{
+    try{
+        std::rethrow_exception(eptr);
+    }catch( conn::CurlConnectionError& ){
+        return true;
+    }catch(...){
+        return false;
+    }
+}
+
 } /* namespace */
 
 
@@ -153,8 +165,11 @@ curl_execute(conn::HTTPSConnection& connection, bool return_header_data)
      * Curl exceptions are not exposed publicly so we catch and wrap
      */
     try{
-        return connection.execute(return_header_data);
+        auto r = connection.execute(return_header_data);
+        record_request( connection.last_timing() );
+        return r;
     }catch( conn::CurlConnectionError& e ){
+        record_request( connection.last_timing() );
         cerr<< "CurlConnectionError --> ConnectionException" << endl;
         string msg = e.what() + string("(curl code=")
                    + std::to_string(e.code) + ')';
@@ -162,6 +177,38 @@ curl_execute(conn::HTTPSConnection& connection, bool return_header_data)
     }
 }
 
+conn::execute_buffer_result_ty
+curl_execute_buffer(conn::HTTPSConnection& connection, bool return_header_data)
+{
+    try{
+        auto r = connection.execute_buffer(return_header_data);
+        record_request( connection.last_timing() );
+        return r;
+    }catch( conn::CurlConnectionError& e ){
+        record_request( connection.last_timing() );
+        cerr<< "CurlConnectionError --> ConnectionException" << endl;
+        string msg = e.what() + string("(curl code=")
+                   + std::to_string(e.code) + ')';
+        TDMA_API_THROW( ConnectException, msg );
+    }
+}
+
+/* same wrapping as curl_execute for errors coming back from execute_async */
+void
+rethrow_curl_error(std::exception_ptr eptr)
+{
+    try{
+        std::rethrow_exception(eptr);
+    }catch( conn::CurlConnectionError& e ){
+        cerr<< "CurlConnectionError --> ConnectionException" << endl;
+        string msg = e.what() + string("(curl code=")
+                   + std::to_string(e.code) + ')';
+        TDMA_API_THROW( ConnectException, msg );
+    }catch( conn::CurlException& e ){
+        TDMA_API_THROW( ConnectException, e.what() );
+    }
+}
+
 
 bool
 on_return( long code,
@@ -193,6 +240,20 @@ on_return( long code,
     return false;
 }
 
+/* only build the string on the error path */
+bool
+on_return( long code,
+           long success_code,
+           const conn::ResponseBuffer& data,
+           bool allow_refresh,
+           api_on_error_cb_ty on_error_cb )
+{
+    if( code == success_code )
+        return true;
+    return on_return(code, success_code, data.str(), allow_refresh,
+                     on_error_cb);
+}
+
 
 vector<pair<string,string>>
 build_auth_headers( const vector<pair<string,string>>& headers,
@@ -204,115 +265,144 @@ build_auth_headers( const vector<pair<string,string>>& headers,
 }
 
 
-tuple<string, string, conn::clock_ty::time_point>
-connect( conn::HTTPSConnection& connection,
-         Credentials& creds,
-         const vector<pair<string,string>>& static_headers,
-         api_on_error_cb_ty on_error_cb,
-         bool return_headers,
-         long success_code )
+/* sync the client's cred struct w/ the cached token */
+void
+set_creds_token(Credentials& creds, const string& token)
 {
-    if( !creds.access_token || !creds.client_id )
-        TDMA_API_THROW( LocalCredentialException, "invalid credentials" );
+    if( strcmp(creds.access_token, token.c_str()) ){
+        delete[] creds.access_token;
+        creds.access_token = new char[token.size() + 1];
+        creds.access_token[token.size()] = 0;
+        strcpy(creds.access_token, token.c_str());
+    }
+}
 
-    if( creds.access_token[0] == '\0' )
-        TDMA_API_THROW( LocalCredentialException, "empty access_token" );
+/*
+ * (re)build auth headers if missing or not using 'token' (e.g the token was
+ * refreshed by another connection or in the background) so we don't have
+ * to take a 401 to find out
+ */
+void
+set_auth_headers( conn::HTTPSConnection& connection,
+                  const vector<pair<string,string>>& static_headers,
+                  const string& token )
+{
+    if( connection.has_headers() ){
+        auto old_headers = connection.GET_headers();
+        assert( old_headers.back().first == "Authorization");
+        if( old_headers.back().second == ("Bearer " + token) )
+            return;
+        connection.RESET_headers();
+    }
+    connection.ADD_headers( build_auth_headers(static_headers, token) );
+}
 
-    if( creds.client_id[0] == '\0' )
-        TDMA_API_THROW( LocalCredentialException, "empty client_id");
 
-    /*
-     * cache access tokens across calls by client_id so all cred structs
-     * of the same account are linked but different client_ids aren't
-     *
-     * NOTE - the cached token takes priority to avoid refresh 'thrashing'
-     *        between unsynced callers
-     */
-    static std::unordered_map<string, string> token_cache;
-    string& cached_token = token_cache.insert(
-        {creds.client_id, creds.access_token}
-    ).first->second;
-
-    /* only add headers if we don't already have them */
-    if( !connection.has_headers() ){
-        auto headers = build_auth_headers(static_headers, cached_token);
-        connection.ADD_headers(headers);
-    }
+tuple<conn::ResponseBuffer, string, conn::clock_ty::time_point>
+connect_buffer( conn::HTTPSConnection& connection,
+                Credentials& creds,
+                const vector<pair<string,string>>& static_headers,
+                api_on_error_cb_ty on_error_cb,
+                bool return_headers,
+                long success_code )
+{
+    /* (the cache may have been refreshed in the background) */
+    string token = cached_access_token(creds);
+    set_creds_token(creds, token);
+    set_auth_headers(connection, static_headers, token);
 
     long r_code;
-    string r_data, r_head;
+    conn::ResponseBuffer r_data;
+    string r_head;
     conn::clock_ty::time_point r_tp;
-    tie(r_code, r_data, r_head, r_tp) = curl_execute(connection, return_headers);
+    tie(r_code, r_data, r_head, r_tp) =
+        curl_execute_buffer(connection, return_headers);
 
     if( !on_return(r_code, success_code, r_data, true, on_error_cb) ){
         /*
          * if 'on_return' returns FALSE initially we have an expired token
          * IN THE HEADER (or in the header AND cache):
          *
-         * 1) if current token in the header is different than cache:
-         *     a) update the cred struct w/ the cache token (if different)
-         *     b) reset auth header w/ the cache token
-         *     c) try the call again
-         *     d) if 'on_return' returns TRUE, return, else...
-         * 2) refresh the token (automatically updates 'creds.access_token')
-         * 3) update the cache
-         * 4) update the header
-         * 5) try again (this should either return true or THROW)
+         * 1) if the cache was updated since we read it:
+         *     a) update the cred struct/header w/ the cache token
+         *     b) try the call again
+         *     c) if 'on_return' returns TRUE, return, else...
+         * 2) refresh the token in the cache (single-flight; if another
+         *    thread is already refreshing we wait on it)
+         * 3) update the cred struct/header
+         * 4) try again (this should either return true or THROW)
          */
+        string cached = cached_access_token(creds);
+        if( cached != token ){
+            token = cached;
+            /*
+             * should only get in here if client is using references
+             * to different cred structs (not recommended) or another
+             * thread refreshed
+             */
+            set_creds_token(creds, token);
+            set_auth_headers(connection, static_headers, token);
 
-        auto old_headers = connection.GET_headers();
-        assert( old_headers.back().first == "Authorization");
-
-        /* first check that header token is same as cached version */
-        if( old_headers.back().second != ("Bearer " + cached_token) ){
-
-            /* overwrite the token in creds w/ cached */
-            if( strcmp(creds.access_token, cached_token.c_str()) ){
-                /*
-                 * should only get in here if client is using references
-                 * to different cred structs (not recommended)
-                 */
-                delete[] creds.access_token;
-                creds.access_token = new char[cached_token.size() + 1];
-                creds.access_token[cached_token.size()] = 0;
-                strcpy(creds.access_token, cached_token.c_str());
-            }
-
-            /* update headers w/ cached */
-            connection.RESET_headers();
-            auto new_headers = build_auth_headers(static_headers, cached_token);
-            connection.ADD_headers(new_headers);
-
-            /* try again */
             tie(r_code, r_data, r_head, r_tp) =
-                curl_execute(connection, return_headers);
+                curl_execute_buffer(connection, return_headers);
 
             /* if still FALSE, expired token IN CACHE, continue to refresh */
-            if( on_return(r_code, success_code, r_data, true, on_error_cb) )
-                return make_tuple(r_data, r_head, r_tp);
+            if( on_return(r_code, success_code, r_data, true, on_error_cb) ){
+                return make_tuple( std::move(r_data), std::move(r_head),
+                                   r_tp );
+            }
         }
 
-        cerr<< "access token expired; try to refresh..." << endl;
-        RefreshAccessToken(creds); // updates creds.access_token
-
-        /* update the cache */
-        cached_token = creds.access_token;
-
-        /* update the header */
-        connection.RESET_headers();
-        auto new_headers = build_auth_headers(static_headers, cached_token);
-        connection.ADD_headers(new_headers);
+        token = refresh_cached_access_token(creds, token);
+        set_creds_token(creds, token);
+        set_auth_headers(connection, static_headers, token);
 
         /* try again */
         tie(r_code, r_data, r_head, r_tp) =
-            curl_execute(connection, return_headers);
+            curl_execute_buffer(connection, return_headers);
 
         bool r = on_return(r_code, success_code, r_data, false, on_error_cb);
         assert(r); /* should either be true or have thrown */
-        cerr<< "...successfully refreshed access token" << endl;
     } 
 
-    return make_tuple(r_data, r_head, r_tp);
+    return make_tuple(std::move(r_data), std::move(r_head), r_tp);
+}
+
+
+/*
+ * the async paths' 401: refresh 'stale_token' - the one the request used -
+ * (or pick up a newer cached one) and try ONCE more. Blocks; call from the
+ * engine's worker thread (execute_blocking).
+ */
+tuple<long, string, string, conn::clock_ty::time_point>
+retry_with_fresh_token( conn::HTTPSConnection& connection,
+                        Credentials& creds,
+                        const vector<pair<string,string>>& static_headers,
+                        const string& stale_token,
+                        bool return_headers )
+{
+    string token = refresh_cached_access_token(creds, stale_token);
+    set_creds_token(creds, token);
+    set_auth_headers(connection, static_headers, token);
+    return curl_execute(connection, return_headers);
+}
+
+
+tuple<string, string, conn::clock_ty::time_point>
+connect( conn::HTTPSConnection& connection,
+         Credentials& creds,
+         const vector<pair<string,string>>& static_headers,
+         api_on_error_cb_ty on_error_cb,
+         bool return_headers,
+         long success_code )
+{
+    conn::ResponseBuffer r_data;
+    string r_head;
+    conn::clock_ty::time_point r_tp;
+    tie(r_data, r_head, r_tp) = connect_buffer( connection, creds,
+                                                static_headers, on_error_cb,
+                                                return_headers, success_code );
+    return make_tuple(r_data.str(), std::move(r_head), r_tp);
 }
 
 
@@ -335,6 +425,102 @@ connect_get( conn::HTTPSConnection& connection,
 }
 
 
+pair<conn::ResponseBuffer, conn::clock_ty::time_point>
+connect_get_buffer( conn::HTTPSConnection& connection,
+                    Credentials& creds,
+                    api_on_error_cb_ty on_error_cb )
+{
+    static const vector<pair<string,string>> STATIC_HEADERS = {
+        {"Accept", "application/json"}
+    };
+
+    conn::ResponseBuffer r_data;
+    string r_head;
+    conn::clock_ty::time_point r_tp;
+    tie(r_data, r_head, r_tp) = connect_buffer(connection, creds,
+                                               STATIC_HEADERS, on_error_cb,
+                                               false, conn::HTTP_RESPONSE_OK);
+
+    return make_pair(std::move(r_data), r_tp);
+}
+
+
+void
+connect_get_async( conn::HTTPSConnection& connection,
+                   Credentials& creds,
+                   api_on_error_cb_ty on_error_cb,
+                   connect_async_cb_ty callback,
+                   conn::clock_ty::time_point not_before )
+{
+    static const vector<pair<string,string>> STATIC_HEADERS = {
+        {"Accept", "application/json"}
+    };
+
+    string token = cached_access_token(creds);
+    set_auth_headers(connection, STATIC_HEADERS, token);
+
+    /* NOTE - runs on the async engine thread; must not block */
+    auto on_done =
+        [&connection, &creds, on_error_cb, callback, token](
+            conn::execute_result_ty res, std::exception_ptr eptr )
+        {
+            /* the timing is set before the engine calls us, error or not */
+            if( !eptr || is_curl_connection_error(eptr) )
+                record_request( connection.last_timing() );
+
+            string r_data;
+            try{
+                if( eptr )
+                    rethrow_curl_error(eptr);
+
+                long r_code;
+                string r_head;
+                conn::clock_ty::time_point r_tp;
+                tie(r_code, r_data, r_head, r_tp) = res;
+
+                if( !on_return(r_code, conn::HTTP_RESPONSE_OK, r_data, true,
+                               on_error_cb) )
+                {
+                    /*
+                     * expired token; refreshing blocks so run it (and the
+                     * one retry) on the engine's worker thread
+                     */
+                    conn::CurlConnection::execute_blocking(
+                        [&connection, &creds, on_error_cb, callback, token](){
+                            string data;
+                            std::exception_ptr e;
+                            try{
+                                long code;
+                                string body, head;
+                                conn::clock_ty::time_point tp;
+                                tie(code, body, head, tp) =
+                                    retry_with_fresh_token( connection, creds,
+                                                            STATIC_HEADERS,
+                                                            token, false );
+                                bool r = on_return( code,
+                                                    conn::HTTP_RESPONSE_OK,
+                                                    body, false,
+                                                    on_error_cb );
+                                assert(r); /* true or thrown */
+                                data = std::move(body);
+                            }catch(...){
+                                e = std::current_exception();
+                            }
+                            callback(data, e);
+                        } );
+                    return;
+                }
+            }catch(...){
+                callback( string(), std::current_exception() );
+                return;
+            }
+            callback( r_data, nullptr );
+        };
+
+    connection.execute_async(false, on_done, not_before);
+}
+
+
 pair<string, conn::clock_ty::time_point>
 connect_execute( conn::HTTPSConnection& connection,
                  Credentials& creds,
@@ -355,6 +541,78 @@ connect_execute( conn::HTTPSConnection& connection,
 }
 
 
+void
+connect_execute_async( conn::HTTPSConnection& connection,
+                       Credentials& creds,
+                       long success_code,
+                       connect_async_cb_ty callback )
+{
+    static const vector<pair<string,string>> STATIC_HEADERS = {
+        {"Accept", "*/*"},
+        {"Content-Type", "application/json"}
+    };
+
+    string token = cached_access_token(creds);
+    set_auth_headers(connection, STATIC_HEADERS, token);
+
+    /* NOTE - runs on the async engine thread; must not block */
+    auto on_done =
+        [&connection, &creds, success_code, callback, token](
+            conn::execute_result_ty res, std::exception_ptr eptr )
+        {
+            if( !eptr || is_curl_connection_error(eptr) )
+                record_request( connection.last_timing() );
+
+            string r_head;
+            try{
+                if( eptr )
+                    rethrow_curl_error(eptr);
+
+                long r_code;
+                string r_data;
+                conn::clock_ty::time_point r_tp;
+                tie(r_code, r_data, r_head, r_tp) = res;
+
+                if( !on_return(r_code, success_code, r_data, true,
+                               account_api_on_error_callback) )
+                {
+                    /* expired token; refresh and retry on the engine's worker */
+                    conn::CurlConnection::execute_blocking(
+                        [&connection, &creds, success_code, callback, token](){
+                            string head;
+                            std::exception_ptr e;
+                            try{
+                                long code;
+                                string body, h;
+                                conn::clock_ty::time_point tp;
+                                tie(code, body, h, tp) =
+                                    retry_with_fresh_token( connection, creds,
+                                                            STATIC_HEADERS,
+                                                            token, true );
+                                bool r = on_return(
+                                    code, success_code, body, false,
+                                    account_api_on_error_callback
+                                    );
+                                assert(r); /* true or thrown */
+                                head = std::move(h);
+                            }catch(...){
+                                e = std::current_exception();
+                            }
+                            callback(head, e);
+                        } );
+                    return;
+                }
+            }catch(...){
+                callback( string(), std::current_exception() );
+                return;
+            }
+            callback( r_head, nullptr );
+        };
+
+    connection.execute_async(true, on_done);
+}
+
+
 json
 connect_auth(conn::HTTPSPostConnection& connection, std::string fname)
 {
@@ -0,0 +1,354 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+#include "../include/_tdma_api.h"
+
+using std::string;
+using std::shared_ptr;
+using std::cerr;
+using std::endl;
+
+namespace {
+
+using namespace tdma;
+
+typedef std::chrono::steady_clock clock_ty;
+
+/* refresh this long before the access token expires */
+const std::chrono::seconds REFRESH_MARGIN(120);
+
+/* wait this long after a failed background refresh before trying again */
+const std::chrono::seconds REFRESH_RETRY(10);
+
+/*
+ * TokenCache - access tokens by client_id so all cred structs of the same
+ * account are linked but different client_ids aren't
+ *
+ * 1) reads don't lock: the entry map is copy-on-write and each entry's
+ *    token is a shared_ptr swapped atomically
+ * 2) refreshes are single-flight: the first caller w/ a stale token
+ *    refreshes, others w/ the same stale token wait on (and share) it
+ * 3) a background thread refreshes REFRESH_MARGIN before a token we know
+ *    the lifetime of (one we refreshed) expires; a token loaded from disk
+ *    (age unknown) is refreshed once, right away and quietly, so it has
+ *    one too
+ *
+ * NOTE - the cached token takes priority to avoid refresh 'thrashing'
+ *        between unsynced callers
+ */
+class TokenCache{
+    struct Entry{
+        shared_ptr<const string> token; // std::atomic_load/store only
+        std::mutex mtx;
+        std::condition_variable cond;
+        bool refreshing;
+        std::exception_ptr error;
+        Credentials creds; // private copy used to refresh
+        clock_ty::time_point expires; // epoch if unknown
+        clock_ty::time_point next_attempt;
+        bool refresh_now; // one quiet background refresh ASAP (loaded token)
+
+        Entry(const Credentials& c)
+            :
+                token( std::make_shared<const string>(c.access_token) ),
+                refreshing(false),
+                creds(),
+                refresh_now(false)
+            {
+                if( c.refresh_token )
+                    creds = Credentials(c);
+            }
+    };
+
+    typedef std::map<string, shared_ptr<Entry>> entries_ty;
+
+    shared_ptr<const entries_ty> _entries; // std::atomic_load/store only
+    std::mutex _mtx; // inserts and background thread
+    std::condition_variable _cond;
+    bool _stop;
+    std::thread _thread;
+
+    TokenCache()
+        :
+            _entries( std::make_shared<const entries_ty>() ),
+            _stop(false)
+        {
+            _thread = std::thread( &TokenCache::_run, this );
+        }
+
+    shared_ptr<Entry>
+    _find(const char* client_id)
+    {
+        shared_ptr<const entries_ty> e = std::atomic_load(&_entries);
+        auto i = e->find(client_id);
+        return (i == e->end()) ? nullptr : i->second;
+    }
+
+    shared_ptr<Entry>
+    _find_or_insert(const Credentials& creds)
+    {
+        shared_ptr<Entry> entry = _find(creds.client_id);
+        if( entry )
+            return entry;
+
+        std::lock_guard<std::mutex> _(_mtx);
+        shared_ptr<const entries_ty> old = std::atomic_load(&_entries);
+        auto i = old->find(creds.client_id);
+        if( i != old->end() )
+            return i->second;
+
+        std::shared_ptr<entries_ty> e = std::make_shared<entries_ty>(*old);
+        entry = std::make_shared<Entry>(creds);
+        e->insert( {creds.client_id, entry} );
+        std::atomic_store( &_entries, shared_ptr<const entries_ty>(e) );
+        return entry;
+    }
+
+    /* 'caller' (if not null) is used to pick up a newer refresh token */
+    string
+    _refresh( Entry& e,
+              const string& stale_token,
+              const Credentials *caller,
+              bool quiet = false )
+    {
+        std::unique_lock<std::mutex> l(e.mtx);
+
+        bool waited = false;
+        while( true ){
+            shared_ptr<const string> cur = std::atomic_load(&e.token);
+            if( *cur != stale_token )
+                return *cur; /* someone else already refreshed */
+
+            if( !e.refreshing ){
+                if( waited && e.error )
+                    std::rethrow_exception(e.error);
+                break;
+            }
+            e.cond.wait( l, [&e](){ return !e.refreshing; } );
+            waited = true;
+        }
+
+        e.refreshing = true;
+        e.error = nullptr;
+        if( caller && caller->refresh_token && caller->refresh_token[0] )
+            e.creds = Credentials(*caller);
+        l.unlock();
+
+        /* only this thread touches e.creds until 'refreshing' is reset */
+        long long life = 0;
+        std::exception_ptr eptr;
+        try{
+            if( !quiet )
+                cerr<< "refreshing access token..." << endl;
+            life = refresh_access_token(&e.creds);
+            if( !quiet )
+                cerr<< "...successfully refreshed access token" << endl;
+        }catch(...){
+            eptr = std::current_exception();
+        }
+
+        l.lock();
+        e.refreshing = false;
+        e.error = eptr;
+        shared_ptr<const string> tok;
+        if( !eptr ){
+            tok = std::make_shared<const string>(e.creds.access_token);
+            std::atomic_store(&e.token, tok);
+            e.expires = (life > 0)
+                      ? clock_ty::now() + std::chrono::seconds(life)
+                      : clock_ty::time_point();
+        }
+        l.unlock();
+        e.cond.notify_all();
+
+        if( eptr )
+            std::rethrow_exception(eptr);
+        return *tok;
+    }
+
+    void
+    _run()
+    {
+        std::unique_lock<std::mutex> l(_mtx);
+        while( !_stop ){
+            _cond.wait_for( l, std::chrono::seconds(1) );
+            if( _stop )
+                break;
+
+            shared_ptr<const entries_ty> entries = std::atomic_load(&_entries);
+            l.unlock();
+            for( auto& p : *entries )
+                _refresh_if_expiring(*p.second);
+            l.lock();
+        }
+    }
+
+    void
+    _refresh_if_expiring(Entry& e)
+    {
+        string stale;
+        bool loaded;
+        {
+            std::lock_guard<std::mutex> _(e.mtx);
+            auto now = clock_ty::now();
+            loaded = e.refresh_now;
+            bool due = loaded
+                || ( e.expires != clock_ty::time_point()
+                     && now >= e.expires - REFRESH_MARGIN );
+            if( e.refreshing || !due || now < e.next_attempt )
+                return;
+            /* (if this fails the lifetime stays unknown: no retries; a
+               loaded token is then just refreshed on demand) */
+            e.refresh_now = false;
+            e.next_attempt = now + REFRESH_RETRY;
+            stale = *std::atomic_load(&e.token);
+        }
+
+        try{
+            _refresh(e, stale, nullptr, loaded);
+        }catch( std::exception& ex ){
+            if( !loaded )
+                cerr<< "background access token refresh failed: " << ex.what()
+                    << endl;
+        }catch( ... ){
+            if( !loaded )
+                cerr<< "background access token refresh failed" << endl;
+        }
+    }
+
+public:
+    static TokenCache&
+    instance()
+    {
+        static TokenCache cache;
+        return cache;
+    }
+
+    ~TokenCache()
+    {
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            _stop = true;
+        }
+        _cond.notify_all();
+        if( _thread.joinable() )
+            _thread.join();
+    }
+
+    string
+    get(const Credentials& creds)
+    { return *std::atomic_load( &_find_or_insert(creds)->token ); }
+
+    string
+    refresh(const Credentials& creds, const string& stale_token)
+    { return _refresh( *_find_or_insert(creds), stale_token, &creds ); }
+
+    void
+    update(const Credentials& creds, long long life_sec)
+    {
+        shared_ptr<Entry> e = _find_or_insert(creds);
+        std::lock_guard<std::mutex> _(e->mtx);
+        std::atomic_store( &e->token,
+                           std::make_shared<const string>(creds.access_token) );
+        if( creds.refresh_token )
+            e->creds = Credentials(creds);
+        e->expires = (life_sec > 0)
+                   ? clock_ty::now() + std::chrono::seconds(life_sec)
+                   : clock_ty::time_point();
+        e->refresh_now = false;
+    }
+
+    void
+    load(const Credentials& creds)
+    {
+        if( !creds.client_id || !creds.client_id[0] || !creds.access_token
+            || !creds.refresh_token || !creds.refresh_token[0] )
+        {
+            return;
+        }
+
+        shared_ptr<Entry> e = _find_or_insert(creds);
+        {
+            std::lock_guard<std::mutex> _(e->mtx);
+            /* cached token still takes priority; if we know its lifetime
+               there's nothing to do */
+            if( e->expires != clock_ty::time_point() )
+                return;
+            if( !e->refreshing )
+                e->creds = Credentials(creds);
+            e->refresh_now = true;
+        }
+        _cond.notify_all();
+    }
+};
+
+
+void
+check_creds(const Credentials& creds)
+{
+    if( !creds.access_token || !creds.client_id )
+        TDMA_API_THROW( LocalCredentialException, "invalid credentials" );
+
+    if( creds.access_token[0] == '\0' )
+        TDMA_API_THROW( LocalCredentialException, "empty access_token" );
+
+    if( creds.client_id[0] == '\0' )
+        TDMA_API_THROW( LocalCredentialException, "empty client_id");
+}
+
+} /* namespace */
+
+
+namespace tdma{
+
+string
+cached_access_token(Credentials& creds)
+{
+    check_creds(creds);
+    return TokenCache::instance().get(creds);
+}
+
+string
+refresh_cached_access_token(Credentials& creds, const string& stale_token)
+{
+    check_creds(creds);
+    return TokenCache::instance().refresh(creds, stale_token);
+}
+
+void
+update_cached_access_token(const Credentials& creds, long long life_sec)
+{
+    check_creds(creds);
+    TokenCache::instance().update(creds, life_sec);
+}
+
+void
+load_cached_access_token(const Credentials& creds)
+{
+    /* no check_creds: loading a stored file shouldn't throw on it */
+    TokenCache::instance().load(creds);
+}
+
+} /* tdma */
@@ -16,6 +16,7 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 */
 
 #include <iostream>
+#include <algorithm>
 
 #include "../include/websocket_connect.h"
 
@@ -32,23 +33,32 @@ void
 D(string msg, WebSocketClient *obj)
 { util::debug_out("WebSocket", msg, obj, std::cout); }
 
-WebSocketClient *WebSocketClient::Callbacks::wsc = nullptr;
-
-WebSocketClient::WebSocketClient(string url)
+WebSocketClient::WebSocketClient(string url, bool compress, Stats *stats)
     :
-        _hub(),
+        /* we only inflate; outgoing messages are small */
+        _hub( 0, false, 16777216, compress ? uWS::PERMESSAGE_DEFLATE : 0 ),
         _url(url),
         _signal(new uS::Async(_hub.getLoop())),
+        _signal_mtx(),
         _thread(),
-        _in_queue(),
+        _in_ring(IN_RING_CAPACITY),
         _out_queue(),
         _init_cond(),
         _init_flag(false),
         _init_mtx(),
         _ws(nullptr),
-        _closing_state( CloseType::none )
+        _stats(stats),
+        _closing_state( CloseType::none ),
+        _inline_handlers(),
+        _inline(false),
+        _inline_msg(),
+        _timer(nullptr),
+        _inline_next(),
+        _inline_switching(false),
+        _inline_closed(false),
+        _inline_mtx(),
+        _inline_cond()
     {
-        Callbacks::wsc = this;
         _hub.onConnection( Callbacks::on_connect );
         _hub.onDisconnection( Callbacks::on_disconnect );
         _hub.onError( Callbacks::on_error );
@@ -66,13 +76,29 @@ WebSocketClient::~WebSocketClient()
 }
 
 
+WebSocketClient*
+WebSocketClient::Callbacks::client(uws_client_ty *ws)
+{
+    /*
+     * uWS re-uses the user data for the close timer once the socket is
+     * shutting down; by then we've been told of the disconnect
+     */
+    if( ws->isShuttingDown() )
+        return nullptr;
+    return reinterpret_cast<WebSocketClient*>(ws->getUserData());
+}
+
+
 void
 WebSocketClient::Callbacks::on_connect( uws_client_ty *ws, uWS::HttpRequest r)
 {
+    WebSocketClient *wsc = client(ws);
     D("on_connect", wsc);
 
     assert(wsc);
     wsc->_ws = ws;
+    if( wsc->_stats )
+        wsc->_stats->compressed = ws->hasPerMessageDeflate();
     {
         lock_guard<mutex> _(wsc->_init_mtx);
         wsc->_init_flag = true;
@@ -87,26 +113,31 @@ WebSocketClient::Callbacks::on_disconnect( uws_client_ty *ws,
                                            char* msg,
                                            size_t msg_len )
 {
+    WebSocketClient *wsc = client(ws);
     D("on_disconnect", wsc);
 
     assert(wsc);
     wsc->_ws = nullptr;
+    wsc->_end_inline();
 
     D("on_disconnect, _signal->close", wsc);
-    wsc->_signal->close();
+    wsc->_close_signal();
 }
 
 
 void
 WebSocketClient::Callbacks::on_error(void *v)
 {
+    /* the user data passed to Hub::connect */
+    WebSocketClient *wsc = reinterpret_cast<WebSocketClient*>(v);
     D("on_error", wsc);
 
     assert(wsc);
     wsc->_ws = nullptr;
+    wsc->_end_inline();
 
     D("on_error, _signal->close", wsc);
-    wsc->_signal->close();
+    wsc->_close_signal();
     {
         lock_guard<mutex> _(wsc->_init_mtx);
         wsc->_init_flag = true;
@@ -121,25 +152,46 @@ WebSocketClient::Callbacks::on_message( uws_client_ty *ws,
                                         size_t msg_len,
                                         uWS::OpCode op )
 {
-    D("on_message", wsc);
+    WebSocketClient *wsc = client(ws);
+    if( !wsc ) /* late frame after we closed */
+        return;
+    assert( msg_len );
+
+#ifdef DEBUG_VERBOSE_1_
+    D("on_message: " + string(msg, msg_len), wsc);
+#endif /* DEBUG_VERBOSE_1_ */
+
+    if( wsc->_stats ){
+        /* we're the only writer; skip the locked RMW */
+        Stats& s = *wsc->_stats;
+        auto bump = [](std::atomic<unsigned long long>& a, size_t n){
+            a.store(a.load(std::memory_order_relaxed) + n,
+                    std::memory_order_relaxed);
+        };
+        bump(s.messages, 1);
+        bump(s.wire_bytes, ws->getWireLength());
+        bump(s.decoded_bytes, msg_len);
+    }
 
-    assert(wsc);
-    string msg_s(msg, msg_len);
-    assert( !msg_s.empty() );
+    /* only this thread switches modes; no lock */
+    if( wsc->_inline.load(std::memory_order_relaxed) ){
+        wsc->_inline_msg.assign(msg, msg_len);
+        wsc->_inline_handlers.on_message(wsc->_inline_msg);
+        return;
+    }
 
-    D("message: " + msg_s, wsc);
-    wsc->_in_queue.emplace( msg_s );
+    /* copy straight into a pooled ring slot */
+    wsc->_in_ring.push( [msg, msg_len](string& s){ s.assign(msg, msg_len); } );
 }
 
 
 void
 WebSocketClient::Callbacks::on_signal(uS::Async *a)
 {
+    auto wsc = reinterpret_cast<WebSocketClient*>(a->getData());
     D("on_signal", wsc);
 
-    auto wsc = reinterpret_cast<WebSocketClient*>(a->getData());
     assert(wsc);
-    assert(wsc == WebSocketClient::Callbacks::wsc);
     assert(wsc->_ws);
 
     if( wsc->_closing_state == CloseType::immediate ){
@@ -155,6 +207,8 @@ WebSocketClient::Callbacks::on_signal(uS::Async *a)
         wsc->_ws->send(msg.c_str(), msg.size(), uWS::OpCode::TEXT);
     }
 
+    wsc->_switch_inline();
+
     if( wsc->_closing_state == CloseType::graceful ){
         D("on_signal, _ws->close", wsc);
         wsc->_ws->close();
@@ -162,6 +216,148 @@ WebSocketClient::Callbacks::on_signal(uS::Async *a)
 }
 
 
+void
+WebSocketClient::Callbacks::on_timer(uS::Timer *t)
+{
+    auto wsc = reinterpret_cast<WebSocketClient*>(t->getData());
+    assert(wsc);
+
+    if( wsc->_inline.load(std::memory_order_relaxed)
+        && wsc->_inline_handlers.on_timer )
+    {
+        wsc->_inline_handlers.on_timer();
+    }
+}
+
+
+/* uWS thread */
+void
+WebSocketClient::_close_timer()
+{
+    if( _timer ){
+        _timer->stop();
+        _timer->close();
+        _timer = nullptr;
+    }
+}
+
+
+bool
+WebSocketClient::_request_inline(InlineHandlers handlers)
+{
+    {
+        lock_guard<mutex> _(_inline_mtx);
+        if( _inline_closed )
+            return false;
+        _inline_next = handlers;
+        _inline_switching = true;
+    }
+
+    if( !_send_signal() ){
+        lock_guard<mutex> _(_inline_mtx);
+        _inline_switching = false;
+        return false;
+    }
+
+    /* on_signal makes the switch; _end_inline gives up on it */
+    std::unique_lock<mutex> lock(_inline_mtx);
+    _inline_cond.wait( lock, [this]{ return !_inline_switching; } );
+    return !_inline_closed;
+}
+
+
+/* uWS thread */
+void
+WebSocketClient::_switch_inline()
+{
+    InlineHandlers next;
+    {
+        lock_guard<mutex> _(_inline_mtx);
+        if( !_inline_switching )
+            return;
+        next = _inline_next;
+        _inline_next = InlineHandlers();
+    }
+
+    if( next.on_message && !_inline ){
+        /*
+         * the requester waits for us, so this thread is the ring's reader
+         * until we're done (the handshake orders the hand-off)
+         */
+        string msg;
+        while( _in_ring.pop(msg) ){
+            if( msg.empty() ){
+                /* put the stop message back for the reader */
+                _in_ring.interrupt();
+                break;
+            }
+            next.on_message(msg);
+        }
+    }
+
+    _close_timer();
+    if( next.on_message && next.on_timer ){
+        D("_switch_inline, start inline timer", this);
+        int ms = static_cast<int>(next.interval.count());
+        _timer = new uS::Timer(_hub.getLoop());
+        _timer->setData( reinterpret_cast<void*>(this) );
+        _timer->start( Callbacks::on_timer, ms, ms );
+    }
+
+    _inline_handlers = next;
+    _inline.store( static_cast<bool>(next.on_message),
+                   std::memory_order_relaxed );
+    {
+        lock_guard<mutex> _(_inline_mtx);
+        _inline_switching = false;
+    }
+    _inline_cond.notify_all();
+}
+
+
+/* uWS thread */
+void
+WebSocketClient::_end_inline()
+{
+    _close_timer();
+    /* inline reader is only waiting on the ring for the stop message */
+    if( _inline )
+        _in_ring.interrupt();
+    _inline = false;
+    _inline_handlers = InlineHandlers();
+    {
+        lock_guard<mutex> _(_inline_mtx);
+        _inline_closed = true;
+        _inline_switching = false;
+        _inline_next = InlineHandlers();
+    }
+    _inline_cond.notify_all();
+}
+
+
+bool
+WebSocketClient::_send_signal()
+{
+    lock_guard<mutex> _(_signal_mtx);
+    if( !_signal )
+        return false;
+    _signal->send();
+    return true;
+}
+
+
+/* uWS thread */
+void
+WebSocketClient::_close_signal()
+{
+    lock_guard<mutex> _(_signal_mtx);
+    if( _signal ){
+        _signal->close();
+        _signal = nullptr;
+    }
+}
+
+
 void
 WebSocketClient::connect(milliseconds timeout)
 {
@@ -202,7 +398,7 @@ WebSocketClient::close(bool graceful)
     if( is_connected() ){
         _closing_state = graceful ? CloseType::graceful : CloseType::immediate;
         D("close, _signal->send", this);
-        _signal->send();
+        _send_signal();
     }
 
     D("close, join _thread", this);
@@ -219,31 +415,57 @@ WebSocketClient::send(string msg)
     if( is_connected() ){
         _out_queue.emplace(msg);
         D("send, _signal->send: " + msg, this);
-        _signal->send();
+        _send_signal();
     }
 }
 
 
+bool
+WebSocketClient::start_inline( inline_message_cb_ty on_message,
+                               inline_timer_cb_ty on_timer,
+                               milliseconds interval )
+{
+    D("start_inline", this);
+    if( !is_connected() )
+        return false;
+
+    return _request_inline(
+        {on_message, on_timer, std::max(interval, milliseconds(1))}
+        );
+}
+
+
+void
+WebSocketClient::stop_inline()
+{
+    D("stop_inline", this);
+    /* false if disconnected; the handlers are done w/ either way */
+    _request_inline( InlineHandlers() );
+}
+
+
 string
 WebSocketClient::recv()
 {
-    auto p = _in_queue.front_safe();
-    return p.second ? p.first : "";
+    string msg;
+    return _in_ring.pop(msg) ? msg : "";
 }
 
 
 string
 WebSocketClient::recv_or_wait()
 {
-    return _in_queue.pop_front_or_wait();
+    string msg;
+    _in_ring.pop_or_wait(msg);
+    return msg;
 }
 
 
 string
 WebSocketClient::recv_or_wait_for(milliseconds timeout)
 {
-    auto p = _in_queue.pop_front_or_wait_for(timeout);
-    return p.second ? p.first : "";
+    string msg;
+    return _in_ring.pop_or_wait_for(msg, timeout) ? msg : "";
 }
 
 
@@ -251,12 +473,9 @@ vector<string>
 WebSocketClient::recv_all()
 {
     vector<string> ret;
-
-    auto p = _in_queue.pop_front_safe();
-    while( p.second ){
-        ret.emplace_back( p.first );
-        p = _in_queue.pop_front_safe();
-    }
+    string msg;
+    while( _in_ring.pop(msg) )
+        ret.emplace_back( std::move(msg) );
     return ret;
 }
 
@@ -296,12 +515,9 @@ vector<string>
 WebSocketClient::recv_atmost_n(size_t n)
 {
     vector<string> ret;
-    while( ret.size() < n ){
-        auto p = _in_queue.pop_front_safe();
-        if( !p.second )
-            break;
-        ret.emplace_back(p.first);
-    }
+    string msg;
+    while( ret.size() < n && _in_ring.pop(msg) )
+        ret.emplace_back( std::move(msg) );
     return ret;
 }
 
@@ -310,9 +526,10 @@ vector<string>
 WebSocketClient::recv_n_or_wait(size_t n)
 {
     vector<string> ret;
+    string msg;
     while( ret.size() < n ){
-        auto p = _in_queue.pop_front_or_wait();
-        ret.emplace_back(p);
+        _in_ring.pop_or_wait(msg);
+        ret.emplace_back( std::move(msg) );
     }
     return ret;
 }
@@ -321,20 +538,13 @@ WebSocketClient::recv_n_or_wait(size_t n)
 vector<string>
 WebSocketClient::recv_n_or_wait_for(size_t n, milliseconds timeout)
 {
-    using namespace std::chrono;
-
     vector<string> ret;
-    auto t_beg = steady_clock::now();
-    auto t_left = timeout;
-
-    while( ret.size() < n && t_left.count() >= 0 ){
-        auto p = _in_queue.pop_front_or_wait_for(t_left);
-        if( !p.second )
+    string msg;
+    auto t_end = std::chrono::steady_clock::now() + timeout;
+    while( ret.size() < n ){
+        if( !_in_ring.pop_or_wait_until(msg, t_end) )
             break;
-        ret.emplace_back(p.first);
-        auto t_elapsed =
-            duration_cast<milliseconds>(steady_clock::now() - t_beg);
-        t_left = timeout - t_elapsed;
+        ret.emplace_back( std::move(msg) );
     }
     return ret;
 }
@@ -60,6 +60,7 @@ int test_ironcondor_unbalanced_spread_order_builder(); /*DONE*/
 int test_doublediagonal_spread_order_builder(); /*DONE*/
 int test_one_cancels_other_order_builder(); /*DONE*/
 int test_one_triggers_other_order_builder(); /*DONE*/
+int test_order_json_string();
 
 int
 Test_Execution_Order_Objects()
@@ -154,6 +155,10 @@ Test_Execution_Order_Objects()
     if( err )
         return err;
 
+    err = test_order_json_string();
+    if( err )
+        return err;
+
     return 0;
 }
 
@@ -5293,6 +5298,160 @@ int test_order_access()
 }
 
 
+/* expected strings are what json.hpp's dump() gives for the same order */
+int check_json_string(OrderTicket_C* porder, const char* expected,
+                      const char* name)
+{
+    int err = 0;
+    char *buf;
+    size_t n;
+
+    if( (err = OrderTicket_AsJsonString(porder, &buf, &n)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_AsJsonString");
+
+    if( strcmp(buf, expected) || n != strlen(expected) + 1 ){
+        fprintf(stderr, "json string doesn't match(%s):\n%s\n%s\n", name, buf,
+                expected);
+        FreeBuffer(buf);
+        return -1;
+    }
+    printf("%s\n%s\n", name, buf);
+    FreeBuffer(buf);
+    return 0;
+}
+
+int test_order_json_string()
+{
+    int err = 0;
+    OrderTicket_C o1 = {0,0}, o2 = {0,0}, o3 = {0,0}, o4 = {0,0};
+    OrderLeg_C legs[] = {{0,0},{0,0}};
+
+    if( (err = BuildOrder_Equity_Limit("SPY", 100, 1, 1, 289.91, &o1)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "BuildOrder_Equity_Limit");
+    if( (err = OrderTicket_SetDuration(&o1, OrderDuration_GOOD_TILL_CANCEL)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetDuration");
+    if( (err = OrderTicket_SetCancelTime(&o1, "2019-12-31")) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetCancelTime");
+
+    if( check_json_string(&o1,
+        "{\"cancelTime\":\"2019-12-31\",\"duration\":\"GOOD_TILL_CANCEL\","
+        "\"orderLegCollection\":[{\"instruction\":\"BUY\",\"instrument\":"
+        "{\"assetType\":\"EQUITY\",\"symbol\":\"SPY\"},\"quantity\":100}],"
+        "\"orderStrategyType\":\"SINGLE\",\"orderType\":\"LIMIT\","
+        "\"price\":\"289.9100\",\"session\":\"NORMAL\"}",
+        "JSON-STRING-[GTC]") )
+    {
+        return -1;
+    }
+
+    if( (err = BuildOrder_Equity_Stop("SPY", 100, 0, 1, 282.01, &o2)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "BuildOrder_Equity_Stop");
+    if( (err = BuildOrder_OneCancelsOther(&o1, &o2, &o3)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "BuildOrder_OneCancelsOther");
+
+    if( check_json_string(&o3,
+        "{\"childOrderStrategies\":[{\"cancelTime\":\"2019-12-31\","
+        "\"duration\":\"GOOD_TILL_CANCEL\",\"orderLegCollection\":"
+        "[{\"instruction\":\"BUY\",\"instrument\":{\"assetType\":\"EQUITY\","
+        "\"symbol\":\"SPY\"},\"quantity\":100}],\"orderStrategyType\":"
+        "\"SINGLE\",\"orderType\":\"LIMIT\",\"price\":\"289.9100\","
+        "\"session\":\"NORMAL\"},{\"duration\":\"DAY\",\"orderLegCollection\":"
+        "[{\"instruction\":\"SELL_SHORT\",\"instrument\":{\"assetType\":"
+        "\"EQUITY\",\"symbol\":\"SPY\"},\"quantity\":100}],"
+        "\"orderStrategyType\":\"SINGLE\",\"orderType\":\"STOP\","
+        "\"session\":\"NORMAL\",\"stopPrice\":\"282.0100\"}],"
+        "\"orderStrategyType\":\"OCO\"}",
+        "JSON-STRING-[OCO]") )
+    {
+        return -1;
+    }
+
+    if( (err = OrderTicket_SetCancelTime(&o1,
+                                   "\"q\" \\ \b\f\n\r\t \x01\x1f /")) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetCancelTime");
+
+    if( check_json_string(&o1,
+        "{\"cancelTime\":\"\\\"q\\\" \\\\ \\b\\f\\n\\r\\t \\u0001\\u001f /\","
+        "\"duration\":\"GOOD_TILL_CANCEL\","
+        "\"orderLegCollection\":[{\"instruction\":\"BUY\",\"instrument\":"
+        "{\"assetType\":\"EQUITY\",\"symbol\":\"SPY\"},\"quantity\":100}],"
+        "\"orderStrategyType\":\"SINGLE\",\"orderType\":\"LIMIT\","
+        "\"price\":\"289.9100\",\"session\":\"NORMAL\"}",
+        "JSON-STRING-[CONTROL CHARACTERS]") )
+    {
+        return -1;
+    }
+
+    err = OrderLeg_Create(OrderAssetType_EQUITY, "\xc3\x84\xc3\x96",
+                          OrderInstruction_BUY, 10, &legs[0]);
+    if( err ) CHECK_AND_RETURN_ON_ERROR(err, "OrderLeg_Create");
+
+    err = OrderLeg_Create(OrderAssetType_EQUITY, "\xe2\x82\xac\xf0\x9f\x98\x80",
+                          OrderInstruction_SELL, 20, &legs[1]);
+    if( err ){
+        OrderLeg_Destroy(&legs[0]);
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderLeg_Create (2)");
+    }
+
+    if( (err = OrderTicket_Create(&o4)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_Create");
+    if( (err = OrderTicket_SetType(&o4, OrderType_LIMIT)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetType");
+    if( (err = OrderTicket_SetDuration(&o4, OrderDuration_DAY)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetDuration");
+    if( (err = OrderTicket_SetSession(&o4, OrderSession_NORMAL)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetSession");
+    if( (err = OrderTicket_SetPrice(&o4, 123456789012.9999)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetPrice");
+    if( (err = OrderTicket_SetStopPrice(&o4, 0.00005)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetStopPrice");
+    if( (err = OrderTicket_AddLegs(&o4, legs, 2)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_AddLegs");
+
+    OrderLeg_Destroy(&legs[0]);
+    OrderLeg_Destroy(&legs[1]);
+
+    if( check_json_string(&o4,
+        "{\"duration\":\"DAY\",\"orderLegCollection\":[{\"instruction\":"
+        "\"BUY\",\"instrument\":{\"assetType\":\"EQUITY\",\"symbol\":"
+        "\"\xc3\x84\xc3\x96\"},\"quantity\":10},{\"instruction\":\"SELL\","
+        "\"instrument\":{\"assetType\":\"EQUITY\",\"symbol\":"
+        "\"\xe2\x82\xac\xf0\x9f\x98\x80\"},\"quantity\":20}],"
+        "\"orderStrategyType\":\"SINGLE\",\"orderType\":\"LIMIT\","
+        "\"price\":\"123456789012.9999\",\"session\":\"NORMAL\","
+        "\"stopPrice\":\"0.0001\"}",
+        "JSON-STRING-[NON-ASCII SYMBOLS, LARGE PRICE]") )
+    {
+        return -1;
+    }
+
+    if( (err = OrderTicket_SetPrice(&o4, -0.0001)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetPrice");
+    if( (err = OrderTicket_SetStopPrice(&o4, -98765.4321)) )
+        CHECK_AND_RETURN_ON_ERROR(err, "OrderTicket_SetStopPrice");
+
+    if( check_json_string(&o4,
+        "{\"duration\":\"DAY\",\"orderLegCollection\":[{\"instruction\":"
+        "\"BUY\",\"instrument\":{\"assetType\":\"EQUITY\",\"symbol\":"
+        "\"\xc3\x84\xc3\x96\"},\"quantity\":10},{\"instruction\":\"SELL\","
+        "\"instrument\":{\"assetType\":\"EQUITY\",\"symbol\":"
+        "\"\xe2\x82\xac\xf0\x9f\x98\x80\"},\"quantity\":20}],"
+        "\"orderStrategyType\":\"SINGLE\",\"orderType\":\"LIMIT\","
+        "\"price\":\"-0.0001\",\"session\":\"NORMAL\","
+        "\"stopPrice\":\"-98765.4321\"}",
+        "JSON-STRING-[NEGATIVE PRICES]") )
+    {
+        return -1;
+    }
+
+    OrderTicket_Destroy(&o1);
+    OrderTicket_Destroy(&o2);
+    OrderTicket_Destroy(&o3);
+    OrderTicket_Destroy(&o4);
+    return 0;
+}
+
+
 int test_order_leg(size_t nleg, OrderLeg_C* l1, struct TestLeg *l2)
 {
     int err = 0;
@@ -3,6 +3,8 @@
 #define TEST_H_
 
 #include <string>
+#include <stdexcept>
+#include <cmath>
 
 #include "tdma_common.h"
 
@@ -10,10 +12,26 @@ extern bool use_live_connection;
 
 long long msec_since_epoch();
 
+/* offline checks */
+inline void
+check(bool b, const std::string& msg)
+{
+    if( !b )
+        throw std::runtime_error(msg);
+}
+
+inline bool
+approx(double a, double b)
+{ return std::fabs(a - b) < 1e-9; }
+
 void test_getters(const std::string& account_id, Credentials& creds);
 
 void test_streaming(const std::string& account_id, Credentials& c);
 
+void test_candles(); // offline
+
+void test_streaming_decoders(); // offline
+
 void test_execution_order_objects();
 
 void
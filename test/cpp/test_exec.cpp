@@ -1986,6 +1986,139 @@ test_conditional_exec_oto()
 }
 
 
+void
+test_exec_json_string(const OrderTicket& order, string e)
+{
+    string s = order.as_json_string();
+    string d = order.as_json().dump();
+    cout << e << endl << s << endl;
+
+    if( s != d ){
+        throw runtime_error("as_json_string() != as_json().dump() (" + e
+                            + "):\n" + s + "\n" + d);
+    }
+}
+
+void
+test_exec_json_strings()
+{
+    OrderTicket order1 =
+        SimpleOrderBuilder::Equity::Build("SPY", 100, true, true, 289.91);
+    test_exec_json_string(order1, "JSON-STRING-[LIMIT-BUY-EQUITY]");
+
+    order1.set_duration(OrderDuration::GOOD_TILL_CANCEL)
+          .set_cancel_time("2019-12-31");
+    test_exec_json_string(order1, "JSON-STRING-[GTC]");
+
+    OrderTicket order2 = SpreadOrderBuilder::IronCondor::Build(
+        "SPY_011720P200", "SPY_011720P225", "SPY_011720C300",
+        "SPY_011720C325", 3, true, .25);
+    test_exec_json_string(order2, "JSON-STRING-[IRON_CONDOR]");
+
+    OrderTicket order3 =
+        SimpleOrderBuilder::Equity::Stop::Build("SPY", 100, false, true, 282.01);
+    test_exec_json_string( ConditionalOrderBuilder::OCO(order1, order3),
+                           "JSON-STRING-[OCO]" );
+    test_exec_json_string( ConditionalOrderBuilder::OTO(order3, order2),
+                           "JSON-STRING-[OTO]" );
+
+    OrderTicket order4 =
+        SimpleOrderBuilder::Equity::Build("SPY", 1, true, true, 1.0);
+    order4.set_duration(OrderDuration::GOOD_TILL_CANCEL)
+          .set_cancel_time("\"q\" \\ \b\f\n\r\t \x01\x1f\x7f /");
+    test_exec_json_string(order4, "JSON-STRING-[CONTROL CHARACTERS]");
+
+    OrderTicket order5;
+    order5.set_type(OrderType::LIMIT)
+          .set_duration(OrderDuration::DAY)
+          .set_session(OrderSession::NORMAL)
+          .set_price(1.5)
+          .add_leg( {OrderAssetType::EQUITY, "\xc3\x84\xc3\x96",
+                     OrderInstruction::BUY, 10} )
+          .add_leg( {OrderAssetType::EQUITY, "\xe2\x82\xac\xf0\x9f\x98\x80",
+                     OrderInstruction::SELL, 20} );
+    test_exec_json_string(order5, "JSON-STRING-[NON-ASCII SYMBOLS]");
+
+    order5.set_price(123456789012.9999).set_stop_price(0.00005);
+    test_exec_json_string(order5, "JSON-STRING-[LARGE PRICE]");
+
+    order5.set_price(-0.0001).set_stop_price(-98765.4321);
+    test_exec_json_string(order5, "JSON-STRING-[NEGATIVE PRICES]");
+
+    order5.set_price(1e300);
+    test_exec_json_string(order5, "JSON-STRING-[HUGE PRICE]");
+}
+
+
+template<typename F>
+void
+test_exec_throws(F f, string e)
+{
+    try{
+        f();
+    }catch( APIException& ex ){
+        cout<< "successfully caught exception: " << ex << endl;
+        return;
+    }
+    throw runtime_error("failed to catch exception(" + e + ")");
+}
+
+void
+test_exec_template_obj_json(const OrderTemplate& t, const OrderTicket& order,
+                            string e)
+{
+    cout << e << endl << t.as_json_string() << endl;
+
+    if( t.as_json() != order.as_json() )
+        throw runtime_error("template json doesn't match order(" + e + ")");
+}
+
+void
+test_exec_order_template()
+{
+    /* no connection is made until warm/send */
+    OrderTicket order = SpreadOrderBuilder::Vertical::Build("SPY_011720C300",
+        "SPY_011720C325", 1, true, 11.99);
+    OrderTemplate t("123456789", order);
+    test_exec_template_obj_json(t, order, "TEMPLATE-[VERTICAL]");
+
+    t.set_price(1234.5).set_quantity(0, 25).set_quantity(1, 25);
+    order = SpreadOrderBuilder::Vertical::Build("SPY_011720C300",
+        "SPY_011720C325", 25, true, 1234.5);
+    test_exec_template_obj_json(t, order, "TEMPLATE-[VERTICAL, PATCHED]");
+
+    t.set_quantity(1, 18446744073709551615ULL);
+    string body = t.as_json_string();
+    if( t.as_json()["orderLegCollection"][1]["quantity"]
+        != 18446744073709551615ULL )
+    {
+        throw runtime_error("template max quantity doesn't match");
+    }
+
+    test_exec_throws( [&](){ t.set_price(1e30); },
+                      "TEMPLATE-[PRICE TOO WIDE]" );
+    test_exec_throws( [&](){ t.set_price(-1e22); },
+                      "TEMPLATE-[NEGATIVE PRICE TOO WIDE]" );
+    test_exec_throws( [&](){ t.set_quantity(2, 1); },
+                      "TEMPLATE-[BAD LEG INDEX]" );
+    test_exec_throws( [&](){ t.set_quantity(0, 0); },
+                      "TEMPLATE-[ZERO QUANTITY]" );
+    test_exec_throws( [&](){ t.set_stop_price(1.0); },
+                      "TEMPLATE-[NO STOP PRICE]" );
+    if( t.as_json_string() != body )
+        throw runtime_error("template body changed by a failed patch");
+
+    order = SimpleOrderBuilder::Equity::Stop::Build("SPY", 100, true, true,
+                                                    275.00, 275.10);
+    OrderTemplate t2("123456789", order);
+    test_exec_template_obj_json(t2, order, "TEMPLATE-[STOP_LIMIT]");
+
+    t2.set_price(-0.0001).set_stop_price(999999999999.9999);
+    order.set_price(-0.0001).set_stop_price(999999999999.9999);
+    test_exec_template_obj_json(t2, order, "TEMPLATE-[STOP_LIMIT, PATCHED]");
+}
+
+
 void
 test_execution_order_objects()
 {    
@@ -2014,6 +2147,8 @@ test_execution_order_objects()
     test_spread_exec_double_diagonal();
     test_conditional_exec_oco();
     test_conditional_exec_oto();
+    test_exec_json_strings();
+    test_exec_order_template();
 }
 
 /* LIVE ORDERS! */
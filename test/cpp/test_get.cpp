@@ -2,10 +2,19 @@
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <memory>
 
 #include "test.h"
 
 #include "tdma_api_get.h"
+#include "_tdma_api.h"
+#include "_get.h" /* CandleColumns, decode_candles */
+#include "candle_store.h"
 
 using namespace tdma;
 using namespace std;
@@ -866,6 +875,14 @@ historical_getters(Credentials& c)
     }catch(ValueException& e){
         cout<< "succesfully caught: " << e << endl;
     }
+    /* checked before any I/O, so this is safe offline */
+    try{
+        hpg.get_async();
+        throw runtime_error("failed to catch exception for bad frequency type"
+                            " (async)");
+    }catch(ValueException& e){
+        cout<< "succesfully caught: " << e << endl;
+    }
     hpg.set_frequency(FrequencyType::minute, 30);
 
     try{
@@ -1037,6 +1054,9 @@ quote_getters(Credentials& c)
         if( qsg.get() != json() )
             throw runtime_error("empty quotes getter did not return {}");
     }
+    /* no request is made, so this is safe offline */
+    if( qsg.get_async().get() != json() )
+        throw runtime_error("empty quotes getter (async) did not return {}");
 
     qsg.add_symbols( {"xlf","XLY", "XLE"} );
     if( qsg.get_symbols() != set<string>{"XLF","XLY", "XLE"} )
@@ -1085,8 +1105,298 @@ quote_getters(Credentials& c)
 }
 
 
+/* OFFLINE - candle decoding and the candle store */
+
+namespace {
+
+const long long MSEC_MIN = 60 * 1000;
+const long long T0 = 1538404200000; // 10/01/2018 14:30 UTC
+
+bool
+decode_fails(const string& j)
+{
+    try{
+        CandleColumns c;
+        decode_candles(j.data(), j.size(), c);
+    }catch( ValueException& e ){
+        cout<< "successfully caught: " << e.what() << endl;
+        Candles_C cc;
+        try{
+            decode_candles(j.data(), j.size(), &cc);
+        }catch( ValueException& ){
+            return cc.n == 0 && cc.datetime == nullptr;
+        }
+    }
+    return false;
+}
+
+void
+test_candle_decoder()
+{
+    /* any field order, null -> NaN (0 for datetime/volume), unknown keys */
+    string j = "{\"symbol\":\"SPY\",\"other\":{\"a\":[1,{\"b\":\"]}\"}]},"
+               "\"candles\":["
+               "{\"open\":1.5,\"high\":2,\"low\":1,\"close\":1.75,"
+               "\"volume\":100,\"datetime\":1538404200000},"
+               "{\"datetime\":1538404260000,\"close\":2.5,\"x\":[1,2],"
+               "\"volume\":200,\"low\":2.25,\"open\":null,\"high\":3e0},"
+               "{\"datetime\":null,\"volume\":null,\"y\":\"z\"}"
+               "],\"empty\":false}";
+
+    CandleColumns c;
+    decode_candles(j.data(), j.size(), c);
+    check( c.size() == 3, "candles: bad size" );
+    check( c.datetime[0] == 1538404200000 && c.open[0] == 1.5
+           && c.high[0] == 2.0 && c.low[0] == 1.0 && c.close[0] == 1.75
+           && c.volume[0] == 100, "candles: bad first candle" );
+    check( c.datetime[1] == 1538404260000 && std::isnan(c.open[1])
+           && c.high[1] == 3.0 && c.low[1] == 2.25 && c.close[1] == 2.5
+           && c.volume[1] == 200, "candles: bad reordered candle" );
+    check( c.datetime[2] == 0 && c.volume[2] == 0 && std::isnan(c.open[2])
+           && std::isnan(c.high[2]) && std::isnan(c.low[2])
+           && std::isnan(c.close[2]), "candles: bad null/missing fields" );
+
+    /* appends */
+    decode_candles(j.data(), j.size(), c);
+    check( c.size() == 6 && c.close[3] == 1.75, "candles: didn't append" );
+
+    /* ONE block: [datetime][open][high][low][close][volume] */
+    Candles_C cc;
+    decode_candles(j.data(), j.size(), &cc);
+    check( cc.n == 3, "candles: bad Candles_C size" );
+    const char *block = reinterpret_cast<const char*>(cc.datetime);
+    size_t sz = cc.n * sizeof(double);
+    check( reinterpret_cast<const char*>(cc.open) == block + sz
+           && reinterpret_cast<const char*>(cc.high) == block + sz * 2
+           && reinterpret_cast<const char*>(cc.low) == block + sz * 3
+           && reinterpret_cast<const char*>(cc.close) == block + sz * 4
+           && reinterpret_cast<const char*>(cc.volume) == block + sz * 5,
+           "candles: Candles_C isn't one block" );
+    for( size_t i = 0; i < cc.n; ++i ){
+        check( cc.datetime[i] == c.datetime[i]
+               && cc.volume[i] == c.volume[i]
+               && (cc.close[i] == c.close[i]
+                   || (std::isnan(cc.close[i]) && std::isnan(c.close[i]))),
+               "candles: Candles_C doesn't match columns" );
+    }
+    check( FreeCandles_ABI(&cc, 0) == 0, "candles: FreeCandles_ABI failed" );
+    check( cc.n == 0 && cc.datetime == nullptr && cc.volume == nullptr,
+           "candles: FreeCandles_ABI didn't reset" );
+
+    /* empty */
+    for( string e : {"{\"candles\":[],\"symbol\":\"SPY\",\"empty\":true}",
+                     "{}", ""} )
+    {
+        CandleColumns ec;
+        decode_candles(e.data(), e.size(), ec);
+        check( ec.size() == 0, "candles: empty input not empty: " + e );
+        Candles_C ecc;
+        decode_candles(e.data(), e.size(), &ecc);
+        check( ecc.n == 0, "candles: empty Candles_C not empty: " + e );
+        FreeCandles_ABI(&ecc, 0);
+    }
+
+    check( decode_fails("{\"candles\":[{\"open\":1.0}"),
+           "candles: unterminated array didn't fail" );
+    check( decode_fails("{\"candles\":[{\"open\":abc}]}"),
+           "candles: bad number didn't fail" );
+    check( decode_fails("{\"candles\":[{\"open\" 1.0}]}"),
+           "candles: missing ':' didn't fail" );
+    check( decode_fails("[1,2,3]"), "candles: non-object didn't fail" );
+    check( decode_fails("{\"candles\":[1.0]}"),
+           "candles: non-object candle didn't fail" );
+}
+
+/* open/high/low == close */
+CandleColumns
+candle_columns(const vector<long long>& datetimes, double close)
+{
+    CandleColumns c;
+    for( long long dt : datetimes )
+        c.push_back(dt, close, close, close, close, 100);
+    return c;
+}
+
+string
+temp_store_base()
+{
+    const char *d = getenv("TMPDIR");
+    if( !d ) d = getenv("TEMP");
+    if( !d ) d = getenv("TMP");
+    string base = d ? d : ".";
+    return base + "/tdma_test_candles_" + to_string(msec_since_epoch());
+}
+
+void
+remove_store_files(const string& base)
+{
+    for( auto ext : {".candles", ".index", ".candles.tmp", ".index.tmp"} )
+        remove( (base + ext).c_str() );
+}
+
+void
+check_gaps( const CandleStoreFile& f,
+            long long start,
+            long long end,
+            const vector<CandleStoreFile::range_ty>& gaps,
+            const string& what )
+{
+    check( f.missing(start, end) == gaps, "candle store: bad gaps, " + what );
+}
 
+void
+check_records( const CandleStoreView& v,
+               const vector<long long>& datetimes,
+               const vector<double>& closes,
+               const string& what )
+{
+    check( v.n == datetimes.size(), "candle store: bad view size, " + what );
+    for( size_t i = 0; i < v.n; ++i ){
+        check( v.records[i].datetime == datetimes[i],
+               "candle store: bad datetime, " + what );
+        check( v.records[i].close == closes[i],
+               "candle store: bad close, " + what );
+    }
+}
 
+/* header: magic, version, record size, count */
+void
+check_data_header(const string& base, unsigned long long count)
+{
+    FILE *f = fopen( (base + ".candles").c_str(), "rb" );
+    check( f != nullptr, "candle store: no data file" );
+    char magic[8];
+    uint32_t version_size[2];
+    uint64_t n = 0;
+    bool ok = fread(magic, sizeof(magic), 1, f) == 1
+              && fread(version_size, sizeof(version_size), 1, f) == 1
+              && fread(&n, sizeof(n), 1, f) == 1;
+    fclose(f);
+    check( ok, "candle store: short data header" );
+    check( memcmp(magic, "TDMACNDL", 8) == 0, "candle store: bad data magic" );
+    check( version_size[0] == 1, "candle store: bad version" );
+    check( version_size[1] == sizeof(CandleRecord_C),
+           "candle store: bad record size" );
+    check( n == count, "candle store: bad header count" );
+}
 
+/* index: magic, # of ranges, [start, end] ranges */
+vector<CandleStoreFile::range_ty>
+read_index(const string& base)
+{
+    FILE *f = fopen( (base + ".index").c_str(), "rb" );
+    check( f != nullptr, "candle store: no index file" );
+    char magic[8];
+    uint64_t n = 0;
+    bool ok = fread(magic, sizeof(magic), 1, f) == 1
+              && fread(&n, sizeof(n), 1, f) == 1;
+    vector<CandleStoreFile::range_ty> ranges;
+    for( uint64_t i = 0; ok && i < n; ++i ){
+        uint64_t r[2];
+        ok = fread(r, sizeof(r), 1, f) == 1;
+        if( ok )
+            ranges.emplace_back(r[0], r[1]);
+    }
+    fclose(f);
+    check( ok, "candle store: short index file" );
+    check( memcmp(magic, "TDMACIDX", 8) == 0, "candle store: bad index magic" );
+    return ranges;
+}
+
+void
+test_candle_store_file(const string& base)
+{
+    typedef CandleStoreFile::range_ty R;
+
+    auto f = make_shared<CandleStoreFile>(base, MSEC_MIN);
+    check( f->size() == 0, "candle store: new store not empty" );
+    check_gaps( *f, T0, T0 + 9 * MSEC_MIN, {R(T0, T0 + 9 * MSEC_MIN)},
+                "empty store" );
+    check( f->view(0, T0 * 2).n == 0, "candle store: empty view not empty" );
+
+    /* past the end -> append */
+    vector<long long> head = {T0, T0 + MSEC_MIN, T0 + 2 * MSEC_MIN,
+                              T0 + 3 * MSEC_MIN, T0 + 4 * MSEC_MIN};
+    f->insert(T0, T0 + 4 * MSEC_MIN, candle_columns(head, 1.0));
+    check( f->size() == 5, "candle store: bad size after first insert" );
+    check_data_header(base, 5);
+
+    vector<long long> tail = {T0 + 7 * MSEC_MIN, T0 + 8 * MSEC_MIN,
+                              T0 + 9 * MSEC_MIN};
+    f->insert(T0 + 7 * MSEC_MIN, T0 + 9 * MSEC_MIN, candle_columns(tail, 2.0));
+    check( f->size() == 8, "candle store: bad size after append" );
+    check_data_header(base, 8);
+
+    /* separate ranges leave a gap */
+    check_gaps( *f, T0, T0 + 9 * MSEC_MIN,
+                {R(T0 + 4 * MSEC_MIN + 1, T0 + 7 * MSEC_MIN - 1)},
+                "between ranges" );
+    check_gaps( *f, T0 + 8 * MSEC_MIN, T0 + 9 * MSEC_MIN, {},
+                "inside a range" );
+
+    /* a view of the current mapping must survive the rewrite below */
+    CandleStoreView before = f->view(T0, T0 + 4 * MSEC_MIN);
+    check_records( before, head, {1.0, 1.0, 1.0, 1.0, 1.0}, "before rewrite" );
+
+    /*
+     * fill the middle -> rewrite; T0 + 4min is a duplicate (newer wins) and
+     * the range overlaps the first one and is adjacent to the second
+     */
+    f->insert( T0 + 4 * MSEC_MIN, T0 + 7 * MSEC_MIN - 1,
+               candle_columns({T0 + 4 * MSEC_MIN, T0 + 5 * MSEC_MIN,
+                               T0 + 6 * MSEC_MIN}, 3.0) );
+    check( f->size() == 10, "candle store: bad size after rewrite" );
+    check_data_header(base, 10);
+
+    vector<long long> all;
+    for( long long i = 0; i < 10; ++i )
+        all.push_back(T0 + i * MSEC_MIN);
+    vector<double> closes = {1.0, 1.0, 1.0, 1.0, 3.0, 3.0, 3.0,
+                             2.0, 2.0, 2.0};
+    check_records( f->view(T0, T0 + 9 * MSEC_MIN), all, closes,
+                   "after rewrite" );
+    check_records( f->view(T0 + 4 * MSEC_MIN, T0 + 5 * MSEC_MIN),
+                   {T0 + 4 * MSEC_MIN, T0 + 5 * MSEC_MIN}, {3.0, 3.0},
+                   "slice after rewrite" );
+    check_records( before, head, {1.0, 1.0, 1.0, 1.0, 1.0}, "old view" );
+
+    /* coverage merged into one range */
+    check_gaps( *f, T0, T0 + 9 * MSEC_MIN, {}, "merged ranges" );
+    check_gaps( *f, T0 - MSEC_MIN, T0 + 10 * MSEC_MIN,
+                {R(T0 - MSEC_MIN, T0 - 1),
+                 R(T0 + 9 * MSEC_MIN + 1, T0 + 10 * MSEC_MIN)},
+                "around merged range" );
+    check( read_index(base) == vector<R>{R(T0, T0 + 9 * MSEC_MIN)},
+           "candle store: bad index after merge" );
+
+    /* reopen; header and index are read back */
+    before = CandleStoreView();
+    f.reset();
+    f = make_shared<CandleStoreFile>(base, MSEC_MIN);
+    check( f->size() == 10, "candle store: bad size after reopen" );
+    check_records( f->view(0, T0 * 2), all, closes, "after reopen" );
+    check_gaps( *f, T0 - MSEC_MIN, T0 + 9 * MSEC_MIN,
+                {R(T0 - MSEC_MIN, T0 - 1)}, "after reopen" );
+}
+
+void
+test_candle_store()
+{
+    string base = temp_store_base();
+    try{
+        test_candle_store_file(base);
+    }catch(...){
+        remove_store_files(base);
+        throw;
+    }
+    remove_store_files(base);
+}
 
+} /* namespace */
 
+void
+test_candles()
+{
+    test_candle_decoder();
+    test_candle_store();
+}
@@ -68,6 +68,14 @@ int main(int argc, char* argv[])
         test_getters(account_id, cmanager.credentials);
         cout<< "*** [END] TEST GETTERS [END] ***" << endl << endl;
 
+        cout<< "*** [BEGIN] TEST CANDLES [BEGIN] ***" << endl;
+        test_candles();
+        cout<< "*** [END] TEST CANDLES [END] ***" << endl << endl;
+
+        cout<< "*** [BEGIN] TEST STREAMING DECODERS [BEGIN] ***" << endl;
+        test_streaming_decoders();
+        cout<< "*** [END] TEST STREAMING DECODERS [END] ***" << endl << endl;
+
         cout<< "*** [BEGIN] TEST STREAMING [BEGIN] ***" << endl;
         if( use_live_connection ){
             test_streaming(account_id, cmanager.credentials);
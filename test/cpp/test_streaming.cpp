@@ -1,8 +1,14 @@
 #include <iostream>
+#include <cmath>
+#include <thread>
 
 #include "test.h"
 
 #include "tdma_api_streaming.h"
+#include "_streaming.h" /* decoders */
+#include "order_tracker.h"
+#include "json_scanner.h"
+#include "spsc_ring.h"
 
 using namespace tdma;
 using namespace std;
@@ -313,3 +319,632 @@ test_streaming(const string& account_id, Credentials& c)
     }
 
 }
+
+
+/* OFFLINE - inbound ring, content decoders, ACCT_ACTIVITY and the order
+   tracker */
+
+namespace {
+
+string
+order_xml( const string& message,
+           const string& order_id,
+           const string& extra = "" )
+{
+    return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+           "<" + message + "Message xmlns=\"urn:xmlns:beb.ameritrade.com\">"
+           "<OrderGroupID><Firm>310</Firm><AccountKey>123456789</AccountKey>"
+           "</OrderGroupID>"
+           "<ActivityTimestamp>2019-01-02T10:00:00.000-06:00"
+           "</ActivityTimestamp>"
+           "<Order><OrderKey>" + order_id + "</OrderKey>"
+           "<Security><CUSIP>78462F103</CUSIP><Symbol>SPY</Symbol>"
+           "<SecurityType>Common Stock</SecurityType></Security>"
+           "<OrderPricing><Limit>270.5</Limit></OrderPricing>"
+           "<OrderType>Limit</OrderType>"
+           "<OrderInstructions>Buy</OrderInstructions>"
+           "<OriginalQuantity>100</OriginalQuantity></Order>"
+           + extra + "</" + message + "Message>";
+}
+
+/* the contra's <Quantity> is outside <ExecutionInformation> */
+string
+execution_xml(double qty, double price, double leaves = -1)
+{
+    string l = (leaves < 0)
+             ? ""
+             : "<LeavesQuantity>" + to_string(leaves) + "</LeavesQuantity>";
+    return "<ContraInformation><Contra><AccountKey>1</AccountKey>"
+           "<Quantity>999</Quantity></Contra></ContraInformation>"
+           "<ExecutionInformation><Type>Bought</Type>"
+           "<Quantity>" + to_string(qty) + "</Quantity>"
+           "<ExecutionPrice>" + to_string(price) + "</ExecutionPrice>"
+           "<AveragePriceIndicator>false</AveragePriceIndicator>" + l +
+           "<ID>1</ID></ExecutionInformation>";
+}
+
+AcctActivity_C
+decode_message(const string& type, const string& xml)
+{
+    json content = json::array();
+    content.push_back( {{"seq", 1}, {"key", "k"}, {"1", "123456789"},
+                        {"2", type}, {"3", xml}} );
+    string s = content.dump();
+    vector<AcctActivity_C> messages;
+    decode_acct_activity(s.data(), s.size(), messages);
+    check( messages.size() == 1, "bad # of ACCT_ACTIVITY messages" );
+    return messages[0];
+}
+
+void
+test_acct_activity_decoder()
+{
+    typedef AcctActivityMessageType MT;
+    const vector<pair<string, MT>> types = {
+        {"BrokenTrade", MT::broken_trade},
+        {"ManualExecution", MT::manual_execution},
+        {"OrderActivation", MT::order_activation},
+        {"OrderCancelReplaceRequest", MT::order_cancel_replace_request},
+        {"OrderCancelRequest", MT::order_cancel_request},
+        {"OrderEntryRequest", MT::order_entry_request},
+        {"OrderFill", MT::order_fill},
+        {"OrderPartialFill", MT::order_partial_fill},
+        {"OrderRejection", MT::order_rejection},
+        {"OrderRoute", MT::order_route},
+        {"TooLateToCancel", MT::too_late_to_cancel},
+        {"UROUT", MT::ur_out},
+        {"SomethingNew", MT::other}
+    };
+    for( auto& t : types ){
+        AcctActivity_C m = decode_message(t.first, order_xml(t.first, "42"));
+        check( m.message_type == static_cast<int>(t.second),
+               "bad message type: " + t.first );
+        check( string(m.account) == "123456789", "bad account: " + t.first );
+        check( string(m.order_id) == "42", "bad order id: " + t.first );
+        check( string(m.symbol) == "SPY", "bad symbol: " + t.first );
+        check( string(m.instruction) == "Buy", "bad instruction: " + t.first );
+        check( approx(m.quantity, 100), "bad quantity: " + t.first );
+        check( approx(m.limit_price, 270.5), "bad limit price: " + t.first );
+        check( m.execution_quantity == 0 && m.leaves_quantity == -1,
+               "bad execution values: " + t.first );
+    }
+
+    AcctActivity_C m = decode_message(
+        "OrderPartialFill",
+        order_xml("OrderPartialFill", "42", execution_xml(40, 270.25, 60))
+        );
+    check( approx(m.execution_quantity, 40) && approx(m.execution_price, 270.25)
+           && approx(m.leaves_quantity, 60), "bad partial fill values" );
+
+    m = decode_message( "OrderFill",
+                        order_xml("OrderFill", "42", execution_xml(100, 271)) );
+    check( approx(m.execution_quantity, 100) && m.leaves_quantity == -1,
+           "bad fill values w/o LeavesQuantity" );
+
+    m = decode_message( "OrderCancelReplaceRequest",
+                        order_xml("OrderCancelReplaceRequest", "43",
+                                  "<PendingCancelQuantity>100"
+                                  "</PendingCancelQuantity>"
+                                  "<OriginalOrderId>42</OriginalOrderId>") );
+    check( string(m.original_order_id) == "42", "bad original order id" );
+
+    m = decode_message("SUBSCRIBED", "");
+    check( m.message_type == static_cast<int>(MT::subscribed)
+           && !*m.order_id, "bad SUBSCRIBED message" );
+
+    vector<AcctActivity_C> messages;
+    string bad = "[{\"1\":";
+    try{
+        decode_acct_activity(bad.data(), bad.size(), messages);
+        throw runtime_error("failed to catch bad ACCT_ACTIVITY content");
+    }catch( StreamingException& e ){
+        cout<< "successfully caught: " << e.what() << endl;
+    }
+}
+
+void
+apply_message( OrderTracker& orders,
+               const string& type,
+               const string& order_id,
+               const string& extra = "" )
+{
+    static unsigned long long ts = 0;
+    orders.apply( ++ts, decode_message(type, order_xml(type, order_id, extra)) );
+}
+
+OrderState_C
+order_state(const OrderTracker& orders, const string& order_id)
+{
+    OrderState_C o;
+    check( orders.get(order_id, o), "order not tracked: " + order_id );
+    return o;
+}
+
+void
+check_status( const OrderTracker& orders,
+              const string& order_id,
+              OrderStatusType status )
+{
+    OrderState_C o = order_state(orders, order_id);
+    check( o.status == static_cast<int>(status),
+           "order " + order_id + " status "
+           + to_string(static_cast<OrderStatusType>(o.status)) + " != "
+           + to_string(status) );
+}
+
+void
+test_order_tracker()
+{
+    typedef OrderStatusType ST;
+
+    /* entry -> route -> partial -> fill */
+    {
+        OrderTracker orders;
+        apply_message(orders, "OrderEntryRequest", "1");
+        check_status(orders, "1", ST::ACCEPTED);
+        apply_message(orders, "OrderRoute", "1");
+        check_status(orders, "1", ST::WORKING);
+        apply_message(orders, "OrderPartialFill", "1",
+                      execution_xml(40, 270, 60));
+        check_status(orders, "1", ST::WORKING);
+        OrderState_C o = order_state(orders, "1");
+        check( approx(o.filled_quantity, 40) && approx(o.remaining_quantity, 60)
+               && approx(o.average_fill_price, 270), "bad partial fill state" );
+        apply_message(orders, "OrderFill", "1", execution_xml(60, 271, 0));
+        check_status(orders, "1", ST::FILLED);
+        o = order_state(orders, "1");
+        check( approx(o.filled_quantity, 100) && approx(o.remaining_quantity, 0)
+               && approx(o.average_fill_price, 270.6)
+               && approx(o.last_fill_price, 271)
+               && approx(o.last_fill_quantity, 60), "bad fill state" );
+        check( string(o.symbol) == "SPY" && approx(o.quantity, 100)
+               && approx(o.limit_price, 270.5), "bad order values" );
+        check( orders.size() == 1, "bad # of orders" );
+    }
+
+    /* fills w/o <LeavesQuantity> go by the order quantity */
+    {
+        OrderTracker orders;
+        apply_message(orders, "OrderEntryRequest", "1");
+        apply_message(orders, "OrderPartialFill", "1", execution_xml(40, 270));
+        check_status(orders, "1", ST::WORKING);
+        check( approx(order_state(orders, "1").remaining_quantity, 60),
+               "bad remaining quantity w/o LeavesQuantity" );
+        apply_message(orders, "OrderFill", "1", execution_xml(60, 270));
+        check_status(orders, "1", ST::FILLED);
+    }
+
+    /* cancel request -> UROUT */
+    {
+        OrderTracker orders;
+        apply_message(orders, "OrderEntryRequest", "1");
+        apply_message(orders, "OrderRoute", "1");
+        apply_message(orders, "OrderCancelRequest", "1");
+        check_status(orders, "1", ST::PENDING_CANCEL);
+        apply_message(orders, "UROUT", "1");
+        check_status(orders, "1", ST::CANCELED);
+    }
+
+    /* cancel request -> too late to cancel */
+    {
+        OrderTracker orders;
+        apply_message(orders, "OrderEntryRequest", "1");
+        apply_message(orders, "OrderRoute", "1");
+        apply_message(orders, "OrderCancelRequest", "1");
+        apply_message(orders, "TooLateToCancel", "1");
+        check_status(orders, "1", ST::WORKING);
+    }
+
+    /* replace: the original goes PENDING_REPLACE -> REPLACED */
+    {
+        OrderTracker orders;
+        apply_message(orders, "OrderEntryRequest", "1");
+        apply_message(orders, "OrderRoute", "1");
+        apply_message(orders, "OrderCancelReplaceRequest", "2",
+                      "<OriginalOrderId>1</OriginalOrderId>");
+        check_status(orders, "1", ST::PENDING_REPLACE);
+        check_status(orders, "2", ST::ACCEPTED);
+        apply_message(orders, "UROUT", "1");
+        check_status(orders, "1", ST::REPLACED);
+        apply_message(orders, "OrderRoute", "2");
+        check_status(orders, "2", ST::WORKING);
+        check( orders.size() == 2, "bad # of orders after replace" );
+    }
+
+    /* rejection; first seen mid-life */
+    {
+        OrderTracker orders;
+        apply_message(orders, "OrderEntryRequest", "1");
+        apply_message(orders, "OrderRejection", "1");
+        check_status(orders, "1", ST::REJECTED);
+        apply_message(orders, "OrderPartialFill", "2",
+                      execution_xml(10, 270, 90));
+        check_status(orders, "2", ST::WORKING);
+        check( approx(order_state(orders, "2").filled_quantity, 10),
+               "bad fill state for order first seen mid-life" );
+    }
+}
+
+/* the protected primitives, for testing */
+class TestScanner
+        : private JsonScanner {
+public:
+    TestScanner(const string& s)
+        : JsonScanner(s.data(), s.size())
+        {}
+
+    void
+    expect(char c)
+    { _expect(c); }
+
+    bool
+    consume(char c)
+    { return _consume(c); }
+
+    string
+    next_string()
+    {
+        slice_ty s = _string();
+        return string(s.first, s.second);
+    }
+
+    string
+    next_literal()
+    {
+        slice_ty s = _literal();
+        return string(s.first, s.second);
+    }
+
+    void
+    skip()
+    { _skip_value(); }
+
+    bool
+    at_end()
+    {
+        _skip_ws();
+        return _p == _end;
+    }
+
+    template<typename F>
+    static bool
+    fails(const string& s, F f)
+    {
+        TestScanner t(s);
+        try{
+            f(t);
+        }catch( Fail& ){
+            return true;
+        }
+        return false;
+    }
+};
+
+void
+check_pops( SPSCRing<string>& r,
+            const vector<string>& expected,
+            const string& what )
+{
+    for( auto& e : expected ){
+        string s;
+        check( r.pop(s), "ring: nothing to pop, " + what );
+        check( s == e, "ring: popped '" + s + "' not '" + e + "', " + what );
+    }
+}
+
+void
+test_spsc_ring_order()
+{
+    SPSCRing<string> r(4);
+    check( r.capacity() == 4, "ring: bad capacity" );
+
+    /* fill the ring, spill, drain both in order, then back to the ring */
+    for( int i = 1; i <= 10; ++i )
+        r.push( [i](string& s){ s = to_string(i); } );
+    check( r.size() == 10, "ring: bad size after spill" );
+    check( r.nspilled() == 6, "ring: bad spill count" );
+    check_pops(r, {"1","2","3","4","5","6","7","8","9","10"}, "ring -> spill");
+    string s;
+    check( !r.pop(s), "ring: popped from an empty ring" );
+
+    r.push( [](string& s){ s = "11"; } );
+    r.push( [](string& s){ s = "12"; } );
+    check( r.nspilled() == 6, "ring: didn't go back to the ring" );
+    check_pops(r, {"11","12"}, "spill -> ring");
+
+    /* push while partially drained: still spilling until the spill is empty */
+    for( int i = 13; i <= 18; ++i )
+        r.push( [i](string& s){ s = to_string(i); } );
+    check_pops(r, {"13","14"}, "partial drain");
+    r.push( [](string& s){ s = "19"; } );
+    check( r.nspilled() == 9, "ring: stopped spilling early" );
+    check_pops(r, {"15","16","17","18","19"}, "partial drain");
+    check( !r.pop(s), "ring: popped from an empty ring" );
+}
+
+void
+test_spsc_ring_interrupt()
+{
+    SPSCRing<string> r(4);
+
+    /* the empty marker comes after everything pushed before interrupt() */
+    r.push( [](string& s){ s = "1"; } );
+    r.push( [](string& s){ s = "2"; } );
+    r.interrupt();
+    r.push( [](string& s){ s = "3"; } );
+    check_pops(r, {"1", "2", "", "3"}, "interrupt");
+
+    string s = "x";
+    r.interrupt();
+    check( r.pop(s) && s.empty(), "ring: no marker on an empty ring" );
+    check( !r.pop(s), "ring: marker popped twice" );
+
+    /* ...including spilled ones */
+    for( int i = 1; i <= 6; ++i )
+        r.push( [i](string& s){ s = to_string(i); } );
+    r.interrupt();
+    check_pops(r, {"1","2","3","4","5","6",""}, "interrupt after spill");
+
+    check( !r.pop_or_wait_for(s, chrono::milliseconds(10)),
+           "ring: wait didn't time out" );
+    r.interrupt();
+    check( r.pop_or_wait_for(s, chrono::milliseconds(1000)) && s.empty(),
+           "ring: wait didn't see the marker" );
+}
+
+/* the consumer stalls now and then so the producer spills mid-stream */
+void
+test_spsc_ring_threads()
+{
+    const size_t N = 200000;
+    SPSCRing<size_t> r(16);
+
+    thread producer( [&r, N](){
+        for( size_t i = 1; i <= N; ++i ){
+            r.push( [i](size_t& v){ v = i; } );
+            if( i % 64 == 0 )
+                this_thread::yield();
+        }
+    } );
+
+    size_t bad = 0;
+    for( size_t i = 1; i <= N; ++i ){
+        size_t v = 0;
+        r.pop_or_wait(v);
+        if( v != i && !bad )
+            bad = i;
+        if( i % 5000 == 0 )
+            this_thread::sleep_for( chrono::microseconds(100) );
+    }
+    producer.join();
+
+    cout<< "ring stress: " << N << " pushed, " << r.nspilled()
+        << " spilled" << endl;
+    check( !bad, "ring: out of order at " + to_string(bad) );
+    size_t v;
+    check( !r.pop(v), "ring: left over after stress" );
+}
+
+void
+test_json_scanner()
+{
+    /* whitespace, and escapes/brackets inside strings */
+    string j = " { \"a\" : \"x\\\"y]}\" , \"b\":[1,{\"c\":\"]\"},[]] ,"
+               "\"d\":-1.5e3, \"e\":null}\n";
+    TestScanner t(j);
+    t.expect('{');
+    check( t.next_string() == "a", "scanner: bad key a" );
+    t.expect(':');
+    check( t.next_string() == "x\\\"y]}", "scanner: bad escaped string" );
+    check( t.consume(','), "scanner: no ','" );
+    check( t.next_string() == "b", "scanner: bad key b" );
+    t.expect(':');
+    t.skip();
+    check( t.consume(','), "scanner: skip_value didn't stop after ']'" );
+    check( t.next_string() == "d", "scanner: bad key d" );
+    t.expect(':');
+    check( t.next_literal() == "-1.5e3", "scanner: bad number" );
+    t.expect(',');
+    check( t.next_string() == "e", "scanner: bad key e" );
+    t.expect(':');
+    check( t.next_literal() == "null", "scanner: bad null" );
+    check( !t.consume(','), "scanner: consumed the wrong char" );
+    t.expect('}');
+    check( t.at_end(), "scanner: not at end" );
+
+    check( TestScanner::fails("\"abc", [](TestScanner& s){ s.next_string(); }),
+           "scanner: unterminated string didn't fail" );
+    check( TestScanner::fails("\"ab\\\"",
+                              [](TestScanner& s){ s.next_string(); }),
+           "scanner: escaped closing quote didn't fail" );
+    check( TestScanner::fails("[1,[2]", [](TestScanner& s){ s.skip(); }),
+           "scanner: unterminated array didn't fail" );
+    check( TestScanner::fails(",1", [](TestScanner& s){ s.next_literal(); }),
+           "scanner: empty literal didn't fail" );
+    check( TestScanner::fails("  ", [](TestScanner& s){ s.expect('['); }),
+           "scanner: expect at end didn't fail" );
+}
+
+template<typename T, typename E>
+bool
+has_field(const T& u, E field)
+{ return u.fields & (1ULL << static_cast<int>(field)); }
+
+template<typename T, typename F>
+vector<T>
+decode_content(F decode, const string& content)
+{
+    vector<T> out;
+    decode(content.data(), content.size(), out);
+    return out;
+}
+
+template<typename T, typename F>
+void
+check_decode_fails(F decode, const string& content, const string& what)
+{
+    try{
+        decode_content<T>(decode, content);
+    }catch( StreamingException& e ){
+        cout<< "successfully caught: " << e.what() << endl;
+        return;
+    }
+    throw runtime_error("failed to catch bad content: " + what);
+}
+
+void
+test_quote_decoder()
+{
+    typedef QuotesSubscriptionField QF;
+
+    /* nulls stay unset, non-numbered and unknown fields are skipped */
+    string content =
+        "[{\"key\":\"SPY\",\"delayed\":false,\"assetMainType\":\"EQUITY\","
+        "\"1\":270.1,\"2\":null,\"4\":\"300\",\"6\":\"P\",\"8\":12345678,"
+        "\"17\":true,\"18\":0,"
+        "\"25\":\"S\\u0026P \\\"500\\\" \\u00c4\\ud83d\\ude00\\/\\\\\","
+        "\"99\":{\"x\":[1,\"]\"]},\"102\":[]},"
+        " {\"key\":\"QQQ\",\"3\":170.25,\"10\":1.5e3}]";
+    auto q = decode_content<QuoteUpdate_C>(decode_quote_updates, content);
+    check( q.size() == 2, "quotes: bad # of updates" );
+
+    check( string(q[0].symbol) == "SPY", "quotes: bad symbol" );
+    check( approx(q[0].bid_price, 270.1) && has_field(q[0], QF::bid_price),
+           "quotes: bad bid_price" );
+    check( q[0].ask_price == 0 && !has_field(q[0], QF::ask_price),
+           "quotes: null ask_price was set" );
+    check( q[0].bid_size == 300, "quotes: bad bid_size (string)" );
+    check( q[0].ask_id == 'P', "quotes: bad ask_id" );
+    check( q[0].total_volume == 12345678, "quotes: bad total_volume" );
+    check( q[0].marginable == 1 && q[0].shortable == 0
+           && has_field(q[0], QF::shortable), "quotes: bad booleans" );
+    check( string(q[0].description)
+               == "S&P \"500\" \xC3\x84" "\xF0\x9F\x98\x80" "/\\",
+           "quotes: bad unescaped description" );
+    check( q[0].fields == ( (1ULL << static_cast<int>(QF::symbol))
+                            | (1ULL << static_cast<int>(QF::bid_price))
+                            | (1ULL << static_cast<int>(QF::bid_size))
+                            | (1ULL << static_cast<int>(QF::ask_id))
+                            | (1ULL << static_cast<int>(QF::total_volume))
+                            | (1ULL << static_cast<int>(QF::marginable))
+                            | (1ULL << static_cast<int>(QF::shortable))
+                            | (1ULL << static_cast<int>(QF::description)) ),
+           "quotes: bad field bits" );
+
+    check( string(q[1].symbol) == "QQQ" && approx(q[1].last_price, 170.25)
+           && q[1].trade_time == 1500, "quotes: bad second update" );
+
+    /* truncated before a multi-byte char, not inside it */
+    string desc(STREAMING_TEXT_BUFFER_SIZE - 2, 'A');
+    q = decode_content<QuoteUpdate_C>(
+        decode_quote_updates,
+        "[{\"key\":\"SPY\",\"25\":\"" + desc + "\\u00c4\"}]" );
+    check( string(q[0].description) == desc, "quotes: bad truncation" );
+
+    check( decode_content<QuoteUpdate_C>(decode_quote_updates, " [ ] ").empty(),
+           "quotes: empty content" );
+
+    check_decode_fails<QuoteUpdate_C>(decode_quote_updates,
+        "[{\"key\":\"SPY\",\"25\":\"\\ud83d\"}]", "lone surrogate");
+    check_decode_fails<QuoteUpdate_C>(decode_quote_updates,
+        "[{\"key\":\"SPY\",\"25\":\"\\u00zz\"}]", "bad hex");
+    check_decode_fails<QuoteUpdate_C>(decode_quote_updates,
+        "[{\"key\":\"SPY\",\"1\":\"abc\"}]", "bad number");
+    check_decode_fails<QuoteUpdate_C>(decode_quote_updates,
+        "[{\"key\":\"SPY\"}] x", "trailing data");
+    check_decode_fails<QuoteUpdate_C>(decode_quote_updates,
+        "[{\"key\":\"SPY\",\"1\":", "truncated content");
+}
+
+void
+test_option_decoder()
+{
+    typedef OptionsSubscriptionField OF;
+
+    string content =
+        "[{\"key\":\"SPY_011819C270\",\"1\":\"SPY Jan 18 2019 270 Call\","
+        "\"2\":1.5,\"3\":null,\"24\":270,\"25\":\"C\",\"26\":\"SPY\","
+        "\"32\":-0.55,\"unknown\":\"x\",\"500\":1}]";
+    auto o = decode_content<OptionUpdate_C>(decode_option_updates, content);
+    check( o.size() == 1, "options: bad # of updates" );
+    check( string(o[0].symbol) == "SPY_011819C270"
+           && string(o[0].description) == "SPY Jan 18 2019 270 Call",
+           "options: bad text fields" );
+    check( approx(o[0].bid_price, 1.5) && !has_field(o[0], OF::ask_price),
+           "options: bad prices" );
+    check( approx(o[0].strike_price, 270) && o[0].contract_type == 'C'
+           && string(o[0].underlying) == "SPY" && approx(o[0].delta, -0.55),
+           "options: bad contract values" );
+    check( has_field(o[0], OF::delta) && !has_field(o[0], OF::gamma),
+           "options: bad field bits" );
+}
+
+void
+test_timesale_decoder()
+{
+    typedef TimesaleSubscriptionField TF;
+
+    string content =
+        "[{\"seq\":1,\"key\":\"SPY\",\"1\":1546444800000,\"2\":250.5,"
+        "\"3\":100.0,\"4\":12345},"
+        "{\"seq\":2,\"key\":\"SPY\",\"2\":250.75,\"3\":null}]";
+    auto t = decode_content<TimesaleTick_C>(decode_timesale_ticks, content);
+    check( t.size() == 2, "timesale: bad # of ticks" );
+    check( t[0].trade_time == 1546444800000LL && approx(t[0].last_price, 250.5)
+           && approx(t[0].last_size, 100) && t[0].last_sequence == 12345,
+           "timesale: bad first tick" );
+    check( has_field(t[0], TF::last_sequence), "timesale: bad field bits" );
+    check( approx(t[1].last_price, 250.75) && !has_field(t[1], TF::last_size)
+           && !has_field(t[1], TF::trade_time), "timesale: bad second tick" );
+}
+
+void
+test_chart_decoder()
+{
+    typedef ChartEquitySubscriptionField CF;
+
+    string content =
+        "[{\"seq\":0,\"key\":\"SPY\",\"1\":250,\"2\":251,\"3\":249,"
+        "\"4\":250.5,\"5\":1000.0,\"6\":7,\"7\":1546444800000,"
+        "\"8\":17900}]";
+    vector<ChartBar_C> b;
+    decode_chart_bars(StreamerServiceType::CHART_EQUITY, content.data(),
+                      content.size(), b);
+    check( b.size() == 1 && string(b[0].symbol) == "SPY", "chart: bad bar" );
+    check( approx(b[0].open_price, 250) && approx(b[0].high_price, 251)
+           && approx(b[0].low_price, 249) && approx(b[0].close_price, 250.5)
+           && approx(b[0].volume, 1000) && b[0].sequence == 7
+           && b[0].chart_time == 1546444800000LL && b[0].chart_day == 17900,
+           "chart: bad equity values" );
+
+    /* futures/options fields are in a different order, same bits */
+    content = "[{\"seq\":0,\"key\":\"/ES\",\"1\":1546444800000,"
+              "\"2\":2500,\"3\":2510,\"4\":2490,\"5\":2505,\"6\":null}]";
+    decode_chart_bars(StreamerServiceType::CHART_FUTURES, content.data(),
+                      content.size(), b);
+    check( b.size() == 1 && string(b[0].symbol) == "/ES"
+           && b[0].chart_time == 1546444800000LL
+           && approx(b[0].open_price, 2500) && approx(b[0].high_price, 2510)
+           && approx(b[0].low_price, 2490) && approx(b[0].close_price, 2505),
+           "chart: bad futures values" );
+    check( has_field(b[0], CF::chart_time) && has_field(b[0], CF::close_price)
+           && !has_field(b[0], CF::volume) && !has_field(b[0], CF::sequence),
+           "chart: bad futures field bits" );
+}
+
+} /* namespace */
+
+void
+test_streaming_decoders()
+{
+    test_spsc_ring_order();
+    test_spsc_ring_interrupt();
+    test_spsc_ring_threads();
+    test_json_scanner();
+    test_quote_decoder();
+    test_option_decoder();
+    test_timesale_decoder();
+    test_chart_decoder();
+    test_acct_activity_decoder();
+    test_order_tracker();
+}
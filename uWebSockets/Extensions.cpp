@@ -123,7 +123,22 @@ void ExtensionsNegotiator<isServer>::readOffer(std::string offer) {
             options &= ~PERMESSAGE_DEFLATE;
         }
     } else {
-        // todo!
+        // the server's answer to our offer; it can only accept or narrow it
+        ExtensionsParser extensionsParser(offer.data(), offer.length());
+        if ((options & PERMESSAGE_DEFLATE) && extensionsParser.perMessageDeflate) {
+            if (extensionsParser.clientNoContextTakeover) {
+                options |= CLIENT_NO_CONTEXT_TAKEOVER;
+            }
+
+            // without this the server keeps its window, so must our inflater
+            if (extensionsParser.serverNoContextTakeover) {
+                options |= SERVER_NO_CONTEXT_TAKEOVER;
+            } else {
+                options &= ~SERVER_NO_CONTEXT_TAKEOVER;
+            }
+        } else {
+            options &= ~PERMESSAGE_DEFLATE;
+        }
     }
 }
 
@@ -158,8 +158,18 @@ uS::Socket *HttpSocket<isServer>::onData(uS::Socket *s, char *data, size_t lengt
             } else {
                 if (req.getHeader("upgrade", 7)) {
 
+                    // what the server accepted of our extensions offer (if any)
+                    int options = Group<isServer>::from(httpSocket)->extensionOptions;
+                    if (options & PERMESSAGE_DEFLATE) {
+                        Header extensions = req.getHeader("sec-websocket-extensions", 24);
+                        ExtensionsNegotiator<uWS::CLIENT> extensionsNegotiator(options);
+                        extensionsNegotiator.readOffer(extensions ? std::string(extensions.value, extensions.valueLength) : std::string());
+                        options = extensionsNegotiator.getNegotiatedOptions();
+                    }
+                    bool perMessageDeflate = options & PERMESSAGE_DEFLATE;
+
                     // Warning: changes socket, needs to inform the stack of Poll address change!
-                    WebSocket<isServer> *webSocket = new WebSocket<isServer>(false, httpSocket);
+                    WebSocket<isServer> *webSocket = new WebSocket<isServer>(perMessageDeflate, httpSocket, !(options & SERVER_NO_CONTEXT_TAKEOVER));
                     httpSocket->cancelTimeout();
                     webSocket->setUserData(httpSocket->httpUser);
                     webSocket->template setState<WebSocket<isServer>>();
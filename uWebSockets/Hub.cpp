@@ -10,6 +10,11 @@ z_stream *Hub::allocateDefaultCompressor(z_stream *zStream) {
     return zStream;
 }
 
+z_stream *Hub::allocateDefaultDecompressor(z_stream *zStream) {
+    inflateInit2(zStream, -15);
+    return zStream;
+}
+
 char *Hub::deflate(char *data, size_t &length, z_stream *slidingDeflateWindow) {
     dynamicZlibBuffer.clear();
 
@@ -52,9 +57,61 @@ char *Hub::deflate(char *data, size_t &length, z_stream *slidingDeflateWindow) {
 }
 
 // todo: let's go through this code once more some time!
-char *Hub::inflate(char *data, size_t &length, size_t maxPayload) {
+char *Hub::inflate(char *data, size_t &length, size_t maxPayload, z_stream *slidingInflateWindow) {
     dynamicZlibBuffer.clear();
 
+    if (slidingInflateWindow) {
+        // the sender kept its window (context takeover) so we keep ours: never reset,
+        // and give each message back the 0x00 0x00 0xff 0xff it stripped (RFC 7692 7.2.2)
+        static char tail[] = {0x00, 0x00, (char) 0xff, (char) 0xff};
+        char *input[] = {data, tail};
+        size_t inputLength[] = {length, sizeof(tail)};
+
+        size_t produced = 0;
+        int err = Z_OK;
+        for (int i = 0; i < 2; i++) {
+            slidingInflateWindow->next_in = (Bytef *) input[i];
+            slidingInflateWindow->avail_in = (unsigned int) inputLength[i];
+            bool full;
+            do {
+                slidingInflateWindow->next_out = (Bytef *) zlibBuffer + produced;
+                slidingInflateWindow->avail_out = (unsigned int) (LARGE_BUFFER_SIZE - produced);
+                err = ::inflate(slidingInflateWindow, Z_SYNC_FLUSH);
+                produced = LARGE_BUFFER_SIZE - slidingInflateWindow->avail_out;
+                full = !slidingInflateWindow->avail_out;
+                if (full) {
+                    dynamicZlibBuffer.append(zlibBuffer, produced);
+                    produced = 0;
+                }
+            } while (err == Z_OK && (slidingInflateWindow->avail_in || full) && dynamicZlibBuffer.length() <= maxPayload);
+
+            if (err == Z_STREAM_END) {
+                // the sender ended its stream; the next message starts a new one
+                inflateReset(slidingInflateWindow);
+                err = Z_OK;
+                break;
+            }
+            // Z_BUF_ERROR: all of the input used, nothing more to output
+            if ((err != Z_OK && err != Z_BUF_ERROR) || dynamicZlibBuffer.length() > maxPayload) {
+                length = 0;
+                return nullptr;
+            }
+        }
+
+        if (dynamicZlibBuffer.length()) {
+            dynamicZlibBuffer.append(zlibBuffer, produced);
+            if (dynamicZlibBuffer.length() > maxPayload) {
+                length = 0;
+                return nullptr;
+            }
+            length = dynamicZlibBuffer.length();
+            return (char *) dynamicZlibBuffer.data();
+        }
+
+        length = produced;
+        return zlibBuffer;
+    }
+
     inflationStream.next_in = (Bytef *) data;
     inflationStream.avail_in = (unsigned int) length;
 
@@ -224,6 +281,11 @@ void Hub::connect(std::string uri, void *user, std::map<std::string, std::string
                                      "Host: " + hostname + ":" + std::to_string(port) + "\r\n"
                                      "Sec-WebSocket-Version: 13\r\n";
 
+            if (eh->extensionOptions & PERMESSAGE_DEFLATE) {
+                ExtensionsNegotiator<CLIENT> extensionsNegotiator(eh->extensionOptions);
+                httpSocket->httpBuffer += "Sec-WebSocket-Extensions: " + extensionsNegotiator.generateOffer() + "\r\n";
+            }
+
             for (std::pair<std::string, std::string> header : extraHeaders) {
                 httpSocket->httpBuffer += header.first + ": " + header.second + "\r\n";
             }
@@ -19,10 +19,11 @@ protected:
     };
 
     static z_stream *allocateDefaultCompressor(z_stream *zStream);
+    static z_stream *allocateDefaultDecompressor(z_stream *zStream);
 
     z_stream inflationStream = {}, deflationStream = {};
     char *deflate(char *data, size_t &length, z_stream *slidingDeflateWindow);
-    char *inflate(char *data, size_t &length, size_t maxPayload);
+    char *inflate(char *data, size_t &length, size_t maxPayload, z_stream *slidingInflateWindow = nullptr);
     char *zlibBuffer;
     std::string dynamicZlibBuffer;
     static const int LARGE_BUFFER_SIZE = 300 * 1024;
@@ -46,8 +47,9 @@ public:
     void connect(std::string uri, void *user = nullptr, std::map<std::string, std::string> extraHeaders = {}, int timeoutMs = 5000, Group<CLIENT> *eh = nullptr);
     void upgrade(uv_os_sock_t fd, const char *secKey, SSL *ssl, const char *extensions, size_t extensionsLength, const char *subprotocol, size_t subprotocolLength, Group<SERVER> *serverGroup = nullptr);
 
-    Hub(int extensionOptions = 0, bool useDefaultLoop = false, unsigned int maxPayload = 16777216) : uS::Node(LARGE_BUFFER_SIZE, WebSocketProtocol<SERVER, WebSocket<SERVER>>::CONSUME_PRE_PADDING, WebSocketProtocol<SERVER, WebSocket<SERVER>>::CONSUME_POST_PADDING, useDefaultLoop),
-                                             Group<SERVER>(extensionOptions, maxPayload, this, nodeData), Group<CLIENT>(0, maxPayload, this, nodeData) {
+    // clientExtensionOptions: PERMESSAGE_DEFLATE to offer it when connecting (we inflate, never deflate)
+    Hub(int extensionOptions = 0, bool useDefaultLoop = false, unsigned int maxPayload = 16777216, int clientExtensionOptions = 0) : uS::Node(LARGE_BUFFER_SIZE, WebSocketProtocol<SERVER, WebSocket<SERVER>>::CONSUME_PRE_PADDING, WebSocketProtocol<SERVER, WebSocket<SERVER>>::CONSUME_POST_PADDING, useDefaultLoop),
+                                             Group<SERVER>(extensionOptions, maxPayload, this, nodeData), Group<CLIENT>(clientExtensionOptions, maxPayload, this, nodeData) {
         inflateInit2(&inflationStream, -15);
         zlibBuffer = new char[LARGE_BUFFER_SIZE];
 
@@ -5,9 +5,14 @@
 namespace uWS {
 
 template <bool isServer>
-WebSocket<isServer>::WebSocket(bool perMessageDeflate, uS::Socket *socket) : uS::Socket(std::move(*socket)) {
+WebSocket<isServer>::WebSocket(bool perMessageDeflate, uS::Socket *socket, bool keepInflateWindow) : uS::Socket(std::move(*socket)) {
     compressionStatus = perMessageDeflate ? CompressionStatus::ENABLED : CompressionStatus::DISABLED;
 
+    // the peer compresses w/ context takeover; our inflater has to keep its window too
+    if (perMessageDeflate && keepInflateWindow) {
+        slidingInflateWindow = Hub::allocateDefaultDecompressor(new z_stream{});
+    }
+
     // if we are created in a group with sliding deflate window allocate it here
     if (Group<isServer>::from(this)->extensionOptions & SLIDING_DEFLATE_WINDOW) {
         slidingDeflateWindow = Hub::allocateDefaultCompressor(new z_stream{});
@@ -315,6 +320,13 @@ void WebSocket<isServer>::onEnd(uS::Socket *s) {
         delete (z_stream *) webSocket->slidingDeflateWindow;
         webSocket->slidingDeflateWindow = nullptr;
     }
+
+    if (webSocket->slidingInflateWindow) {
+        // this relates to Hub::allocateDefaultDecompressor
+        inflateEnd((z_stream *) webSocket->slidingInflateWindow);
+        delete (z_stream *) webSocket->slidingInflateWindow;
+        webSocket->slidingInflateWindow = nullptr;
+    }
 }
 
 template <bool isServer>
@@ -324,9 +336,10 @@ bool WebSocket<isServer>::handleFragment(char *data, size_t length, unsigned int
 
     if (opCode < 3) {
         if (!remainingBytes && fin && !webSocket->fragmentBuffer.length()) {
+            webSocket->wireLength = length;
             if (webSocket->compressionStatus == WebSocket<isServer>::CompressionStatus::COMPRESSED_FRAME) {
                     webSocket->compressionStatus = WebSocket<isServer>::CompressionStatus::ENABLED;
-                    data = group->hub->inflate(data, length, group->maxPayload);
+                    data = group->hub->inflate(data, length, group->maxPayload, (z_stream *) webSocket->slidingInflateWindow);
                     if (!data) {
                         forceClose(webSocketState);
                         return true;
@@ -346,10 +359,11 @@ bool WebSocket<isServer>::handleFragment(char *data, size_t length, unsigned int
             webSocket->fragmentBuffer.append(data, length);
             if (!remainingBytes && fin) {
                 length = webSocket->fragmentBuffer.length();
+                webSocket->wireLength = length;
                 if (webSocket->compressionStatus == WebSocket<isServer>::CompressionStatus::COMPRESSED_FRAME) {
                         webSocket->compressionStatus = WebSocket<isServer>::CompressionStatus::ENABLED;
                         webSocket->fragmentBuffer.append("....");
-                        data = group->hub->inflate((char *) webSocket->fragmentBuffer.data(), length, group->maxPayload);
+                        data = group->hub->inflate((char *) webSocket->fragmentBuffer.data(), length, group->maxPayload, (z_stream *) webSocket->slidingInflateWindow);
                         if (!data) {
                             forceClose(webSocketState);
                             return true;
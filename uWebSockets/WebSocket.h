@@ -24,8 +24,11 @@ protected:
     unsigned char controlTipLength = 0, hasOutstandingPong = false;
 
     void *slidingDeflateWindow = nullptr;
+    // client: kept across messages unless the server agreed to server_no_context_takeover
+    void *slidingInflateWindow = nullptr;
+    size_t wireLength = 0;
 
-    WebSocket(bool perMessageDeflate, uS::Socket *socket);
+    WebSocket(bool perMessageDeflate, uS::Socket *socket, bool keepInflateWindow = false);
 
     static uS::Socket *onData(uS::Socket *s, char *data, size_t length);
     static void onEnd(uS::Socket *s);
@@ -68,6 +71,11 @@ public:
     void close(int code = 1000, const char *message = nullptr, size_t length = 0);
     void transfer(Group<isServer> *group);
 
+    // permessage-deflate was negotiated
+    bool hasPerMessageDeflate() {return compressionStatus != CompressionStatus::DISABLED;}
+    // payload bytes of the message being handled, as received (before inflating)
+    size_t getWireLength() {return wireLength;}
+
     // Thread safe
     void terminate();
     void ping(const char *message) {send(message, OpCode::PING);}